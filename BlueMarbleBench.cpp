@@ -0,0 +1,1055 @@
+#include<iostream>
+#include<algorithm>
+#include<cassert>
+#include<cctype>
+#include<chrono>
+#include<cmath>
+#include<cstdio>
+#include<cstdlib>
+#include<cstring>
+#include<fstream>
+#include<map>
+#include<random>
+#include<sstream>
+#include<string>
+#include<vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include<windows.h>
+#include<psapi.h>
+#else
+#include<sys/resource.h>
+#endif
+
+#include<GL/glew.h>
+#ifndef BLUEMARBLE_HEADLESS
+#include<GLFW/glfw3.h>
+#endif
+#include<glm/glm.hpp>
+#include<glm/ext.hpp>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include "FrameUniforms.h"
+#include "GLState.h"
+#include "HeadlessContext.h"
+#include "PlanetTerrain.h"
+#include "Profiler.h"
+#include "RenderQueue.h"
+#include "ShaderLibrary.h"
+#include "SphereMesh.h"
+#include "TextureCache.h"
+#include "TextureLayers.h"
+#include "ThreadPool.h"
+#include "VertexLayout.h"
+
+//cenários fixos de renderização com o relógio determinístico do modo headless (frame / 60 s): órbita, aproximação
+//e panorâmica rápida sobre o terreno CDLOD, resoluções da esfera do GenerateSphereMesh, tamanhos da textura da Terra
+//e milhares de draws pequenos pela fila de desenho, na ordem pedida e ordenados.
+//cada caso desenha o mesmo número de frames e mede a distribuição do tempo de frame, o tempo de CPU de cada etapa,
+//triângulos por segundo e o pico de memória do processo. O resultado vai para um JSON; com --baseline os números
+//são comparados com um JSON anterior e o programa termina com erro quando algum piorou além do limite.
+//o frame termina num glFinish, então o tempo inclui a GPU. Com EGL (BLUEMARBLE_HEADLESS) roda sem janela;
+//sem ele usa uma janela invisível do GLFW só para ter o contexto, como o MipmapBench.
+
+using Clock = std::chrono::steady_clock;
+
+//frames desenhados antes de cada caso e não medidos: compilação das variantes, primeiros uploads, caches do driver
+constexpr int WarmupFrames = 10;
+
+//etapas mais rápidas que isso não são comparadas com a baseline, a variação é maior que o valor
+constexpr double MinCompareMilliseconds = 0.05;
+
+struct BenchOptions {
+	int Frames = 300; //--frames=N por caso
+	int Width = 1280; //--size=LxA
+	int Height = 720;
+	std::vector<std::string> Scenarios; //--scenario=orbita,aproximacao,panoramica,esfera,textura,fila; vazio roda todos
+	std::vector<uint32_t> SphereResolutions{ 256, 512, 1024, 2048 }; //--sphere-resolutions=256,512,...
+	std::vector<uint32_t> TextureSizes{ 1024, 2048, 4096, 8192 }; //--texture-sizes=1024,2048,..., largura; a altura é a metade
+	int QueueDraws = 4096; //--draws=N do cenário fila
+	std::string OutputPath = "bench.json"; //--output=arquivo.json
+	std::string BaselinePath; //--baseline=arquivo.json
+	double TimeThreshold = 10.0; //--time-threshold=%, tempos de frame, de etapa e de preparo
+	double ThroughputThreshold = 10.0; //--throughput-threshold=%, triângulos por segundo
+	double MemoryThreshold = 10.0; //--memory-threshold=%, pico de memória e memória da GPU
+	std::string ProfilePath; //--profile[=caminho], trace do Chrome dos casos; precisa do BLUEMARBLE_PROFILER
+};
+
+//resultado de um caso
+struct BenchCase {
+	std::string Name;
+	std::vector<double> FrameMilliseconds;
+	std::vector<std::pair<std::string, double>> Stages;         //tempo somado de cada etapa nos frames medidos
+	std::vector<std::pair<std::string, double>> SetupMilliseconds;  //uma vez, antes dos frames
+	double Triangles = 0.0;       //somados nos frames medidos
+	double GPUMiB = 0.0;          //malha e texturas do caso
+	double PeakMemoryMiB = 0.0;   //pico do processo até o fim do caso
+	GLStateStats StateCalls;      //somadas nos frames medidos
+	RenderStateChanges StateChanges;  //do último frame, nos casos da fila de desenho
+};
+
+//câmera de um frame do cenário, no espaço do modelo do planeta (raio 1)
+struct BenchCamera {
+	glm::vec3 Position{ 0.0f, 0.0f, 3.0f };
+	glm::vec3 Target{ 0.0f };
+	glm::vec3 Up{ 0.0f, 1.0f, 0.0f };
+};
+
+using CameraPath = BenchCamera(*)(double Time, double Duration);
+
+//lista de inteiros positivos separados por vírgula; falso se algum item não for um deles ou a lista for vazia
+bool ParseList(const std::string& Value, std::vector<uint32_t>& OutValues) {
+	std::vector<uint32_t> Values;
+	std::stringstream Stream{ Value };
+	std::string Item;
+	while (std::getline(Stream, Item, ',')) {
+		if (!Item.empty()) {
+			int Parsed = 0;
+			if (std::sscanf(Item.c_str(), "%d", &Parsed) != 1 || Parsed <= 0) {
+				return false;
+			}
+			Values.push_back(static_cast<uint32_t>(Parsed));
+		}
+	}
+	if (Values.empty()) {
+		return false;
+	}
+	OutValues = std::move(Values);
+	return true;
+}
+
+//porcentagem de tolerância das comparações com a baseline
+bool ParseThreshold(const std::string& Name, const std::string& Value, double& OutThreshold) {
+	if (std::sscanf(Value.c_str(), "%lf", &OutThreshold) != 1 || OutThreshold < 0.0) {
+		std::cerr << "Tolerancia invalida em " << Name << ": " << Value << " (use uma porcentagem, por exemplo 10)" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool ParseOptions(int argc, char* argv[], BenchOptions& Options) {
+	for (int Index = 1; Index < argc; ++Index) {
+		const std::string Argument = argv[Index];
+		const size_t Equal = Argument.find('=');
+		const std::string Name = Argument.substr(0, Equal);
+		const std::string Value = Equal != std::string::npos ? Argument.substr(Equal + 1) : std::string{};
+
+		if (Name == "--frames") {
+			if (std::sscanf(Value.c_str(), "%d", &Options.Frames) != 1 || Options.Frames <= 0) {
+				std::cerr << "Numero de frames invalido: " << Value << " (use um inteiro positivo, por exemplo 300)" << std::endl;
+				return false;
+			}
+		}
+		else if (Name == "--size") {
+			if (std::sscanf(Value.c_str(), "%dx%d", &Options.Width, &Options.Height) != 2 || Options.Width <= 0 || Options.Height <= 0) {
+				std::cerr << "Tamanho invalido: " << Value << " (use LxA, por exemplo 1920x1080)" << std::endl;
+				return false;
+			}
+		}
+		else if (Name == "--scenario") {
+			std::stringstream Stream{ Value };
+			std::string Item;
+			while (std::getline(Stream, Item, ',')) {
+				Options.Scenarios.push_back(Item);
+			}
+		}
+		else if (Name == "--sphere-resolutions") {
+			if (!ParseList(Value, Options.SphereResolutions)) {
+				std::cerr << "Resolucoes invalidas: " << Value << " (use inteiros positivos, por exemplo 256,512)" << std::endl;
+				return false;
+			}
+		}
+		else if (Name == "--texture-sizes") {
+			if (!ParseList(Value, Options.TextureSizes)) {
+				std::cerr << "Tamanhos de textura invalidos: " << Value << " (use larguras positivas, por exemplo 1024,2048)" << std::endl;
+				return false;
+			}
+		}
+		else if (Name == "--draws") {
+			if (std::sscanf(Value.c_str(), "%d", &Options.QueueDraws) != 1 || Options.QueueDraws <= 0) {
+				std::cerr << "Numero de draws invalido: " << Value << " (use um inteiro positivo, por exemplo 4096)" << std::endl;
+				return false;
+			}
+		}
+		else if (Name == "--output") {
+			Options.OutputPath = Value;
+		}
+		else if (Name == "--baseline") {
+			Options.BaselinePath = Value;
+		}
+		else if (Name == "--time-threshold") {
+			if (!ParseThreshold(Name, Value, Options.TimeThreshold)) {
+				return false;
+			}
+		}
+		else if (Name == "--throughput-threshold") {
+			if (!ParseThreshold(Name, Value, Options.ThroughputThreshold)) {
+				return false;
+			}
+		}
+		else if (Name == "--memory-threshold") {
+			if (!ParseThreshold(Name, Value, Options.MemoryThreshold)) {
+				return false;
+			}
+		}
+		else if (Name == "--profile") {
+			Options.ProfilePath = Value.empty() ? "bench_profile" : Value;
+		}
+		else {
+			std::cerr << "Opcao desconhecida: " << Argument << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+bool IsScenarioEnabled(const BenchOptions& Options, const char* Name) {
+	return Options.Scenarios.empty() || std::find(Options.Scenarios.begin(), Options.Scenarios.end(), Name) != Options.Scenarios.end();
+}
+
+//pico do conjunto residente do processo
+double GetPeakMemoryMiB() {
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS Counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &Counters, sizeof(Counters))) {
+		return 0.0;
+	}
+	return static_cast<double>(Counters.PeakWorkingSetSize) / (1024.0 * 1024.0);
+#else
+	rusage Usage;
+	if (getrusage(RUSAGE_SELF, &Usage) != 0) {
+		return 0.0;
+	}
+	//em KiB no Linux
+	return static_cast<double>(Usage.ru_maxrss) / 1024.0;
+#endif
+}
+
+//percentil pelo posto mais próximo, Values ordenado
+double GetPercentile(const std::vector<double>& Values, double Percentile) {
+	if (Values.empty()) {
+		return 0.0;
+	}
+	const size_t Rank = static_cast<size_t>(std::ceil(Percentile / 100.0 * Values.size()));
+	return Values[std::min(std::max<size_t>(Rank, 1), Values.size()) - 1];
+}
+
+void AddTime(std::vector<std::pair<std::string, double>>& Times, const char* Name, double Milliseconds) {
+	for (std::pair<std::string, double>& Time : Times) {
+		if (Time.first == Name) {
+			Time.second += Milliseconds;
+			return;
+		}
+	}
+	Times.emplace_back(Name, Milliseconds);
+}
+
+//mede as etapas de um frame em sequência: cada Lap fecha a etapa que começou no Lap anterior
+class StageTimer {
+public:
+	explicit StageTimer(BenchCase* NewCase) : Case(NewCase), Last(Clock::now()) {}
+
+	void Lap(const char* Stage) {
+		const Clock::time_point Now = Clock::now();
+		if (Case != nullptr) {
+			AddTime(Case->Stages, Stage, std::chrono::duration<double, std::milli>(Now - Last).count());
+		}
+		Last = Now;
+	}
+
+private:
+	BenchCase* Case;   //nulo nos frames de aquecimento
+	Clock::time_point Last;
+};
+
+//órbita a 2 raios de altitude, uma volta a cada 10 s com a órbita inclinada
+BenchCamera OrbitPath(double Time, double) {
+	const float Angle = static_cast<float>(Time * glm::two_pi<double>() / 10.0);
+	BenchCamera Camera;
+	Camera.Position = glm::vec3{ std::sin(Angle), 0.3f * std::cos(Angle), std::cos(Angle) } * 3.0f;
+	return Camera;
+}
+
+//descida em linha reta de 2 raios até ~3 km de altitude, com a altitude caindo exponencialmente
+BenchCamera ApproachPath(double Time, double Duration) {
+	const double Progress = Duration > 0.0 ? Time / Duration : 1.0;
+	const float Altitude = static_cast<float>(2.0 * std::pow(0.0005 / 2.0, Progress));
+	BenchCamera Camera;
+	Camera.Position = glm::normalize(glm::vec3{ 0.3f, 0.2f, 1.0f }) * (1.0f + Altitude);
+	return Camera;
+}
+
+//voo rasante a ~60 km de altitude, 1 radiano por segundo olhando para o horizonte: a seleção troca chunks todo frame
+BenchCamera PanPath(double Time, double) {
+	const auto SurfaceDirection = [](double Longitude) {
+		return glm::normalize(glm::vec3{ static_cast<float>(std::cos(Longitude)), 0.3f, static_cast<float>(std::sin(Longitude)) });
+	};
+
+	BenchCamera Camera;
+	Camera.Up = SurfaceDirection(Time);
+	Camera.Position = Camera.Up * 1.01f;
+	Camera.Target = SurfaceDirection(Time + 0.05);
+	return Camera;
+}
+
+const float BenchFieldOfView = glm::radians(45.0f);
+
+//projeção do aplicativo, com o near plane se aproximando perto da superfície
+glm::mat4 GetProjection(const BenchCamera& Camera, const BenchOptions& Options) {
+	const float Altitude = glm::max(glm::length(Camera.Position) - 1.0f, 1.0e-6f);
+	return glm::perspective(BenchFieldOfView, static_cast<float>(Options.Width) / Options.Height, glm::min(0.01f, Altitude * 0.5f), 1000.0f);
+}
+
+//dados do frame (FrameUniforms.h) para a câmera, com o planeta na origem sem rotação
+void WriteFrameUniforms(GLuint Buffer, const BenchCamera& Camera, const BenchOptions& Options, double Time) {
+	const glm::mat4 View = glm::lookAt(Camera.Position, Camera.Target, Camera.Up);
+
+	FrameUniforms Frame;
+	Frame.ModelViewProjection = GetProjection(Camera, Options) * View;
+	Frame.NormalMatrix = glm::inverse(glm::transpose(View));
+	Frame.LightDirection = View * glm::vec4{ 0.0f, 0.0f, -1.0f, 0.0f };
+	Frame.CameraPosition = Camera.Position;
+	Frame.Time = static_cast<float>(Time);
+	GetGLState().BindBuffer(GL_UNIFORM_BUFFER, Buffer);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), &Frame, GL_STREAM_DRAW);
+}
+
+//desenha os frames de aquecimento e depois os medidos. DrawFrame(Time, Camera, Timer) faz o frame, marca as etapas
+//e devolve os triângulos desenhados; o glFinish no fim é a etapa "gpu".
+template<typename DrawFunc>
+void RunFrames(BenchCase& Case, const BenchOptions& Options, HeadlessContext& Target, CameraPath Path, DrawFunc&& DrawFrame) {
+	const double Duration = Options.Frames / 60.0;
+
+	for (int Frame = -WarmupFrames; Frame < Options.Frames; ++Frame) {
+		const bool bMeasured = Frame >= 0;
+		if (Frame == 0) {
+			GetGLState().ResetStats();
+		}
+		const double Time = std::max(Frame, 0) / 60.0;
+		const BenchCamera Camera = Path(Time, Duration);
+
+		BeginProfilerFrame();
+		const Clock::time_point Start = Clock::now();
+		StageTimer Timer{ bMeasured ? &Case : nullptr };
+
+		Target.Bind();
+		GetGLState().SetViewport(0, 0, Options.Width, Options.Height);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		const size_t Triangles = DrawFrame(Time, Camera, Timer);
+
+		{
+			PROFILE_SCOPE("glFinish");
+			glFinish();
+		}
+		Timer.Lap("gpu");
+		EndProfilerFrame();
+
+		if (bMeasured) {
+			Case.FrameMilliseconds.push_back(std::chrono::duration<double, std::milli>(Clock::now() - Start).count());
+			Case.Triangles += static_cast<double>(Triangles);
+		}
+	}
+
+	Case.StateCalls = GetGLState().GetStats();
+	Case.PeakMemoryMiB = GetPeakMemoryMiB();
+}
+
+//esfera UV na GPU, com o layout de vértices padrão
+struct BenchMesh {
+	GLuint VAO = 0;
+	GLuint VertexBuffer = 0;
+	GLuint IndexBuffer = 0;
+	GLsizei NumIndices = 0;
+	size_t Bytes = 0;
+
+	void Destroy() {
+		GetGLState().DeleteVertexArrays(1, &VAO);
+		GetGLState().DeleteBuffers(1, &VertexBuffer);
+		GetGLState().DeleteBuffers(1, &IndexBuffer);
+		*this = BenchMesh{};
+	}
+};
+
+BenchMesh UploadMesh(const std::vector<Vertex>& Vertices, const std::vector<glm::ivec3>& Triangles) {
+	BenchMesh Mesh;
+	Mesh.NumIndices = static_cast<GLsizei>(Triangles.size() * 3);
+	Mesh.Bytes = Vertices.size() * sizeof(Vertex) + Triangles.size() * sizeof(glm::ivec3);
+
+	glGenVertexArrays(1, &Mesh.VAO);
+	GetGLState().BindVertexArray(Mesh.VAO);
+
+	glGenBuffers(1, &Mesh.VertexBuffer);
+	GetGLState().BindBuffer(GL_ARRAY_BUFFER, Mesh.VertexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, Vertices.size() * sizeof(Vertex), Vertices.data(), GL_STATIC_DRAW);
+
+	glGenBuffers(1, &Mesh.IndexBuffer);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, Mesh.IndexBuffer);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, Triangles.size() * sizeof(glm::ivec3), Triangles.data(), GL_STATIC_DRAW);
+
+	ApplyVertexLayout(GetStandardVertexLayout());
+	GetGLState().BindVertexArray(0);
+	return Mesh;
+}
+
+//imagem RGB ou de um canal carregada do disco, repetida em mosaico nos tamanhos maiores que ela
+struct BenchImage {
+	uint32_t Width = 0;
+	uint32_t Height = 0;
+	uint32_t Channels = 0;
+	std::vector<uint8_t> Pixels;
+};
+
+bool LoadImage(const char* Path, uint32_t Channels, BenchImage& OutImage) {
+	int Width = 0, Height = 0, NumberOfComponents = 0;
+	unsigned char* Pixels = stbi_load(Path, &Width, &Height, &NumberOfComponents, static_cast<int>(Channels));
+	if (!Pixels) {
+		std::cerr << "Nao foi possivel carregar " << Path << ": " << stbi_failure_reason() << std::endl;
+		return false;
+	}
+
+	OutImage.Width = static_cast<uint32_t>(Width);
+	OutImage.Height = static_cast<uint32_t>(Height);
+	OutImage.Channels = Channels;
+	OutImage.Pixels.assign(Pixels, Pixels + static_cast<size_t>(Width) * Height * Channels);
+	stbi_image_free(Pixels);
+	return true;
+}
+
+BenchImage MakeTiledImage(const BenchImage& Source, uint32_t Width, uint32_t Height) {
+	BenchImage Image;
+	Image.Width = Width;
+	Image.Height = Height;
+	Image.Channels = Source.Channels;
+	Image.Pixels.resize(static_cast<size_t>(Width) * Height * Source.Channels);
+
+	const size_t PixelBytes = Source.Channels;
+	for (uint32_t Y = 0; Y < Height; ++Y) {
+		const uint8_t* SourceRow = &Source.Pixels[static_cast<size_t>(Y % Source.Height) * Source.Width * PixelBytes];
+		uint8_t* Row = &Image.Pixels[static_cast<size_t>(Y) * Width * PixelBytes];
+		for (uint32_t X = 0; X < Width; X += Source.Width) {
+			const uint32_t Count = std::min(Source.Width, Width - X);
+			std::memcpy(Row + X * PixelBytes, SourceRow, Count * PixelBytes);
+		}
+	}
+	return Image;
+}
+
+//cor e nuvens da Terra como no aplicativo, sem compressão para o tempo de preparo medir só os mipmaps e o envio
+void LoadPlanetLayers(TextureLayers& Layers, const BenchImage& Earth, const BenchImage& Clouds, BenchCase* Case) {
+	const MipmapSettings Mips;
+	std::vector<uint8_t> EarthLevels;
+	std::vector<uint8_t> CloudsLevels;
+	TextureFileView EarthView;
+	TextureFileView CloudsView;
+
+	const Clock::time_point MipStart = Clock::now();
+	BuildTextureLevels(Earth.Pixels.data(), Earth.Width, Earth.Height, TextureFormat::RGB8, Mips, EarthLevels, EarthView);
+	BuildTextureLevels(Clouds.Pixels.data(), Clouds.Width, Clouds.Height, TextureFormat::R8, Mips, CloudsLevels, CloudsView);
+
+	//o envio espera a cópia do driver terminar
+	const Clock::time_point UploadStart = Clock::now();
+	const TextureLayerHandle EarthLayer = Layers.AddLayer("EarthLayer", Earth.Width, Earth.Height, TextureFormat::RGB8, glm::vec3{ 0.05f, 0.15f, 0.35f });
+	const TextureLayerHandle CloudsLayer = Layers.AddLayer("CloudsLayer", Clouds.Width, Clouds.Height, TextureFormat::R8, glm::vec3{ 0.0f });
+	Layers.Upload(EarthLayer, EarthView, 0, EarthLevels.data());
+	Layers.Upload(CloudsLayer, CloudsView, 0, CloudsLevels.data());
+	Layers.SetLayerDone(EarthLayer);
+	Layers.SetLayerDone(CloudsLayer);
+	glFinish();
+	const Clock::time_point UploadEnd = Clock::now();
+
+	if (Case != nullptr) {
+		AddTime(Case->SetupMilliseconds, "mipmaps", std::chrono::duration<double, std::milli>(UploadStart - MipStart).count());
+		AddTime(Case->SetupMilliseconds, "envio", std::chrono::duration<double, std::milli>(UploadEnd - UploadStart).count());
+	}
+}
+
+double ToMiB(size_t Bytes) {
+	return static_cast<double>(Bytes) / (1024.0 * 1024.0);
+}
+
+void PrintCase(const BenchCase& Case) {
+	std::vector<double> Sorted = Case.FrameMilliseconds;
+	std::sort(Sorted.begin(), Sorted.end());
+	double TotalMilliseconds = 0.0;
+	for (double Milliseconds : Sorted) {
+		TotalMilliseconds += Milliseconds;
+	}
+	const double Frames = static_cast<double>(std::max<size_t>(Sorted.size(), 1));
+
+	std::cout << Case.Name << ": " << TotalMilliseconds / Frames << " ms por frame (p50 " << GetPercentile(Sorted, 50.0)
+		<< ", p95 " << GetPercentile(Sorted, 95.0) << ", p99 " << GetPercentile(Sorted, 99.0) << "), "
+		<< (TotalMilliseconds > 0.0 ? Case.Triangles / (TotalMilliseconds / 1000.0) / 1.0e6 : 0.0) << " M triangulos/s, "
+		<< Case.GPUMiB << " MiB na GPU, " << Case.StateCalls.GetIssued() / Frames << " chamadas de estado por frame ("
+		<< Case.StateCalls.GetFiltered() / Frames << " filtradas)" << std::endl;
+}
+
+//escreve os números de um caso; os nomes das chaves são os usados na comparação com a baseline
+void WriteCase(std::ostream& Stream, const BenchCase& Case) {
+	std::vector<double> Sorted = Case.FrameMilliseconds;
+	std::sort(Sorted.begin(), Sorted.end());
+	double TotalMilliseconds = 0.0;
+	for (double Milliseconds : Sorted) {
+		TotalMilliseconds += Milliseconds;
+	}
+	const double Frames = static_cast<double>(std::max<size_t>(Sorted.size(), 1));
+
+	Stream << "    \"" << Case.Name << "\": {\n";
+	Stream << "      \"frames\": " << Sorted.size() << ",\n";
+	Stream << "      \"frame_ms\": { \"media\": " << TotalMilliseconds / Frames << ", \"p50\": " << GetPercentile(Sorted, 50.0)
+		<< ", \"p95\": " << GetPercentile(Sorted, 95.0) << ", \"p99\": " << GetPercentile(Sorted, 99.0)
+		<< ", \"max\": " << (Sorted.empty() ? 0.0 : Sorted.back()) << " },\n";
+
+	const auto WriteTimes = [&Stream](const char* Key, const std::vector<std::pair<std::string, double>>& Times, double Divisor) {
+		Stream << "      \"" << Key << "\": {";
+		for (size_t Index = 0; Index < Times.size(); ++Index) {
+			Stream << (Index > 0 ? ", " : " ") << "\"" << Times[Index].first << "\": " << Times[Index].second / Divisor;
+		}
+		Stream << (Times.empty() ? "},\n" : " },\n");
+	};
+	WriteTimes("etapas_ms", Case.Stages, Frames);
+	WriteTimes("preparo_ms", Case.SetupMilliseconds, 1.0);
+
+	Stream << "      \"triangulos_por_frame\": " << Case.Triangles / Frames << ",\n";
+	Stream << "      \"triangulos_por_segundo\": " << (TotalMilliseconds > 0.0 ? Case.Triangles / (TotalMilliseconds / 1000.0) : 0.0) << ",\n";
+	Stream << "      \"gpu_mib\": " << Case.GPUMiB << ",\n";
+	Stream << "      \"memoria_pico_mib\": " << Case.PeakMemoryMiB << ",\n";
+	Stream << "      \"estado_gl_por_frame\": { \"chamadas\": " << Case.StateCalls.GetIssued() / Frames
+		<< ", \"filtradas\": " << Case.StateCalls.GetFiltered() / Frames << " },\n";
+	Stream << "      \"trocas_por_frame\": { \"programa\": " << Case.StateChanges.Programs << ", \"texturas\": " << Case.StateChanges.TextureSets
+		<< ", \"vao\": " << Case.StateChanges.VertexArrays << " }\n";
+	Stream << "    }";
+}
+
+bool WriteResults(const std::string& Path, const std::string& Renderer, const std::string& Version, const BenchOptions& Options, const std::vector<BenchCase>& Cases) {
+	std::ofstream Stream{ Path, std::ios::out | std::ios::trunc };
+	if (!Stream) {
+		std::cerr << "Nao foi possivel gravar " << Path << std::endl;
+		return false;
+	}
+
+	//o renderer entra no arquivo porque números de outra GPU ou de outro driver não são comparáveis
+	Stream << "{\n";
+	Stream << "  \"versao\": 1,\n";
+	Stream << "  \"renderer\": \"" << Renderer << "\",\n";
+	Stream << "  \"versao_gl\": \"" << Version << "\",\n";
+	Stream << "  \"largura\": " << Options.Width << ",\n";
+	Stream << "  \"altura\": " << Options.Height << ",\n";
+	Stream << "  \"frames\": " << Options.Frames << ",\n";
+	Stream << "  \"threads\": " << GetThreadPool().GetNumThreads() << ",\n";
+	Stream << "  \"casos\": {\n";
+	for (size_t Index = 0; Index < Cases.size(); ++Index) {
+		WriteCase(Stream, Cases[Index]);
+		Stream << (Index + 1 < Cases.size() ? ",\n" : "\n");
+	}
+	Stream << "  }\n";
+	Stream << "}\n";
+	return static_cast<bool>(Stream);
+}
+
+//leitor mínimo de JSON para a baseline: guarda cada número e string com o caminho das chaves, "casos.orbita.frame_ms.p95"
+class FlatJsonReader {
+public:
+	bool Parse(const std::string& NewText, std::map<std::string, std::string>& OutValues) {
+		Text = NewText;
+		Position = 0;
+		Values = &OutValues;
+		return ParseValue(std::string{}) && (SkipSpace(), Position == Text.size());
+	}
+
+private:
+	void SkipSpace() {
+		while (Position < Text.size() && std::isspace(static_cast<unsigned char>(Text[Position]))) {
+			++Position;
+		}
+	}
+
+	bool ParseString(std::string& Out) {
+		if (Text[Position] != '"') {
+			return false;
+		}
+		for (++Position; Position < Text.size() && Text[Position] != '"'; ++Position) {
+			if (Text[Position] == '\\' && Position + 1 < Text.size()) {
+				++Position;
+			}
+			Out += Text[Position];
+		}
+		return Position++ < Text.size();
+	}
+
+	bool ParseValue(const std::string& Path) {
+		SkipSpace();
+		if (Position >= Text.size()) {
+			return false;
+		}
+
+		const char First = Text[Position];
+		if (First == '{' || First == '[') {
+			const char Last = First == '{' ? '}' : ']';
+			++Position;
+			SkipSpace();
+			for (size_t Index = 0; Position < Text.size() && Text[Position] != Last; ++Index) {
+				std::string Key = std::to_string(Index);
+				if (First == '{') {
+					Key.clear();
+					if (!ParseString(Key)) {
+						return false;
+					}
+					SkipSpace();
+					if (Position >= Text.size() || Text[Position++] != ':') {
+						return false;
+					}
+				}
+				if (!ParseValue(Path.empty() ? Key : Path + "." + Key)) {
+					return false;
+				}
+				SkipSpace();
+				if (Position < Text.size() && Text[Position] == ',') {
+					++Position;
+					SkipSpace();
+				}
+			}
+			return Position++ < Text.size();
+		}
+
+		std::string Value;
+		if (First == '"') {
+			if (!ParseString(Value)) {
+				return false;
+			}
+		}
+		else {
+			while (Position < Text.size() && Text[Position] != ',' && Text[Position] != '}' && Text[Position] != ']' && !std::isspace(static_cast<unsigned char>(Text[Position]))) {
+				Value += Text[Position++];
+			}
+		}
+		(*Values)[Path] = Value;
+		return true;
+	}
+
+	std::string Text;
+	size_t Position = 0;
+	std::map<std::string, std::string>* Values = nullptr;
+};
+
+bool ReadFlatJson(const std::string& Path, std::map<std::string, std::string>& OutValues) {
+	std::ifstream Stream{ Path };
+	if (!Stream) {
+		std::cerr << "Nao foi possivel ler " << Path << std::endl;
+		return false;
+	}
+	std::stringstream Buffer;
+	Buffer << Stream.rdbuf();
+
+	FlatJsonReader Reader;
+	if (!Reader.Parse(Buffer.str(), OutValues)) {
+		std::cerr << "JSON invalido: " << Path << std::endl;
+		return false;
+	}
+	return true;
+}
+
+//compara os casos que existem nos dois arquivos. Tempos e memória pioram quando sobem, triângulos por segundo quando
+//descem; contadores (frames, triângulos por frame) só mudam quando o cenário muda e são avisados sem falhar.
+//devolve o número de regressões.
+int CompareWithBaseline(const std::string& BaselinePath, const std::string& ResultPath, const BenchOptions& Options) {
+	std::map<std::string, std::string> Baseline;
+	std::map<std::string, std::string> Current;
+	if (!ReadFlatJson(BaselinePath, Baseline) || !ReadFlatJson(ResultPath, Current)) {
+		return 1;
+	}
+
+	if (Baseline["renderer"] != Current["renderer"]) {
+		std::cout << "Aviso: baseline de outro renderer (" << Baseline["renderer"] << "), os tempos podem nao ser comparaveis" << std::endl;
+	}
+
+	int Regressions = 0;
+	for (const std::pair<const std::string, std::string>& Entry : Baseline) {
+		const std::string& Key = Entry.first;
+		const auto Found = Current.find(Key);
+		if (Key.compare(0, 6, "casos.") != 0 || Found == Current.end()) {
+			continue;
+		}
+
+		const double Before = std::atof(Entry.second.c_str());
+		const double After = std::atof(Found->second.c_str());
+		const bool bTime = Key.find("_ms.") != std::string::npos;
+		const bool bThroughput = Key.find("_por_segundo") != std::string::npos;
+		const bool bMemory = Key.find("_mib") != std::string::npos;
+
+		//o pior frame é um só, qualquer pausa do sistema muda; fica no arquivo mas não reprova.
+		//as chamadas e as trocas de estado mudam com o código, não com o cenário, e o tempo já mostra o efeito delas
+		if (Key.size() > 4 && Key.compare(Key.size() - 4, 4, ".max") == 0) {
+			continue;
+		}
+		if (Key.find(".estado_gl_por_frame.") != std::string::npos || Key.find(".trocas_por_frame.") != std::string::npos) {
+			continue;
+		}
+		if (!bTime && !bThroughput && !bMemory) {
+			if (Before != After) {
+				std::cout << "Aviso: " << Key << " mudou de " << Before << " para " << After << ", o cenario nao e o mesmo da baseline" << std::endl;
+			}
+			continue;
+		}
+		if (bTime && std::max(Before, After) < MinCompareMilliseconds) {
+			continue;
+		}
+		if (Before <= 0.0) {
+			continue;
+		}
+
+		const double Change = 100.0 * (After - Before) / Before;
+		const double Threshold = bTime ? Options.TimeThreshold : (bThroughput ? Options.ThroughputThreshold : Options.MemoryThreshold);
+		const bool bRegression = bThroughput ? -Change > Threshold : Change > Threshold;
+		if (bRegression) {
+			std::cout << "REGRESSAO " << Key << ": " << Before << " -> " << After << " (" << (Change > 0.0 ? "+" : "") << Change << "%, limite " << Threshold << "%)" << std::endl;
+			++Regressions;
+		}
+	}
+
+	std::cout << "Baseline " << BaselinePath << ": " << Regressions << (Regressions == 1 ? " regressao" : " regressoes") << std::endl;
+	return Regressions;
+}
+
+int main(int argc, char* argv[]) {
+	BenchOptions Options;
+	if (!ParseOptions(argc, argv, Options)) {
+		return 2;
+	}
+
+	HeadlessContext Headless;
+#ifdef BLUEMARBLE_HEADLESS
+	if (!Headless.CreateContext()) {
+		return -1;
+	}
+
+	glewExperimental = GL_TRUE;
+	if (glewContextInit() != GLEW_OK) {
+		std::cerr << "Failed to initialize GLEW" << std::endl;
+		return -1;
+	}
+#else
+	if (!glfwInit()) {
+		std::cerr << "Failed to initialize GLFW" << std::endl;
+		return -1;
+	}
+
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	GLFWwindow* Window = glfwCreateWindow(64, 64, "BlueMarbleBench", nullptr, nullptr);
+	assert(Window);
+	glfwMakeContextCurrent(Window);
+
+	//sem vsync: o frame vai para o framebuffer próprio, mas alguns drivers seguram o contexto da janela mesmo assim
+	glfwSwapInterval(0);
+
+	glewExperimental = GL_TRUE;
+	if (glewInit() != GLEW_OK) {
+		std::cerr << "Failed to initialize GLEW" << std::endl;
+		return -1;
+	}
+#endif
+
+	//o frame é desenhado fora da janela nos dois casos, no tamanho pedido
+	if (!Headless.CreateFramebuffer(Options.Width, Options.Height)) {
+		return -1;
+	}
+
+	//o contexto já foi destruído quando o JSON é gravado
+	const std::string Renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+	const std::string Version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+	std::cout << "GPU: " << Renderer << std::endl;
+	std::cout << "Threads: " << GetThreadPool().GetNumThreads() << std::endl;
+	std::cout << Options.Frames << " frames por caso em " << Options.Width << "x" << Options.Height << std::endl << std::endl;
+
+	BenchImage Earth;
+	BenchImage Clouds;
+	if (!LoadImage("textures/earth_2k.jpg", 3, Earth) || !LoadImage("textures/earth_clouds_2k.jpg", 1, Clouds)) {
+		return -1;
+	}
+
+	//as mesmas variantes do aplicativo com todos os recursos ligados, compiladas antes dos casos e sem o cache de
+	//binários, para não depender do que ficou na pasta cache. Sem programa os números não medem nada.
+	ShaderLibrary Shaders(false);
+	const ShaderDefines EarthDefines{ "CLOUDS", "SPECULAR" };
+	Shaders.SetUniformBlock(FrameUniformsBlock, FrameUniformsBinding, sizeof(FrameUniforms), GetFrameUniformsMembers());
+	const ShaderHandle TerrainShader = Shaders.Load("shaders/terrain_vert.glsl", "shaders/terrain_frag.glsl", EarthDefines);
+	const ShaderHandle TriangleShader = Shaders.Load("shaders/triangle_vert.glsl", "shaders/triangle_frag.glsl", EarthDefines);
+	//a fila de desenho alterna entre três variantes do mesmo shader
+	const ShaderHandle CloudsShader = Shaders.Load("shaders/triangle_vert.glsl", "shaders/triangle_frag.glsl", ShaderDefines{ "CLOUDS" });
+	const ShaderHandle PlainShader = Shaders.Load("shaders/triangle_vert.glsl", "shaders/triangle_frag.glsl");
+	if (Shaders.GetProgram(TerrainShader) == 0 || Shaders.GetProgram(TriangleShader) == 0 || Shaders.GetProgram(CloudsShader) == 0 || Shaders.GetProgram(PlainShader) == 0) {
+		std::cerr << "Os shaders nao compilaram, rode na pasta com shaders e textures" << std::endl;
+		return -1;
+	}
+
+	GLuint FrameUniformBuffer = 0;
+	glGenBuffers(1, &FrameUniformBuffer);
+	GetGLState().BindBuffer(GL_UNIFORM_BUFFER, FrameUniformBuffer);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), nullptr, GL_STREAM_DRAW);
+	GetGLState().BindBufferBase(GL_UNIFORM_BUFFER, FrameUniformsBinding, FrameUniformBuffer);
+
+	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+	GetGLState().SetEnabled(GL_CULL_FACE, true);
+	GetGLState().SetCullFace(GL_BACK);
+	GetGLState().SetEnabled(GL_DEPTH_TEST, true);
+	GetGLState().SetDepthFunc(GL_LESS);
+
+	if (!Options.ProfilePath.empty() && !StartProfiler(Options.ProfilePath)) {
+		std::cout << "Profiler nao compilado, --profile precisa do BLUEMARBLE_PROFILER" << std::endl;
+	}
+
+	std::vector<BenchCase> Cases;
+
+	//terreno com as texturas de 2k, os três cenários de câmera
+	const std::pair<const char*, CameraPath> TerrainScenarios[] = {
+		{ "orbita", OrbitPath },
+		{ "aproximacao", ApproachPath },
+		{ "panoramica", PanPath }
+	};
+	for (const std::pair<const char*, CameraPath>& Scenario : TerrainScenarios) {
+		if (!IsScenarioEnabled(Options, Scenario.first)) {
+			continue;
+		}
+
+		BenchCase Case;
+		Case.Name = Scenario.first;
+
+		TextureLayers Layers;
+		LoadPlanetLayers(Layers, Earth, Clouds, &Case);
+
+		const TerrainSettings Settings;
+		PlanetTerrain Terrain;
+		Terrain.Initialize(Settings);
+
+		RunFrames(Case, Options, Headless, Scenario.second, [&](double Time, const BenchCamera& Camera, StageTimer& Timer) {
+			const GLuint Program = Shaders.GetProgram(TerrainShader);
+			GetGLState().UseProgram(Program);
+			WriteFrameUniforms(FrameUniformBuffer, Camera, Options, Time);
+			Layers.Update(0.0f);
+			Layers.Bind(Program, 0);
+			GetGLState().SetUniform(Shaders.GetUniformLocation(TerrainShader, "GridSegments"), static_cast<float>(Settings.GridResolution - 1));
+			Timer.Lap("atualizacao");
+
+			TerrainView View;
+			View.ModelViewProjection = GetProjection(Camera, Options) * glm::lookAt(Camera.Position, Camera.Target, Camera.Up);
+			View.CameraPosition = Camera.Position;
+			View.FieldOfView = BenchFieldOfView;
+			View.ViewportHeight = static_cast<float>(Options.Height);
+			Terrain.Select(View);
+			Timer.Lap("selecao");
+
+			Terrain.Draw();
+			Timer.Lap("envio");
+			return Terrain.GetStats().NumTriangles;
+		});
+
+		Case.GPUMiB = ToMiB(Layers.GetGPUBytes());
+		Terrain.Shutdown();
+		Layers.Shutdown();
+
+		PrintCase(Case);
+		Cases.push_back(std::move(Case));
+	}
+
+	//esfera UV do GenerateSphereMesh em órbita, uma resolução por caso
+	if (IsScenarioEnabled(Options, "esfera")) {
+		TextureLayers Layers;
+		LoadPlanetLayers(Layers, Earth, Clouds, nullptr);
+
+		for (uint32_t Resolution : Options.SphereResolutions) {
+			BenchCase Case;
+			Case.Name = "esfera_" + std::to_string(Resolution);
+
+			std::vector<Vertex> Vertices;
+			std::vector<glm::ivec3> Triangles;
+			const Clock::time_point GenerateStart = Clock::now();
+			GenerateSphereMesh(Resolution, Vertices, Triangles);
+			const Clock::time_point UploadStart = Clock::now();
+			BenchMesh Mesh = UploadMesh(Vertices, Triangles);
+			glFinish();
+			AddTime(Case.SetupMilliseconds, "geracao", std::chrono::duration<double, std::milli>(UploadStart - GenerateStart).count());
+			AddTime(Case.SetupMilliseconds, "envio", std::chrono::duration<double, std::milli>(Clock::now() - UploadStart).count());
+
+			RunFrames(Case, Options, Headless, OrbitPath, [&](double Time, const BenchCamera& Camera, StageTimer& Timer) {
+				const GLuint Program = Shaders.GetProgram(TriangleShader);
+				GetGLState().UseProgram(Program);
+				WriteFrameUniforms(FrameUniformBuffer, Camera, Options, Time);
+				Layers.Update(0.0f);
+				Layers.Bind(Program, 0);
+				Timer.Lap("atualizacao");
+
+				GetGLState().BindVertexArray(Mesh.VAO);
+				glDrawElements(GL_TRIANGLES, Mesh.NumIndices, GL_UNSIGNED_INT, nullptr);
+				Timer.Lap("envio");
+				return Triangles.size();
+			});
+
+			Case.GPUMiB = ToMiB(Mesh.Bytes + Layers.GetGPUBytes());
+			Mesh.Destroy();
+
+			PrintCase(Case);
+			Cases.push_back(std::move(Case));
+		}
+
+		Layers.Shutdown();
+	}
+
+	//textura da Terra em vários tamanhos (mosaico da de 2k) numa esfera fixa, com a câmera perto para amostrar os levels finos
+	if (IsScenarioEnabled(Options, "textura")) {
+		std::vector<Vertex> Vertices;
+		std::vector<glm::ivec3> Triangles;
+		GenerateSphereMesh(512, Vertices, Triangles);
+		BenchMesh Mesh = UploadMesh(Vertices, Triangles);
+
+		for (uint32_t Size : Options.TextureSizes) {
+			BenchCase Case;
+			Case.Name = "textura_" + std::to_string(Size);
+
+			TextureLayers Layers;
+			LoadPlanetLayers(Layers, MakeTiledImage(Earth, Size, std::max(Size / 2, 1u)), Clouds, &Case);
+
+			const CameraPath ClosePath = [](double Time, double Duration) {
+				BenchCamera Camera = OrbitPath(Time, Duration);
+				Camera.Position *= 0.5f;
+				return Camera;
+			};
+			RunFrames(Case, Options, Headless, ClosePath, [&](double Time, const BenchCamera& Camera, StageTimer& Timer) {
+				const GLuint Program = Shaders.GetProgram(TriangleShader);
+				GetGLState().UseProgram(Program);
+				WriteFrameUniforms(FrameUniformBuffer, Camera, Options, Time);
+				Layers.Update(0.0f);
+				Layers.Bind(Program, 0);
+				Timer.Lap("atualizacao");
+
+				GetGLState().BindVertexArray(Mesh.VAO);
+				glDrawElements(GL_TRIANGLES, Mesh.NumIndices, GL_UNSIGNED_INT, nullptr);
+				Timer.Lap("envio");
+				return Triangles.size();
+			});
+
+			Case.GPUMiB = ToMiB(Mesh.Bytes + Layers.GetGPUBytes());
+			Layers.Shutdown();
+
+			PrintCase(Case);
+			Cases.push_back(std::move(Case));
+		}
+
+		Mesh.Destroy();
+	}
+
+	//muitos draws de esferas pequenas com programa, texturas e malha sorteados: na ordem pedida quase todo draw troca
+	//de estado, ordenados pela chave ficam só as trocas entre grupos. A câmera longe deixa cada esfera com poucos
+	//pixels, o tempo medido é o do envio.
+	if (IsScenarioEnabled(Options, "fila")) {
+		TextureLayers EarthLayers;
+		TextureLayers OtherLayers;
+		LoadPlanetLayers(EarthLayers, Earth, Clouds, nullptr);
+		LoadPlanetLayers(OtherLayers, Earth, Clouds, nullptr);
+
+		std::vector<Vertex> Vertices;
+		std::vector<glm::ivec3> Triangles;
+		GenerateSphereMesh(16, Vertices, Triangles);
+		BenchMesh CoarseMesh = UploadMesh(Vertices, Triangles);
+		GenerateSphereMesh(32, Vertices, Triangles);
+		BenchMesh FineMesh = UploadMesh(Vertices, Triangles);
+
+		RenderQueue Queue;
+		const uint32_t TextureSets[] = {
+			Queue.AddTextureSet([&EarthLayers](GLuint Program) { EarthLayers.Bind(Program, 0); }),
+			Queue.AddTextureSet([&OtherLayers](GLuint Program) { OtherLayers.Bind(Program, 0); })
+		};
+		const ShaderHandle QueueShaders[] = { TriangleShader, CloudsShader, PlainShader };
+		const BenchMesh* Meshes[] = { &CoarseMesh, &FineMesh };
+
+		//o mesmo sorteio em todo frame e nos dois casos
+		struct QueueDraw {
+			uint32_t Shader;
+			uint32_t TextureSet;
+			uint32_t Mesh;
+			float Depth;
+		};
+		std::vector<QueueDraw> Draws(static_cast<size_t>(Options.QueueDraws));
+		std::mt19937 Random{ 1234 };
+		for (QueueDraw& Draw : Draws) {
+			Draw.Shader = Random() % 3;
+			Draw.TextureSet = Random() % 2;
+			Draw.Mesh = Random() % 2;
+			Draw.Depth = std::uniform_real_distribution<float>{ 20.0f, 40.0f }(Random);
+		}
+
+		const CameraPath FarPath = [](double Time, double Duration) {
+			BenchCamera Camera = OrbitPath(Time, Duration);
+			Camera.Position *= 10.0f;
+			return Camera;
+		};
+		for (bool bSort : { false, true }) {
+			BenchCase Case;
+			Case.Name = bSort ? "fila_ordenada" : "fila_pedida";
+
+			RunFrames(Case, Options, Headless, FarPath, [&](double Time, const BenchCamera& Camera, StageTimer& Timer) {
+				WriteFrameUniforms(FrameUniformBuffer, Camera, Options, Time);
+				EarthLayers.Update(0.0f);
+				OtherLayers.Update(0.0f);
+
+				size_t NumTriangles = 0;
+				for (const QueueDraw& Draw : Draws) {
+					const BenchMesh* Mesh = Meshes[Draw.Mesh];
+					Queue.Add(RenderPass::Opaque, Shaders.GetProgram(QueueShaders[Draw.Shader]), TextureSets[Draw.TextureSet], Mesh->VAO, Draw.Depth, [Mesh] {
+						glDrawElements(GL_TRIANGLES, Mesh->NumIndices, GL_UNSIGNED_INT, nullptr);
+					});
+					NumTriangles += static_cast<size_t>(Mesh->NumIndices / 3);
+				}
+				Timer.Lap("atualizacao");
+
+				Queue.Submit(bSort);
+				Timer.Lap("envio");
+				return NumTriangles;
+			});
+			Case.StateChanges = Queue.GetStats().Submitted;
+			Case.GPUMiB = ToMiB(CoarseMesh.Bytes + FineMesh.Bytes + EarthLayers.GetGPUBytes() + OtherLayers.GetGPUBytes());
+
+			PrintCase(Case);
+			std::cout << "  trocas de estado por frame: programa " << Case.StateChanges.Programs << ", texturas " << Case.StateChanges.TextureSets
+				<< ", VAO " << Case.StateChanges.VertexArrays << ", ordenacao de " << Queue.GetStats().SortMicroseconds << " us" << std::endl;
+			Cases.push_back(std::move(Case));
+		}
+
+		Queue.Shutdown();
+		CoarseMesh.Destroy();
+		FineMesh.Destroy();
+		EarthLayers.Shutdown();
+		OtherLayers.Shutdown();
+	}
+
+	StopProfiler();
+
+	GetGLState().DeleteBuffers(1, &FrameUniformBuffer);
+	Shaders.Shutdown();
+	Headless.Destroy();
+#ifndef BLUEMARBLE_HEADLESS
+	glfwDestroyWindow(Window);
+	glfwTerminate();
+#endif
+
+	if (Cases.empty()) {
+		std::cerr << "Nenhum cenario selecionado (use orbita, aproximacao, panoramica, esfera ou textura)" << std::endl;
+		return 2;
+	}
+
+	if (!WriteResults(Options.OutputPath, Renderer, Version, Options, Cases)) {
+		return 1;
+	}
+	std::cout << std::endl << "Resultados em " << Options.OutputPath << std::endl;
+
+	//código de saída 1 com regressão, para a CI
+	if (!Options.BaselinePath.empty() && CompareWithBaseline(Options.BaselinePath, Options.OutputPath, Options) > 0) {
+		return 1;
+	}
+	return 0;
+}
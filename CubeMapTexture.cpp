@@ -0,0 +1,174 @@
+#include "CubeMapTexture.h"
+
+#include<algorithm>
+#include<cassert>
+#include<iostream>
+#include<memory>
+
+#include "GLState.h"
+#include "Hash.h"
+#include "stb_image.h"
+
+uint64_t GetCubeMapCacheKey(const std::string& SourcePath, TextureFormat Format, const MipmapSettings& Mips, ResampleFilter Filter, uint32_t FaceSize, uint32_t FaceIndex) {
+	uint64_t Key = GetTextureCacheKey(SourcePath, Format, Mips);
+	Key = HashValue(Filter, Key);
+	Key = HashValue(FaceSize, Key);
+	Key = HashValue(FaceIndex, Key);
+	return HashValue(CubeMapVersion, Key);
+}
+
+bool CubeMapTexture::Load(const std::string& SourcePath, TextureFormat Format, const MipmapSettings& Mips, ResampleFilter Filter, uint32_t NewFaceSize) {
+	assert(!IsLoaded());
+
+	//a orientação das faces conta com as linhas na ordem do OpenGL, como as outras texturas
+	stbi_set_flip_vertically_on_load(true);
+
+	int Width = 0, Height = 0, NumberOfComponents = 0;
+	if (!stbi_info(SourcePath.c_str(), &Width, &Height, &NumberOfComponents)) {
+		std::cout << "Erro ao carregar " << SourcePath << ": " << stbi_failure_reason() << std::endl;
+		return false;
+	}
+
+	//a longitude vai nas linhas da imagem (o V do EquirectangularUV)
+	FaceSize = NewFaceSize > 0 ? NewFaceSize : GetCubeFaceSize(static_cast<uint32_t>(Height));
+	if (!LoadFaces(SourcePath, Format, Mips, Filter)) {
+		return false;
+	}
+	CreateTexture();
+
+	const size_t CubeTexels = 6 * static_cast<size_t>(FaceSize) * FaceSize;
+	const size_t EquirectangularTexels = static_cast<size_t>(Width) * Height;
+	const size_t EquatorTexels = 4 * static_cast<size_t>(FaceSize) * 2 * FaceSize;
+	std::cout << "Cubemap da Terra: 6 faces de " << FaceSize << "x" << FaceSize << " em " << ToString(Format) << " (" << ToString(Filter) << "), "
+		<< CubeTexels / 1000 << " mil texels contra " << EquirectangularTexels / 1000 << " mil da equiretangular "
+		<< Width << "x" << Height << " e " << EquatorTexels / 1000 << " mil de uma equiretangular com a mesma resolucao no equador ("
+		<< 100 - CubeTexels * 100 / EquatorTexels << "% a menos), " << GPUBytes / 1024 << " KiB na GPU" << std::endl;
+	return true;
+}
+
+bool CubeMapTexture::LoadFaces(const std::string& SourcePath, TextureFormat Format, const MipmapSettings& EquirectangularMips, ResampleFilter Filter) {
+	//as bordas de uma face encostam em outras faces, não nela mesma
+	MipmapSettings Mips = EquirectangularMips;
+	Mips.AddressX = MipAddress::Clamp;
+
+	const bool bCached = IsCompressed(Format);
+	std::array<uint64_t, 6> Keys = {};
+	std::array<std::string, 6> Paths;
+	bool bAllCached = bCached;
+	for (uint32_t Face = 0; Face < 6; ++Face) {
+		Keys[Face] = GetCubeMapCacheKey(SourcePath, Format, Mips, Filter, FaceSize, Face);
+		Paths[Face] = GetTextureCachePath(SourcePath, Keys[Face]);
+		bAllCached = bAllCached && OpenTextureFile(Paths[Face], Keys[Face], Files[Face], Views[Face]);
+	}
+	if (bAllCached) {
+		return true;
+	}
+
+	const uint32_t Channels = GetChannelCount(Format);
+	int Width = 0, Height = 0, NumberOfComponents = 0;
+	std::unique_ptr<unsigned char, void (*)(void*)> Pixels(stbi_load(SourcePath.c_str(), &Width, &Height, &NumberOfComponents, static_cast<int>(Channels)), stbi_image_free);
+	if (!Pixels) {
+		std::cout << "Erro ao carregar " << SourcePath << ": " << stbi_failure_reason() << std::endl;
+		return false;
+	}
+
+	RasterView Source;
+	Source.Pixels = Pixels.get();
+	Source.Width = static_cast<uint32_t>(Width);
+	Source.Height = static_cast<uint32_t>(Height);
+	Source.Channels = Channels;
+
+	std::cout << "Reprojetando " << SourcePath << " " << Width << "x" << Height << " para 6 faces de " << FaceSize << "x" << FaceSize << std::endl;
+	const size_t FaceBytes = static_cast<size_t>(FaceSize) * FaceSize * Channels;
+	std::vector<uint8_t> Faces(6 * FaceBytes);
+	uint8_t* const OutFaces[6] = { &Faces[0], &Faces[FaceBytes], &Faces[2 * FaceBytes], &Faces[3 * FaceBytes], &Faces[4 * FaceBytes], &Faces[5 * FaceBytes] };
+	ReprojectToCubeMap(Source, FaceSize, Filter, OutFaces);
+	Pixels.reset();
+
+	for (uint32_t Face = 0; Face < 6; ++Face) {
+		if (!bCached) {
+			BuildTextureLevels(OutFaces[Face], FaceSize, FaceSize, Format, Mips, FaceData[Face], Views[Face]);
+			continue;
+		}
+		if (Files[Face].IsOpen()) {
+			continue;
+		}
+		if (!BuildTextureFile(Paths[Face], Keys[Face], Format, OutFaces[Face], FaceSize, FaceSize, Channels, Mips)
+			|| !OpenTextureFile(Paths[Face], Keys[Face], Files[Face], Views[Face])) {
+			std::cout << "Erro ao gravar " << Paths[Face] << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+void CubeMapTexture::CreateTexture() {
+	const TextureFileView& Layout = Views[0];
+	const GLenum InternalFormat = GetGLInternalFormat(Layout.Format);
+	const GLenum PixelFormat = GetChannelCount(Layout.Format) == 1 ? GL_RED : GL_RGB;
+
+	//as faces são amostradas juntas nas arestas, sem a borda de cada uma aparecer como costura
+	GetGLState().SetEnabled(GL_TEXTURE_CUBE_MAP_SEAMLESS, true);
+
+	glGenTextures(1, &Texture);
+	GetGLState().BindTexture(GL_TEXTURE_CUBE_MAP, Texture);
+	if (GLEW_ARB_texture_storage) {
+		glTexStorage2D(GL_TEXTURE_CUBE_MAP, static_cast<GLsizei>(Layout.NumLevels), InternalFormat, static_cast<GLsizei>(FaceSize), static_cast<GLsizei>(FaceSize));
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	GPUBytes = 0;
+	for (uint32_t Face = 0; Face < 6; ++Face) {
+		const TextureFileView& View = Views[Face];
+		const GLenum Target = GL_TEXTURE_CUBE_MAP_POSITIVE_X + Face;
+		for (uint32_t Level = 0; Level < View.NumLevels; ++Level) {
+			const GLsizei LevelSize = static_cast<GLsizei>(std::max(1u, FaceSize >> Level));
+			const uint8_t* LevelData = View.Data + View.LevelOffsets[Level];
+			if (GLEW_ARB_texture_storage) {
+				if (IsCompressed(View.Format)) {
+					glCompressedTexSubImage2D(Target, static_cast<GLint>(Level), 0, 0, LevelSize, LevelSize, InternalFormat, static_cast<GLsizei>(View.LevelBytes[Level]), LevelData);
+				}
+				else {
+					glTexSubImage2D(Target, static_cast<GLint>(Level), 0, 0, LevelSize, LevelSize, PixelFormat, GL_UNSIGNED_BYTE, LevelData);
+				}
+			}
+			else if (IsCompressed(View.Format)) {
+				glCompressedTexImage2D(Target, static_cast<GLint>(Level), InternalFormat, LevelSize, LevelSize, 0, static_cast<GLsizei>(View.LevelBytes[Level]), LevelData);
+			}
+			else {
+				glTexImage2D(Target, static_cast<GLint>(Level), InternalFormat, LevelSize, LevelSize, 0, PixelFormat, GL_UNSIGNED_BYTE, LevelData);
+			}
+		}
+		GPUBytes += GetTextureBytes(View, 0);
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_BASE_LEVEL, 0);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(Layout.NumLevels) - 1);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+
+	//os dados já estão na GPU
+	for (uint32_t Face = 0; Face < 6; ++Face) {
+		Files[Face].Close();
+		FaceData[Face].clear();
+		FaceData[Face].shrink_to_fit();
+		Views[Face].Data = nullptr;
+	}
+}
+
+void CubeMapTexture::Bind(GLuint Program, GLint Unit) const {
+	GetGLState().BindTexture(Unit, GL_TEXTURE_CUBE_MAP, Texture);
+	GetGLState().SetUniform(GetGLState().GetUniformLocation(Program, "EarthCube"), Unit);
+}
+
+void CubeMapTexture::Shutdown() {
+	if (Texture != 0) {
+		GetGLState().DeleteTextures(1, &Texture);
+		Texture = 0;
+	}
+	GPUBytes = 0;
+}
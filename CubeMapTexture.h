@@ -0,0 +1,61 @@
+#pragma once
+
+#include<array>
+#include<cstddef>
+#include<cstdint>
+#include<string>
+#include<vector>
+
+#include<GL/glew.h>
+
+#include "MappedFile.h"
+#include "Mipmap.h"
+#include "Reprojection.h"
+#include "TextureCache.h"
+#include "TextureCompression.h"
+
+//textura da Terra num GL_TEXTURE_CUBE_MAP, no lugar da equiretangular no modo terreno (--cubemap).
+//o shader lê com texture(EarthCube, SpherePosition): sem costura na longitude e sem texels espremidos nos polos.
+//as faces saem da imagem equiretangular pelo ReprojectToCubeMap e, nos formatos comprimidos, ficam no cache
+//como um DDS por face, com os mipmaps prontos; RGB8 é reprojetado a cada execução, como a textura comum.
+//mudar a reprojeção exige incrementar CubeMapVersion.
+constexpr uint32_t CubeMapVersion = 1;
+
+//chave e caminho do arquivo de uma face no cache
+uint64_t GetCubeMapCacheKey(const std::string& SourcePath, TextureFormat Format, const MipmapSettings& Mips, ResampleFilter Filter, uint32_t FaceSize, uint32_t FaceIndex);
+
+class CubeMapTexture {
+public:
+	CubeMapTexture() = default;
+
+	CubeMapTexture(const CubeMapTexture&) = delete;
+	CubeMapTexture& operator=(const CubeMapTexture&) = delete;
+
+	//abre as faces do cache ou reprojeta a imagem, e cria a textura. FaceSize 0 usa a mesma resolução
+	//no equador que a imagem (GetCubeFaceSize). Precisa do contexto OpenGL ativo.
+	bool Load(const std::string& SourcePath, TextureFormat Format, const MipmapSettings& Mips, ResampleFilter Filter, uint32_t FaceSize = 0);
+
+	//libera a textura, com o contexto ainda ativo
+	void Shutdown();
+
+	bool IsLoaded() const { return Texture != 0; }
+	uint32_t GetFaceSize() const { return FaceSize; }
+
+	//liga a textura na unidade e preenche o sampler EarthCube
+	void Bind(GLuint Program, GLint Unit) const;
+
+	size_t GetGPUBytes() const { return GPUBytes; }
+
+private:
+	bool LoadFaces(const std::string& SourcePath, TextureFormat Format, const MipmapSettings& Mips, ResampleFilter Filter);
+	void CreateTexture();
+
+	GLuint Texture = 0;
+	uint32_t FaceSize = 0;
+	size_t GPUBytes = 0;
+
+	//levels das faces, mapeados do cache ou gerados em memória, liberados depois do envio
+	std::array<MappedFile, 6> Files;
+	std::array<std::vector<uint8_t>, 6> FaceData;
+	std::array<TextureFileView, 6> Views;
+};
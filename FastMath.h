@@ -0,0 +1,105 @@
+#pragma once
+
+#include<cstddef>
+#include<cstdint>
+
+//SSE2 faz parte do x64, mas o MSVC não define __SSE2__
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BLUEMARBLE_SSE2 1
+#include<emmintrin.h>
+#else
+#define BLUEMARBLE_SSE2 0
+#endif
+
+//seno e cosseno em lote, precisão de float (~1e-7), baseado nos polinômios do Cephes.
+//o mesmo algoritmo é usado na versão SSE (4 ângulos por vez) e na escalar, então os resultados são idênticos.
+namespace FastMath {
+
+	constexpr float FourOverPi = 1.27323954473516f;
+	constexpr float DP1 = 0.78515625f;
+	constexpr float DP2 = 2.4187564849853515625e-4f;
+	constexpr float DP3 = 3.77489497744594108e-8f;
+
+	inline void SinCos(float Angle, float& OutSin, float& OutCos) {
+		float X = Angle < 0.0f ? -Angle : Angle;
+
+		//octante do ângulo, sempre par
+		int32_t J = static_cast<int32_t>(X * FourOverPi);
+		J = (J + 1) & ~1;
+		const float Y = static_cast<float>(J);
+
+		//redução de faixa estendida para [-Pi/4, Pi/4]
+		X = ((X - Y * DP1) - Y * DP2) - Y * DP3;
+		const float Z = X * X;
+
+		const float PolyCos = ((2.443315711809948e-5f * Z - 1.388731625493765e-3f) * Z + 4.166664568298827e-2f) * Z * Z - 0.5f * Z + 1.0f;
+		const float PolySin = ((-1.9515295891e-4f * Z + 8.3321608736e-3f) * Z - 1.6666654611e-1f) * Z * X + X;
+
+		const bool bSwap = (J & 2) != 0;
+		float Sin = bSwap ? PolyCos : PolySin;
+		float Cos = bSwap ? PolySin : PolyCos;
+
+		if (((J & 4) != 0) != (Angle < 0.0f)) {
+			Sin = -Sin;
+		}
+		if (((J - 2) & 4) == 0) {
+			Cos = -Cos;
+		}
+
+		OutSin = Sin;
+		OutCos = Cos;
+	}
+
+#if BLUEMARBLE_SSE2
+	inline void SinCos4(__m128 Angle, __m128& OutSin, __m128& OutCos) {
+		const __m128 SignMask = _mm_castsi128_ps(_mm_set1_epi32(static_cast<int32_t>(0x80000000)));
+		__m128 SignSin = _mm_and_ps(Angle, SignMask);
+		__m128 X = _mm_andnot_ps(SignMask, Angle);
+
+		__m128i J = _mm_cvttps_epi32(_mm_mul_ps(X, _mm_set1_ps(FourOverPi)));
+		J = _mm_and_si128(_mm_add_epi32(J, _mm_set1_epi32(1)), _mm_set1_epi32(~1));
+		const __m128 Y = _mm_cvtepi32_ps(J);
+
+		//sinal do seno: bit 2 do octante, sinal do cosseno: bit 2 de (J - 2) negado
+		SignSin = _mm_xor_ps(SignSin, _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(J, _mm_set1_epi32(4)), 29)));
+		const __m128 SignCos = _mm_castsi128_ps(_mm_slli_epi32(_mm_andnot_si128(_mm_sub_epi32(J, _mm_set1_epi32(2)), _mm_set1_epi32(4)), 29));
+		const __m128 SwapMask = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(J, _mm_set1_epi32(2)), _mm_set1_epi32(2)));
+
+		X = _mm_sub_ps(X, _mm_mul_ps(Y, _mm_set1_ps(DP1)));
+		X = _mm_sub_ps(X, _mm_mul_ps(Y, _mm_set1_ps(DP2)));
+		X = _mm_sub_ps(X, _mm_mul_ps(Y, _mm_set1_ps(DP3)));
+		const __m128 Z = _mm_mul_ps(X, X);
+
+		__m128 PolyCos = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(2.443315711809948e-5f), Z), _mm_set1_ps(-1.388731625493765e-3f));
+		PolyCos = _mm_add_ps(_mm_mul_ps(PolyCos, Z), _mm_set1_ps(4.166664568298827e-2f));
+		PolyCos = _mm_mul_ps(_mm_mul_ps(PolyCos, Z), Z);
+		PolyCos = _mm_add_ps(_mm_sub_ps(PolyCos, _mm_mul_ps(_mm_set1_ps(0.5f), Z)), _mm_set1_ps(1.0f));
+
+		__m128 PolySin = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(-1.9515295891e-4f), Z), _mm_set1_ps(8.3321608736e-3f));
+		PolySin = _mm_add_ps(_mm_mul_ps(PolySin, Z), _mm_set1_ps(-1.6666654611e-1f));
+		PolySin = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(PolySin, Z), X), X);
+
+		const __m128 Sin = _mm_or_ps(_mm_and_ps(SwapMask, PolyCos), _mm_andnot_ps(SwapMask, PolySin));
+		const __m128 Cos = _mm_or_ps(_mm_and_ps(SwapMask, PolySin), _mm_andnot_ps(SwapMask, PolyCos));
+
+		OutSin = _mm_xor_ps(Sin, SignSin);
+		OutCos = _mm_xor_ps(Cos, SignCos);
+	}
+#endif
+
+	//calcula seno e cosseno de Count ângulos
+	inline void SinCos(const float* Angles, float* OutSin, float* OutCos, size_t Count) {
+		size_t Index = 0;
+#if BLUEMARBLE_SSE2
+		for (; Index + 4 <= Count; Index += 4) {
+			__m128 Sin, Cos;
+			SinCos4(_mm_loadu_ps(Angles + Index), Sin, Cos);
+			_mm_storeu_ps(OutSin + Index, Sin);
+			_mm_storeu_ps(OutCos + Index, Cos);
+		}
+#endif
+		for (; Index < Count; ++Index) {
+			SinCos(Angles[Index], OutSin[Index], OutCos[Index]);
+		}
+	}
+}
@@ -0,0 +1,121 @@
+#include "FileWatcher.h"
+
+#include<algorithm>
+#include<system_error>
+
+#ifdef __linux__
+#include<sys/inotify.h>
+#include<unistd.h>
+#endif
+
+FileWatcher::~FileWatcher() {
+	Stop();
+}
+
+#ifdef __linux__
+
+bool FileWatcher::Watch(const std::string& NewDirectory) {
+	Stop();
+
+	NotifyDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (NotifyDescriptor < 0) {
+		return false;
+	}
+
+	//editores que salvam num arquivo temporário e renomeiam geram IN_MOVED_TO, não IN_CLOSE_WRITE
+	if (inotify_add_watch(NotifyDescriptor, NewDirectory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+		close(NotifyDescriptor);
+		NotifyDescriptor = -1;
+		return false;
+	}
+
+	Directory = NewDirectory;
+	return true;
+}
+
+void FileWatcher::Stop() {
+	if (NotifyDescriptor >= 0) {
+		close(NotifyDescriptor);
+		NotifyDescriptor = -1;
+	}
+	Directory.clear();
+}
+
+void FileWatcher::Poll(std::vector<std::string>& OutChangedFiles) {
+	OutChangedFiles.clear();
+	if (NotifyDescriptor < 0) {
+		return;
+	}
+
+	alignas(inotify_event) char Buffer[4096];
+	for (;;) {
+		const ssize_t Bytes = read(NotifyDescriptor, Buffer, sizeof(Buffer));
+		if (Bytes <= 0) {
+			break;
+		}
+
+		for (ssize_t Offset = 0; Offset < Bytes;) {
+			const inotify_event* Event = reinterpret_cast<const inotify_event*>(Buffer + Offset);
+			if (Event->len > 0 && (Event->mask & IN_ISDIR) == 0) {
+				const std::string Path = Directory + "/" + Event->name;
+				if (std::find(OutChangedFiles.begin(), OutChangedFiles.end(), Path) == OutChangedFiles.end()) {
+					OutChangedFiles.push_back(Path);
+				}
+			}
+			Offset += static_cast<ssize_t>(sizeof(inotify_event) + Event->len);
+		}
+	}
+}
+
+#else
+
+bool FileWatcher::Watch(const std::string& NewDirectory) {
+	Stop();
+
+	std::error_code Error;
+	if (!std::filesystem::is_directory(NewDirectory, Error)) {
+		return false;
+	}
+
+	//as datas atuais são a referência, só o que mudar depois é avisado
+	for (const std::filesystem::directory_entry& Entry : std::filesystem::directory_iterator(NewDirectory, Error)) {
+		if (Entry.is_regular_file(Error)) {
+			WriteTimes[NewDirectory + "/" + Entry.path().filename().string()] = Entry.last_write_time(Error);
+		}
+	}
+
+	Directory = NewDirectory;
+	LastPoll = std::chrono::steady_clock::now();
+	return true;
+}
+
+void FileWatcher::Stop() {
+	WriteTimes.clear();
+	Directory.clear();
+}
+
+void FileWatcher::Poll(std::vector<std::string>& OutChangedFiles) {
+	OutChangedFiles.clear();
+	const std::chrono::steady_clock::time_point Now = std::chrono::steady_clock::now();
+	if (Directory.empty() || Now - LastPoll < PollInterval) {
+		return;
+	}
+	LastPoll = Now;
+
+	std::error_code Error;
+	for (const std::filesystem::directory_entry& Entry : std::filesystem::directory_iterator(Directory, Error)) {
+		if (!Entry.is_regular_file(Error)) {
+			continue;
+		}
+
+		const std::string Path = Directory + "/" + Entry.path().filename().string();
+		const std::filesystem::file_time_type WriteTime = Entry.last_write_time(Error);
+		auto Found = WriteTimes.find(Path);
+		if (Found == WriteTimes.end() || Found->second != WriteTime) {
+			WriteTimes[Path] = WriteTime;
+			OutChangedFiles.push_back(Path);
+		}
+	}
+}
+
+#endif
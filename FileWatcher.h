@@ -0,0 +1,39 @@
+#pragma once
+
+#include<chrono>
+#include<cstddef>
+#include<filesystem>
+#include<string>
+#include<unordered_map>
+#include<vector>
+
+//avisa quando arquivos de uma pasta são gravados, sem bloquear: inotify no Linux, nos outros sistemas
+//a data de modificação dos arquivos é comparada no máximo a cada PollInterval
+class FileWatcher {
+public:
+	FileWatcher() = default;
+	~FileWatcher();
+
+	FileWatcher(const FileWatcher&) = delete;
+	FileWatcher& operator=(const FileWatcher&) = delete;
+
+	//observa os arquivos da pasta (sem subpastas)
+	bool Watch(const std::string& NewDirectory);
+	void Stop();
+
+	bool IsWatching() const { return !Directory.empty(); }
+
+	//caminhos (Directory/nome) dos arquivos gravados desde a última chamada, sem repetição. Nunca espera.
+	void Poll(std::vector<std::string>& OutChangedFiles);
+
+private:
+	std::string Directory;
+
+#ifdef __linux__
+	int NotifyDescriptor = -1;
+#else
+	static constexpr std::chrono::milliseconds PollInterval{ 250 };
+	std::unordered_map<std::string, std::filesystem::file_time_type> WriteTimes;
+	std::chrono::steady_clock::time_point LastPoll;
+#endif
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include<cstddef>
+#include<vector>
+
+#include<GL/glew.h>
+#include<glm/glm.hpp>
+
+#include "ShaderReflection.h"
+
+//dados do frame comuns a todos os programas, no bloco FrameUniforms do shaders/frame_uniforms.glsl.
+//um uniform buffer ligado em FrameUniformsBinding recebe a struct inteira numa escrita por frame,
+//no lugar de um glUniform por valor e por programa.
+//o layout é std140: cada vec3 alinha em 16 bytes e o float seguinte ocupa o resto da linha.
+//mudar um lado exige mudar o outro; a linkagem confere os offsets (ProgramReflection::CheckBlock).
+constexpr GLuint FrameUniformsBinding = 0;
+constexpr const char* FrameUniformsBlock = "FrameUniforms";
+
+struct FrameUniforms {
+	glm::mat4 ModelViewProjection;
+	glm::mat4 NormalMatrix;
+	glm::vec3 LightDirection;      //no espaço da câmera
+	float LightIntensity = 1.0f;
+	glm::vec3 CameraPosition;      //no espaço do modelo
+	float Time = 0.0f;
+};
+static_assert(sizeof(FrameUniforms) == 160, "FrameUniforms tem que seguir o layout std140 do shader");
+
+inline std::vector<UniformBlockMember> GetFrameUniformsMembers() {
+	return {
+		{ "ModelViewProjection", offsetof(FrameUniforms, ModelViewProjection) },
+		{ "NormalMatrix", offsetof(FrameUniforms, NormalMatrix) },
+		{ "LightDirection", offsetof(FrameUniforms, LightDirection) },
+		{ "LightIntensity", offsetof(FrameUniforms, LightIntensity) },
+		{ "CameraPosition", offsetof(FrameUniforms, CameraPosition) },
+		{ "Time", offsetof(FrameUniforms, Time) },
+	};
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include<glm/glm.hpp>
+
+//planos do frustum (Gribb-Hartmann) no espaço em que a matriz recebe os vértices, normalizados.
+//um ponto P está do lado de dentro de um plano quando dot(xyz, P) + w >= 0
+inline void ExtractFrustumPlanes(const glm::mat4& ModelViewProjection, glm::vec4 OutPlanes[6]) {
+	const glm::mat4& M = ModelViewProjection;
+	const glm::vec4 W{ M[0][3], M[1][3], M[2][3], M[3][3] };
+	for (int Index = 0; Index < 3; ++Index) {
+		const glm::vec4 Row{ M[0][Index], M[1][Index], M[2][Index], M[3][Index] };
+		OutPlanes[Index * 2 + 0] = W + Row;
+		OutPlanes[Index * 2 + 1] = W - Row;
+	}
+	for (int Index = 0; Index < 6; ++Index) {
+		OutPlanes[Index] /= glm::length(glm::vec3{ OutPlanes[Index] });
+	}
+}
+
+inline bool IsSphereOutsideFrustum(const glm::vec4 Planes[6], const glm::vec3& Center, float Radius) {
+	for (int Index = 0; Index < 6; ++Index) {
+		if (glm::dot(glm::vec3{ Planes[Index] }, Center) + Planes[Index].w < -Radius) {
+			return true;
+		}
+	}
+	return false;
+}
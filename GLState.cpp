@@ -0,0 +1,314 @@
+#include "GLState.h"
+
+#include<cassert>
+#include<cstring>
+
+static int GetTextureTargetIndex(GLenum Target) {
+	switch (Target) {
+	case GL_TEXTURE_2D: return 0;
+	case GL_TEXTURE_2D_ARRAY: return 1;
+	case GL_TEXTURE_CUBE_MAP: return 2;
+	default: return -1;
+	}
+}
+
+static int GetCapabilityIndex(GLenum Capability) {
+	switch (Capability) {
+	case GL_CULL_FACE: return 0;
+	case GL_DEPTH_TEST: return 1;
+	case GL_BLEND: return 2;
+	case GL_TEXTURE_CUBE_MAP_SEAMLESS: return 3;
+	default: return -1;
+	}
+}
+
+static uint32_t GetBits(GLfloat Value) {
+	uint32_t Bits;
+	std::memcpy(&Bits, &Value, sizeof(Bits));
+	return Bits;
+}
+
+const char* ToString(GLStateCall Call) {
+	switch (Call) {
+	case GLStateCall::Program: return "programa";
+	case GLStateCall::VertexArray: return "VAO";
+	case GLStateCall::Texture: return "textura";
+	case GLStateCall::Buffer: return "buffer";
+	case GLStateCall::Uniform: return "uniform";
+	case GLStateCall::FixedFunction: return "estado fixo";
+	default: return "?";
+	}
+}
+
+size_t GLStateStats::GetIssued() const {
+	size_t Total = 0;
+	for (size_t Count : Issued) {
+		Total += Count;
+	}
+	return Total;
+}
+
+size_t GLStateStats::GetFiltered() const {
+	size_t Total = 0;
+	for (size_t Count : Filtered) {
+		Total += Count;
+	}
+	return Total;
+}
+
+GLStateCache::GLStateCache() {
+	Invalidate();
+}
+
+void GLStateCache::Invalidate() {
+	Program = Unknown;
+	VertexArray = Unknown;
+	ArrayBuffer = Unknown;
+	UniformBuffer = Unknown;
+	ActiveUnit = -1;
+	for (std::array<GLuint, NumTextureTargets>& Unit : Textures) {
+		Unit.fill(Unknown);
+	}
+	Capabilities.fill(Unknown);
+	CullFace = Unknown;
+	DepthFunc = Unknown;
+	PolygonMode = Unknown;
+	PointSize = -1.0f;
+	LineWidth = -1.0f;
+	Viewport.fill(-1);
+}
+
+bool GLStateCache::Filter(GLStateCall Call, bool bChanged) {
+	const size_t Index = static_cast<size_t>(Call);
+	if (bChanged) {
+		++Stats.Issued[Index];
+	}
+	else {
+		++Stats.Filtered[Index];
+	}
+	return bChanged;
+}
+
+void GLStateCache::UseProgram(GLuint NewProgram) {
+	if (Filter(GLStateCall::Program, Program != NewProgram)) {
+		glUseProgram(NewProgram);
+		Program = NewProgram;
+	}
+}
+
+void GLStateCache::BindVertexArray(GLuint NewVertexArray) {
+	if (Filter(GLStateCall::VertexArray, VertexArray != NewVertexArray)) {
+		glBindVertexArray(NewVertexArray);
+		VertexArray = NewVertexArray;
+	}
+}
+
+void GLStateCache::SetActiveUnit(GLint Unit) {
+	if (ActiveUnit != Unit) {
+		glActiveTexture(GL_TEXTURE0 + Unit);
+		ActiveUnit = Unit;
+		++Stats.Issued[static_cast<size_t>(GLStateCall::Texture)];
+	}
+}
+
+void GLStateCache::BindTexture(GLint Unit, GLenum Target, GLuint Texture) {
+	assert(Unit >= 0);
+	const int TargetIndex = GetTextureTargetIndex(Target);
+	if (Unit >= MaxTextureUnits || TargetIndex < 0) {
+		SetActiveUnit(Unit);
+		Filter(GLStateCall::Texture, true);
+		glBindTexture(Target, Texture);
+		return;
+	}
+
+	GLuint& Bound = Textures[Unit][TargetIndex];
+	if (Filter(GLStateCall::Texture, Bound != Texture)) {
+		SetActiveUnit(Unit);
+		glBindTexture(Target, Texture);
+		Bound = Texture;
+	}
+}
+
+void GLStateCache::BindTexture(GLenum Target, GLuint Texture) {
+	//sem unidade conhecida, a 0 é tão boa quanto qualquer outra
+	BindTexture(ActiveUnit >= 0 ? ActiveUnit : 0, Target, Texture);
+}
+
+void GLStateCache::BindBuffer(GLenum Target, GLuint Buffer) {
+	GLuint* Bound = nullptr;
+	if (Target == GL_ARRAY_BUFFER) {
+		Bound = &ArrayBuffer;
+	}
+	else if (Target == GL_UNIFORM_BUFFER) {
+		Bound = &UniformBuffer;
+	}
+
+	if (Filter(GLStateCall::Buffer, Bound == nullptr || *Bound != Buffer)) {
+		glBindBuffer(Target, Buffer);
+		if (Bound) {
+			*Bound = Buffer;
+		}
+	}
+}
+
+void GLStateCache::BindBufferBase(GLenum Target, GLuint Index, GLuint Buffer) {
+	//também troca a ligação genérica do alvo
+	Filter(GLStateCall::Buffer, true);
+	glBindBufferBase(Target, Index, Buffer);
+	if (Target == GL_UNIFORM_BUFFER) {
+		UniformBuffer = Buffer;
+	}
+}
+
+GLint GLStateCache::GetUniformLocation(GLuint Program, const char* Name) {
+	std::unordered_map<std::string, GLint>& Locations = Uniforms[Program].Locations;
+	auto Found = Locations.find(Name);
+	if (Found == Locations.end()) {
+		Found = Locations.emplace(Name, glGetUniformLocation(Program, Name)).first;
+	}
+	return Found->second;
+}
+
+bool GLStateCache::ShouldSetUniform(GLint Location, const std::array<uint32_t, 2>& Bits) {
+	if (Location < 0) {
+		return Filter(GLStateCall::Uniform, false);
+	}
+
+	assert(Program != Unknown && Program != 0);
+	std::unordered_map<GLint, std::array<uint32_t, 2>>& Values = Uniforms[Program].Values;
+	auto Found = Values.find(Location);
+	if (Found != Values.end() && Found->second == Bits) {
+		return Filter(GLStateCall::Uniform, false);
+	}
+	Values[Location] = Bits;
+	return Filter(GLStateCall::Uniform, true);
+}
+
+void GLStateCache::SetUniform(GLint Location, GLint Value) {
+	if (ShouldSetUniform(Location, { static_cast<uint32_t>(Value), 0 })) {
+		glUniform1i(Location, Value);
+	}
+}
+
+void GLStateCache::SetUniform(GLint Location, GLfloat Value) {
+	if (ShouldSetUniform(Location, { GetBits(Value), 0 })) {
+		glUniform1f(Location, Value);
+	}
+}
+
+void GLStateCache::SetUniform(GLint Location, GLfloat X, GLfloat Y) {
+	if (ShouldSetUniform(Location, { GetBits(X), GetBits(Y) })) {
+		glUniform2f(Location, X, Y);
+	}
+}
+
+void GLStateCache::SetEnabled(GLenum Capability, bool bEnabled) {
+	const int Index = GetCapabilityIndex(Capability);
+	const GLuint State = bEnabled ? GL_TRUE : GL_FALSE;
+	if (Filter(GLStateCall::FixedFunction, Index < 0 || Capabilities[Index] != State)) {
+		if (bEnabled) {
+			glEnable(Capability);
+		}
+		else {
+			glDisable(Capability);
+		}
+		if (Index >= 0) {
+			Capabilities[Index] = State;
+		}
+	}
+}
+
+void GLStateCache::SetCullFace(GLenum Face) {
+	if (Filter(GLStateCall::FixedFunction, CullFace != Face)) {
+		glCullFace(Face);
+		CullFace = Face;
+	}
+}
+
+void GLStateCache::SetDepthFunc(GLenum Func) {
+	if (Filter(GLStateCall::FixedFunction, DepthFunc != Func)) {
+		glDepthFunc(Func);
+		DepthFunc = Func;
+	}
+}
+
+void GLStateCache::SetPolygonMode(GLenum Mode) {
+	//o core profile só aceita GL_FRONT_AND_BACK
+	if (Filter(GLStateCall::FixedFunction, PolygonMode != Mode)) {
+		glPolygonMode(GL_FRONT_AND_BACK, Mode);
+		PolygonMode = Mode;
+	}
+}
+
+void GLStateCache::SetPointSize(GLfloat Size) {
+	if (Filter(GLStateCall::FixedFunction, PointSize != Size)) {
+		glPointSize(Size);
+		PointSize = Size;
+	}
+}
+
+void GLStateCache::SetLineWidth(GLfloat Width) {
+	if (Filter(GLStateCall::FixedFunction, LineWidth != Width)) {
+		glLineWidth(Width);
+		LineWidth = Width;
+	}
+}
+
+void GLStateCache::SetViewport(GLint X, GLint Y, GLsizei Width, GLsizei Height) {
+	const std::array<GLint, 4> NewViewport = { X, Y, Width, Height };
+	if (Filter(GLStateCall::FixedFunction, Viewport != NewViewport)) {
+		glViewport(X, Y, Width, Height);
+		Viewport = NewViewport;
+	}
+}
+
+void GLStateCache::DeleteProgram(GLuint DeletedProgram) {
+	//o programa ativo só é apagado de fato quando deixa de ser usado, mas os uniforms guardados já não servem
+	Uniforms.erase(DeletedProgram);
+	glDeleteProgram(DeletedProgram);
+}
+
+void GLStateCache::DeleteVertexArrays(GLsizei Count, const GLuint* VertexArrays) {
+	for (GLsizei Index = 0; Index < Count; ++Index) {
+		if (VertexArrays[Index] != 0 && VertexArray == VertexArrays[Index]) {
+			VertexArray = 0;
+		}
+	}
+	glDeleteVertexArrays(Count, VertexArrays);
+}
+
+void GLStateCache::DeleteTextures(GLsizei Count, const GLuint* DeletedTextures) {
+	for (GLsizei Index = 0; Index < Count; ++Index) {
+		if (DeletedTextures[Index] == 0) {
+			continue;
+		}
+		for (std::array<GLuint, NumTextureTargets>& Unit : Textures) {
+			for (GLuint& Bound : Unit) {
+				if (Bound == DeletedTextures[Index]) {
+					Bound = 0;
+				}
+			}
+		}
+	}
+	glDeleteTextures(Count, DeletedTextures);
+}
+
+void GLStateCache::DeleteBuffers(GLsizei Count, const GLuint* Buffers) {
+	for (GLsizei Index = 0; Index < Count; ++Index) {
+		if (Buffers[Index] == 0) {
+			continue;
+		}
+		if (ArrayBuffer == Buffers[Index]) {
+			ArrayBuffer = 0;
+		}
+		if (UniformBuffer == Buffers[Index]) {
+			UniformBuffer = 0;
+		}
+	}
+	glDeleteBuffers(Count, Buffers);
+}
+
+GLStateCache& GetGLState() {
+	static GLStateCache State;
+	return State;
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include<array>
+#include<cstddef>
+#include<cstdint>
+#include<string>
+#include<unordered_map>
+
+#include<GL/glew.h>
+
+//espelho do estado do OpenGL na thread do contexto: programa, VAO, texturas por unidade, buffers, uniforms e o
+//estado fixo. Cada chamada compara com o espelho e só chega ao driver quando muda alguma coisa; o frame pode
+//pedir o mesmo estado todo frame sem pagar o custo de validação do driver.
+//o espelho só vale se todo o código passar por aqui: quem chamar o OpenGL direto para estes estados tem que
+//chamar Invalidate depois.
+
+enum class GLStateCall : uint32_t {
+	Program,
+	VertexArray,
+	Texture,
+	Buffer,
+	Uniform,
+	FixedFunction,
+	Count
+};
+
+constexpr size_t NumGLStateCalls = static_cast<size_t>(GLStateCall::Count);
+
+const char* ToString(GLStateCall Call);
+
+//chamadas que chegaram ao driver e chamadas descartadas por não mudarem nada, por tipo
+struct GLStateStats {
+	std::array<size_t, NumGLStateCalls> Issued{};
+	std::array<size_t, NumGLStateCalls> Filtered{};
+
+	size_t GetIssued() const;
+	size_t GetFiltered() const;
+};
+
+class GLStateCache {
+public:
+	GLStateCache();
+
+	GLStateCache(const GLStateCache&) = delete;
+	GLStateCache& operator=(const GLStateCache&) = delete;
+
+	//esquece as ligações e o estado fixo, a próxima chamada de cada um sempre chega ao driver.
+	//os valores dos uniforms são dos programas e continuam valendo.
+	void Invalidate();
+
+	void UseProgram(GLuint Program);
+	void BindVertexArray(GLuint VertexArray);
+
+	//troca a unidade ativa só quando a textura muda
+	void BindTexture(GLint Unit, GLenum Target, GLuint Texture);
+
+	//na unidade ativa, para os envios que só precisam da textura ligada
+	void BindTexture(GLenum Target, GLuint Texture);
+
+	//GL_ELEMENT_ARRAY_BUFFER é estado do VAO e sempre passa direto
+	void BindBuffer(GLenum Target, GLuint Buffer);
+	void BindBufferBase(GLenum Target, GLuint Index, GLuint Buffer);
+
+	//glGetUniformLocation guardado por programa e nome
+	GLint GetUniformLocation(GLuint Program, const char* Name);
+
+	//no programa ativo; Location -1 (uniform removido pelo compilador) não chega ao driver
+	void SetUniform(GLint Location, GLint Value);
+	void SetUniform(GLint Location, GLfloat Value);
+	void SetUniform(GLint Location, GLfloat X, GLfloat Y);
+
+	void SetEnabled(GLenum Capability, bool bEnabled);
+	void SetCullFace(GLenum Face);
+	void SetDepthFunc(GLenum Func);
+	void SetPolygonMode(GLenum Mode);
+	void SetPointSize(GLfloat Size);
+	void SetLineWidth(GLfloat Width);
+	void SetViewport(GLint X, GLint Y, GLsizei Width, GLsizei Height);
+
+	GLuint GetProgram() const { return Program; }
+
+	//os nomes apagados voltam a ser usados pelo driver, as ligações espelhadas precisam sair junto
+	void DeleteProgram(GLuint Program);
+	void DeleteVertexArrays(GLsizei Count, const GLuint* VertexArrays);
+	void DeleteTextures(GLsizei Count, const GLuint* Textures);
+	void DeleteBuffers(GLsizei Count, const GLuint* Buffers);
+
+	const GLStateStats& GetStats() const { return Stats; }
+	void ResetStats() { Stats = GLStateStats{}; }
+
+private:
+	//valor de um estado que o espelho não conhece
+	static constexpr GLuint Unknown = ~0u;
+
+	static constexpr GLint MaxTextureUnits = 32;
+
+	//GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY e GL_TEXTURE_CUBE_MAP, os alvos que o programa usa
+	static constexpr size_t NumTextureTargets = 3;
+
+	//GL_CULL_FACE, GL_DEPTH_TEST, GL_BLEND e GL_TEXTURE_CUBE_MAP_SEAMLESS
+	static constexpr size_t NumCapabilities = 4;
+
+	struct ProgramUniforms {
+		std::unordered_map<std::string, GLint> Locations;
+
+		//bits do valor, vec2 usa os dois
+		std::unordered_map<GLint, std::array<uint32_t, 2>> Values;
+	};
+
+	//conta a chamada e diz se ela precisa chegar ao driver
+	bool Filter(GLStateCall Call, bool bChanged);
+
+	void SetActiveUnit(GLint Unit);
+
+	//guarda o valor no programa ativo e diz se ele mudou
+	bool ShouldSetUniform(GLint Location, const std::array<uint32_t, 2>& Bits);
+
+	GLuint Program = Unknown;
+	GLuint VertexArray = Unknown;
+	GLuint ArrayBuffer = Unknown;
+	GLuint UniformBuffer = Unknown;
+	GLint ActiveUnit = -1;
+	std::array<std::array<GLuint, NumTextureTargets>, MaxTextureUnits> Textures;
+	std::array<GLuint, NumCapabilities> Capabilities;
+	GLenum CullFace = Unknown;
+	GLenum DepthFunc = Unknown;
+	GLenum PolygonMode = Unknown;
+	GLfloat PointSize = -1.0f;
+	GLfloat LineWidth = -1.0f;
+	std::array<GLint, 4> Viewport;
+
+	std::unordered_map<GLuint, ProgramUniforms> Uniforms;
+
+	GLStateStats Stats;
+};
+
+//espelho do contexto da thread do OpenGL
+GLStateCache& GetGLState();
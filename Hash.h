@@ -0,0 +1,37 @@
+#pragma once
+
+#include<cstddef>
+#include<cstdint>
+#include<string>
+
+//hash FNV-1a de 64 bits, usado como chave dos caches em disco (não é criptográfico)
+constexpr uint64_t HashSeed = 0xcbf29ce484222325ull;
+
+inline uint64_t HashBytes(const void* Data, size_t Size, uint64_t Hash = HashSeed) {
+	const unsigned char* Bytes = static_cast<const unsigned char*>(Data);
+	for (size_t Index = 0; Index < Size; ++Index) {
+		Hash ^= Bytes[Index];
+		Hash *= 0x100000001b3ull;
+	}
+	return Hash;
+}
+
+inline uint64_t HashString(const std::string& Text, uint64_t Hash = HashSeed) {
+	return HashBytes(Text.data(), Text.size(), Hash);
+}
+
+template<typename T>
+uint64_t HashValue(const T& Value, uint64_t Hash = HashSeed) {
+	return HashBytes(&Value, sizeof(T), Hash);
+}
+
+//chave em hexadecimal para nomes de arquivo
+inline std::string HashToString(uint64_t Hash) {
+	static const char Digits[] = "0123456789abcdef";
+	std::string Text(16, '0');
+	for (int Index = 15; Index >= 0; --Index) {
+		Text[Index] = Digits[Hash & 0xF];
+		Hash >>= 4;
+	}
+	return Text;
+}
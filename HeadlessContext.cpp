@@ -0,0 +1,181 @@
+#include "HeadlessContext.h"
+
+#include<cstring>
+#include<fstream>
+#include<iostream>
+
+#ifdef BLUEMARBLE_HEADLESS
+#include<EGL/egl.h>
+#include<EGL/eglext.h>
+#endif
+
+HeadlessContext::~HeadlessContext() {
+	Destroy();
+}
+
+#ifdef BLUEMARBLE_HEADLESS
+
+static bool HasExtension(const char* Extensions, const char* Name) {
+	if (Extensions == nullptr) {
+		return false;
+	}
+
+	//a lista é separada por espaços; um nome pode ser prefixo de outro
+	const size_t Length = std::strlen(Name);
+	for (const char* Found = std::strstr(Extensions, Name); Found != nullptr; Found = std::strstr(Found + Length, Name)) {
+		if ((Found == Extensions || Found[-1] == ' ') && (Found[Length] == ' ' || Found[Length] == '\0')) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool HeadlessContext::CreateContext() {
+	Destroy();
+
+	//a plataforma surfaceless do Mesa não precisa de X, Wayland nem de um dispositivo DRM
+	EGLDisplay NewDisplay = EGL_NO_DISPLAY;
+	const char* ClientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+	const PFNEGLGETPLATFORMDISPLAYEXTPROC GetPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+	if (GetPlatformDisplay != nullptr && HasExtension(ClientExtensions, "EGL_MESA_platform_surfaceless")) {
+		NewDisplay = GetPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+	}
+	if (NewDisplay == EGL_NO_DISPLAY) {
+		NewDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	}
+
+	EGLint Major = 0;
+	EGLint Minor = 0;
+	if (NewDisplay == EGL_NO_DISPLAY || !eglInitialize(NewDisplay, &Major, &Minor)) {
+		std::cout << "EGL: nenhum display disponivel" << std::endl;
+		return false;
+	}
+	Display = NewDisplay;
+
+	if (!HasExtension(eglQueryString(NewDisplay, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context") || !eglBindAPI(EGL_OPENGL_API)) {
+		std::cout << "EGL: o driver nao cria contexto OpenGL sem superficie" << std::endl;
+		Destroy();
+		return false;
+	}
+
+	//a configuração só escolhe o tipo de contexto, o frame vai para o framebuffer criado depois
+	const EGLint ConfigAttributes[] = {
+		EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_NONE
+	};
+	EGLConfig Config = nullptr;
+	EGLint NumConfigs = 0;
+	if (!eglChooseConfig(NewDisplay, ConfigAttributes, &Config, 1, &NumConfigs) || NumConfigs == 0) {
+		std::cout << "EGL: nenhuma configuracao OpenGL" << std::endl;
+		Destroy();
+		return false;
+	}
+
+	const EGLint ContextAttributes[] = {
+		EGL_CONTEXT_MAJOR_VERSION, 3,
+		EGL_CONTEXT_MINOR_VERSION, 3,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+		EGL_NONE
+	};
+	EGLContext NewContext = eglCreateContext(NewDisplay, Config, EGL_NO_CONTEXT, ContextAttributes);
+	if (NewContext == EGL_NO_CONTEXT || !eglMakeCurrent(NewDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, NewContext)) {
+		std::cout << "EGL: nao foi possivel criar o contexto OpenGL 3.3 core (erro 0x" << std::hex << eglGetError() << std::dec << ")" << std::endl;
+		if (NewContext != EGL_NO_CONTEXT) {
+			eglDestroyContext(NewDisplay, NewContext);
+		}
+		Destroy();
+		return false;
+	}
+	Context = NewContext;
+
+	std::cout << "EGL " << Major << "." << Minor << " sem superficie (" << eglQueryString(NewDisplay, EGL_VENDOR) << ")" << std::endl;
+	return true;
+}
+
+static void DestroyContext(void* Display, void* Context) {
+	if (Context != nullptr) {
+		eglMakeCurrent(Display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		eglDestroyContext(Display, Context);
+	}
+	if (Display != nullptr) {
+		eglTerminate(Display);
+	}
+}
+
+#else
+
+bool HeadlessContext::CreateContext() {
+	std::cout << "Compilado sem EGL: --headless precisa do BLUEMARBLE_HEADLESS" << std::endl;
+	return false;
+}
+
+static void DestroyContext(void*, void*) {}
+
+#endif
+
+bool HeadlessContext::CreateFramebuffer(int NewWidth, int NewHeight) {
+	Width = NewWidth;
+	Height = NewHeight;
+
+	glGenRenderbuffers(1, &ColorBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, ColorBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, Width, Height);
+
+	glGenRenderbuffers(1, &DepthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, DepthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, Width, Height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &Framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, Framebuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, ColorBuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, DepthBuffer);
+	const bool bComplete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	if (!bComplete) {
+		std::cout << "Framebuffer sem janela incompleto" << std::endl;
+	}
+	return bComplete;
+}
+
+void HeadlessContext::Bind() const {
+	glBindFramebuffer(GL_FRAMEBUFFER, Framebuffer);
+}
+
+bool HeadlessContext::SaveFrame(const std::string& Path) {
+	const size_t RowBytes = static_cast<size_t>(Width) * 3;
+	Pixels.resize(RowBytes * Height);
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, Framebuffer);
+	glReadBuffer(GL_COLOR_ATTACHMENT0);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, Width, Height, GL_RGB, GL_UNSIGNED_BYTE, Pixels.data());
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+	std::ofstream Stream{ Path, std::ios::out | std::ios::binary | std::ios::trunc };
+	if (!Stream) {
+		return false;
+	}
+
+	//o OpenGL começa pela linha de baixo, o PPM pela de cima
+	Stream << "P6\n" << Width << " " << Height << "\n255\n";
+	for (int Row = Height - 1; Row >= 0; --Row) {
+		Stream.write(reinterpret_cast<const char*>(Pixels.data() + Row * RowBytes), static_cast<std::streamsize>(RowBytes));
+	}
+	return static_cast<bool>(Stream);
+}
+
+void HeadlessContext::Destroy() {
+	if (Framebuffer != 0) {
+		glDeleteFramebuffers(1, &Framebuffer);
+		glDeleteRenderbuffers(1, &ColorBuffer);
+		glDeleteRenderbuffers(1, &DepthBuffer);
+		Framebuffer = ColorBuffer = DepthBuffer = 0;
+	}
+
+	DestroyContext(Display, Context);
+	Display = nullptr;
+	Context = nullptr;
+}
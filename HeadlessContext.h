@@ -0,0 +1,49 @@
+#pragma once
+
+#include<cstdint>
+#include<string>
+#include<vector>
+
+#include<GL/glew.h>
+
+//contexto OpenGL sem janela, para os nós de renderização e a CI: EGL surfaceless (com o Mesa llvmpipe funciona
+//sem display e sem GPU) e um framebuffer de cor e profundidade no lugar do framebuffer da janela.
+//o EGL só existe com BLUEMARBLE_HEADLESS (Linux com libEGL); sem ele CreateContext falha e o resto não muda.
+class HeadlessContext {
+public:
+	HeadlessContext() = default;
+	~HeadlessContext();
+
+	HeadlessContext(const HeadlessContext&) = delete;
+	HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+	//cria um contexto OpenGL 3.3 core e o torna atual na thread que chama, antes do GLEW
+	bool CreateContext();
+
+	//cor RGBA8 e profundidade de 24 bits, depois do GLEW
+	bool CreateFramebuffer(int NewWidth, int NewHeight);
+
+	//o frame é desenhado aqui, no lugar do framebuffer 0
+	void Bind() const;
+
+	//lê a cor e grava um PPM (P6). Espera a GPU terminar o frame.
+	bool SaveFrame(const std::string& Path);
+
+	//libera o framebuffer e o contexto
+	void Destroy();
+
+	bool IsCreated() const { return Context != nullptr; }
+	GLuint GetFramebuffer() const { return Framebuffer; }
+
+private:
+	int Width = 0;
+	int Height = 0;
+	GLuint Framebuffer = 0;
+	GLuint ColorBuffer = 0;
+	GLuint DepthBuffer = 0;
+	std::vector<uint8_t> Pixels;
+
+	//EGLDisplay e EGLContext, sem o EGL neste cabeçalho
+	void* Display = nullptr;
+	void* Context = nullptr;
+};
@@ -0,0 +1,201 @@
+#include "MappedFile.h"
+
+#include<utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include<windows.h>
+#else
+#include<fcntl.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include<unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+	Close();
+}
+
+MappedFile::MappedFile(MappedFile&& Other) noexcept {
+	*this = std::move(Other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& Other) noexcept {
+	if (this != &Other) {
+		Close();
+		std::swap(Data, Other.Data);
+		std::swap(Size, Other.Size);
+		std::swap(bWritable, Other.bWritable);
+#ifdef _WIN32
+		std::swap(FileHandle, Other.FileHandle);
+		std::swap(MappingHandle, Other.MappingHandle);
+#else
+		std::swap(FileDescriptor, Other.FileDescriptor);
+#endif
+	}
+	return *this;
+}
+
+#ifdef _WIN32
+
+bool MappedFile::OpenRead(const std::string& Path) {
+	Close();
+
+	HANDLE File = CreateFileA(Path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (File == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	LARGE_INTEGER FileSize;
+	if (!GetFileSizeEx(File, &FileSize) || FileSize.QuadPart == 0) {
+		CloseHandle(File);
+		return false;
+	}
+
+	HANDLE Mapping = CreateFileMappingA(File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!Mapping) {
+		CloseHandle(File);
+		return false;
+	}
+
+	Data = MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!Data) {
+		CloseHandle(Mapping);
+		CloseHandle(File);
+		return false;
+	}
+
+	FileHandle = File;
+	MappingHandle = Mapping;
+	Size = static_cast<size_t>(FileSize.QuadPart);
+	bWritable = false;
+	return true;
+}
+
+bool MappedFile::CreateWrite(const std::string& Path, size_t NewSize) {
+	Close();
+
+	HANDLE File = CreateFileA(Path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (File == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	const uint64_t Size64 = NewSize;
+	HANDLE Mapping = CreateFileMappingA(File, nullptr, PAGE_READWRITE, static_cast<DWORD>(Size64 >> 32), static_cast<DWORD>(Size64 & 0xFFFFFFFF), nullptr);
+	if (!Mapping) {
+		CloseHandle(File);
+		return false;
+	}
+
+	Data = MapViewOfFile(Mapping, FILE_MAP_WRITE, 0, 0, NewSize);
+	if (!Data) {
+		CloseHandle(Mapping);
+		CloseHandle(File);
+		return false;
+	}
+
+	FileHandle = File;
+	MappingHandle = Mapping;
+	Size = NewSize;
+	bWritable = true;
+	return true;
+}
+
+void MappedFile::Close() {
+	if (Data) {
+		if (bWritable) {
+			FlushViewOfFile(Data, 0);
+		}
+		UnmapViewOfFile(Data);
+	}
+	if (MappingHandle) {
+		CloseHandle(MappingHandle);
+	}
+	if (FileHandle) {
+		CloseHandle(FileHandle);
+	}
+
+	Data = nullptr;
+	MappingHandle = nullptr;
+	FileHandle = nullptr;
+	Size = 0;
+	bWritable = false;
+}
+
+#else
+
+bool MappedFile::OpenRead(const std::string& Path) {
+	Close();
+
+	const int File = open(Path.c_str(), O_RDONLY);
+	if (File < 0) {
+		return false;
+	}
+
+	struct stat FileStat;
+	if (fstat(File, &FileStat) != 0 || FileStat.st_size == 0) {
+		close(File);
+		return false;
+	}
+
+	void* Mapping = mmap(nullptr, static_cast<size_t>(FileStat.st_size), PROT_READ, MAP_PRIVATE, File, 0);
+	if (Mapping == MAP_FAILED) {
+		close(File);
+		return false;
+	}
+
+	//o arquivo é lido do início ao fim para a cópia na GPU
+	madvise(Mapping, static_cast<size_t>(FileStat.st_size), MADV_SEQUENTIAL);
+
+	FileDescriptor = File;
+	Data = Mapping;
+	Size = static_cast<size_t>(FileStat.st_size);
+	bWritable = false;
+	return true;
+}
+
+bool MappedFile::CreateWrite(const std::string& Path, size_t NewSize) {
+	Close();
+
+	const int File = open(Path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (File < 0) {
+		return false;
+	}
+
+	if (ftruncate(File, static_cast<off_t>(NewSize)) != 0) {
+		close(File);
+		return false;
+	}
+
+	void* Mapping = mmap(nullptr, NewSize, PROT_READ | PROT_WRITE, MAP_SHARED, File, 0);
+	if (Mapping == MAP_FAILED) {
+		close(File);
+		return false;
+	}
+
+	FileDescriptor = File;
+	Data = Mapping;
+	Size = NewSize;
+	bWritable = true;
+	return true;
+}
+
+void MappedFile::Close() {
+	if (Data) {
+		if (bWritable) {
+			msync(Data, Size, MS_SYNC);
+		}
+		munmap(Data, Size);
+	}
+	if (FileDescriptor >= 0) {
+		close(FileDescriptor);
+	}
+
+	Data = nullptr;
+	FileDescriptor = -1;
+	Size = 0;
+	bWritable = false;
+}
+
+#endif
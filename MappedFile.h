@@ -0,0 +1,42 @@
+#pragma once
+
+#include<cstddef>
+#include<cstdint>
+#include<string>
+
+//arquivo mapeado em memória (mmap no Linux, MapViewOfFile no Windows)
+class MappedFile {
+public:
+	MappedFile() = default;
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	MappedFile(MappedFile&& Other) noexcept;
+	MappedFile& operator=(MappedFile&& Other) noexcept;
+
+	//mapeia um arquivo existente somente para leitura
+	bool OpenRead(const std::string& Path);
+
+	//cria (ou trunca) um arquivo com Size bytes e mapeia para escrita
+	bool CreateWrite(const std::string& Path, size_t Size);
+
+	void Close();
+
+	bool IsOpen() const { return Data != nullptr; }
+	const uint8_t* GetData() const { return static_cast<const uint8_t*>(Data); }
+	uint8_t* GetMutableData() const { return bWritable ? static_cast<uint8_t*>(Data) : nullptr; }
+	size_t GetSize() const { return Size; }
+
+private:
+	void* Data = nullptr;
+	size_t Size = 0;
+	bool bWritable = false;
+
+#ifdef _WIN32
+	void* FileHandle = nullptr;
+	void* MappingHandle = nullptr;
+#else
+	int FileDescriptor = -1;
+#endif
+};
@@ -0,0 +1,97 @@
+#include "MeshCache.h"
+
+#include<cstring>
+#include<filesystem>
+#include<new>
+#include<system_error>
+
+#include "Hash.h"
+#include "VertexPacking.h"
+
+static const char MeshFileMagic[4] = { 'B', 'M', 'S', 'H' };
+
+static uint64_t AlignUp(uint64_t Value) {
+	return (Value + MeshFileAlignment - 1) / MeshFileAlignment * MeshFileAlignment;
+}
+
+std::string GetMeshCachePath(const std::string& Name, uint64_t Key) {
+	return "cache/" + Name + "_" + HashToString(Key) + ".bmesh";
+}
+
+bool OpenMeshFile(const std::string& Path, uint64_t Key, MappedFile& File, MeshFileView& OutView) {
+	if (!File.OpenRead(Path)) {
+		return false;
+	}
+
+	if (File.GetSize() < sizeof(MeshFileHeader)) {
+		File.Close();
+		return false;
+	}
+
+	//o mapeamento é só leitura, o const_cast só existe para o View servir também na escrita
+	uint8_t* Data = const_cast<uint8_t*>(File.GetData());
+	MeshFileHeader* Header = reinterpret_cast<MeshFileHeader*>(Data);
+
+	const bool bValid = std::memcmp(Header->Magic, MeshFileMagic, sizeof(MeshFileMagic)) == 0
+		&& Header->Version == MeshFileVersion
+		&& Header->Key == Key
+		&& Header->Layout.NumAttributes <= MaxVertexAttributes
+		&& Header->VertexBytes == Header->NumVertices * Header->Layout.Stride
+		&& Header->IndexBytes == Header->NumIndices * GetIndexSize(Header->IndexType)
+		&& Header->VertexOffset + Header->VertexBytes <= File.GetSize()
+		&& Header->IndexOffset + Header->IndexBytes <= File.GetSize();
+
+	if (!bValid) {
+		File.Close();
+		return false;
+	}
+
+	OutView.Header = Header;
+	OutView.Vertices = Data + Header->VertexOffset;
+	OutView.Indices = Data + Header->IndexOffset;
+	return true;
+}
+
+bool CreateMeshFile(const std::string& Path, uint64_t Key, const VertexLayout& Layout, uint32_t IndexType, uint64_t NumVertices, uint64_t NumIndices, MappedFile& File, MeshFileView& OutView) {
+	std::error_code Error;
+	std::filesystem::create_directories(std::filesystem::path(Path).parent_path(), Error);
+
+	const uint64_t VertexOffset = AlignUp(sizeof(MeshFileHeader));
+	const uint64_t VertexBytes = NumVertices * Layout.Stride;
+	const uint64_t IndexOffset = AlignUp(VertexOffset + VertexBytes);
+	const uint64_t IndexBytes = NumIndices * GetIndexSize(IndexType);
+
+	if (!File.CreateWrite(Path + ".tmp", static_cast<size_t>(IndexOffset + IndexBytes))) {
+		return false;
+	}
+
+	uint8_t* Data = File.GetMutableData();
+	MeshFileHeader* Header = new (Data) MeshFileHeader{};
+	std::memcpy(Header->Magic, MeshFileMagic, sizeof(MeshFileMagic));
+	Header->Version = MeshFileVersion;
+	Header->Key = Key;
+	Header->Layout = Layout;
+	Header->IndexType = IndexType;
+	Header->NumVertices = NumVertices;
+	Header->NumIndices = NumIndices;
+	Header->VertexOffset = VertexOffset;
+	Header->VertexBytes = VertexBytes;
+	Header->IndexOffset = IndexOffset;
+	Header->IndexBytes = IndexBytes;
+
+	OutView.Header = Header;
+	OutView.Vertices = Data + VertexOffset;
+	OutView.Indices = Data + IndexOffset;
+	return true;
+}
+
+bool CommitMeshFile(const std::string& Path, MappedFile& File) {
+	if (!File.IsOpen()) {
+		return false;
+	}
+	File.Close();
+
+	std::error_code Error;
+	std::filesystem::rename(Path + ".tmp", Path, Error);
+	return !Error;
+}
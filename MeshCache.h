@@ -0,0 +1,51 @@
+#pragma once
+
+#include<cstddef>
+#include<cstdint>
+#include<string>
+
+#include "MappedFile.h"
+#include "VertexLayout.h"
+
+//formato binário de malha: cabeçalho fixo seguido dos blocos de vértices e índices,
+//alinhados para que o arquivo mapeado possa ser enviado direto para o glBufferData.
+//mudar o layout do cabeçalho exige incrementar MeshFileVersion.
+constexpr uint32_t MeshFileVersion = 1;
+constexpr size_t MeshFileAlignment = 64;
+
+struct MeshFileHeader {
+	char Magic[4];           //"BMSH"
+	uint32_t Version;
+	uint64_t Key;            //hash dos parâmetros do gerador
+	VertexLayout Layout;
+	uint32_t IndexType;      //GL_UNSIGNED_INT ou GL_UNSIGNED_SHORT
+	uint32_t Reserved;
+	uint64_t NumVertices;
+	uint64_t NumIndices;
+	uint64_t VertexOffset;
+	uint64_t VertexBytes;
+	uint64_t IndexOffset;
+	uint64_t IndexBytes;
+	float BoundsMin[3];
+	float BoundsMax[3];
+};
+
+//ponteiros para dentro de um arquivo de malha mapeado
+struct MeshFileView {
+	MeshFileHeader* Header = nullptr;
+	uint8_t* Vertices = nullptr;
+	uint8_t* Indices = nullptr;
+};
+
+//caminho do arquivo de cache para um nome de malha e chave
+std::string GetMeshCachePath(const std::string& Name, uint64_t Key);
+
+//mapeia um arquivo de malha e valida versão, chave e tamanhos. O View aponta para a memória mapeada
+//(somente leitura) enquanto File estiver aberto.
+bool OpenMeshFile(const std::string& Path, uint64_t Key, MappedFile& File, MeshFileView& OutView);
+
+//cria o arquivo temporário Path + ".tmp" já no tamanho final e devolve onde escrever vértices e índices
+bool CreateMeshFile(const std::string& Path, uint64_t Key, const VertexLayout& Layout, uint32_t IndexType, uint64_t NumVertices, uint64_t NumIndices, MappedFile& File, MeshFileView& OutView);
+
+//grava o arquivo temporário em disco e troca pelo definitivo, uma inicialização interrompida nunca deixa um cache pela metade
+bool CommitMeshFile(const std::string& Path, MappedFile& File);
@@ -0,0 +1,168 @@
+#include "MeshOptimize.h"
+
+#include<cassert>
+#include<cstring>
+#include<vector>
+
+VertexCacheStats AnalyzeVertexCache(const uint32_t* Indices, size_t NumIndices, size_t NumVertices, uint32_t CacheSize) {
+	VertexCacheStats Stats;
+	if (NumIndices == 0 || NumVertices == 0) {
+		return Stats;
+	}
+
+	//momento em que cada vértice entrou no FIFO, ele continua lá enquanto Misses - Entrada < CacheSize
+	std::vector<size_t> EntryTime(NumVertices, 0);
+	std::vector<bool> bReferenced(NumVertices, false);
+	size_t Misses = 0;
+	size_t NumReferenced = 0;
+
+	for (size_t Index = 0; Index < NumIndices; ++Index) {
+		const uint32_t VertexIndex = Indices[Index];
+		assert(VertexIndex < NumVertices);
+
+		if (!bReferenced[VertexIndex]) {
+			bReferenced[VertexIndex] = true;
+			++NumReferenced;
+		}
+		else if (Misses - EntryTime[VertexIndex] < CacheSize) {
+			continue;
+		}
+
+		EntryTime[VertexIndex] = Misses;
+		++Misses;
+	}
+
+	Stats.ACMR = static_cast<float>(Misses) / static_cast<float>(NumIndices / 3);
+	Stats.ATVR = static_cast<float>(Misses) / static_cast<float>(NumReferenced);
+	return Stats;
+}
+
+void OptimizeVertexCache(uint32_t* Indices, size_t NumIndices, size_t NumVertices, uint32_t CacheSize) {
+	const size_t NumTriangles = NumIndices / 3;
+	if (NumTriangles == 0) {
+		return;
+	}
+
+	//adjacência vértice -> triângulos em formato compacto (offsets + lista)
+	std::vector<uint32_t> LiveTriangles(NumVertices, 0);
+	for (size_t Index = 0; Index < NumIndices; ++Index) {
+		++LiveTriangles[Indices[Index]];
+	}
+
+	std::vector<uint32_t> AdjacencyOffsets(NumVertices + 1, 0);
+	for (size_t VertexIndex = 0; VertexIndex < NumVertices; ++VertexIndex) {
+		AdjacencyOffsets[VertexIndex + 1] = AdjacencyOffsets[VertexIndex] + LiveTriangles[VertexIndex];
+	}
+
+	std::vector<uint32_t> Adjacency(NumIndices);
+	std::vector<uint32_t> Fill(AdjacencyOffsets.begin(), AdjacencyOffsets.end() - 1);
+	for (size_t Index = 0; Index < NumIndices; ++Index) {
+		Adjacency[Fill[Indices[Index]]++] = static_cast<uint32_t>(Index / 3);
+	}
+
+	std::vector<uint32_t> Output;
+	Output.reserve(NumIndices);
+
+	std::vector<bool> bEmitted(NumTriangles, false);
+	std::vector<size_t> CacheTime(NumVertices, 0);
+	std::vector<uint32_t> DeadEnds;
+	std::vector<uint32_t> Candidates;
+
+	//o relógio começa acima do tamanho do cache para que nenhum vértice pareça estar nele
+	size_t Time = CacheSize + 1;
+	size_t Cursor = 0;
+	int64_t Fanning = 0;
+
+	while (Fanning >= 0) {
+		Candidates.clear();
+
+		//emite todos os triângulos ainda vivos em volta do vértice atual
+		for (uint32_t Slot = AdjacencyOffsets[Fanning]; Slot < AdjacencyOffsets[Fanning + 1]; ++Slot) {
+			const uint32_t Triangle = Adjacency[Slot];
+			if (bEmitted[Triangle]) {
+				continue;
+			}
+			bEmitted[Triangle] = true;
+
+			for (int Corner = 0; Corner < 3; ++Corner) {
+				const uint32_t VertexIndex = Indices[Triangle * 3 + Corner];
+				Output.push_back(VertexIndex);
+				DeadEnds.push_back(VertexIndex);
+				Candidates.push_back(VertexIndex);
+				--LiveTriangles[VertexIndex];
+
+				if (Time - CacheTime[VertexIndex] > CacheSize) {
+					CacheTime[VertexIndex] = Time++;
+				}
+			}
+		}
+
+		//próximo vértice: o candidato que continua no cache depois de emitir seus triângulos e está há mais tempo nele
+		int64_t Best = -1;
+		size_t BestPriority = 0;
+		for (uint32_t VertexIndex : Candidates) {
+			if (LiveTriangles[VertexIndex] == 0) {
+				continue;
+			}
+
+			size_t Priority = 0;
+			if (Time - CacheTime[VertexIndex] + 2 * LiveTriangles[VertexIndex] <= CacheSize) {
+				Priority = Time - CacheTime[VertexIndex];
+			}
+			if (Best < 0 || Priority > BestPriority) {
+				Best = VertexIndex;
+				BestPriority = Priority;
+			}
+		}
+
+		//beco sem saída: volta para vértices emitidos recentemente e, em último caso, percorre em ordem
+		while (Best < 0 && !DeadEnds.empty()) {
+			const uint32_t VertexIndex = DeadEnds.back();
+			DeadEnds.pop_back();
+			if (LiveTriangles[VertexIndex] > 0) {
+				Best = VertexIndex;
+			}
+		}
+		while (Best < 0 && Cursor < NumVertices) {
+			if (LiveTriangles[Cursor] > 0) {
+				Best = static_cast<int64_t>(Cursor);
+			}
+			++Cursor;
+		}
+
+		Fanning = Best;
+	}
+
+	assert(Output.size() == NumTriangles * 3);
+	std::memcpy(Indices, Output.data(), Output.size() * sizeof(uint32_t));
+}
+
+size_t OptimizeVertexFetch(void* Vertices, size_t NumVertices, size_t Stride, uint32_t* Indices, size_t NumIndices) {
+	constexpr uint32_t Unused = ~0u;
+	std::vector<uint32_t> Remap(NumVertices, Unused);
+
+	uint32_t NextVertex = 0;
+	for (size_t Index = 0; Index < NumIndices; ++Index) {
+		uint32_t& NewIndex = Remap[Indices[Index]];
+		if (NewIndex == Unused) {
+			NewIndex = NextVertex++;
+		}
+		Indices[Index] = NewIndex;
+	}
+
+	const size_t NumUsed = NextVertex;
+	for (uint32_t& NewIndex : Remap) {
+		if (NewIndex == Unused) {
+			NewIndex = NextVertex++;
+		}
+	}
+
+	const uint8_t* Source = static_cast<const uint8_t*>(Vertices);
+	std::vector<uint8_t> Reordered(NumVertices * Stride);
+	for (size_t VertexIndex = 0; VertexIndex < NumVertices; ++VertexIndex) {
+		std::memcpy(Reordered.data() + Remap[VertexIndex] * Stride, Source + VertexIndex * Stride, Stride);
+	}
+	std::memcpy(Vertices, Reordered.data(), Reordered.size());
+
+	return NumUsed;
+}
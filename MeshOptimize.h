@@ -0,0 +1,23 @@
+#pragma once
+
+#include<cstddef>
+#include<cstdint>
+
+//tamanho do cache pós-transformação simulado, um FIFO pequeno como o das GPUs atuais
+constexpr uint32_t DefaultVertexCacheSize = 16;
+
+struct VertexCacheStats {
+	float ACMR = 0.0f; //vértices transformados por triângulo (ideal perto de 0.5 numa grade)
+	float ATVR = 0.0f; //vértices transformados por vértice único da malha (ideal 1.0)
+};
+
+//simula um cache FIFO de CacheSize vértices sobre a lista de triângulos
+VertexCacheStats AnalyzeVertexCache(const uint32_t* Indices, size_t NumIndices, size_t NumVertices, uint32_t CacheSize = DefaultVertexCacheSize);
+
+//reordena os triângulos no lugar com o Tipsify (Sander, Nehab e Barczak 2007), tempo linear.
+//a imagem não muda, só a ordem em que os triângulos chegam na GPU.
+void OptimizeVertexCache(uint32_t* Indices, size_t NumIndices, size_t NumVertices, uint32_t CacheSize = DefaultVertexCacheSize);
+
+//reordena os vértices na ordem do primeiro uso pelos índices e corrige os índices.
+//vértices não referenciados vão para o fim, retorna quantos são usados.
+size_t OptimizeVertexFetch(void* Vertices, size_t NumVertices, size_t Stride, uint32_t* Indices, size_t NumIndices);
@@ -0,0 +1,214 @@
+#include "Meshlet.h"
+
+#include<cassert>
+#include<cstring>
+
+#include "Frustum.h"
+#include "Profiler.h"
+#include "VertexPacking.h"
+
+//triângulos com normal mais afastada que isso da normal do primeiro triângulo começam outro meshlet,
+//assim o cone não abre demais quando o Tipsify pula de um lugar para outro da malha
+constexpr float MeshletNormalLimit = 0.7f;
+
+//o cone só é usado quando todas as normais estão a menos de ~84 graus do eixo
+constexpr float MinConeDot = 0.1f;
+
+static glm::vec3 ReadPosition(const VertexLayout& Layout, const uint8_t* Vertices, size_t VertexIndex) {
+	const VertexAttribute* Position = nullptr;
+	for (uint32_t Index = 0; Index < Layout.NumAttributes; ++Index) {
+		if (Layout.Attributes[Index].Location == 0) {
+			Position = &Layout.Attributes[Index];
+		}
+	}
+	assert(Position && Position->Components >= 3);
+
+	const uint8_t* Data = Vertices + VertexIndex * Layout.Stride + Position->Offset;
+	if (Position->Type == GL_SHORT) {
+		int16_t Packed[3];
+		std::memcpy(Packed, Data, sizeof(Packed));
+		return glm::vec3{ Packed[0], Packed[1], Packed[2] } / 32767.0f;
+	}
+
+	assert(Position->Type == GL_FLOAT);
+	glm::vec3 Result;
+	std::memcpy(&Result, Data, sizeof(Result));
+	return Result;
+}
+
+static void FinishMeshlet(Meshlet& Current, const std::vector<glm::vec3>& Positions, const std::vector<uint32_t>& Indices) {
+	const uint32_t End = Current.FirstIndex + Current.NumIndices;
+
+	//esfera envolvente: centro da caixa e maior distância até ele
+	glm::vec3 Min{ Positions[Indices[Current.FirstIndex]] };
+	glm::vec3 Max{ Min };
+	for (uint32_t Index = Current.FirstIndex; Index < End; ++Index) {
+		Min = glm::min(Min, Positions[Indices[Index]]);
+		Max = glm::max(Max, Positions[Indices[Index]]);
+	}
+	Current.Center = (Min + Max) * 0.5f;
+	for (uint32_t Index = Current.FirstIndex; Index < End; ++Index) {
+		Current.Radius = glm::max(Current.Radius, glm::length(Positions[Indices[Index]] - Current.Center));
+	}
+
+	//cone das normais: eixo na média das normais e abertura até a mais afastada. Triângulos degenerados (polos) não contam
+	glm::vec3 NormalSum{ 0.0f };
+	std::vector<glm::vec3> Normals;
+	Normals.reserve(Current.NumIndices / 3);
+	for (uint32_t Index = Current.FirstIndex; Index < End; Index += 3) {
+		const glm::vec3& P0 = Positions[Indices[Index + 0]];
+		const glm::vec3 Normal = glm::cross(Positions[Indices[Index + 1]] - P0, Positions[Indices[Index + 2]] - P0);
+		const float Length = glm::length(Normal);
+		if (Length > 1e-12f) {
+			Normals.push_back(Normal / Length);
+			NormalSum += Normals.back();
+		}
+	}
+
+	const float SumLength = glm::length(NormalSum);
+	if (Normals.empty() || SumLength < 1e-6f) {
+		return;
+	}
+
+	Current.ConeAxis = NormalSum / SumLength;
+	float MinDot = 1.0f;
+	for (const glm::vec3& Normal : Normals) {
+		MinDot = glm::min(MinDot, glm::dot(Normal, Current.ConeAxis));
+	}
+	if (MinDot >= MinConeDot) {
+		Current.ConeCutoff = glm::sqrt(1.0f - MinDot * MinDot);
+	}
+}
+
+std::vector<Meshlet> BuildMeshlets(const VertexLayout& Layout, const void* Vertices, size_t NumVertices, uint32_t IndexType, const void* Indices, size_t NumIndices) {
+	std::vector<glm::vec3> Positions(NumVertices);
+	for (size_t VertexIndex = 0; VertexIndex < NumVertices; ++VertexIndex) {
+		Positions[VertexIndex] = ReadPosition(Layout, static_cast<const uint8_t*>(Vertices), VertexIndex);
+	}
+
+	std::vector<uint32_t> WideIndices(NumIndices);
+	for (size_t Index = 0; Index < NumIndices; ++Index) {
+		WideIndices[Index] = IndexType == GL_UNSIGNED_SHORT ? static_cast<const uint16_t*>(Indices)[Index] : static_cast<const uint32_t*>(Indices)[Index];
+	}
+
+	std::vector<Meshlet> Meshlets;
+
+	//marca os vértices já usados pelo meshlet atual com o número dele + 1
+	std::vector<uint32_t> VertexStamp(NumVertices, 0);
+	Meshlet Current;
+	glm::vec3 FirstNormal{ 0.0f };
+	bool bHasFirstNormal = false;
+
+	for (size_t Index = 0; Index + 2 < NumIndices; Index += 3) {
+		const uint32_t* Triangle = &WideIndices[Index];
+
+		const glm::vec3& P0 = Positions[Triangle[0]];
+		glm::vec3 Normal = glm::cross(Positions[Triangle[1]] - P0, Positions[Triangle[2]] - P0);
+		const float NormalLength = glm::length(Normal);
+		const bool bDegenerate = NormalLength <= 1e-12f;
+		if (!bDegenerate) {
+			Normal /= NormalLength;
+		}
+
+		if (Current.NumIndices > 0) {
+			const uint32_t Stamp = static_cast<uint32_t>(Meshlets.size() + 1);
+			uint32_t NewVertices = 0;
+			for (int Corner = 0; Corner < 3; ++Corner) {
+				NewVertices += VertexStamp[Triangle[Corner]] != Stamp ? 1 : 0;
+			}
+
+			const bool bFull = Current.NumIndices / 3 >= MeshletMaxTriangles || Current.NumVertices + NewVertices > MeshletMaxVertices;
+			const bool bDiverges = bHasFirstNormal && !bDegenerate && glm::dot(Normal, FirstNormal) < MeshletNormalLimit;
+			if (bFull || bDiverges) {
+				FinishMeshlet(Current, Positions, WideIndices);
+				Meshlets.push_back(Current);
+				Current = Meshlet{};
+				bHasFirstNormal = false;
+			}
+		}
+
+		if (Current.NumIndices == 0) {
+			Current.FirstIndex = static_cast<uint32_t>(Index);
+		}
+		if (!bHasFirstNormal && !bDegenerate) {
+			FirstNormal = Normal;
+			bHasFirstNormal = true;
+		}
+
+		const uint32_t Stamp = static_cast<uint32_t>(Meshlets.size() + 1);
+		for (int Corner = 0; Corner < 3; ++Corner) {
+			if (VertexStamp[Triangle[Corner]] != Stamp) {
+				VertexStamp[Triangle[Corner]] = Stamp;
+				++Current.NumVertices;
+			}
+		}
+		Current.NumIndices += 3;
+	}
+
+	if (Current.NumIndices > 0) {
+		FinishMeshlet(Current, Positions, WideIndices);
+		Meshlets.push_back(Current);
+	}
+
+	return Meshlets;
+}
+
+void MeshletDrawList::Cull(const std::vector<Meshlet>& Meshlets, const glm::mat4& ModelViewProjection, const glm::vec3& CameraPosition, uint32_t NewIndexType) {
+	PROFILE_SCOPE("MeshletDrawList::Cull");
+	IndexType = NewIndexType;
+	const size_t IndexSize = GetIndexSize(IndexType);
+
+	Counts.clear();
+	Offsets.clear();
+	Stats = MeshletCullStats{};
+	Stats.NumMeshlets = Meshlets.size();
+
+	glm::vec4 FrustumPlanes[6];
+	ExtractFrustumPlanes(ModelViewProjection, FrustumPlanes);
+
+	//fim da última faixa enviada, meshlets visíveis em sequência viram um único desenho
+	uint32_t RangeEnd = ~0u;
+
+	for (const Meshlet& Current : Meshlets) {
+		bool bCulled = false;
+
+		if (IsSphereOutsideFrustum(FrustumPlanes, Current.Center, Current.Radius)) {
+			++Stats.FrustumCulled;
+			bCulled = true;
+		}
+		else {
+			//todas as normais do cone apontam para longe da câmera em toda a esfera do meshlet
+			const glm::vec3 ToCenter = Current.Center - CameraPosition;
+			if (glm::dot(ToCenter, Current.ConeAxis) >= Current.ConeCutoff * glm::length(ToCenter) + Current.Radius) {
+				++Stats.BackfaceCulled;
+				bCulled = true;
+			}
+		}
+
+		if (bCulled) {
+			Stats.TrianglesSkipped += Current.NumIndices / 3;
+			Stats.VerticesSkipped += Current.NumVertices;
+			continue;
+		}
+
+		Stats.NumTriangles += Current.NumIndices / 3;
+		if (Current.FirstIndex == RangeEnd) {
+			Counts.back() += static_cast<GLsizei>(Current.NumIndices);
+		}
+		else {
+			Counts.push_back(static_cast<GLsizei>(Current.NumIndices));
+			Offsets.push_back(reinterpret_cast<const void*>(static_cast<uintptr_t>(Current.FirstIndex * IndexSize)));
+		}
+		RangeEnd = Current.FirstIndex + Current.NumIndices;
+	}
+
+	Stats.NumDraws = Counts.size();
+}
+
+void MeshletDrawList::Draw() const {
+	if (Counts.empty()) {
+		return;
+	}
+
+	glMultiDrawElements(GL_TRIANGLES, Counts.data(), IndexType, Offsets.data(), static_cast<GLsizei>(Counts.size()));
+}
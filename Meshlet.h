@@ -0,0 +1,58 @@
+#pragma once
+
+#include<cstddef>
+#include<cstdint>
+#include<vector>
+
+#include<GL/glew.h>
+#include<glm/glm.hpp>
+
+#include "VertexLayout.h"
+
+//limites de um meshlet, os mesmos sugeridos para mesh shaders
+constexpr uint32_t MeshletMaxTriangles = 124;
+constexpr uint32_t MeshletMaxVertices = 64;
+
+//faixa contígua do index buffer com esfera envolvente e cone das normais para descartar na CPU
+struct Meshlet {
+	uint32_t FirstIndex = 0;
+	uint32_t NumIndices = 0;
+	uint32_t NumVertices = 0;  //vértices únicos, trabalho do vertex shader evitado quando é descartado
+	glm::vec3 Center{ 0.0f };
+	float Radius = 0.0f;
+	glm::vec3 ConeAxis{ 0.0f, 0.0f, 1.0f };
+	float ConeCutoff = 1.0f;   //seno da abertura do cone, 1 quando o cone é largo demais para descartar
+};
+
+struct MeshletCullStats {
+	size_t NumMeshlets = 0;
+	size_t FrustumCulled = 0;
+	size_t BackfaceCulled = 0;
+	size_t NumDraws = 0;          //faixas enviadas ao glMultiDrawElements depois de juntar meshlets vizinhos
+	size_t NumTriangles = 0;      //triângulos enviados
+	size_t TrianglesSkipped = 0;
+	size_t VerticesSkipped = 0;
+};
+
+//divide os triângulos em meshlets sem mudar a ordem do index buffer, que já deve estar otimizada para o
+//cache de vértices. Lê a posição (location 0) no formato do layout, então serve para os vértices em memória
+//e para um arquivo de cache mapeado.
+std::vector<Meshlet> BuildMeshlets(const VertexLayout& Layout, const void* Vertices, size_t NumVertices, uint32_t IndexType, const void* Indices, size_t NumIndices);
+
+//escolhe por frame os meshlets visíveis e desenha só eles
+class MeshletDrawList {
+public:
+	//CameraPosition no mesmo espaço dos vértices (espaço do modelo)
+	void Cull(const std::vector<Meshlet>& Meshlets, const glm::mat4& ModelViewProjection, const glm::vec3& CameraPosition, uint32_t NewIndexType);
+
+	//desenha o resultado do último Cull com o VAO ativo
+	void Draw() const;
+
+	const MeshletCullStats& GetStats() const { return Stats; }
+
+private:
+	std::vector<GLsizei> Counts;
+	std::vector<const void*> Offsets;
+	GLenum IndexType = GL_UNSIGNED_INT;
+	MeshletCullStats Stats;
+};
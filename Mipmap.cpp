@@ -0,0 +1,312 @@
+#include "Mipmap.h"
+
+#include<algorithm>
+#include<cassert>
+#include<cmath>
+#include<cstring>
+#include<vector>
+
+#include "FastMath.h"
+#include "ThreadPool.h"
+
+//linhas de saída por tarefa do ParallelFor, cada tarefa converte e filtra na horizontal as linhas de origem que usa
+constexpr size_t MipRowsPerTask = 16;
+
+//maior raio do filtro em pixels da imagem de origem
+constexpr int MaxKernelRadius = 6;
+
+//pesos de uma redução 2:1. Como a fase é sempre a mesma, os pesos valem para todo pixel de saída:
+//a amostra K fica em 2 * X - Radius + 1 + K.
+struct MipKernel {
+	int Radius = 1;
+	float Weights[2 * MaxKernelRadius] = {};
+};
+
+//tabelas de conversão: 8 bits para linear e linear (16 bits) para sRGB de 8 bits
+struct MipColorTables {
+	float SRGBToLinear[256];
+	float UnormToFloat[256];
+	uint8_t LinearToSRGB[65536];
+};
+
+static float Sinc(float X) {
+	if (std::abs(X) < 1e-6f) {
+		return 1.0f;
+	}
+	X *= 3.14159265358979f;
+	return std::sin(X) / X;
+}
+
+//função de Bessel modificada de ordem zero, série de potências
+static float BesselI0(float X) {
+	float Sum = 1.0f, Term = 1.0f;
+	for (int K = 1; K < 32; ++K) {
+		const float Factor = X / (2.0f * K);
+		Term *= Factor * Factor;
+		Sum += Term;
+	}
+	return Sum;
+}
+
+static MipKernel BuildKernel(MipFilter Filter) {
+	MipKernel Kernel;
+	Kernel.Radius = Filter == MipFilter::Box ? 1 : MaxKernelRadius;
+
+	float Sum = 0.0f;
+	for (int K = 0; K < 2 * Kernel.Radius; ++K) {
+		//distância até o centro do pixel de saída, em pixels da imagem reduzida
+		const float T = (K - Kernel.Radius + 0.5f) * 0.5f;
+
+		float Weight = 1.0f;
+		if (Filter == MipFilter::Lanczos) {
+			Weight = Sinc(T) * Sinc(T / 3.0f);
+		}
+		else if (Filter == MipFilter::Kaiser) {
+			const float Window = T / 3.0f;
+			Weight = Sinc(T) * BesselI0(4.0f * std::sqrt(std::max(0.0f, 1.0f - Window * Window))) / BesselI0(4.0f);
+		}
+
+		Kernel.Weights[K] = Weight;
+		Sum += Weight;
+	}
+
+	for (int K = 0; K < 2 * Kernel.Radius; ++K) {
+		Kernel.Weights[K] /= Sum;
+	}
+	return Kernel;
+}
+
+static const MipKernel& GetKernel(MipFilter Filter) {
+	static const MipKernel Kernels[] = { BuildKernel(MipFilter::Box), BuildKernel(MipFilter::Kaiser), BuildKernel(MipFilter::Lanczos) };
+	return Kernels[static_cast<int>(Filter)];
+}
+
+static float SRGBToLinear(float Value) {
+	return Value <= 0.04045f ? Value / 12.92f : std::pow((Value + 0.055f) / 1.055f, 2.4f);
+}
+
+static float LinearToSRGB(float Value) {
+	return Value <= 0.0031308f ? Value * 12.92f : 1.055f * std::pow(Value, 1.0f / 2.4f) - 0.055f;
+}
+
+static MipColorTables BuildColorTables() {
+	MipColorTables Tables;
+	for (int Index = 0; Index < 256; ++Index) {
+		Tables.SRGBToLinear[Index] = SRGBToLinear(Index / 255.0f);
+		Tables.UnormToFloat[Index] = Index / 255.0f;
+	}
+	for (int Index = 0; Index < 65536; ++Index) {
+		Tables.LinearToSRGB[Index] = static_cast<uint8_t>(LinearToSRGB(Index / 65535.0f) * 255.0f + 0.5f);
+	}
+	return Tables;
+}
+
+static const MipColorTables& GetColorTables() {
+	static const MipColorTables Tables = BuildColorTables();
+	return Tables;
+}
+
+const char* ToString(MipFilter Filter) {
+	switch (Filter) {
+	case MipFilter::Box: return "box";
+	case MipFilter::Lanczos: return "lanczos";
+	default: return "kaiser";
+	}
+}
+
+bool ParseMipFilter(const char* Text, MipFilter& OutFilter) {
+	const MipFilter Filters[] = { MipFilter::Box, MipFilter::Kaiser, MipFilter::Lanczos };
+	for (MipFilter Filter : Filters) {
+		if (std::strcmp(Text, ToString(Filter)) == 0) {
+			OutFilter = Filter;
+			return true;
+		}
+	}
+	return false;
+}
+
+uint32_t GetNumMipLevels(uint32_t Width, uint32_t Height) {
+	uint32_t NumLevels = 1;
+	while ((Width | Height) > 1) {
+		Width = std::max(1u, Width / 2);
+		Height = std::max(1u, Height / 2);
+		++NumLevels;
+	}
+	return NumLevels;
+}
+
+//converte uma linha para 4 floats por pixel (canais que faltam ficam em zero)
+static void ConvertRow(const uint8_t* Row, uint32_t Width, uint32_t Channels, bool bSRGB, float* OutRow) {
+	const MipColorTables& Tables = GetColorTables();
+	const float* ColorTable = bSRGB ? Tables.SRGBToLinear : Tables.UnormToFloat;
+	const float* ChannelTables[4] = { ColorTable, ColorTable, ColorTable, Tables.UnormToFloat };
+
+	std::fill(OutRow, OutRow + static_cast<size_t>(Width) * 4, 0.0f);
+	for (uint32_t X = 0; X < Width; ++X) {
+		for (uint32_t Channel = 0; Channel < Channels; ++Channel) {
+			OutRow[X * 4 + Channel] = ChannelTables[Channel][Row[X * Channels + Channel]];
+		}
+	}
+}
+
+//coluna de origem de uma amostra que pode cair fora da imagem
+static int GetSourceColumn(int X, int Width, MipAddress Address) {
+	if (Address == MipAddress::Repeat) {
+		X %= Width;
+		return X < 0 ? X + Width : X;
+	}
+	return std::clamp(X, 0, Width - 1);
+}
+
+//filtro horizontal: Width pixels de origem para OutWidth pixels, 4 floats por pixel
+static void FilterRow(const float* Row, uint32_t Width, const MipKernel& Kernel, MipAddress Address, float* OutRow, uint32_t OutWidth, bool bSIMD) {
+	const int Taps = 2 * Kernel.Radius;
+
+	uint32_t X = 0;
+#if BLUEMARBLE_SSE2
+	if (bSIMD) {
+		__m128 Weights[2 * MaxKernelRadius];
+		for (int K = 0; K < Taps; ++K) {
+			Weights[K] = _mm_set1_ps(Kernel.Weights[K]);
+		}
+
+		for (; X < OutWidth; ++X) {
+			const int First = static_cast<int>(X) * 2 - Kernel.Radius + 1;
+			__m128 Sum = _mm_setzero_ps();
+			//só os pixels perto das bordas precisam de endereçamento
+			if (First >= 0 && First + Taps <= static_cast<int>(Width)) {
+				const float* Source = Row + First * 4;
+				for (int K = 0; K < Taps; ++K) {
+					Sum = _mm_add_ps(Sum, _mm_mul_ps(Weights[K], _mm_loadu_ps(Source + K * 4)));
+				}
+			}
+			else {
+				for (int K = 0; K < Taps; ++K) {
+					Sum = _mm_add_ps(Sum, _mm_mul_ps(Weights[K], _mm_loadu_ps(Row + GetSourceColumn(First + K, static_cast<int>(Width), Address) * 4)));
+				}
+			}
+			_mm_storeu_ps(OutRow + X * 4, Sum);
+		}
+	}
+#endif
+	for (; X < OutWidth; ++X) {
+		const int First = static_cast<int>(X) * 2 - Kernel.Radius + 1;
+		const bool bInside = First >= 0 && First + Taps <= static_cast<int>(Width);
+		float Sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		for (int K = 0; K < Taps; ++K) {
+			const float* Source = Row + (bInside ? First + K : GetSourceColumn(First + K, static_cast<int>(Width), Address)) * 4;
+			for (int Channel = 0; Channel < 4; ++Channel) {
+				Sum[Channel] += Kernel.Weights[K] * Source[Channel];
+			}
+		}
+		std::memcpy(OutRow + X * 4, Sum, sizeof(Sum));
+	}
+}
+
+//filtro vertical: combina as linhas já filtradas na horizontal, Count floats por linha
+static void FilterColumns(const float* const* Rows, const MipKernel& Kernel, size_t Count, float* OutRow, bool bSIMD) {
+	const int Taps = 2 * Kernel.Radius;
+	size_t Index = 0;
+
+#if BLUEMARBLE_SSE2
+	if (bSIMD) {
+		__m128 Weights[2 * MaxKernelRadius];
+		for (int K = 0; K < Taps; ++K) {
+			Weights[K] = _mm_set1_ps(Kernel.Weights[K]);
+		}
+
+		for (; Index + 4 <= Count; Index += 4) {
+			__m128 Sum = _mm_setzero_ps();
+			for (int K = 0; K < Taps; ++K) {
+				Sum = _mm_add_ps(Sum, _mm_mul_ps(Weights[K], _mm_loadu_ps(Rows[K] + Index)));
+			}
+			_mm_storeu_ps(OutRow + Index, Sum);
+		}
+	}
+#endif
+	for (; Index < Count; ++Index) {
+		float Sum = 0.0f;
+		for (int K = 0; K < Taps; ++K) {
+			Sum += Kernel.Weights[K] * Rows[K][Index];
+		}
+		OutRow[Index] = Sum;
+	}
+}
+
+//volta para 8 bits. Kaiser e Lanczos têm lobos negativos, então o resultado é limitado a [0, 1].
+static void EncodeRow(const float* Row, uint32_t Width, uint32_t Channels, bool bSRGB, uint8_t* OutRow, bool bSIMD) {
+	const MipColorTables& Tables = GetColorTables();
+
+	for (uint32_t X = 0; X < Width; ++X) {
+		//índice de 16 bits da tabela sRGB e valor de 8 bits direto, cada canal usa um dos dois
+		int32_t Index16[4], Value8[4];
+#if BLUEMARBLE_SSE2
+		if (bSIMD) {
+			const __m128 Value = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(Row + X * 4), _mm_setzero_ps()), _mm_set1_ps(1.0f));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(Index16), _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(Value, _mm_set1_ps(65535.0f)), _mm_set1_ps(0.5f))));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(Value8), _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(Value, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f))));
+		}
+		else
+#endif
+		{
+			for (int Channel = 0; Channel < 4; ++Channel) {
+				const float Value = std::min(std::max(Row[X * 4 + Channel], 0.0f), 1.0f);
+				Index16[Channel] = static_cast<int32_t>(Value * 65535.0f + 0.5f);
+				Value8[Channel] = static_cast<int32_t>(Value * 255.0f + 0.5f);
+			}
+		}
+
+		for (uint32_t Channel = 0; Channel < Channels; ++Channel) {
+			OutRow[X * Channels + Channel] = bSRGB && Channel < 3 ? Tables.LinearToSRGB[Index16[Channel]] : static_cast<uint8_t>(Value8[Channel]);
+		}
+	}
+}
+
+void GetMipSourceRows(const MipmapSettings& Settings, uint32_t Height, uint32_t OutRowBegin, uint32_t OutRowEnd, uint32_t& OutFirstRow, uint32_t& OutEndRow) {
+	assert(OutRowBegin < OutRowEnd);
+	const int Radius = GetKernel(Settings.Filter).Radius;
+	const int First = static_cast<int>(OutRowBegin) * 2 - Radius + 1;
+	const int Last = static_cast<int>(OutRowEnd - 1) * 2 + Radius;
+	OutFirstRow = static_cast<uint32_t>(std::clamp(First, 0, static_cast<int>(Height) - 1));
+	OutEndRow = static_cast<uint32_t>(std::clamp(Last, 0, static_cast<int>(Height) - 1)) + 1;
+}
+
+void DownsampleMipLevel(const uint8_t* Pixels, uint32_t Width, uint32_t Height, uint32_t Channels, const MipmapSettings& Settings, uint8_t* OutPixels, bool bAllowSIMD) {
+	DownsampleMipRows(Pixels, 0, Width, Height, Channels, Settings, 0, std::max(1u, Height / 2), OutPixels, bAllowSIMD);
+}
+
+void DownsampleMipRows(const uint8_t* Rows, uint32_t FirstRow, uint32_t Width, uint32_t Height, uint32_t Channels, const MipmapSettings& Settings,
+	uint32_t OutRowBegin, uint32_t OutRowEnd, uint8_t* OutPixels, bool bAllowSIMD) {
+	assert(Channels >= 1 && Channels <= 4);
+
+	const uint32_t OutWidth = std::max(1u, Width / 2);
+	const MipKernel& Kernel = GetKernel(Settings.Filter);
+	const int Taps = 2 * Kernel.Radius;
+
+	ParallelFor(OutRowBegin, OutRowEnd, MipRowsPerTask, [&](size_t RowBegin, size_t RowEnd) {
+		//linhas de origem usadas pela faixa, as de fora da imagem repetem a borda
+		const int SourceBegin = static_cast<int>(RowBegin) * 2 - Kernel.Radius + 1;
+		const int SourceEnd = static_cast<int>(RowEnd - 1) * 2 - Kernel.Radius + 1 + Taps;
+		const size_t FilteredStride = static_cast<size_t>(OutWidth) * 4;
+
+		std::vector<float> Linear(static_cast<size_t>(Width) * 4);
+		std::vector<float> Filtered(static_cast<size_t>(SourceEnd - SourceBegin) * FilteredStride);
+		for (int SourceY = SourceBegin; SourceY < SourceEnd; ++SourceY) {
+			const int Y = std::clamp(SourceY, 0, static_cast<int>(Height) - 1);
+			assert(Y >= static_cast<int>(FirstRow));
+			ConvertRow(Rows + static_cast<size_t>(Y - FirstRow) * Width * Channels, Width, Channels, Settings.bSRGB, Linear.data());
+			FilterRow(Linear.data(), Width, Kernel, Settings.AddressX, &Filtered[(SourceY - SourceBegin) * FilteredStride], OutWidth, bAllowSIMD);
+		}
+
+		std::vector<float> OutRow(FilteredStride);
+		const float* FilteredRows[2 * MaxKernelRadius];
+		for (size_t Y = RowBegin; Y < RowEnd; ++Y) {
+			const int First = static_cast<int>(Y) * 2 - Kernel.Radius + 1;
+			for (int K = 0; K < Taps; ++K) {
+				FilteredRows[K] = &Filtered[(First + K - SourceBegin) * FilteredStride];
+			}
+			FilterColumns(FilteredRows, Kernel, FilteredStride, OutRow.data(), bAllowSIMD);
+			EncodeRow(OutRow.data(), OutWidth, Channels, Settings.bSRGB, OutPixels + (Y - OutRowBegin) * OutWidth * Channels, bAllowSIMD);
+		}
+	});
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+
+#include<cstddef>
+#include<cstdint>
+
+//filtros de redução dos mipmaps gerados na CPU
+enum class MipFilter {
+	Box,      //média 2x2, o que o glGenerateMipmap costuma fazer
+	Kaiser,   //sinc com janela de Kaiser (alfa 4), 12 amostras por eixo
+	Lanczos   //Lanczos de 3 lobos, 12 amostras por eixo
+};
+
+//como o filtro trata as colunas de fora da imagem; as linhas sempre repetem a borda (os polos)
+enum class MipAddress {
+	Clamp,
+	Repeat    //a coluna 0 vem depois da última, como a longitude das imagens equiretangulares
+};
+
+struct MipmapSettings {
+	MipFilter Filter = MipFilter::Kaiser;
+	bool bSRGB = true;  //filtra em espaço linear e converte de volta para sRGB. O quarto canal (alfa) é sempre linear.
+	MipAddress AddressX = MipAddress::Repeat;
+};
+
+const char* ToString(MipFilter Filter);
+bool ParseMipFilter(const char* Text, MipFilter& OutFilter);
+
+//levels até 1x1, incluindo o level 0
+uint32_t GetNumMipLevels(uint32_t Width, uint32_t Height);
+
+//reduz uma imagem de 8 bits por canal (1 a 4 canais) para max(1, Width / 2) x max(1, Height / 2).
+//as linhas de saída são divididas entre as threads do pool e os filtros usam SSE2 quando disponível;
+//bAllowSIMD = false força o caminho escalar (mesmo resultado), usado para comparação no benchmark.
+void DownsampleMipLevel(const uint8_t* Pixels, uint32_t Width, uint32_t Height, uint32_t Channels, const MipmapSettings& Settings, uint8_t* OutPixels, bool bAllowSIMD = true);
+
+//linhas de origem [OutFirstRow, OutEndRow) que as linhas de saída [OutRowBegin, OutRowEnd) usam, já limitadas à imagem
+void GetMipSourceRows(const MipmapSettings& Settings, uint32_t Height, uint32_t OutRowBegin, uint32_t OutRowEnd, uint32_t& OutFirstRow, uint32_t& OutEndRow);
+
+//mesma redução, só das linhas de saída [OutRowBegin, OutRowEnd), para imagens que não cabem na memória.
+//Rows tem as linhas de origem a partir de FirstRow, pelo menos as do GetMipSourceRows; OutPixels recebe só a faixa.
+void DownsampleMipRows(const uint8_t* Rows, uint32_t FirstRow, uint32_t Width, uint32_t Height, uint32_t Channels, const MipmapSettings& Settings,
+	uint32_t OutRowBegin, uint32_t OutRowEnd, uint8_t* OutPixels, bool bAllowSIMD = true);
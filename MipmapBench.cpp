@@ -0,0 +1,240 @@
+#include<iostream>
+#include<iomanip>
+#include<algorithm>
+#include<cassert>
+#include<chrono>
+#include<cstring>
+#include<string>
+#include<vector>
+
+#include<GL/glew.h>
+#include<GLFW/glfw3.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include "Mipmap.h"
+#include "ThreadPool.h"
+
+//compara a cadeia de mipmaps gerada na CPU (Mipmap.cpp) com o glGenerateMipmap do driver.
+//roda com uma janela invisível só para ter um contexto OpenGL.
+
+//tempo mínimo medido por caso, repete até atingir
+constexpr double MinSeconds = 0.5;
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchImage {
+	std::string Name;
+	uint32_t Width = 0;
+	uint32_t Height = 0;
+	std::vector<uint8_t> Pixels;  //RGB
+};
+
+template<typename Func>
+double MeasureSeconds(Func&& Body) {
+	int Iterations = 0;
+	const Clock::time_point Start = Clock::now();
+	double Elapsed = 0.0;
+	do {
+		Body();
+		++Iterations;
+		Elapsed = std::chrono::duration<double>(Clock::now() - Start).count();
+	} while (Elapsed < MinSeconds);
+
+	return Elapsed / Iterations;
+}
+
+bool LoadImage(const char* Path, BenchImage& OutImage) {
+	int Width = 0, Height = 0, NumberOfComponents = 0;
+	unsigned char* Pixels = stbi_load(Path, &Width, &Height, &NumberOfComponents, 3);
+	if (!Pixels) {
+		std::cerr << "Nao foi possivel carregar " << Path << ": " << stbi_failure_reason() << std::endl;
+		return false;
+	}
+
+	OutImage.Name = Path;
+	OutImage.Width = static_cast<uint32_t>(Width);
+	OutImage.Height = static_cast<uint32_t>(Height);
+	OutImage.Pixels.assign(Pixels, Pixels + static_cast<size_t>(Width) * Height * 3);
+	stbi_image_free(Pixels);
+	return true;
+}
+
+//não há uma textura de 16k no repositório: repete a de 2k em mosaico, o custo dos filtros não depende do conteúdo
+BenchImage MakeTiledImage(const BenchImage& Source, uint32_t Width, uint32_t Height) {
+	BenchImage Image;
+	Image.Name = Source.Name + " (mosaico " + std::to_string(Width) + "x" + std::to_string(Height) + ")";
+	Image.Width = Width;
+	Image.Height = Height;
+	Image.Pixels.resize(static_cast<size_t>(Width) * Height * 3);
+
+	for (uint32_t Y = 0; Y < Height; ++Y) {
+		const uint8_t* SourceRow = &Source.Pixels[static_cast<size_t>(Y % Source.Height) * Source.Width * 3];
+		uint8_t* Row = &Image.Pixels[static_cast<size_t>(Y) * Width * 3];
+		for (uint32_t X = 0; X < Width; X += Source.Width) {
+			const uint32_t Count = std::min(Source.Width, Width - X);
+			std::memcpy(Row + static_cast<size_t>(X) * 3, SourceRow, static_cast<size_t>(Count) * 3);
+		}
+	}
+	return Image;
+}
+
+//gera todos os levels a partir do level 0, cada um reduzido do anterior
+void GenerateChain(const BenchImage& Image, const MipmapSettings& Settings, bool bAllowSIMD, std::vector<std::vector<uint8_t>>& Levels) {
+	const uint32_t NumLevels = GetNumMipLevels(Image.Width, Image.Height);
+	Levels.resize(NumLevels - 1);
+
+	const uint8_t* Pixels = Image.Pixels.data();
+	uint32_t Width = Image.Width, Height = Image.Height;
+	for (uint32_t Level = 1; Level < NumLevels; ++Level) {
+		const uint32_t NextWidth = std::max(1u, Width / 2);
+		const uint32_t NextHeight = std::max(1u, Height / 2);
+		Levels[Level - 1].resize(static_cast<size_t>(NextWidth) * NextHeight * 3);
+		DownsampleMipLevel(Pixels, Width, Height, 3, Settings, Levels[Level - 1].data(), bAllowSIMD);
+
+		Pixels = Levels[Level - 1].data();
+		Width = NextWidth;
+		Height = NextHeight;
+	}
+}
+
+//glGenerateMipmap com o level 0 já na GPU: tempo de GPU pelo GL_TIME_ELAPSED e tempo de parede até o glFinish
+void MeasureGenerateMipmap(const BenchImage& Image, double& OutGPUMilliseconds, double& OutWallMilliseconds) {
+	GLuint Texture;
+	glGenTextures(1, &Texture);
+	glBindTexture(GL_TEXTURE_2D, Texture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, Image.Width, Image.Height, 0, GL_RGB, GL_UNSIGNED_BYTE, Image.Pixels.data());
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glGenerateMipmap(GL_TEXTURE_2D);
+	glFinish();
+
+	GLuint Query;
+	glGenQueries(1, &Query);
+
+	int Iterations = 0;
+	GLuint64 GPUNanoseconds = 0;
+	const double WallSeconds = MeasureSeconds([&] {
+		glBeginQuery(GL_TIME_ELAPSED, Query);
+		glGenerateMipmap(GL_TEXTURE_2D);
+		glEndQuery(GL_TIME_ELAPSED);
+		glFinish();
+
+		GLuint64 Elapsed = 0;
+		glGetQueryObjectui64v(Query, GL_QUERY_RESULT, &Elapsed);
+		GPUNanoseconds += Elapsed;
+		++Iterations;
+	});
+
+	glDeleteQueries(1, &Query);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glDeleteTextures(1, &Texture);
+
+	OutGPUMilliseconds = GPUNanoseconds / 1e6 / Iterations;
+	OutWallMilliseconds = WallSeconds * 1000.0;
+}
+
+//envio dos levels gerados na CPU, o custo extra do caminho sem glGenerateMipmap
+double MeasureLevelUpload(const BenchImage& Image, const std::vector<std::vector<uint8_t>>& Levels) {
+	GLuint Texture;
+	glGenTextures(1, &Texture);
+	glBindTexture(GL_TEXTURE_2D, Texture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	const double Seconds = MeasureSeconds([&] {
+		for (size_t Level = 0; Level < Levels.size(); ++Level) {
+			const GLsizei Width = std::max(1u, Image.Width >> (Level + 1));
+			const GLsizei Height = std::max(1u, Image.Height >> (Level + 1));
+			glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(Level + 1), GL_RGB8, Width, Height, 0, GL_RGB, GL_UNSIGNED_BYTE, Levels[Level].data());
+		}
+		glFinish();
+	});
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glDeleteTextures(1, &Texture);
+	return Seconds * 1000.0;
+}
+
+void PrintImageBenchmark(const BenchImage& Image) {
+	std::cout << Image.Name << " " << Image.Width << "x" << Image.Height << std::endl;
+
+	double GPUMilliseconds = 0.0, WallMilliseconds = 0.0;
+	MeasureGenerateMipmap(Image, GPUMilliseconds, WallMilliseconds);
+	std::cout << std::fixed << std::setprecision(2)
+		<< "  glGenerateMipmap: " << GPUMilliseconds << " ms de GPU, " << WallMilliseconds << " ms ate o glFinish" << std::endl;
+
+	std::cout << std::setw(10) << "Filtro"
+		<< std::setw(8) << "sRGB"
+		<< std::setw(16) << "Escalar (ms)"
+		<< std::setw(14) << "SSE2 (ms)"
+		<< std::setw(14) << "Mpixel/s"
+		<< std::setw(14) << "Envio (ms)" << std::endl;
+
+	const MipFilter Filters[] = { MipFilter::Box, MipFilter::Kaiser, MipFilter::Lanczos };
+	std::vector<std::vector<uint8_t>> Levels;
+	for (MipFilter Filter : Filters) {
+		for (bool bSRGB : { false, true }) {
+			MipmapSettings Settings;
+			Settings.Filter = Filter;
+			Settings.bSRGB = bSRGB;
+
+			const double ScalarSeconds = MeasureSeconds([&] { GenerateChain(Image, Settings, false, Levels); });
+			const double SIMDSeconds = MeasureSeconds([&] { GenerateChain(Image, Settings, true, Levels); });
+			const double UploadMilliseconds = MeasureLevelUpload(Image, Levels);
+
+			std::cout << std::setw(10) << ToString(Filter)
+				<< std::setw(8) << (bSRGB ? "sim" : "nao")
+				<< std::setw(16) << ScalarSeconds * 1000.0
+				<< std::setw(14) << SIMDSeconds * 1000.0
+				<< std::setw(14) << static_cast<double>(Image.Width) * Image.Height / SIMDSeconds / 1e6
+				<< std::setw(14) << UploadMilliseconds << std::endl;
+		}
+	}
+
+	std::cout << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+	//--no-16k pula o mosaico de 16384x8192 (384 MiB só no level 0)
+	const bool bLarge = !(argc > 1 && std::strcmp(argv[1], "--no-16k") == 0);
+
+	if (!glfwInit()) {
+		std::cerr << "Failed to initialize GLFW" << std::endl;
+		return -1;
+	}
+
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	GLFWwindow* Window = glfwCreateWindow(64, 64, "MipmapBench", nullptr, nullptr);
+	assert(Window);
+	glfwMakeContextCurrent(Window);
+
+	glewExperimental = GL_TRUE;
+	if (glewInit() != GLEW_OK) {
+		std::cerr << "Failed to initialize GLEW" << std::endl;
+		return -1;
+	}
+
+	std::cout << "GPU: " << glGetString(GL_RENDERER) << std::endl;
+	std::cout << "Threads: " << GetThreadPool().GetNumThreads() << std::endl << std::endl;
+
+	std::vector<BenchImage> Images(2);
+	if (!LoadImage("textures/earth_2k.jpg", Images[0]) || !LoadImage("textures/earth_clouds_2k.jpg", Images[1])) {
+		return -1;
+	}
+	if (bLarge) {
+		Images.push_back(MakeTiledImage(Images[0], 16384, 8192));
+	}
+
+	for (const BenchImage& Image : Images) {
+		PrintImageBenchmark(Image);
+	}
+
+	glfwDestroyWindow(Window);
+	glfwTerminate();
+	return 0;
+}
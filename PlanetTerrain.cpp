@@ -0,0 +1,271 @@
+#include "PlanetTerrain.h"
+
+#include<algorithm>
+#include<cassert>
+#include<chrono>
+#include<limits>
+
+#include<glm/ext.hpp>
+
+#include "Frustum.h"
+#include "GLState.h"
+#include "MeshOptimize.h"
+#include "Profiler.h"
+#include "SphereMesh.h"
+
+//quantas vezes a seleção é refeita com erro maior quando o orçamento de triângulos estoura
+constexpr int MaxBudgetIterations = 8;
+
+void PlanetTerrain::Initialize(const TerrainSettings& NewSettings) {
+	Settings = NewSettings;
+	assert(Settings.GridResolution >= 3 && (Settings.GridResolution - 1) % 2 == 0);
+	assert(Settings.GridResolution * Settings.GridResolution <= 65536);
+
+	LastPixelError = Settings.TargetPixelError;
+
+	const GLuint N = Settings.GridResolution;
+	const float InvSegments = 1.0f / static_cast<float>(N - 1);
+
+	//grade única compartilhada por todos os chunks, posições em [0, 1]
+	std::vector<glm::vec2> Grid;
+	Grid.reserve(N * N);
+	for (GLuint Row = 0; Row < N; ++Row) {
+		for (GLuint Column = 0; Column < N; ++Column) {
+			Grid.push_back(glm::vec2{ Column * InvSegments, Row * InvSegments });
+		}
+	}
+
+	//anti-horário no plano (U, V) da face, que é o sentido de fora da esfera
+	std::vector<GLushort> Indices;
+	Indices.reserve((N - 1) * (N - 1) * 6);
+	for (GLuint Row = 0; Row < N - 1; ++Row) {
+		for (GLuint Column = 0; Column < N - 1; ++Column) {
+			const GLushort P00 = static_cast<GLushort>(Row * N + Column);
+			const GLushort P10 = static_cast<GLushort>(P00 + 1);
+			const GLushort P01 = static_cast<GLushort>(P00 + N);
+			const GLushort P11 = static_cast<GLushort>(P01 + 1);
+
+			Indices.insert(Indices.end(), { P00, P10, P01, P01, P10, P11 });
+		}
+	}
+
+	//a grade é desenhada em todo chunk, então vale reordenar para o cache de vértices
+	std::vector<uint32_t> WideIndices(Indices.begin(), Indices.end());
+	OptimizeVertexCache(WideIndices.data(), WideIndices.size(), Grid.size());
+	OptimizeVertexFetch(Grid.data(), Grid.size(), sizeof(glm::vec2), WideIndices.data(), WideIndices.size());
+	std::copy(WideIndices.begin(), WideIndices.end(), Indices.begin());
+	NumGridIndices = static_cast<GLsizei>(Indices.size());
+
+	glGenBuffers(1, &GridBuffer);
+	GetGLState().BindBuffer(GL_ARRAY_BUFFER, GridBuffer);
+	glBufferData(GL_ARRAY_BUFFER, Grid.size() * sizeof(glm::vec2), Grid.data(), GL_STATIC_DRAW);
+
+	glGenBuffers(1, &IndexBuffer);
+	glGenBuffers(1, &InstanceBuffer);
+
+	glGenVertexArrays(1, &VAO);
+	GetGLState().BindVertexArray(VAO);
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, IndexBuffer);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, Indices.size() * sizeof(GLushort), Indices.data(), GL_STATIC_DRAW);
+
+	glEnableVertexAttribArray(0);
+	GetGLState().BindBuffer(GL_ARRAY_BUFFER, GridBuffer);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), nullptr);
+
+	//atributos por instância: avançam uma vez por chunk
+	glEnableVertexAttribArray(4);
+	glEnableVertexAttribArray(5);
+	GetGLState().BindBuffer(GL_ARRAY_BUFFER, InstanceBuffer);
+	glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(ChunkInstance), reinterpret_cast<void*>(offsetof(ChunkInstance, Rect)));
+	glVertexAttribPointer(5, 2, GL_FLOAT, GL_FALSE, sizeof(ChunkInstance), reinterpret_cast<void*>(offsetof(ChunkInstance, MorphRange)));
+	glVertexAttribDivisor(4, 1);
+	glVertexAttribDivisor(5, 1);
+
+	GetGLState().BindVertexArray(0);
+	GetGLState().BindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void PlanetTerrain::Shutdown() {
+	GetGLState().DeleteVertexArrays(1, &VAO);
+	GetGLState().DeleteBuffers(1, &GridBuffer);
+	GetGLState().DeleteBuffers(1, &IndexBuffer);
+	GetGLState().DeleteBuffers(1, &InstanceBuffer);
+	VAO = GridBuffer = IndexBuffer = InstanceBuffer = 0;
+	InstanceCapacity = 0;
+}
+
+void PlanetTerrain::GetBounds(const Node& CurrentNode, glm::vec3& OutCenter, float& OutRadius) const {
+	const float Size = 1.0f / static_cast<float>(1u << CurrentNode.Depth);
+	const glm::vec2 Corner{ CurrentNode.X * Size, CurrentNode.Y * Size };
+
+	OutCenter = CubeToSphere(CurrentNode.Face, Corner + glm::vec2{ 0.5f * Size });
+
+	//cantos e meios das arestas cobrem o pedaço curvo da esfera
+	OutRadius = 0.0f;
+	for (int J = 0; J <= 2; ++J) {
+		for (int I = 0; I <= 2; ++I) {
+			const glm::vec3 Point = CubeToSphere(CurrentNode.Face, Corner + glm::vec2{ I * 0.5f * Size, J * 0.5f * Size });
+			OutRadius = glm::max(OutRadius, glm::distance(Point, OutCenter));
+		}
+	}
+}
+
+float PlanetTerrain::GetMinDistance(const glm::vec3& Center, float Radius) const {
+	return glm::max(0.0f, glm::distance(CameraPosition, Center) - Radius);
+}
+
+bool PlanetTerrain::IsCulled(const glm::vec3& Center, float Radius) {
+	if (IsSphereOutsideFrustum(FrustumPlanes, Center, Radius)) {
+		++Stats.FrustumCulled;
+		return true;
+	}
+
+	//horizonte: pontos da esfera com dot(P, C) < 1 / |C| ficam escondidos pelo próprio planeta
+	const float CameraDistance = glm::length(CameraPosition);
+	if (CameraDistance > 1.0f) {
+		const glm::vec3 CameraDirection = CameraPosition / CameraDistance;
+		if (glm::dot(Center, CameraDirection) + Radius < 1.0f / CameraDistance) {
+			++Stats.HorizonCulled;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void PlanetTerrain::AddChunk(const Node& CurrentNode, bool bTestCulling) {
+	if (bTestCulling) {
+		glm::vec3 Center;
+		float Radius;
+		GetBounds(CurrentNode, Center, Radius);
+		if (IsCulled(Center, Radius)) {
+			return;
+		}
+	}
+
+	const float Size = 1.0f / static_cast<float>(1u << CurrentNode.Depth);
+
+	//o nível 0 não tem nível mais grosso para onde morfar: faixa inalcançável
+	glm::vec2 MorphRange{ 1.0e30f, 2.0e30f };
+	if (CurrentNode.Depth > 0) {
+		const float End = Ranges[CurrentNode.Depth];
+		MorphRange = glm::vec2{ End * Settings.MorphStartRatio, End };
+	}
+
+	Instances.push_back(ChunkInstance{
+		glm::vec4{ CurrentNode.X * Size, CurrentNode.Y * Size, Size, static_cast<float>(CurrentNode.Face) },
+		MorphRange
+	});
+
+	Stats.DeepestLevel = glm::max(Stats.DeepestLevel, CurrentNode.Depth);
+}
+
+bool PlanetTerrain::SelectNode(const Node& CurrentNode) {
+	++Stats.NodesVisited;
+
+	glm::vec3 Center;
+	float Radius;
+	GetBounds(CurrentNode, Center, Radius);
+	const float MinDistance = GetMinDistance(Center, Radius);
+
+	//fora da faixa deste nível: o pai desenha esta área
+	if (CurrentNode.Depth > 0 && MinDistance >= Ranges[CurrentNode.Depth]) {
+		return false;
+	}
+
+	//invisível: a área foi tratada, não há nada a desenhar
+	if (IsCulled(Center, Radius)) {
+		return true;
+	}
+
+	if (CurrentNode.Depth == Settings.MaxDepth || MinDistance >= Ranges[CurrentNode.Depth + 1]) {
+		AddChunk(CurrentNode, false);
+		return true;
+	}
+
+	for (uint32_t Child = 0; Child < 4; ++Child) {
+		const Node ChildNode{ CurrentNode.Face, CurrentNode.Depth + 1, CurrentNode.X * 2 + (Child & 1), CurrentNode.Y * 2 + (Child >> 1) };
+
+		//filho fora da própria faixa: desenhado no tamanho do filho, mas totalmente morfado para a densidade do pai
+		if (!SelectNode(ChildNode)) {
+			AddChunk(ChildNode, true);
+		}
+	}
+
+	return true;
+}
+
+void PlanetTerrain::SelectWithPixelError(const TerrainView& View, float PixelError) {
+	Instances.clear();
+	Stats.NumChunks = 0;
+	Stats.NumTriangles = 0;
+	Stats.NodesVisited = 0;
+	Stats.FrustumCulled = 0;
+	Stats.HorizonCulled = 0;
+	Stats.DeepestLevel = 0;
+	Stats.PixelError = PixelError;
+
+	//distância abaixo da qual a aresta de um triângulo do nível passa de PixelError na tela:
+	//Ranges[k] é onde o nível k - 1 deixa de ser suficiente
+	const float SegmentsPerFace = static_cast<float>(Settings.GridResolution - 1);
+	const float SegmentLength = glm::half_pi<float>() / SegmentsPerFace;
+	const float PixelsPerRadian = View.ViewportHeight / (2.0f * glm::tan(View.FieldOfView * 0.5f));
+
+	Ranges.assign(Settings.MaxDepth + 2, 0.0f);
+	Ranges[0] = std::numeric_limits<float>::max();
+	for (GLuint Depth = 1; Depth <= Settings.MaxDepth + 1; ++Depth) {
+		const float ParentSegment = SegmentLength / static_cast<float>(1u << (Depth - 1));
+		Ranges[Depth] = ParentSegment * PixelsPerRadian / PixelError;
+	}
+
+	for (uint32_t Face = 0; Face < 6; ++Face) {
+		SelectNode(Node{ Face, 0, 0, 0 });
+	}
+
+	const size_t TrianglesPerChunk = static_cast<size_t>(Settings.GridResolution - 1) * (Settings.GridResolution - 1) * 2;
+	Stats.NumChunks = Instances.size();
+	Stats.NumTriangles = Instances.size() * TrianglesPerChunk;
+}
+
+void PlanetTerrain::Select(const TerrainView& View) {
+	PROFILE_SCOPE("PlanetTerrain::Select");
+	const auto Start = std::chrono::steady_clock::now();
+
+	CameraPosition = View.CameraPosition;
+
+	//planos do frustum no espaço do modelo
+	ExtractFrustumPlanes(View.ModelViewProjection, FrustumPlanes);
+
+	//começa um pouco mais fino que o frame anterior e só engrossa se estourar o orçamento
+	float PixelError = glm::max(Settings.TargetPixelError, LastPixelError / 1.25f);
+	SelectWithPixelError(View, PixelError);
+
+	for (int Iteration = 0; Iteration < MaxBudgetIterations && Stats.NumTriangles > Settings.TriangleBudget; ++Iteration) {
+		PixelError *= 1.5f;
+		SelectWithPixelError(View, PixelError);
+	}
+	LastPixelError = PixelError;
+
+	Stats.SelectionMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - Start).count();
+}
+
+void PlanetTerrain::Draw() const {
+	PROFILE_SCOPE("PlanetTerrain::Draw");
+	if (Instances.empty()) {
+		return;
+	}
+
+	GetGLState().BindBuffer(GL_ARRAY_BUFFER, InstanceBuffer);
+
+	//a capacidade só cresce; realocar o buffer todo frame (orphaning) evita esperar a GPU terminar o frame anterior
+	if (Instances.size() > InstanceCapacity) {
+		InstanceCapacity = Instances.size() * 2;
+	}
+	glBufferData(GL_ARRAY_BUFFER, InstanceCapacity * sizeof(ChunkInstance), nullptr, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, Instances.size() * sizeof(ChunkInstance), Instances.data());
+
+	//o buffer e o VAO ficam ligados: o feedback da textura virtual desenha de novo com os mesmos
+	GetGLState().BindVertexArray(VAO);
+	glDrawElementsInstanced(GL_TRIANGLES, NumGridIndices, GL_UNSIGNED_SHORT, nullptr, static_cast<GLsizei>(Instances.size()));
+}
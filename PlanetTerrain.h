@@ -0,0 +1,95 @@
+#pragma once
+
+#include<cstddef>
+#include<cstdint>
+#include<vector>
+
+#include<GL/glew.h>
+#include<glm/glm.hpp>
+
+//terreno planetário com nível de detalhe por quadtree (CDLOD) sobre as 6 faces da esfera cubo.
+//cada chunk é a mesma grade GridResolution x GridResolution desenhada com instancing, e o vertex shader
+//projeta a grade na esfera e faz o geomorph para o nível mais grosso perto do fim da faixa de distância do chunk.
+
+struct TerrainSettings {
+	GLuint GridResolution = 33;     //vértices por lado do chunk, precisa ter um número par de segmentos
+	GLuint MaxDepth = 16;           //nível mais fino da quadtree
+	float TargetPixelError = 8.0f;  //tamanho desejado da aresta de um triângulo na tela, em pixels
+	size_t TriangleBudget = 512 * 1024;
+	float MorphStartRatio = 0.7f;   //fração da faixa do nível onde começa o geomorph
+};
+
+//dados da câmera usados na seleção, no espaço do modelo do planeta (raio 1)
+struct TerrainView {
+	glm::mat4 ModelViewProjection;
+	glm::vec3 CameraPosition;
+	float FieldOfView = 0.0f;       //vertical, em radianos
+	float ViewportHeight = 0.0f;    //em pixels
+};
+
+struct TerrainStats {
+	size_t NumChunks = 0;
+	size_t NumTriangles = 0;
+	size_t NodesVisited = 0;
+	size_t FrustumCulled = 0;
+	size_t HorizonCulled = 0;
+	GLuint DeepestLevel = 0;
+	float PixelError = 0.0f;        //erro usado de fato, maior que o alvo quando o orçamento estoura
+	double SelectionMilliseconds = 0.0;
+};
+
+class PlanetTerrain {
+public:
+	void Initialize(const TerrainSettings& NewSettings);
+	void Shutdown();
+
+	//escolhe os chunks do frame respeitando o orçamento de triângulos
+	void Select(const TerrainView& View);
+
+	//envia os chunks selecionados e desenha com o programa ativo
+	void Draw() const;
+
+	const TerrainStats& GetStats() const { return Stats; }
+	const TerrainSettings& GetSettings() const { return Settings; }
+
+	//a grade e os atributos por instância, para a chave da fila de desenho
+	GLuint GetVertexArray() const { return VAO; }
+
+private:
+	struct Node {
+		uint32_t Face;
+		uint32_t Depth;
+		uint32_t X;
+		uint32_t Y;
+	};
+
+	//dados por instância, atributos 4 e 5 do terrain_vert.glsl
+	struct ChunkInstance {
+		glm::vec4 Rect;        //xy = canto na face, z = tamanho, w = índice da face
+		glm::vec2 MorphRange;  //distância de início e fim do geomorph
+	};
+
+	void SelectWithPixelError(const TerrainView& View, float PixelError);
+	bool SelectNode(const Node& CurrentNode);
+	void AddChunk(const Node& CurrentNode, bool bTestCulling);
+	bool IsCulled(const glm::vec3& Center, float Radius);
+	void GetBounds(const Node& CurrentNode, glm::vec3& OutCenter, float& OutRadius) const;
+	float GetMinDistance(const glm::vec3& Center, float Radius) const;
+
+	TerrainSettings Settings;
+	TerrainStats Stats;
+
+	//estado da seleção em andamento
+	std::vector<float> Ranges;
+	glm::vec4 FrustumPlanes[6];
+	glm::vec3 CameraPosition{ 0.0f };
+	std::vector<ChunkInstance> Instances;
+	float LastPixelError = 0.0f;
+
+	GLuint VAO = 0;
+	GLuint GridBuffer = 0;
+	GLuint IndexBuffer = 0;
+	GLuint InstanceBuffer = 0;
+	GLsizei NumGridIndices = 0;
+	mutable size_t InstanceCapacity = 0;
+};
@@ -0,0 +1,357 @@
+#include "Profiler.h"
+
+#ifdef BLUEMARBLE_PROFILER
+
+#include<algorithm>
+#include<array>
+#include<cassert>
+#include<chrono>
+#include<cmath>
+#include<fstream>
+#include<iomanip>
+#include<iostream>
+#include<map>
+#include<memory>
+#include<mutex>
+#include<thread>
+#include<vector>
+
+#include<GL/glew.h>
+
+//eventos por thread entre dois fins de frame; cheio, os eventos novos são descartados e contados
+constexpr uint32_t ProfileRingCapacity = 16384;
+static_assert((ProfileRingCapacity & (ProfileRingCapacity - 1)) == 0, "o anel usa índices que dão a volta em 2^32");
+
+//conjuntos de consultas de GPU: o do frame N é lido no começo do frame N + 2
+constexpr size_t GpuQueryFrames = 2;
+
+//teto do trace na memória; as estatísticas continuam depois dele
+constexpr size_t MaxTraceEvents = 4 * 1024 * 1024;
+
+//a trilha da GPU aparece como uma thread a mais no trace
+constexpr uint32_t GpuTrackId = 0;
+
+struct ProfileEvent {
+	const char* Name = nullptr;
+	uint64_t BeginNanoseconds = 0;
+	uint64_t EndNanoseconds = 0;
+};
+
+//anel de uma produtora (a thread dona) e uma consumidora (a thread do OpenGL)
+struct ProfileThread {
+	uint32_t Id = 0;
+	std::string Name;                        //protegido pelo RegistryMutex
+	std::atomic<uint32_t> Head{ 0 };         //escrito pela dona
+	std::atomic<uint32_t> Tail{ 0 };         //escrito pela consumidora
+	std::atomic<uint64_t> Dropped{ 0 };
+	std::array<ProfileEvent, ProfileRingCapacity> Events;
+};
+
+struct TraceEvent {
+	const char* Name;
+	uint64_t BeginNanoseconds;
+	uint64_t DurationNanoseconds;
+	uint32_t TrackId;
+};
+
+struct GpuQuery {
+	GLuint Query = 0;
+	const char* Name = nullptr;
+	uint64_t BeginNanoseconds = 0;          //quando os comandos foram enviados, a GPU executa depois
+};
+
+struct GpuQueryFrame {
+	std::vector<GpuQuery> Queries;
+	size_t Used = 0;
+};
+
+struct ProfilerState {
+	std::chrono::steady_clock::time_point Start;
+	std::string OutputPath;
+	std::thread::id OpenGLThread;
+
+	//os anéis vivem até o fim do programa: uma thread pode terminar com eventos ainda não lidos
+	std::mutex RegistryMutex;
+	std::vector<std::unique_ptr<ProfileThread>> Threads;
+
+	std::vector<TraceEvent> Trace;
+	std::map<std::string, std::vector<double>> CpuSamples;   //microssegundos por escopo
+	std::map<std::string, std::vector<double>> GpuSamples;
+	uint64_t Frames = 0;
+	uint64_t FrameBeginNanoseconds = 0;
+
+	std::array<GpuQueryFrame, GpuQueryFrames> GpuFrames;
+	size_t GpuFrame = 0;
+	bool bGpuScopeOpen = false;
+	uint64_t LateGpuFrames = 0;
+	uint64_t NestedGpuScopes = 0;
+};
+
+static ProfilerState& GetState() {
+	static ProfilerState State;
+	return State;
+}
+
+static thread_local ProfileThread* LocalThread = nullptr;
+
+static uint64_t GetProfilerNanoseconds() {
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - GetState().Start).count());
+}
+
+static ProfileThread& GetLocalThread() {
+	if (LocalThread == nullptr) {
+		ProfilerState& State = GetState();
+		std::lock_guard<std::mutex> Lock(State.RegistryMutex);
+		std::unique_ptr<ProfileThread> Thread = std::make_unique<ProfileThread>();
+		Thread->Id = static_cast<uint32_t>(State.Threads.size()) + 1;
+		Thread->Name = "Thread " + std::to_string(Thread->Id);
+		LocalThread = Thread.get();
+		State.Threads.push_back(std::move(Thread));
+	}
+	return *LocalThread;
+}
+
+static void PushEvent(ProfileThread& Thread, const ProfileEvent& Event) {
+	const uint32_t Head = Thread.Head.load(std::memory_order_relaxed);
+	if (Head - Thread.Tail.load(std::memory_order_acquire) >= ProfileRingCapacity) {
+		Thread.Dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	Thread.Events[Head % ProfileRingCapacity] = Event;
+	Thread.Head.store(Head + 1, std::memory_order_release);
+}
+
+static void RecordEvent(ProfilerState& State, const char* Name, uint64_t BeginNanoseconds, uint64_t EndNanoseconds, uint32_t TrackId) {
+	const uint64_t Duration = EndNanoseconds > BeginNanoseconds ? EndNanoseconds - BeginNanoseconds : 0;
+	if (State.Trace.size() < MaxTraceEvents) {
+		State.Trace.push_back(TraceEvent{ Name, BeginNanoseconds, Duration, TrackId });
+	}
+	(TrackId == GpuTrackId ? State.GpuSamples : State.CpuSamples)[Name].push_back(Duration / 1000.0);
+}
+
+//só a thread do OpenGL consome; as outras continuam gravando enquanto isso
+static void CollectEvents(ProfilerState& State) {
+	std::lock_guard<std::mutex> Lock(State.RegistryMutex);
+	for (const std::unique_ptr<ProfileThread>& Thread : State.Threads) {
+		const uint32_t Head = Thread->Head.load(std::memory_order_acquire);
+		uint32_t Tail = Thread->Tail.load(std::memory_order_relaxed);
+		for (; Tail != Head; ++Tail) {
+			const ProfileEvent& Event = Thread->Events[Tail % ProfileRingCapacity];
+			RecordEvent(State, Event.Name, Event.BeginNanoseconds, Event.EndNanoseconds, Thread->Id);
+		}
+		Thread->Tail.store(Tail, std::memory_order_release);
+	}
+}
+
+//consultas completam na ordem em que foram enviadas: se a última chegou, todas chegaram
+static void ReadGpuFrame(ProfilerState& State, GpuQueryFrame& Frame, bool bWait) {
+	if (Frame.Used == 0) {
+		return;
+	}
+
+	GLint bAvailable = GL_FALSE;
+	glGetQueryObjectiv(Frame.Queries[Frame.Used - 1].Query, GL_QUERY_RESULT_AVAILABLE, &bAvailable);
+	if (bAvailable == GL_FALSE && !bWait) {
+		++State.LateGpuFrames;
+		Frame.Used = 0;
+		return;
+	}
+
+	for (size_t Index = 0; Index < Frame.Used; ++Index) {
+		const GpuQuery& Query = Frame.Queries[Index];
+		GLuint64 Nanoseconds = 0;
+		glGetQueryObjectui64v(Query.Query, GL_QUERY_RESULT, &Nanoseconds);
+		RecordEvent(State, Query.Name, Query.BeginNanoseconds, Query.BeginNanoseconds + Nanoseconds, GpuTrackId);
+	}
+	Frame.Used = 0;
+}
+
+void CpuProfileScope::Begin(const char* NewName) {
+	Name = NewName;
+	BeginNanoseconds = GetProfilerNanoseconds();
+}
+
+void CpuProfileScope::End() {
+	PushEvent(GetLocalThread(), ProfileEvent{ Name, BeginNanoseconds, GetProfilerNanoseconds() });
+}
+
+void GpuProfileScope::Begin(const char* NewName) {
+	ProfilerState& State = GetState();
+	assert(std::this_thread::get_id() == State.OpenGLThread);
+	if (State.bGpuScopeOpen) {
+		++State.NestedGpuScopes;
+		return;
+	}
+
+	GpuQueryFrame& Frame = State.GpuFrames[State.GpuFrame];
+	if (Frame.Used == Frame.Queries.size()) {
+		GpuQuery Query;
+		glGenQueries(1, &Query.Query);
+		Frame.Queries.push_back(Query);
+	}
+
+	GpuQuery& Query = Frame.Queries[Frame.Used++];
+	Query.Name = NewName;
+	Query.BeginNanoseconds = GetProfilerNanoseconds();
+	glBeginQuery(GL_TIME_ELAPSED, Query.Query);
+	State.bGpuScopeOpen = true;
+	bActive = true;
+}
+
+void GpuProfileScope::End() {
+	glEndQuery(GL_TIME_ELAPSED);
+	GetState().bGpuScopeOpen = false;
+}
+
+bool StartProfiler(const std::string& OutputPath) {
+	ProfilerState& State = GetState();
+	State.Start = std::chrono::steady_clock::now();
+	State.OutputPath = OutputPath;
+	State.OpenGLThread = std::this_thread::get_id();
+	SetProfilerThreadName("Principal");
+
+	bProfilerRunning.store(true, std::memory_order_relaxed);
+	std::cout << "Profiler gravando, " << OutputPath << ".json e " << OutputPath << ".csv ao fechar" << std::endl;
+	return true;
+}
+
+void BeginProfilerFrame() {
+	if (!bProfilerRunning.load(std::memory_order_relaxed)) {
+		return;
+	}
+
+	ProfilerState& State = GetState();
+	State.GpuFrame = (State.GpuFrame + 1) % GpuQueryFrames;
+	ReadGpuFrame(State, State.GpuFrames[State.GpuFrame], false);
+	State.FrameBeginNanoseconds = GetProfilerNanoseconds();
+}
+
+void EndProfilerFrame() {
+	if (!bProfilerRunning.load(std::memory_order_relaxed)) {
+		return;
+	}
+
+	ProfilerState& State = GetState();
+	PushEvent(GetLocalThread(), ProfileEvent{ "Frame", State.FrameBeginNanoseconds, GetProfilerNanoseconds() });
+	CollectEvents(State);
+	++State.Frames;
+}
+
+void SetProfilerThreadName(const char* Name) {
+	ProfileThread& Thread = GetLocalThread();
+	std::lock_guard<std::mutex> Lock(GetState().RegistryMutex);
+	Thread.Name = Name;
+}
+
+static std::string EscapeJSON(const std::string& Text) {
+	std::string Escaped;
+	for (const char Character : Text) {
+		if (Character == '"' || Character == '\\') {
+			Escaped += '\\';
+		}
+		Escaped += Character;
+	}
+	return Escaped;
+}
+
+//posto mais próximo sobre as amostras ordenadas
+static double GetPercentile(const std::vector<double>& Sorted, double Fraction) {
+	const size_t Rank = static_cast<size_t>(std::ceil(Fraction * Sorted.size()));
+	return Sorted[std::min(std::max<size_t>(Rank, 1), Sorted.size()) - 1];
+}
+
+static bool WriteTrace(const ProfilerState& State, const std::string& Path) {
+	std::ofstream Stream{ Path, std::ios::out | std::ios::trunc };
+	if (!Stream) {
+		return false;
+	}
+
+	//microssegundos com três casas: o Chrome lê ts e dur em microssegundos
+	Stream << std::fixed << std::setprecision(3);
+	Stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	Stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << GpuTrackId << ",\"args\":{\"name\":\"GPU\"}}";
+	for (const std::unique_ptr<ProfileThread>& Thread : State.Threads) {
+		Stream << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << Thread->Id << ",\"args\":{\"name\":\"" << EscapeJSON(Thread->Name) << "\"}}";
+	}
+	for (const TraceEvent& Event : State.Trace) {
+		Stream << ",\n{\"name\":\"" << EscapeJSON(Event.Name) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << Event.TrackId
+			<< ",\"ts\":" << Event.BeginNanoseconds / 1000.0 << ",\"dur\":" << Event.DurationNanoseconds / 1000.0 << "}";
+	}
+	Stream << "\n]}\n";
+	return static_cast<bool>(Stream);
+}
+
+static bool WriteSummary(ProfilerState& State, const std::string& Path) {
+	std::ofstream Stream{ Path, std::ios::out | std::ios::trunc };
+	if (!Stream) {
+		return false;
+	}
+
+	Stream << std::fixed << std::setprecision(4);
+	Stream << "escopo,origem,amostras,media_ms,p50_ms,p95_ms,p99_ms,max_ms\n";
+	for (auto* Samples : { &State.CpuSamples, &State.GpuSamples }) {
+		const char* Source = Samples == &State.CpuSamples ? "cpu" : "gpu";
+		for (auto& [Name, Durations] : *Samples) {
+			std::sort(Durations.begin(), Durations.end());
+			double Sum = 0.0;
+			for (const double Duration : Durations) {
+				Sum += Duration;
+			}
+
+			const double P50 = GetPercentile(Durations, 0.50) / 1000.0;
+			const double P95 = GetPercentile(Durations, 0.95) / 1000.0;
+			const double P99 = GetPercentile(Durations, 0.99) / 1000.0;
+			Stream << "\"" << Name << "\"," << Source << "," << Durations.size() << "," << Sum / Durations.size() / 1000.0 << ","
+				<< P50 << "," << P95 << "," << P99 << "," << Durations.back() / 1000.0 << "\n";
+			std::cout << "  " << Source << " " << Name << ": p50 " << P50 << " ms, p95 " << P95 << " ms, p99 " << P99 << " ms" << std::endl;
+		}
+	}
+	return static_cast<bool>(Stream);
+}
+
+void StopProfiler() {
+	if (!bProfilerRunning.exchange(false)) {
+		return;
+	}
+
+	//no fim pode esperar: as consultas dos dois últimos frames ainda não foram lidas
+	ProfilerState& State = GetState();
+	for (size_t Offset = 1; Offset <= GpuQueryFrames; ++Offset) {
+		ReadGpuFrame(State, State.GpuFrames[(State.GpuFrame + Offset) % GpuQueryFrames], true);
+	}
+	for (GpuQueryFrame& Frame : State.GpuFrames) {
+		for (const GpuQuery& Query : Frame.Queries) {
+			glDeleteQueries(1, &Query.Query);
+		}
+		Frame = GpuQueryFrame{};
+	}
+	CollectEvents(State);
+
+	uint64_t Dropped = 0;
+	{
+		std::lock_guard<std::mutex> Lock(State.RegistryMutex);
+		for (const std::unique_ptr<ProfileThread>& Thread : State.Threads) {
+			Dropped += Thread->Dropped.load(std::memory_order_relaxed);
+		}
+	}
+
+	std::cout << "Profiler: " << State.Frames << " frames, " << State.Trace.size() << " eventos no trace, " << Dropped << " descartados com o anel cheio, "
+		<< State.LateGpuFrames << " frames sem o tempo de GPU a tempo, " << State.NestedGpuScopes << " escopos de GPU aninhados ignorados" << std::endl;
+
+	const std::string TracePath = State.OutputPath + ".json";
+	const std::string SummaryPath = State.OutputPath + ".csv";
+	if (!WriteSummary(State, SummaryPath)) {
+		std::cout << "Nao foi possivel gravar " << SummaryPath << std::endl;
+	}
+	if (!WriteTrace(State, TracePath)) {
+		std::cout << "Nao foi possivel gravar " << TracePath << std::endl;
+	}
+
+	State.Trace.clear();
+	State.CpuSamples.clear();
+	State.GpuSamples.clear();
+	State.Frames = 0;
+}
+
+#endif
@@ -0,0 +1,102 @@
+#pragma once
+
+#include<atomic>
+#include<cstdint>
+#include<string>
+
+//profiler de frame: escopos de CPU aninhados em qualquer thread e escopos de GPU (GL_TIME_ELAPSED) na thread
+//do OpenGL. Cada thread grava os eventos num anel próprio, sem trava; a thread do OpenGL esvazia os anéis no fim
+//do frame. As consultas de GPU usam dois conjuntos alternados por frame e só são lidas quando o resultado já
+//chegou, então o profiler nunca espera a GPU. No StopProfiler grava um trace do Chrome (chrome://tracing ou
+//ui.perfetto.dev) e um CSV com média, p50, p95, p99 e máximo de cada escopo.
+//só existe com BLUEMARBLE_PROFILER definido; sem ele as macros não geram código e as funções são vazias.
+
+#ifdef BLUEMARBLE_PROFILER
+
+//começa a gravar. Os arquivos são OutputPath + ".json" e OutputPath + ".csv".
+//a thread que chama é a do OpenGL, a única que pode abrir escopos de GPU e marcar frames.
+bool StartProfiler(const std::string& OutputPath);
+
+//para de gravar, espera as últimas consultas de GPU e grava os arquivos
+void StopProfiler();
+
+//em volta de cada frame, na thread do OpenGL: lê as consultas de GPU de dois frames atrás e esvazia os anéis
+void BeginProfilerFrame();
+void EndProfilerFrame();
+
+//nome da thread atual no trace
+void SetProfilerThreadName(const char* Name);
+
+inline std::atomic<bool> bProfilerRunning{ false };
+
+//mede do construtor ao destrutor. Name tem que ser um literal: só o ponteiro é guardado.
+class CpuProfileScope {
+public:
+	explicit CpuProfileScope(const char* NewName) {
+		if (bProfilerRunning.load(std::memory_order_relaxed)) {
+			Begin(NewName);
+		}
+	}
+
+	~CpuProfileScope() {
+		if (Name != nullptr) {
+			End();
+		}
+	}
+
+	CpuProfileScope(const CpuProfileScope&) = delete;
+	CpuProfileScope& operator=(const CpuProfileScope&) = delete;
+
+private:
+	void Begin(const char* NewName);
+	void End();
+
+	const char* Name = nullptr;
+	uint64_t BeginNanoseconds = 0;
+};
+
+//tempo de GPU dos comandos enviados entre o construtor e o destrutor. GL_TIME_ELAPSED não aninha:
+//um escopo de GPU aberto dentro de outro é ignorado.
+class GpuProfileScope {
+public:
+	explicit GpuProfileScope(const char* NewName) {
+		if (bProfilerRunning.load(std::memory_order_relaxed)) {
+			Begin(NewName);
+		}
+	}
+
+	~GpuProfileScope() {
+		if (bActive) {
+			End();
+		}
+	}
+
+	GpuProfileScope(const GpuProfileScope&) = delete;
+	GpuProfileScope& operator=(const GpuProfileScope&) = delete;
+
+private:
+	void Begin(const char* NewName);
+	void End();
+
+	bool bActive = false;
+};
+
+#define BLUEMARBLE_PROFILE_CONCAT_(A, B) A##B
+#define BLUEMARBLE_PROFILE_CONCAT(A, B) BLUEMARBLE_PROFILE_CONCAT_(A, B)
+#define PROFILE_SCOPE(Name) CpuProfileScope BLUEMARBLE_PROFILE_CONCAT(CpuProfileScope, __LINE__){ Name }
+#define PROFILE_GPU_SCOPE(Name) GpuProfileScope BLUEMARBLE_PROFILE_CONCAT(GpuProfileScope, __LINE__){ Name }
+#define PROFILE_THREAD(Name) SetProfilerThreadName(Name)
+
+#else
+
+inline bool StartProfiler(const std::string&) { return false; }
+inline void StopProfiler() {}
+inline void BeginProfilerFrame() {}
+inline void EndProfilerFrame() {}
+inline void SetProfilerThreadName(const char*) {}
+
+#define PROFILE_SCOPE(Name) ((void)0)
+#define PROFILE_GPU_SCOPE(Name) ((void)0)
+#define PROFILE_THREAD(Name) ((void)0)
+
+#endif
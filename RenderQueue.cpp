@@ -0,0 +1,184 @@
+#include "RenderQueue.h"
+
+#include<algorithm>
+#include<array>
+#include<cassert>
+#include<chrono>
+#include<cstring>
+
+#include "GLState.h"
+#include "Profiler.h"
+#include "ThreadPool.h"
+
+//itens por bloco do radix sort paralelo; abaixo de dois blocos a ordenação fica na thread que chama
+constexpr size_t MinItemsPerChunk = 4096;
+
+constexpr uint32_t PassShift = 60;
+constexpr uint32_t ProgramShift = 48;
+constexpr uint32_t TextureSetShift = 36;
+constexpr uint32_t VertexArrayShift = 24;
+constexpr uint64_t NameMask = 0xFFF;
+
+//os bits de um float positivo crescem com o valor: os 24 bits altos já ordenam a profundidade
+static uint64_t GetDepthBits(float Depth) {
+	Depth = std::max(Depth, 0.0f);
+	uint32_t Bits;
+	std::memcpy(&Bits, &Depth, sizeof(Bits));
+	return Bits >> 8;
+}
+
+void RadixSort(std::vector<DrawSortItem>& Items, std::vector<DrawSortItem>& Scratch) {
+	const size_t Count = Items.size();
+	if (Count < 2) {
+		return;
+	}
+	Scratch.resize(Count);
+
+	const size_t NumChunks = std::max<size_t>(1, std::min<size_t>(GetThreadPool().GetNumThreads(), Count / MinItemsPerChunk));
+	const size_t ChunkSize = (Count + NumChunks - 1) / NumChunks;
+	std::vector<std::array<size_t, 256>> Histograms(NumChunks);
+
+	const auto ForEachChunk = [&](const std::function<void(size_t, size_t, size_t)>& Func) {
+		if (NumChunks == 1) {
+			Func(0, 0, Count);
+			return;
+		}
+		ParallelFor(0, NumChunks, 1, [&](size_t First, size_t Last) {
+			for (size_t Chunk = First; Chunk < Last; ++Chunk) {
+				Func(Chunk, Chunk * ChunkSize, std::min(Count, (Chunk + 1) * ChunkSize));
+			}
+		});
+	};
+
+	DrawSortItem* Source = Items.data();
+	DrawSortItem* Target = Scratch.data();
+	for (uint32_t Shift = 0; Shift < 64; Shift += 8) {
+		ForEachChunk([&](size_t Chunk, size_t Begin, size_t End) {
+			std::array<size_t, 256>& Histogram = Histograms[Chunk];
+			Histogram.fill(0);
+			for (size_t Index = Begin; Index < End; ++Index) {
+				++Histogram[(Source[Index].Key >> Shift) & 0xFF];
+			}
+		});
+
+		//posição inicial de cada bloco em cada bucket, os blocos na ordem para a ordenação continuar estável
+		size_t Offset = 0;
+		bool bSingleBucket = false;
+		for (size_t Bucket = 0; Bucket < 256; ++Bucket) {
+			const size_t BucketBegin = Offset;
+			for (std::array<size_t, 256>& Histogram : Histograms) {
+				const size_t BucketCount = Histogram[Bucket];
+				Histogram[Bucket] = Offset;
+				Offset += BucketCount;
+			}
+			bSingleBucket |= Offset - BucketBegin == Count;
+		}
+		if (bSingleBucket) {
+			continue;
+		}
+
+		ForEachChunk([&](size_t Chunk, size_t Begin, size_t End) {
+			std::array<size_t, 256>& Histogram = Histograms[Chunk];
+			for (size_t Index = Begin; Index < End; ++Index) {
+				Target[Histogram[(Source[Index].Key >> Shift) & 0xFF]++] = Source[Index];
+			}
+		});
+		std::swap(Source, Target);
+	}
+
+	if (Source != Items.data()) {
+		std::copy(Source, Source + Count, Items.data());
+	}
+}
+
+uint32_t RenderQueue::AddTextureSet(TextureSetFunc Bind) {
+	TextureSets.push_back(std::move(Bind));
+	return static_cast<uint32_t>(TextureSets.size());
+}
+
+void RenderQueue::SetPass(RenderPass Pass, PassFunc Begin, PassFunc End) {
+	assert(Pass < RenderPass::Count);
+	Passes[static_cast<size_t>(Pass)] = PassCallbacks{ std::move(Begin), std::move(End) };
+}
+
+void RenderQueue::Add(RenderPass Pass, GLuint Program, uint32_t TextureSet, GLuint VertexArray, float Depth, DrawFunc Draw) {
+	assert(Pass < RenderPass::Count && TextureSet <= TextureSets.size());
+	const uint64_t Key = static_cast<uint64_t>(Pass) << PassShift
+		| (Program & NameMask) << ProgramShift
+		| (TextureSet & NameMask) << TextureSetShift
+		| (VertexArray & NameMask) << VertexArrayShift
+		| GetDepthBits(Depth);
+
+	Items.push_back(DrawSortItem{ Key, static_cast<uint32_t>(Draws.size()) });
+	Draws.push_back(DrawCommand{ Pass, Program, TextureSet, VertexArray, std::move(Draw) });
+}
+
+RenderStateChanges RenderQueue::CountStateChanges() const {
+	RenderStateChanges Changes;
+	const DrawCommand* Previous = nullptr;
+	for (const DrawSortItem& Item : Items) {
+		const DrawCommand& Command = Draws[Item.Index];
+		Changes.Programs += !Previous || Previous->Program != Command.Program;
+		Changes.TextureSets += !Previous || Previous->TextureSet != Command.TextureSet || Previous->Program != Command.Program;
+		Changes.VertexArrays += !Previous || Previous->VertexArray != Command.VertexArray;
+		Previous = &Command;
+	}
+	return Changes;
+}
+
+void RenderQueue::Submit(bool bSort) {
+	PROFILE_SCOPE("RenderQueue::Submit");
+
+	Stats = RenderQueueStats{};
+	Stats.NumDraws = Draws.size();
+	Stats.Requested = CountStateChanges();
+	if (bSort) {
+		const auto Start = std::chrono::steady_clock::now();
+		RadixSort(Items, Scratch);
+		Stats.SortMicroseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - Start).count();
+		Stats.Submitted = CountStateChanges();
+	}
+	else {
+		Stats.Submitted = Stats.Requested;
+	}
+
+	GLStateCache& State = GetGLState();
+	const DrawCommand* Previous = nullptr;
+	for (const DrawSortItem& Item : Items) {
+		const DrawCommand& Command = Draws[Item.Index];
+		if (!Previous || Previous->Pass != Command.Pass) {
+			if (Previous && Passes[static_cast<size_t>(Previous->Pass)].End) {
+				Passes[static_cast<size_t>(Previous->Pass)].End();
+			}
+			if (Passes[static_cast<size_t>(Command.Pass)].Begin) {
+				Passes[static_cast<size_t>(Command.Pass)].Begin();
+			}
+		}
+
+		//os samplers são uniforms do programa: um programa novo recebe o conjunto de novo
+		State.UseProgram(Command.Program);
+		const bool bNewTextures = !Previous || Previous->TextureSet != Command.TextureSet || Previous->Program != Command.Program;
+		if (bNewTextures && Command.TextureSet != NoTextureSet) {
+			TextureSets[Command.TextureSet - 1](Command.Program);
+		}
+		State.BindVertexArray(Command.VertexArray);
+		Command.Draw();
+		Previous = &Command;
+	}
+	if (Previous && Passes[static_cast<size_t>(Previous->Pass)].End) {
+		Passes[static_cast<size_t>(Previous->Pass)].End();
+	}
+
+	Draws.clear();
+	Items.clear();
+}
+
+void RenderQueue::Shutdown() {
+	TextureSets.clear();
+	for (PassCallbacks& Callbacks : Passes) {
+		Callbacks = PassCallbacks{};
+	}
+	Draws.clear();
+	Items.clear();
+	Scratch.clear();
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include<cstddef>
+#include<cstdint>
+#include<functional>
+#include<vector>
+
+#include<GL/glew.h>
+
+//fila de desenho do frame: cada draw vira uma chave de 64 bits e a fila é ordenada por ela antes do envio, para
+//agrupar os draws por passada, programa, conjunto de texturas e VAO, e dentro do mesmo estado da frente para trás
+//(o early-Z descarta os fragmentos escondidos antes do fragment shader).
+//
+//chave, do bit mais alto para o mais baixo:
+//  passada 4 | programa 12 | conjunto de texturas 12 | VAO 12 | profundidade 24
+//os nomes do OpenGL entram só com os bits baixos: dois nomes que colidem só ficam menos agrupados, o draw
+//sempre usa o estado guardado nele.
+
+//passadas na ordem do envio
+enum class RenderPass : uint32_t {
+	Opaque,
+	Feedback,  //feedback da textura virtual, num framebuffer próprio
+	Count
+};
+
+constexpr size_t NumRenderPasses = static_cast<size_t>(RenderPass::Count);
+
+//conjunto sem texturas
+constexpr uint32_t NoTextureSet = 0;
+
+struct DrawSortItem {
+	uint64_t Key;
+	uint32_t Index;
+};
+
+//radix sort estável de 8 bits por passada. Com muitos itens cada passada divide o array entre as threads do
+//pool (histograma por bloco, depois a distribuição); passadas em que todas as chaves têm o mesmo byte são puladas.
+void RadixSort(std::vector<DrawSortItem>& Items, std::vector<DrawSortItem>& Scratch);
+
+//trocas entre draws seguidos; o primeiro draw do frame conta como troca
+struct RenderStateChanges {
+	size_t Programs = 0;
+	size_t TextureSets = 0;
+	size_t VertexArrays = 0;
+
+	size_t GetTotal() const { return Programs + TextureSets + VertexArrays; }
+};
+
+struct RenderQueueStats {
+	size_t NumDraws = 0;
+	RenderStateChanges Requested;   //na ordem em que os draws foram pedidos
+	RenderStateChanges Submitted;   //na ordem enviada
+	double SortMicroseconds = 0.0;
+};
+
+class RenderQueue {
+public:
+	using TextureSetFunc = std::function<void(GLuint Program)>;
+	using PassFunc = std::function<void()>;
+	using DrawFunc = std::function<void()>;
+
+	//liga as texturas e os samplers do conjunto para o programa; chamado a cada troca de conjunto ou de programa.
+	//devolve o identificador usado no Add, os conjuntos valem até o Shutdown.
+	uint32_t AddTextureSet(TextureSetFunc Bind);
+
+	//em volta dos draws da passada, só nos frames que têm algum
+	void SetPass(RenderPass Pass, PassFunc Begin, PassFunc End);
+
+	//Depth é a distância da câmera até o ponto mais próximo do objeto. Draw só desenha: o programa, as texturas
+	//e o VAO já estão ligados, os uniforms do draw ficam com ele.
+	void Add(RenderPass Pass, GLuint Program, uint32_t TextureSet, GLuint VertexArray, float Depth, DrawFunc Draw);
+
+	//envia a fila na ordem das chaves, ou na ordem pedida com bSort falso, e a esvazia
+	void Submit(bool bSort = true);
+
+	void Shutdown();
+
+	//do último Submit
+	const RenderQueueStats& GetStats() const { return Stats; }
+
+private:
+	struct DrawCommand {
+		RenderPass Pass;
+		GLuint Program;
+		uint32_t TextureSet;
+		GLuint VertexArray;
+		DrawFunc Draw;
+	};
+
+	struct PassCallbacks {
+		PassFunc Begin;
+		PassFunc End;
+	};
+
+	RenderStateChanges CountStateChanges() const;
+
+	std::vector<TextureSetFunc> TextureSets;
+	PassCallbacks Passes[NumRenderPasses];
+
+	std::vector<DrawCommand> Draws;
+	std::vector<DrawSortItem> Items;
+	std::vector<DrawSortItem> Scratch;
+
+	RenderQueueStats Stats;
+};
@@ -0,0 +1,144 @@
+#include<iostream>
+#include<iomanip>
+#include<algorithm>
+#include<chrono>
+#include<cstdlib>
+#include<cstring>
+#include<string>
+#include<vector>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include "Reprojection.h"
+#include "ThreadPool.h"
+
+//mede a reprojeção na CPU (Reprojection.cpp): equiretangular para cubemap e ida e volta pela Web Mercator,
+//com os dois filtros, no caminho escalar e no SSE2, e confere que os dois dão o mesmo resultado.
+
+//tempo mínimo medido por caso, repete até atingir
+constexpr double MinSeconds = 0.5;
+
+using Clock = std::chrono::steady_clock;
+
+template<typename Func>
+double MeasureSeconds(Func&& Body) {
+	int Iterations = 0;
+	const Clock::time_point Start = Clock::now();
+	double Elapsed = 0.0;
+	do {
+		Body();
+		++Iterations;
+		Elapsed = std::chrono::duration<double>(Clock::now() - Start).count();
+	} while (Elapsed < MinSeconds);
+
+	return Elapsed / Iterations;
+}
+
+size_t CountDifferences(const std::vector<uint8_t>& A, const std::vector<uint8_t>& B) {
+	size_t Count = 0;
+	for (size_t Index = 0; Index < A.size(); ++Index) {
+		Count += A[Index] != B[Index] ? 1 : 0;
+	}
+	return Count;
+}
+
+//diferença média por canal entre a imagem original e a que voltou da Mercator, só nas linhas que a Mercator cobre
+double MeanRoundTripError(const RasterView& Source, const std::vector<uint8_t>& RoundTrip) {
+	const uint32_t Margin = static_cast<uint32_t>(Source.Height * (0.5 - MaxMercatorLatitude / 3.14159265358979)) + 2;
+	const size_t RowBytes = static_cast<size_t>(Source.Width) * Source.Channels;
+	double Sum = 0.0;
+	size_t Count = 0;
+	for (uint32_t Y = Margin; Y + Margin < Source.Height; ++Y) {
+		for (size_t Index = Y * RowBytes; Index < (Y + 1) * RowBytes; ++Index) {
+			Sum += std::abs(static_cast<int>(Source.Pixels[Index]) - static_cast<int>(RoundTrip[Index]));
+			++Count;
+		}
+	}
+	return Count > 0 ? Sum / Count : 0.0;
+}
+
+void PrintBenchmark(const RasterView& Source) {
+	const uint32_t FaceSize = GetCubeFaceSize(Source.Height);
+	const size_t FaceBytes = static_cast<size_t>(FaceSize) * FaceSize * Source.Channels;
+	const size_t CubeTexels = 6 * static_cast<size_t>(FaceSize) * FaceSize;
+	const size_t EquatorTexels = 8 * static_cast<size_t>(FaceSize) * FaceSize;
+	std::cout << "Cubemap: 6 faces de " << FaceSize << "x" << FaceSize << ", " << CubeTexels << " texels contra " << EquatorTexels
+		<< " de uma equiretangular com a mesma resolucao no equador (" << 100 - CubeTexels * 100 / EquatorTexels << "% a menos)" << std::endl;
+
+	std::cout << std::setw(16) << "Caso"
+		<< std::setw(10) << "Filtro"
+		<< std::setw(16) << "Escalar (ms)"
+		<< std::setw(14) << "SSE2 (ms)"
+		<< std::setw(14) << "Mtexel/s"
+		<< std::setw(14) << "Diferencas" << std::endl;
+
+	std::vector<uint8_t> ScalarFaces(6 * FaceBytes), SIMDFaces(6 * FaceBytes);
+	std::vector<uint8_t> Mercator(static_cast<size_t>(Source.Width) * Source.Width * Source.Channels);
+	std::vector<uint8_t> RoundTrip(static_cast<size_t>(Source.Width) * Source.Height * Source.Channels);
+
+	for (ResampleFilter Filter : { ResampleFilter::Bilinear, ResampleFilter::Bicubic }) {
+		uint8_t* const Scalar[6] = { &ScalarFaces[0], &ScalarFaces[FaceBytes], &ScalarFaces[2 * FaceBytes], &ScalarFaces[3 * FaceBytes], &ScalarFaces[4 * FaceBytes], &ScalarFaces[5 * FaceBytes] };
+		uint8_t* const SIMD[6] = { &SIMDFaces[0], &SIMDFaces[FaceBytes], &SIMDFaces[2 * FaceBytes], &SIMDFaces[3 * FaceBytes], &SIMDFaces[4 * FaceBytes], &SIMDFaces[5 * FaceBytes] };
+		const double CubeScalar = MeasureSeconds([&] { ReprojectToCubeMap(Source, FaceSize, Filter, Scalar, false); });
+		const double CubeSIMD = MeasureSeconds([&] { ReprojectToCubeMap(Source, FaceSize, Filter, SIMD, true); });
+		std::cout << std::fixed << std::setprecision(2)
+			<< std::setw(16) << "cubemap"
+			<< std::setw(10) << ToString(Filter)
+			<< std::setw(16) << CubeScalar * 1000.0
+			<< std::setw(14) << CubeSIMD * 1000.0
+			<< std::setw(14) << CubeTexels / CubeSIMD / 1e6
+			<< std::setw(14) << CountDifferences(ScalarFaces, SIMDFaces) << std::endl;
+
+		std::vector<uint8_t> ScalarMercator(Mercator.size());
+		const double MercatorScalar = MeasureSeconds([&] { ReprojectEquirectangularToMercator(Source, Source.Width, Source.Width, Filter, ScalarMercator.data(), false); });
+		const double MercatorSIMD = MeasureSeconds([&] { ReprojectEquirectangularToMercator(Source, Source.Width, Source.Width, Filter, Mercator.data(), true); });
+		std::cout << std::setw(16) << "para mercator"
+			<< std::setw(10) << ToString(Filter)
+			<< std::setw(16) << MercatorScalar * 1000.0
+			<< std::setw(14) << MercatorSIMD * 1000.0
+			<< std::setw(14) << static_cast<double>(Source.Width) * Source.Width / MercatorSIMD / 1e6
+			<< std::setw(14) << CountDifferences(ScalarMercator, Mercator) << std::endl;
+
+		RasterView MercatorView;
+		MercatorView.Pixels = Mercator.data();
+		MercatorView.Width = Source.Width;
+		MercatorView.Height = Source.Width;
+		MercatorView.Channels = Source.Channels;
+		const double BackSeconds = MeasureSeconds([&] { ReprojectMercatorToEquirectangular(MercatorView, Source.Width, Source.Height, Filter, RoundTrip.data(), true); });
+		std::cout << std::setw(16) << "de mercator"
+			<< std::setw(10) << ToString(Filter)
+			<< std::setw(16) << "-"
+			<< std::setw(14) << BackSeconds * 1000.0
+			<< std::setw(14) << static_cast<double>(Source.Width) * Source.Height / BackSeconds / 1e6
+			<< std::setw(14) << "-" << std::endl;
+		std::cout << "  ida e volta: erro medio de " << MeanRoundTripError(Source, RoundTrip) << " por canal ate 85 graus de latitude" << std::endl;
+	}
+
+	std::cout << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+	const char* Path = argc > 1 ? argv[1] : "textures/earth_2k.jpg";
+
+	int Width = 0, Height = 0, NumberOfComponents = 0;
+	stbi_set_flip_vertically_on_load(true);
+	unsigned char* Pixels = stbi_load(Path, &Width, &Height, &NumberOfComponents, 3);
+	if (!Pixels) {
+		std::cerr << "Nao foi possivel carregar " << Path << ": " << stbi_failure_reason() << std::endl;
+		return -1;
+	}
+
+	std::cout << "Threads: " << GetThreadPool().GetNumThreads() << std::endl;
+	std::cout << Path << " " << Width << "x" << Height << std::endl;
+
+	RasterView Source;
+	Source.Pixels = Pixels;
+	Source.Width = static_cast<uint32_t>(Width);
+	Source.Height = static_cast<uint32_t>(Height);
+	Source.Channels = 3;
+	PrintBenchmark(Source);
+
+	stbi_image_free(Pixels);
+	return 0;
+}
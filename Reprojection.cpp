@@ -0,0 +1,234 @@
+#include "Reprojection.h"
+
+#include<algorithm>
+#include<cassert>
+#include<cmath>
+#include<cstring>
+#include<vector>
+
+#include "FastMath.h"
+#include "SphereMesh.h"
+#include "ThreadPool.h"
+
+//como as coordenadas fora da imagem são tratadas em cada eixo
+enum class RasterAddress {
+	Clamp,
+	Repeat
+};
+
+//texels de um eixo usados por uma amostra e os seus pesos
+struct AxisTaps {
+	int Count = 0;
+	size_t Offsets[4] = {};  //em bytes, já multiplicados pelo passo do eixo
+	float Weights[4] = {};
+};
+
+const char* ToString(ResampleFilter Filter) {
+	switch (Filter) {
+	case ResampleFilter::Bilinear: return "bilinear";
+	default: return "bicubic";
+	}
+}
+
+bool ParseResampleFilter(const char* Text, ResampleFilter& OutFilter) {
+	const ResampleFilter Filters[] = { ResampleFilter::Bilinear, ResampleFilter::Bicubic };
+	for (ResampleFilter Filter : Filters) {
+		if (std::strcmp(Text, ToString(Filter)) == 0) {
+			OutFilter = Filter;
+			return true;
+		}
+	}
+	return false;
+}
+
+//Coordinate em texels, com os centros nos inteiros
+static void ComputeTaps(float Coordinate, uint32_t Size, RasterAddress Address, ResampleFilter Filter, size_t Stride, AxisTaps& OutTaps) {
+	const float Base = std::floor(Coordinate);
+	const float T = Coordinate - Base;
+
+	int First = static_cast<int>(Base);
+	if (Filter == ResampleFilter::Bilinear) {
+		OutTaps.Count = 2;
+		OutTaps.Weights[0] = 1.0f - T;
+		OutTaps.Weights[1] = T;
+	}
+	else {
+		OutTaps.Count = 4;
+		OutTaps.Weights[0] = ((-0.5f * T + 1.0f) * T - 0.5f) * T;
+		OutTaps.Weights[1] = (1.5f * T - 2.5f) * T * T + 1.0f;
+		OutTaps.Weights[2] = ((-1.5f * T + 2.0f) * T + 0.5f) * T;
+		OutTaps.Weights[3] = (0.5f * T - 0.5f) * T * T;
+		First -= 1;
+	}
+
+	const int LastIndex = static_cast<int>(Size) - 1;
+	for (int Tap = 0; Tap < OutTaps.Count; ++Tap) {
+		int Index = First + Tap;
+		if (Address == RasterAddress::Repeat) {
+			Index %= static_cast<int>(Size);
+			if (Index < 0) {
+				Index += static_cast<int>(Size);
+			}
+		}
+		else {
+			Index = std::clamp(Index, 0, LastIndex);
+		}
+		OutTaps.Offsets[Tap] = static_cast<size_t>(Index) * Stride;
+	}
+}
+
+//um texel de saída: soma as linhas na horizontal e depois as linhas na vertical.
+//o caminho SSE2 faz as mesmas operações na mesma ordem com os canais lado a lado, então o resultado é idêntico.
+static void SampleTexel(const RasterView& Source, const AxisTaps& TapsX, const AxisTaps& TapsY, bool bSIMD, uint8_t* OutTexel) {
+	const uint32_t Channels = Source.Channels;
+
+#if BLUEMARBLE_SSE2
+	if (bSIMD) {
+		const __m128i Zero = _mm_setzero_si128();
+		__m128 Sum = _mm_setzero_ps();
+		for (int TapY = 0; TapY < TapsY.Count; ++TapY) {
+			const uint8_t* Row = Source.Pixels + TapsY.Offsets[TapY];
+			__m128 RowSum = _mm_setzero_ps();
+			for (int TapX = 0; TapX < TapsX.Count; ++TapX) {
+				uint32_t Packed = 0;
+				std::memcpy(&Packed, Row + TapsX.Offsets[TapX], Channels);
+				const __m128i Texel = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(Packed)), Zero), Zero);
+				RowSum = _mm_add_ps(RowSum, _mm_mul_ps(_mm_set1_ps(TapsX.Weights[TapX]), _mm_cvtepi32_ps(Texel)));
+			}
+			Sum = _mm_add_ps(Sum, _mm_mul_ps(_mm_set1_ps(TapsY.Weights[TapY]), RowSum));
+		}
+
+		//o bicúbico passa de [0, 255] perto de bordas fortes, a saturação do pack corta
+		__m128i Result = _mm_cvttps_epi32(_mm_add_ps(Sum, _mm_set1_ps(0.5f)));
+		Result = _mm_packs_epi32(Result, Result);
+		Result = _mm_packus_epi16(Result, Result);
+		const uint32_t Packed = static_cast<uint32_t>(_mm_cvtsi128_si32(Result));
+		std::memcpy(OutTexel, &Packed, Channels);
+		return;
+	}
+#endif
+
+	for (uint32_t Channel = 0; Channel < Channels; ++Channel) {
+		float Sum = 0.0f;
+		for (int TapY = 0; TapY < TapsY.Count; ++TapY) {
+			const uint8_t* Row = Source.Pixels + TapsY.Offsets[TapY] + Channel;
+			float RowSum = 0.0f;
+			for (int TapX = 0; TapX < TapsX.Count; ++TapX) {
+				RowSum = RowSum + TapsX.Weights[TapX] * static_cast<float>(Row[TapsX.Offsets[TapX]]);
+			}
+			Sum = Sum + TapsY.Weights[TapY] * RowSum;
+		}
+		OutTexel[Channel] = static_cast<uint8_t>(std::clamp(Sum + 0.5f, 0.0f, 255.0f));
+	}
+}
+
+//preenche NumImages imagens OutWidth x OutHeight. MapTexel(Image, X, Y) devolve a posição na origem,
+//em texels com os centros nos inteiros. Os tiles de todas as imagens vão juntos para o pool.
+template<typename MapFunc>
+static void ReprojectTiles(const RasterView& Source, RasterAddress AddressX, RasterAddress AddressY, uint32_t NumImages, uint32_t OutWidth, uint32_t OutHeight,
+	ResampleFilter Filter, uint8_t* const* OutImages, bool bAllowSIMD, const MapFunc& MapTexel) {
+	assert(Source.Channels >= 1 && Source.Channels <= 4);
+	const size_t Channels = Source.Channels;
+	const size_t SourceRowBytes = static_cast<size_t>(Source.Width) * Channels;
+
+	const size_t TilesX = (OutWidth + ReprojectTileSize - 1) / ReprojectTileSize;
+	const size_t TilesY = (OutHeight + ReprojectTileSize - 1) / ReprojectTileSize;
+	const size_t TilesPerImage = TilesX * TilesY;
+
+	ParallelFor(0, TilesPerImage * NumImages, 1, [&](size_t TileBegin, size_t TileEnd) {
+		AxisTaps TapsX, TapsY;
+		for (size_t Tile = TileBegin; Tile < TileEnd; ++Tile) {
+			const uint32_t Image = static_cast<uint32_t>(Tile / TilesPerImage);
+			const uint32_t TileX = static_cast<uint32_t>(Tile % TilesPerImage % TilesX);
+			const uint32_t TileY = static_cast<uint32_t>(Tile % TilesPerImage / TilesX);
+			const uint32_t EndX = std::min(OutWidth, (TileX + 1) * ReprojectTileSize);
+			const uint32_t EndY = std::min(OutHeight, (TileY + 1) * ReprojectTileSize);
+
+			for (uint32_t Y = TileY * ReprojectTileSize; Y < EndY; ++Y) {
+				uint8_t* OutRow = OutImages[Image] + static_cast<size_t>(Y) * OutWidth * Channels;
+				for (uint32_t X = TileX * ReprojectTileSize; X < EndX; ++X) {
+					const glm::vec2 Position = MapTexel(Image, X, Y);
+					ComputeTaps(Position.x, Source.Width, AddressX, Filter, Channels, TapsX);
+					ComputeTaps(Position.y, Source.Height, AddressY, Filter, SourceRowBytes, TapsY);
+					SampleTexel(Source, TapsX, TapsY, bAllowSIMD, OutRow + X * Channels);
+				}
+			}
+		}
+	});
+}
+
+glm::vec3 GetCubeMapDirection(uint32_t FaceIndex, const glm::vec2& FaceST) {
+	//tabela 8.19 da especificação do OpenGL invertida: S = (sc / |ma| + 1) / 2, T = (tc / |ma| + 1) / 2
+	const float S = FaceST.x * 2.0f - 1.0f;
+	const float T = FaceST.y * 2.0f - 1.0f;
+	switch (FaceIndex) {
+	case 0: return glm::vec3{ 1.0f, -T, -S };
+	case 1: return glm::vec3{ -1.0f, -T, S };
+	case 2: return glm::vec3{ S, 1.0f, T };
+	case 3: return glm::vec3{ S, -1.0f, -T };
+	case 4: return glm::vec3{ S, -T, 1.0f };
+	default: return glm::vec3{ -S, -T, -1.0f };
+	}
+}
+
+uint32_t GetCubeFaceSize(uint32_t LongitudeTexels) {
+	return std::max(1u, LongitudeTexels / 4);
+}
+
+void ReprojectToCubeMap(const RasterView& Source, uint32_t FaceSize, ResampleFilter Filter, uint8_t* const OutFaces[6], bool bAllowSIMD) {
+	const float Width = static_cast<float>(Source.Width);
+	const float Height = static_cast<float>(Source.Height);
+	const float InvFaceSize = 1.0f / FaceSize;
+
+	//a latitude para nos polos, a longitude dá a volta
+	ReprojectTiles(Source, RasterAddress::Clamp, RasterAddress::Repeat, 6, FaceSize, FaceSize, Filter, OutFaces, bAllowSIMD, [&](uint32_t Face, uint32_t X, uint32_t Y) {
+		const glm::vec2 FaceST{ (X + 0.5f) * InvFaceSize, (Y + 0.5f) * InvFaceSize };
+		const glm::vec2 UV = EquirectangularUV(glm::normalize(GetCubeMapDirection(Face, FaceST)));
+		return glm::vec2{ UV.x * Width - 0.5f, UV.y * Height - 0.5f };
+	});
+}
+
+//coluna de origem de cada coluna de saída: as duas imagens cobrem a mesma faixa de longitude
+static std::vector<float> MapColumns(uint32_t SourceWidth, uint32_t OutWidth) {
+	std::vector<float> Columns(OutWidth);
+	const float Scale = static_cast<float>(SourceWidth) / OutWidth;
+	for (uint32_t X = 0; X < OutWidth; ++X) {
+		Columns[X] = (X + 0.5f) * Scale - 0.5f;
+	}
+	return Columns;
+}
+
+void ReprojectEquirectangularToMercator(const RasterView& Source, uint32_t OutWidth, uint32_t OutHeight, ResampleFilter Filter, uint8_t* OutPixels, bool bAllowSIMD) {
+	constexpr double Pi = 3.14159265358979323846;
+
+	//as duas direções são separáveis: uma tabela por eixo, a latitude de cada linha calculada em double
+	const std::vector<float> Columns = MapColumns(Source.Width, OutWidth);
+	std::vector<float> Rows(OutHeight);
+	for (uint32_t Y = 0; Y < OutHeight; ++Y) {
+		const double V = (Y + 0.5) / OutHeight;
+		const double Latitude = std::atan(std::sinh(Pi * (1.0 - 2.0 * V)));
+		Rows[Y] = static_cast<float>((0.5 - Latitude / Pi) * Source.Height - 0.5);
+	}
+
+	uint8_t* const OutImages[1] = { OutPixels };
+	ReprojectTiles(Source, RasterAddress::Repeat, RasterAddress::Clamp, 1, OutWidth, OutHeight, Filter, OutImages, bAllowSIMD, [&](uint32_t, uint32_t X, uint32_t Y) {
+		return glm::vec2{ Columns[X], Rows[Y] };
+	});
+}
+
+void ReprojectMercatorToEquirectangular(const RasterView& Source, uint32_t OutWidth, uint32_t OutHeight, ResampleFilter Filter, uint8_t* OutPixels, bool bAllowSIMD) {
+	constexpr double Pi = 3.14159265358979323846;
+
+	const std::vector<float> Columns = MapColumns(Source.Width, OutWidth);
+	std::vector<float> Rows(OutHeight);
+	for (uint32_t Y = 0; Y < OutHeight; ++Y) {
+		const double Latitude = std::clamp(Pi * (0.5 - (Y + 0.5) / OutHeight), -static_cast<double>(MaxMercatorLatitude), static_cast<double>(MaxMercatorLatitude));
+		const double V = 0.5 - std::asinh(std::tan(Latitude)) / (2.0 * Pi);
+		Rows[Y] = static_cast<float>(V * Source.Height - 0.5);
+	}
+
+	uint8_t* const OutImages[1] = { OutPixels };
+	ReprojectTiles(Source, RasterAddress::Repeat, RasterAddress::Clamp, 1, OutWidth, OutHeight, Filter, OutImages, bAllowSIMD, [&](uint32_t, uint32_t X, uint32_t Y) {
+		return glm::vec2{ Columns[X], Rows[Y] };
+	});
+}
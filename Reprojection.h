@@ -0,0 +1,56 @@
+#pragma once
+
+#include<cstddef>
+#include<cstdint>
+
+#include<glm/glm.hpp>
+
+//reprojeção de imagens do planeta na CPU: da equiretangular para as 6 faces de um cubemap e entre a
+//equiretangular e a Web Mercator (EPSG:3857, a dos servidores de tiles). Cada texel de saída é levado para a
+//imagem de origem e amostrado com filtro bilinear ou bicúbico; os canais de um texel vão juntos num registro
+//SSE2 quando disponível e a saída é dividida em tiles quadrados entre as threads do pool.
+//a interpolação é feita nos valores de 8 bits como estão (sRGB), como nas ferramentas de GIS.
+
+enum class ResampleFilter {
+	Bilinear,   //2x2 texels
+	Bicubic     //Catmull-Rom, 4x4 texels, mais nítido (pode passar um pouco dos vizinhos nas bordas fortes)
+};
+
+const char* ToString(ResampleFilter Filter);
+bool ParseResampleFilter(const char* Text, ResampleFilter& OutFilter);
+
+//imagem de 8 bits por canal (1 a 4 canais), linhas contíguas
+struct RasterView {
+	const uint8_t* Pixels = nullptr;
+	uint32_t Width = 0;
+	uint32_t Height = 0;
+	uint32_t Channels = 3;
+};
+
+//lado dos tiles de saída divididos entre as threads
+constexpr uint32_t ReprojectTileSize = 64;
+
+//maior latitude da Web Mercator, onde o mapa fica quadrado: atan(sinh(Pi)), 85,0511 graus
+constexpr float MaxMercatorLatitude = 1.48442223f;
+
+//direção (não normalizada) do texel de uma face na convenção do GL_TEXTURE_CUBE_MAP: faces na ordem
+//+X, -X, +Y, -Y, +Z, -Z e FaceST em [0, 1], com a linha 0 em T = 0
+glm::vec3 GetCubeMapDirection(uint32_t FaceIndex, const glm::vec2& FaceST);
+
+//lado das faces com a mesma resolução angular no equador que LongitudeTexels texels numa volta completa.
+//o cubemap tem 6 * (N / 4)^2 texels contra N * N / 2 da equiretangular: 25% a menos, quase todos
+//tirados dos polos, onde a equiretangular repete o mesmo ponto numa linha inteira.
+uint32_t GetCubeFaceSize(uint32_t LongitudeTexels);
+
+//6 faces FaceSize x FaceSize a partir de uma imagem na convenção das texturas do planeta: U (colunas) é a latitude
+//e V (linhas) a longitude do EquirectangularUV, linhas na ordem do OpenGL. O texel de cada face recebe o que o
+//shader equiretangular mostra na mesma direção, então a Terra fica na mesma posição nos dois caminhos.
+//OutFaces[Face] tem FaceSize * FaceSize * Source.Channels bytes.
+void ReprojectToCubeMap(const RasterView& Source, uint32_t FaceSize, ResampleFilter Filter, uint8_t* const OutFaces[6], bool bAllowSIMD = true);
+
+//conversões entre imagens de mapa comuns: colunas de -180 a 180 graus de longitude e as duas imagens com a mesma
+//ordem de linhas (norte em cima nos arquivos, como os tiles XYZ). A Mercator cobre até MaxMercatorLatitude;
+//na volta, as linhas da equiretangular além dela repetem a última linha da Mercator.
+//OutPixels tem OutWidth * OutHeight * Source.Channels bytes.
+void ReprojectEquirectangularToMercator(const RasterView& Source, uint32_t OutWidth, uint32_t OutHeight, ResampleFilter Filter, uint8_t* OutPixels, bool bAllowSIMD = true);
+void ReprojectMercatorToEquirectangular(const RasterView& Source, uint32_t OutWidth, uint32_t OutHeight, ResampleFilter Filter, uint8_t* OutPixels, bool bAllowSIMD = true);
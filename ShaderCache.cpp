@@ -0,0 +1,118 @@
+#include "ShaderCache.h"
+
+#include<cstring>
+#include<filesystem>
+#include<fstream>
+#include<system_error>
+
+#include "Hash.h"
+
+static const char ProgramFileMagic[4] = { 'B', 'M', 'P', 'B' };
+
+//binários maiores que isso são tratados como arquivo corrompido
+constexpr uint64_t MaxProgramBinaryBytes = 64ull * 1024 * 1024;
+
+bool IsProgramCacheSupported() {
+	if (!GLEW_ARB_get_program_binary) {
+		return false;
+	}
+
+	GLint NumFormats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &NumFormats);
+	return NumFormats > 0;
+}
+
+static uint64_t HashGLString(GLenum Name, uint64_t Hash) {
+	const GLubyte* Text = glGetString(Name);
+	return Text ? HashString(reinterpret_cast<const char*>(Text), Hash) : Hash;
+}
+
+uint64_t GetProgramCacheKey(const std::vector<std::string>& Sources, const std::string& Defines) {
+	uint64_t Key = HashValue(ProgramFileVersion);
+	for (const std::string& Source : Sources) {
+		//o tamanho separa as fontes, "ab" + "c" não colide com "a" + "bc"
+		Key = HashValue(Source.size(), Key);
+		Key = HashString(Source, Key);
+	}
+	Key = HashString(Defines, Key);
+	Key = HashGLString(GL_VENDOR, Key);
+	Key = HashGLString(GL_RENDERER, Key);
+	return HashGLString(GL_VERSION, Key);
+}
+
+std::string GetProgramCachePath(const std::string& Name, uint64_t Key) {
+	return "cache/" + Name + "_" + HashToString(Key) + ".bmprog";
+}
+
+GLuint LoadProgramBinary(const std::string& Path, uint64_t Key, uint64_t& OutBuildMicroseconds) {
+	std::ifstream Stream{ Path, std::ios::binary };
+	if (!Stream) {
+		return 0;
+	}
+
+	ProgramFileHeader Header{};
+	if (!Stream.read(reinterpret_cast<char*>(&Header), sizeof(Header))
+		|| std::memcmp(Header.Magic, ProgramFileMagic, sizeof(ProgramFileMagic)) != 0
+		|| Header.Version != ProgramFileVersion
+		|| Header.Key != Key
+		|| Header.BinaryBytes == 0
+		|| Header.BinaryBytes > MaxProgramBinaryBytes) {
+		return 0;
+	}
+
+	std::vector<char> Binary(static_cast<size_t>(Header.BinaryBytes));
+	if (!Stream.read(Binary.data(), static_cast<std::streamsize>(Binary.size()))) {
+		return 0;
+	}
+
+	//o driver recusa com GL_LINK_STATUS falso, sem erro do OpenGL
+	GLuint ProgramID = glCreateProgram();
+	glProgramBinary(ProgramID, Header.BinaryFormat, Binary.data(), static_cast<GLsizei>(Binary.size()));
+
+	GLint Result = GL_FALSE;
+	glGetProgramiv(ProgramID, GL_LINK_STATUS, &Result);
+	if (Result == GL_FALSE) {
+		glDeleteProgram(ProgramID);
+		return 0;
+	}
+
+	OutBuildMicroseconds = Header.BuildMicroseconds;
+	return ProgramID;
+}
+
+bool SaveProgramBinary(const std::string& Path, uint64_t Key, GLuint Program, uint64_t BuildMicroseconds) {
+	GLint BinaryLength = 0;
+	glGetProgramiv(Program, GL_PROGRAM_BINARY_LENGTH, &BinaryLength);
+	if (BinaryLength <= 0) {
+		return false;
+	}
+
+	std::vector<char> Binary(static_cast<size_t>(BinaryLength));
+	GLsizei Length = 0;
+	GLenum BinaryFormat = 0;
+	glGetProgramBinary(Program, BinaryLength, &Length, &BinaryFormat, Binary.data());
+	if (Length <= 0) {
+		return false;
+	}
+
+	ProgramFileHeader Header{};
+	std::memcpy(Header.Magic, ProgramFileMagic, sizeof(ProgramFileMagic));
+	Header.Version = ProgramFileVersion;
+	Header.Key = Key;
+	Header.BinaryFormat = BinaryFormat;
+	Header.BinaryBytes = static_cast<uint64_t>(Length);
+	Header.BuildMicroseconds = BuildMicroseconds;
+
+	std::error_code Error;
+	std::filesystem::create_directories(std::filesystem::path(Path).parent_path(), Error);
+	{
+		std::ofstream Stream{ Path + ".tmp", std::ios::binary | std::ios::trunc };
+		if (!Stream.write(reinterpret_cast<const char*>(&Header), sizeof(Header))
+			|| !Stream.write(Binary.data(), Length)) {
+			return false;
+		}
+	}
+
+	std::filesystem::rename(Path + ".tmp", Path, Error);
+	return !Error;
+}
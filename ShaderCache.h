@@ -0,0 +1,42 @@
+#pragma once
+
+#include<cstddef>
+#include<cstdint>
+#include<string>
+#include<vector>
+
+#include<GL/glew.h>
+
+//cache de programas linkados: o binário do glGetProgramBinary vai para um arquivo na pasta cache e nas execuções
+//seguintes volta com glProgramBinary, sem compilar nem linkar. O driver pode recusar o binário (outra versão,
+//outra GPU); nesse caso o programa é compilado de novo e o arquivo regravado.
+//mudar o cabeçalho exige incrementar ProgramFileVersion.
+constexpr uint32_t ProgramFileVersion = 1;
+
+struct ProgramFileHeader {
+	char Magic[4];                 //"BMPB"
+	uint32_t Version;
+	uint64_t Key;                  //GetProgramCacheKey
+	uint32_t BinaryFormat;         //devolvido pelo glGetProgramBinary
+	uint32_t Reserved;
+	uint64_t BinaryBytes;          //o binário vem logo depois do cabeçalho
+	uint64_t BuildMicroseconds;    //tempo de compilar e linkar quando o arquivo foi gravado
+};
+
+//o driver tem ARB_get_program_binary e pelo menos um formato de binário
+bool IsProgramCacheSupported();
+
+//chave do programa: fontes de todos os estágios, defines injetados e GL_VENDOR, GL_RENDERER e GL_VERSION,
+//porque um binário só vale para o driver que o gerou
+uint64_t GetProgramCacheKey(const std::vector<std::string>& Sources, const std::string& Defines = std::string{});
+
+//caminho do arquivo para um nome de programa e chave
+std::string GetProgramCachePath(const std::string& Name, uint64_t Key);
+
+//cria um programa a partir do arquivo. 0 quando o arquivo não existe, não confere com a chave ou o driver
+//não linka o binário. OutBuildMicroseconds recebe o tempo de compilação guardado no arquivo.
+GLuint LoadProgramBinary(const std::string& Path, uint64_t Key, uint64_t& OutBuildMicroseconds);
+
+//grava o binário de um programa já linkado (via Path + ".tmp"). O programa precisa ter sido linkado
+//com GL_PROGRAM_BINARY_RETRIEVABLE_HINT.
+bool SaveProgramBinary(const std::string& Path, uint64_t Key, GLuint Program, uint64_t BuildMicroseconds);
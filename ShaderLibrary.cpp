@@ -0,0 +1,369 @@
+#include "ShaderLibrary.h"
+
+#include<algorithm>
+#include<cctype>
+#include<filesystem>
+#include<iostream>
+
+#include "GLState.h"
+#include "Profiler.h"
+#include "ShaderCache.h"
+
+//o observador devolve "shaders/x.glsl" e os programas podem ter sido carregados com "./shaders/x.glsl"
+static std::string NormalizePath(const std::string& Path) {
+	return std::filesystem::path(Path).lexically_normal().generic_string();
+}
+
+//nome inteiro, não parte de outro identificador
+static bool ContainsIdentifier(const std::string& Source, const std::string& Name) {
+	const auto IsIdentifierChar = [](char C) { return std::isalnum(static_cast<unsigned char>(C)) || C == '_'; };
+	for (size_t Position = Source.find(Name); Position != std::string::npos; Position = Source.find(Name, Position + 1)) {
+		const size_t End = Position + Name.size();
+		if ((Position == 0 || !IsIdentifierChar(Source[Position - 1])) && (End == Source.size() || !IsIdentifierChar(Source[End]))) {
+			return true;
+		}
+	}
+	return false;
+}
+
+//os logs do driver identificam o arquivo pelo número de fonte do #line
+static void PrintSourceFiles(const std::vector<std::string>& Files) {
+	if (Files.size() > 1) {
+		for (size_t Index = 0; Index < Files.size(); ++Index) {
+			std::cout << "  fonte " << Index << ": " << Files[Index] << std::endl;
+		}
+	}
+}
+
+bool CheckShader(GLuint ShaderID, const std::string& Name) {
+	//ShaderID tem que ser um identificador de um shader já compilado
+	GLint Result = GL_TRUE;
+	glGetShaderiv(ShaderID, GL_COMPILE_STATUS, &Result);
+
+	if (Result == GL_FALSE) {
+		//obtém o tamanho do log
+		GLint InfoLogLenght = 0;
+		glGetShaderiv(ShaderID, GL_INFO_LOG_LENGTH, &InfoLogLenght);
+
+		std::string ShaderInfoLog(std::max(InfoLogLenght, 0), '\0');
+		if (InfoLogLenght > 0) {
+			glGetShaderInfoLog(ShaderID, InfoLogLenght, nullptr, &ShaderInfoLog[0]);
+		}
+
+		std::cout << "Erro no shader " << Name << std::endl;
+		std::cout << ShaderInfoLog << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool CheckProgram(GLuint ProgramID, const std::string& Name) {
+	//verifica a linkagem
+	GLint Result = GL_TRUE;
+	glGetProgramiv(ProgramID, GL_LINK_STATUS, &Result);
+
+	if (Result == GL_FALSE) {
+		//pega o log para saber qual é o problema
+		GLint InfoLogLenght = 0;
+		glGetProgramiv(ProgramID, GL_INFO_LOG_LENGTH, &InfoLogLenght);
+
+		std::string ProgramInfoLog(std::max(InfoLogLenght, 0), '\0');
+		if (InfoLogLenght > 0) {
+			glGetProgramInfoLog(ProgramID, InfoLogLenght, nullptr, &ProgramInfoLog[0]);
+		}
+
+		std::cout << "Erro ao linkar o programa " << Name << std::endl;
+		std::cout << ProgramInfoLog << std::endl;
+		return false;
+	}
+	return true;
+}
+
+ShaderHandle ShaderLibrary::Load(const std::string& VertexShaderFile, const std::string& FragmentShaderFile, const ShaderDefines& Defines) {
+	const std::string DefinesKey = GetDefinesKey(Defines);
+	const std::string VariantKey = NormalizePath(VertexShaderFile) + "|" + NormalizePath(FragmentShaderFile) + "|" + DefinesKey;
+	auto Found = Variants.find(VariantKey);
+	if (Found != Variants.end()) {
+		return Found->second;
+	}
+
+	ShaderProgram Entry;
+	Entry.VertexShaderFile = VertexShaderFile;
+	Entry.FragmentShaderFile = FragmentShaderFile;
+	Entry.Defines = NormalizeDefines(Defines);
+	Entry.Name = VertexShaderFile + " + " + FragmentShaderFile + (DefinesKey.empty() ? "" : " [" + DefinesKey + "]");
+	Programs.push_back(std::move(Entry));
+
+	Variants.emplace(VariantKey, Programs.size() - 1);
+	return Programs.size() - 1;
+}
+
+GLuint ShaderLibrary::GetProgram(ShaderHandle Handle) {
+	if (Handle >= Programs.size()) {
+		return 0;
+	}
+
+	//o primeiro pedido espera o driver (as consultas de status do FinishBuild), como na inicialização;
+	//uma variante com erro não é tentada de novo a cada frame, só quando um dos arquivos mudar
+	ShaderProgram& Entry = Programs[Handle];
+	if (!Entry.bRequested) {
+		Entry.bRequested = true;
+		if (StartBuild(Entry)) {
+			FinishBuild(Entry);
+		}
+	}
+	return Entry.Program;
+}
+
+GLint ShaderLibrary::GetUniformLocation(ShaderHandle Handle, const std::string& Name) {
+	if (Handle >= Programs.size()) {
+		return -1;
+	}
+
+	ShaderProgram& Entry = Programs[Handle];
+	if (const UniformInfo* Uniform = Entry.Reflection.FindUniform(Name)) {
+		return Uniform->Location;
+	}
+
+	//inativo é normal (recurso fora da variante, ou descartado pelo driver); ausente dos arquivos é erro de digitação
+	if (Entry.Program != 0 && !ContainsIdentifier(Entry.Sources, Name)
+		&& std::find(Entry.UnknownUniforms.begin(), Entry.UnknownUniforms.end(), Name) == Entry.UnknownUniforms.end()) {
+		std::cout << "Uniform " << Name << " nao existe em " << Entry.Name << std::endl;
+		Entry.UnknownUniforms.push_back(Name);
+	}
+	return -1;
+}
+
+const ProgramReflection& ShaderLibrary::GetReflection(ShaderHandle Handle) const {
+	static const ProgramReflection Empty;
+	return Handle < Programs.size() ? Programs[Handle].Reflection : Empty;
+}
+
+void ShaderLibrary::SetUniformBlock(const std::string& Name, GLuint Binding, size_t Size, const std::vector<UniformBlockMember>& Members) {
+	UniformBlockBinding Block;
+	Block.Name = Name;
+	Block.Binding = Binding;
+	Block.Size = Size;
+	Block.Members = Members;
+	UniformBlocks.push_back(std::move(Block));
+
+	for (ShaderProgram& Entry : Programs) {
+		if (Entry.Program != 0) {
+			BindUniformBlocks(Entry);
+		}
+	}
+}
+
+void ShaderLibrary::BindUniformBlocks(ShaderProgram& Entry) const {
+	for (const UniformBlockBinding& Block : UniformBlocks) {
+		if (const UniformBlockInfo* Info = Entry.Reflection.FindBlock(Block.Name)) {
+			glUniformBlockBinding(Entry.Program, Info->Index, Block.Binding);
+			Entry.Reflection.CheckBlock(Block.Name, Block.Size, Block.Members, Entry.Name);
+		}
+	}
+}
+
+bool ShaderLibrary::WatchDirectory(const std::string& Directory) {
+	if (!Watcher.Watch(Directory)) {
+		std::cout << "Nao foi possivel observar a pasta " << Directory << std::endl;
+		return false;
+	}
+
+	//todas as threads que o driver quiser; o padrão da extensão pode ser compilar na thread que chama
+	if (GLEW_KHR_parallel_shader_compile) {
+		glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+		bParallelCompile = true;
+	}
+	else if (GLEW_ARB_parallel_shader_compile) {
+		glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+		bParallelCompile = true;
+	}
+
+	std::cout << "Observando " << Directory << ": shaders gravados sao recompilados "
+		<< (bParallelCompile ? "em paralelo pelo driver" : "no frame seguinte") << std::endl;
+	return true;
+}
+
+bool ShaderLibrary::StartBuild(ShaderProgram& Entry) {
+	const Clock::time_point Start = Clock::now();
+	PreprocessedShader Vertex;
+	PreprocessedShader Fragment;
+	const bool bVertexRead = PreprocessShader(Entry.VertexShaderFile, Entry.Defines, Vertex);
+	const bool bFragmentRead = PreprocessShader(Entry.FragmentShaderFile, Entry.Defines, Fragment);
+
+	//mesmo sem conseguir ler, os arquivos visitados passam a ser observados e a gravação deles tenta de novo
+	Entry.Dependencies.clear();
+	for (const std::vector<std::string>* Files : { &Vertex.Files, &Fragment.Files }) {
+		for (const std::string& File : *Files) {
+			const std::string Normalized = NormalizePath(File);
+			if (std::find(Entry.Dependencies.begin(), Entry.Dependencies.end(), Normalized) == Entry.Dependencies.end()) {
+				Entry.Dependencies.push_back(Normalized);
+			}
+		}
+	}
+	if (!bVertexRead || !bFragmentRead) {
+		return false;
+	}
+
+	const std::string& VertexShaderSource = Vertex.Source;
+	const std::string& FragmentShaderSource = Fragment.Source;
+
+	ProgramBuild& Build = Entry.Pending;
+	Build = ProgramBuild{};
+	Build.Start = Start;
+	Build.VertexFiles = std::move(Vertex.Files);
+	Build.FragmentFiles = std::move(Fragment.Files);
+	Build.Sources = VertexShaderSource + FragmentShaderSource;
+
+	//a chave inclui o driver: trocar de GPU ou atualizar o driver compila de novo
+	const bool bCache = bProgramCache && IsProgramCacheSupported();
+	if (bCache) {
+		Build.Key = GetProgramCacheKey({ VertexShaderSource, FragmentShaderSource }, GetDefinesKey(Entry.Defines));
+		Build.CachePath = GetProgramCachePath(std::filesystem::path(Entry.VertexShaderFile).stem().string() + "_"
+			+ std::filesystem::path(Entry.FragmentShaderFile).stem().string(), Build.Key);
+
+		Build.Program = LoadProgramBinary(Build.CachePath, Build.Key, Build.CachedBuildMicroseconds);
+		if (Build.Program != 0) {
+			Build.bFromCache = true;
+			return true;
+		}
+	}
+
+	std::cout << "Compilando " << Entry.Name << std::endl;
+	const char* VertexShaderSourcePtr = VertexShaderSource.c_str();
+	Build.VertexShader = glCreateShader(GL_VERTEX_SHADER);
+	glShaderSource(Build.VertexShader, 1, &VertexShaderSourcePtr, nullptr);
+	glCompileShader(Build.VertexShader);
+
+	const char* FragmentShaderSourcePtr = FragmentShaderSource.c_str();
+	Build.FragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+	glShaderSource(Build.FragmentShader, 1, &FragmentShaderSourcePtr, nullptr);
+	glCompileShader(Build.FragmentShader);
+
+	//com compilação paralela nada aqui espera: o status só é consultado quando o programa terminar
+	Build.Program = glCreateProgram();
+	glAttachShader(Build.Program, Build.VertexShader);
+	glAttachShader(Build.Program, Build.FragmentShader);
+	if (bCache) {
+		glProgramParameteri(Build.Program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
+	glLinkProgram(Build.Program);
+	return true;
+}
+
+bool ShaderLibrary::IsBuildComplete(const ProgramBuild& Build) const {
+	if (!bParallelCompile || Build.bFromCache) {
+		return true;
+	}
+
+	GLint bComplete = GL_FALSE;
+	glGetProgramiv(Build.Program, GL_COMPLETION_STATUS_KHR, &bComplete);
+	return bComplete != GL_FALSE;
+}
+
+bool ShaderLibrary::FinishBuild(ShaderProgram& Entry) {
+	ProgramBuild Build = std::move(Entry.Pending);
+	Entry.Pending = ProgramBuild{};
+
+	if (Build.bFromCache) {
+		const double Milliseconds = std::chrono::duration<double, std::milli>(Clock::now() - Build.Start).count();
+		std::cout << "Programa " << Entry.Name << " lido do cache em " << Milliseconds << " ms (compilar levou "
+			<< Build.CachedBuildMicroseconds / 1000.0 << " ms, " << std::max(0.0, Build.CachedBuildMicroseconds / 1000.0 - Milliseconds) << " ms economizados)" << std::endl;
+	}
+	else {
+		//os dois logs de compilação aparecem; o de linkagem só se os dois compilaram
+		const bool bVertexCompiled = CheckShader(Build.VertexShader, Entry.VertexShaderFile);
+		if (!bVertexCompiled) {
+			PrintSourceFiles(Build.VertexFiles);
+		}
+		const bool bFragmentCompiled = CheckShader(Build.FragmentShader, Entry.FragmentShaderFile);
+		if (!bFragmentCompiled) {
+			PrintSourceFiles(Build.FragmentFiles);
+		}
+		const bool bLinked = bVertexCompiled && bFragmentCompiled && CheckProgram(Build.Program, Entry.Name);
+
+		glDetachShader(Build.Program, Build.VertexShader);
+		glDetachShader(Build.Program, Build.FragmentShader);
+		glDeleteShader(Build.VertexShader);
+		glDeleteShader(Build.FragmentShader);
+
+		if (!bLinked) {
+			GetGLState().DeleteProgram(Build.Program);
+			if (Entry.Program != 0) {
+				std::cout << "Programa " << Entry.Name << " mantido na versao anterior" << std::endl;
+			}
+			return false;
+		}
+
+		//o GL_LINK_STATUS acima já esperou o driver terminar
+		const double Milliseconds = std::chrono::duration<double, std::milli>(Clock::now() - Build.Start).count();
+		std::cout << "Programa " << Entry.Name << " compilado em " << Milliseconds << " ms" << std::endl;
+		if (!Build.CachePath.empty() && !SaveProgramBinary(Build.CachePath, Build.Key, Build.Program, static_cast<uint64_t>(Milliseconds * 1000.0))) {
+			std::cout << "Nao foi possivel gravar " << Build.CachePath << std::endl;
+		}
+	}
+
+	//a troca: o frame seguinte pega o programa novo no GetProgram
+	if (Entry.Program != 0) {
+		GetGLState().DeleteProgram(Entry.Program);
+	}
+	Entry.Program = Build.Program;
+	Entry.Sources = std::move(Build.Sources);
+	Entry.UnknownUniforms.clear();
+	Entry.Reflection.Reflect(Entry.Program);
+	BindUniformBlocks(Entry);
+	return true;
+}
+
+void ShaderLibrary::Update() {
+	PROFILE_SCOPE("ShaderLibrary::Update");
+	if (Watcher.IsWatching()) {
+		Watcher.Poll(ChangedFiles);
+		for (const std::string& ChangedFile : ChangedFiles) {
+			const std::string Changed = NormalizePath(ChangedFile);
+			for (ShaderProgram& Entry : Programs) {
+				//variantes ainda não pedidas leem os arquivos novos quando forem compiladas
+				if (!Entry.bRequested || std::find(Entry.Dependencies.begin(), Entry.Dependencies.end(), Changed) == Entry.Dependencies.end()) {
+					continue;
+				}
+
+				//uma compilação por programa de cada vez; a versão mais nova entra quando a atual terminar
+				if (Entry.Pending.Program != 0) {
+					Entry.bReloadQueued = true;
+				}
+				else {
+					StartBuild(Entry);
+				}
+			}
+		}
+	}
+
+	for (ShaderProgram& Entry : Programs) {
+		if (Entry.Pending.Program == 0 || !IsBuildComplete(Entry.Pending)) {
+			continue;
+		}
+
+		FinishBuild(Entry);
+		if (Entry.bReloadQueued) {
+			Entry.bReloadQueued = false;
+			StartBuild(Entry);
+		}
+	}
+}
+
+void ShaderLibrary::Shutdown() {
+	Watcher.Stop();
+	for (ShaderProgram& Entry : Programs) {
+		if (Entry.Pending.Program != 0) {
+			glDeleteShader(Entry.Pending.VertexShader);
+			glDeleteShader(Entry.Pending.FragmentShader);
+			GetGLState().DeleteProgram(Entry.Pending.Program);
+			Entry.Pending = ProgramBuild{};
+		}
+		if (Entry.Program != 0) {
+			GetGLState().DeleteProgram(Entry.Program);
+			Entry.Program = 0;
+			Entry.Reflection.Clear();
+		}
+	}
+}
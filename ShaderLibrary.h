@@ -0,0 +1,127 @@
+#pragma once
+
+#include<chrono>
+#include<cstddef>
+#include<cstdint>
+#include<string>
+#include<unordered_map>
+#include<vector>
+
+#include<GL/glew.h>
+
+#include "FileWatcher.h"
+#include "ShaderPreprocessor.h"
+#include "ShaderReflection.h"
+
+//programas de shader do aplicativo, carregados pelos arquivos GLSL e recarregados quando eles mudam.
+//a recompilação não trava o frame: com KHR_parallel_shader_compile (ou o ARB) o driver compila em threads
+//próprias e o Update só pergunta se terminou; sem a extensão a compilação acontece no Update do frame da mudança.
+//o programa novo só entra no lugar do antigo depois de linkar sem erro, então um erro de digitação no shader
+//mostra o log e o frame continua com a versão anterior.
+//os programas linkados vão para o cache de binários (ShaderCache.h) e as próximas execuções pulam a compilação.
+//cada combinação de arquivos e defines é uma variante (ShaderPreprocessor.h), compilada só no primeiro GetProgram:
+//as permutações que nenhum modo pede nunca passam pelo driver.
+//cada linkagem lê os uniforms ativos uma vez (ShaderReflection.h): as localizações saem daqui, sem consultar o driver,
+//e um nome que não existe em nenhum arquivo do programa é avisado no primeiro pedido em vez de ser ignorado.
+
+using ShaderHandle = size_t;
+constexpr ShaderHandle InvalidShader = static_cast<ShaderHandle>(-1);
+
+//mostra o log de compilação e devolve false se o shader tem erro
+bool CheckShader(GLuint ShaderID, const std::string& Name);
+
+//mostra o log de linkagem e devolve false se o programa tem erro
+bool CheckProgram(GLuint ProgramID, const std::string& Name);
+
+class ShaderLibrary {
+public:
+	explicit ShaderLibrary(bool bNewProgramCache = true) : bProgramCache(bNewProgramCache) {}
+
+	ShaderLibrary(const ShaderLibrary&) = delete;
+	ShaderLibrary& operator=(const ShaderLibrary&) = delete;
+
+	//registra a variante sem compilar; os mesmos arquivos com os mesmos defines devolvem o mesmo handle
+	ShaderHandle Load(const std::string& VertexShaderFile, const std::string& FragmentShaderFile, const ShaderDefines& Defines = {});
+
+	//programa atual, muda depois de um recarregamento. O primeiro pedido de cada variante compila e linka
+	//na hora (ou lê do cache); com erro o programa fica 0 até o arquivo ser corrigido.
+	GLuint GetProgram(ShaderHandle Handle);
+
+	//localização pela reflexão do programa atual. -1 se o uniform não está ativo; se o nome nem aparece nos arquivos
+	//do programa (erro de digitação) o console avisa uma vez.
+	GLint GetUniformLocation(ShaderHandle Handle, const std::string& Name);
+
+	//uniforms do programa atual, vazio enquanto ele não linkou
+	const ProgramReflection& GetReflection(ShaderHandle Handle) const;
+
+	//liga o bloco de uniforms ao ponto de ligação em todos os programas que o usam, inclusive os que linkarem depois,
+	//e confere o layout do bloco com a struct do C++ (tamanho e offset de cada membro)
+	void SetUniformBlock(const std::string& Name, GLuint Binding, size_t Size, const std::vector<UniformBlockMember>& Members);
+
+	//passa a recompilar os programas que usam arquivos da pasta, incluídos ou não, quando eles são gravados
+	bool WatchDirectory(const std::string& Directory);
+
+	//uma vez por frame: começa as recompilações pedidas pelo observador e troca as que terminaram
+	void Update();
+
+	//libera os programas, com o contexto ainda ativo
+	void Shutdown();
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	//compilação em andamento de um programa, ainda não conferida
+	struct ProgramBuild {
+		GLuint Program = 0;
+		GLuint VertexShader = 0;
+		GLuint FragmentShader = 0;
+		uint64_t Key = 0;
+		std::string CachePath;
+		Clock::time_point Start;
+		bool bFromCache = false;           //lido do cache de binários, já linkado
+		uint64_t CachedBuildMicroseconds = 0;
+		std::vector<std::string> VertexFiles;      //números de fonte dos logs de compilação
+		std::vector<std::string> FragmentFiles;
+		std::string Sources;                       //os dois estágios pré-processados, para conferir nomes de uniform
+	};
+
+	struct UniformBlockBinding {
+		std::string Name;
+		GLuint Binding = 0;
+		size_t Size = 0;
+		std::vector<UniformBlockMember> Members;
+	};
+
+	struct ShaderProgram {
+		std::string VertexShaderFile;
+		std::string FragmentShaderFile;
+		ShaderDefines Defines;
+		std::string Name;
+		std::vector<std::string> Dependencies;   //arquivos dos dois estágios, com os incluídos
+		GLuint Program = 0;
+		ProgramReflection Reflection;
+		std::string Sources;
+		std::vector<std::string> UnknownUniforms;   //já avisados
+		ProgramBuild Pending;            //Program 0 quando não há compilação em andamento
+		bool bRequested = false;         //já passou pelo GetProgram; as outras variantes não recompilam
+		bool bReloadQueued = false;      //o arquivo mudou durante a compilação
+	};
+
+	//pré-processa os arquivos e manda compilar e linkar, sem esperar. false se algum arquivo não pôde ser lido.
+	bool StartBuild(ShaderProgram& Entry);
+	bool IsBuildComplete(const ProgramBuild& Build) const;
+
+	//confere a compilação; com sucesso o programa novo substitui o atual
+	bool FinishBuild(ShaderProgram& Entry);
+
+	//o glProgramBinary e a linkagem voltam os blocos para o ponto 0, então a ligação acontece a cada troca
+	void BindUniformBlocks(ShaderProgram& Entry) const;
+
+	std::vector<ShaderProgram> Programs;
+	std::unordered_map<std::string, ShaderHandle> Variants;   //arquivos e defines normalizados para o handle
+	std::vector<UniformBlockBinding> UniformBlocks;
+	FileWatcher Watcher;
+	std::vector<std::string> ChangedFiles;
+	bool bProgramCache = true;
+	bool bParallelCompile = false;
+};
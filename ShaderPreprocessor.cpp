@@ -0,0 +1,129 @@
+#include "ShaderPreprocessor.h"
+
+#include<algorithm>
+#include<cassert>
+#include<cctype>
+#include<filesystem>
+#include<fstream>
+#include<iostream>
+
+static bool IsDirective(const std::string& Line, const char* Directive, size_t& OutEnd) {
+	size_t Position = Line.find_first_not_of(" \t");
+	if (Position == std::string::npos || Line[Position] != '#') {
+		return false;
+	}
+
+	//o pré-processador aceita espaços entre o # e a diretiva
+	Position = Line.find_first_not_of(" \t", Position + 1);
+	const size_t Length = std::char_traits<char>::length(Directive);
+	if (Position == std::string::npos || Line.compare(Position, Length, Directive) != 0) {
+		return false;
+	}
+
+	OutEnd = Position + Length;
+	return OutEnd == Line.size() || Line[OutEnd] == ' ' || Line[OutEnd] == '\t';
+}
+
+//#include "arquivo"; a forma com <> não tem sentido sem caminhos de busca
+static bool ParseInclude(const std::string& Line, std::string& OutName) {
+	size_t End = 0;
+	if (!IsDirective(Line, "include", End)) {
+		return false;
+	}
+
+	const size_t Open = Line.find('"', End);
+	const size_t Close = Open == std::string::npos ? std::string::npos : Line.find('"', Open + 1);
+	if (Close == std::string::npos || Close == Open + 1) {
+		return false;
+	}
+
+	OutName = Line.substr(Open + 1, Close - Open - 1);
+	return true;
+}
+
+static std::string GetDefineLine(const std::string& Define) {
+	const size_t Equals = Define.find('=');
+	const std::string Name = Define.substr(0, Equals);
+	assert(!Name.empty() && !std::isdigit(static_cast<unsigned char>(Name[0])));
+	assert(std::all_of(Name.begin(), Name.end(), [](char C) { return std::isalnum(static_cast<unsigned char>(C)) || C == '_'; }));
+
+	return "#define " + Name + " " + (Equals == std::string::npos ? std::string{ "1" } : Define.substr(Equals + 1)) + "\n";
+}
+
+ShaderDefines NormalizeDefines(const ShaderDefines& Defines) {
+	ShaderDefines Normalized = Defines;
+	std::sort(Normalized.begin(), Normalized.end());
+	Normalized.erase(std::unique(Normalized.begin(), Normalized.end()), Normalized.end());
+	return Normalized;
+}
+
+std::string GetDefinesKey(const ShaderDefines& Defines) {
+	std::string Key;
+	for (const std::string& Define : NormalizeDefines(Defines)) {
+		Key += Key.empty() ? Define : " " + Define;
+	}
+	return Key;
+}
+
+static bool AppendFile(const std::filesystem::path& File, const ShaderDefines& Defines, PreprocessedShader& Out) {
+	const std::string SourceIndex = std::to_string(Out.Files.size());
+	const bool bMainFile = Out.Files.empty();
+	Out.Files.push_back(File.generic_string());
+
+	std::ifstream Stream{ File };
+	if (!Stream) {
+		std::cout << "Nao foi possivel ler " << File.generic_string() << std::endl;
+		return false;
+	}
+
+	std::string Line;
+	int LineNumber = 0;
+	bool bDefinesInjected = !bMainFile;
+	while (std::getline(Stream, Line)) {
+		++LineNumber;
+		if (!Line.empty() && Line.back() == '\r') {
+			Line.pop_back();
+		}
+
+		std::string IncludeName;
+		if (ParseInclude(Line, IncludeName)) {
+			const std::filesystem::path Included = (File.parent_path() / IncludeName).lexically_normal();
+			if (std::find(Out.Files.begin(), Out.Files.end(), Included.generic_string()) == Out.Files.end()) {
+				Out.Source += "#line 1 " + std::to_string(Out.Files.size()) + "\n";
+				if (!AppendFile(Included, Defines, Out)) {
+					return false;
+				}
+			}
+			Out.Source += "#line " + std::to_string(LineNumber + 1) + " " + SourceIndex + "\n";
+			continue;
+		}
+
+		Out.Source += Line;
+		Out.Source += '\n';
+
+		//o #version tem que ser a primeira diretiva, os defines vêm logo depois dele
+		size_t End = 0;
+		if (!bDefinesInjected && IsDirective(Line, "version", End)) {
+			for (const std::string& Define : Defines) {
+				Out.Source += GetDefineLine(Define);
+			}
+			Out.Source += "#line " + std::to_string(LineNumber + 1) + " 0\n";
+			bDefinesInjected = true;
+		}
+	}
+
+	//sem #version os defines vão para o começo, o driver reclama do #version de qualquer jeito
+	if (!bDefinesInjected && !Defines.empty()) {
+		std::string Header;
+		for (const std::string& Define : Defines) {
+			Header += GetDefineLine(Define);
+		}
+		Out.Source = Header + "#line 1 0\n" + Out.Source;
+	}
+	return true;
+}
+
+bool PreprocessShader(const std::string& File, const ShaderDefines& Defines, PreprocessedShader& OutShader) {
+	OutShader = PreprocessedShader{};
+	return AppendFile(std::filesystem::path(File).lexically_normal(), NormalizeDefines(Defines), OutShader);
+}
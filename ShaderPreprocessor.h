@@ -0,0 +1,27 @@
+#pragma once
+
+#include<string>
+#include<vector>
+
+//variantes de shader: o mesmo arquivo GLSL compilado com feature flags diferentes. Cada flag vira um #define
+//injetado logo depois do #version, e os #ifdef do shader tiram o que não foi pedido na compilação,
+//sem desvio no shader. Os #include "arquivo" são resolvidos aqui porque o GLSL não tem include.
+
+//"NOME" vira "#define NOME 1" e "NOME=VALOR" vira "#define NOME VALOR"
+using ShaderDefines = std::vector<std::string>;
+
+//ordenados e sem repetição: a mesma variante tem os mesmos defines em qualquer ordem
+ShaderDefines NormalizeDefines(const ShaderDefines& Defines);
+
+//defines normalizados separados por espaço, vazio sem defines. Identifica a variante e entra na chave do cache de programas.
+std::string GetDefinesKey(const ShaderDefines& Defines);
+
+struct PreprocessedShader {
+	std::string Source;
+	std::vector<std::string> Files;   //o índice é o número de fonte dos #line (0 é o arquivo principal)
+};
+
+//lê o arquivo, resolve os #include relativos a quem inclui (cada arquivo entra uma vez, os #ifdef não são avaliados)
+//e injeta os defines. Os #line mantêm arquivo e linha nos logs do driver.
+//false se algum arquivo não pôde ser lido; OutShader.Files tem os arquivos visitados até o erro, inclusive o que falhou.
+bool PreprocessShader(const std::string& File, const ShaderDefines& Defines, PreprocessedShader& OutShader);
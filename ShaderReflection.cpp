@@ -0,0 +1,115 @@
+#include "ShaderReflection.h"
+
+#include<algorithm>
+#include<iostream>
+
+void ProgramReflection::Clear() {
+	Uniforms.clear();
+	Blocks.clear();
+	UniformIndices.clear();
+}
+
+void ProgramReflection::Reflect(GLuint Program) {
+	Clear();
+
+	GLint NumUniforms = 0;
+	GLint MaxNameLength = 0;
+	glGetProgramiv(Program, GL_ACTIVE_UNIFORMS, &NumUniforms);
+	glGetProgramiv(Program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &MaxNameLength);
+
+	std::vector<GLchar> NameBuffer(std::max(MaxNameLength, 1));
+	std::vector<GLuint> Indices(std::max(NumUniforms, 0));
+	for (GLint Index = 0; Index < NumUniforms; ++Index) {
+		Indices[Index] = static_cast<GLuint>(Index);
+	}
+
+	//bloco e offset de todos de uma vez; -1 no bloco para os uniforms soltos
+	std::vector<GLint> BlockIndices(Indices.size(), -1);
+	std::vector<GLint> Offsets(Indices.size(), -1);
+	if (NumUniforms > 0) {
+		glGetActiveUniformsiv(Program, NumUniforms, Indices.data(), GL_UNIFORM_BLOCK_INDEX, BlockIndices.data());
+		glGetActiveUniformsiv(Program, NumUniforms, Indices.data(), GL_UNIFORM_OFFSET, Offsets.data());
+	}
+
+	Uniforms.reserve(Indices.size());
+	for (GLint Index = 0; Index < NumUniforms; ++Index) {
+		GLsizei Length = 0;
+		UniformInfo Uniform;
+		glGetActiveUniform(Program, static_cast<GLuint>(Index), static_cast<GLsizei>(NameBuffer.size()), &Length, &Uniform.ArraySize, &Uniform.Type, NameBuffer.data());
+		Uniform.Name.assign(NameBuffer.data(), std::max(Length, 0));
+
+		//arrays aparecem como "Nome[0]"; a localização do primeiro elemento é a do nome sem índice
+		const size_t Bracket = Uniform.Name.find('[');
+		if (Bracket != std::string::npos) {
+			Uniform.Name.resize(Bracket);
+		}
+
+		Uniform.BlockIndex = BlockIndices[Index];
+		Uniform.Offset = Offsets[Index];
+		if (Uniform.BlockIndex < 0) {
+			Uniform.Location = glGetUniformLocation(Program, Uniform.Name.c_str());
+		}
+
+		UniformIndices.emplace(Uniform.Name, Uniforms.size());
+		Uniforms.push_back(std::move(Uniform));
+	}
+
+	GLint NumBlocks = 0;
+	GLint MaxBlockNameLength = 0;
+	glGetProgramiv(Program, GL_ACTIVE_UNIFORM_BLOCKS, &NumBlocks);
+	glGetProgramiv(Program, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &MaxBlockNameLength);
+
+	NameBuffer.assign(std::max(MaxBlockNameLength, 1), '\0');
+	for (GLint Index = 0; Index < NumBlocks; ++Index) {
+		GLsizei Length = 0;
+		UniformBlockInfo Block;
+		Block.Index = static_cast<GLuint>(Index);
+		glGetActiveUniformBlockName(Program, Block.Index, static_cast<GLsizei>(NameBuffer.size()), &Length, NameBuffer.data());
+		Block.Name.assign(NameBuffer.data(), std::max(Length, 0));
+		glGetActiveUniformBlockiv(Program, Block.Index, GL_UNIFORM_BLOCK_DATA_SIZE, &Block.DataSize);
+		Blocks.push_back(std::move(Block));
+	}
+}
+
+const UniformInfo* ProgramReflection::FindUniform(const std::string& Name) const {
+	auto Found = UniformIndices.find(Name);
+	return Found != UniformIndices.end() ? &Uniforms[Found->second] : nullptr;
+}
+
+const UniformBlockInfo* ProgramReflection::FindBlock(const std::string& Name) const {
+	auto Found = std::find_if(Blocks.begin(), Blocks.end(), [&Name](const UniformBlockInfo& Block) { return Block.Name == Name; });
+	return Found != Blocks.end() ? &*Found : nullptr;
+}
+
+GLint ProgramReflection::GetLocation(const std::string& Name) const {
+	const UniformInfo* Uniform = FindUniform(Name);
+	return Uniform != nullptr ? Uniform->Location : -1;
+}
+
+bool ProgramReflection::CheckBlock(const std::string& BlockName, size_t Size, const std::vector<UniformBlockMember>& Members, const std::string& ProgramName) const {
+	const UniformBlockInfo* Block = FindBlock(BlockName);
+	if (Block == nullptr) {
+		return true;
+	}
+
+	bool bMatches = true;
+	if (static_cast<size_t>(Block->DataSize) != Size) {
+		std::cout << "Bloco " << BlockName << " de " << ProgramName << " tem " << Block->DataSize << " bytes, a struct tem " << Size << std::endl;
+		bMatches = false;
+	}
+
+	//std140 e shared deixam todos os membros ativos, então um membro que falta é nome diferente dos dois lados
+	for (const UniformBlockMember& Member : Members) {
+		const UniformInfo* Uniform = FindUniform(Member.Name);
+		if (Uniform == nullptr || Uniform->BlockIndex != static_cast<GLint>(Block->Index)) {
+			std::cout << "Bloco " << BlockName << " de " << ProgramName << " nao tem o membro " << Member.Name << std::endl;
+			bMatches = false;
+		}
+		else if (static_cast<size_t>(Uniform->Offset) != Member.Offset) {
+			std::cout << "Membro " << Member.Name << " do bloco " << BlockName << " de " << ProgramName << " esta no byte "
+				<< Uniform->Offset << ", na struct no byte " << Member.Offset << std::endl;
+			bMatches = false;
+		}
+	}
+	return bMatches;
+}
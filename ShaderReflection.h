@@ -0,0 +1,58 @@
+#pragma once
+
+#include<cstddef>
+#include<string>
+#include<unordered_map>
+#include<vector>
+
+#include<GL/glew.h>
+
+//o que ficou ativo num programa linkado, lido uma vez depois da linkagem: os uniforms soltos com a localização
+//e os blocos de uniforms com o offset de cada membro. O frame consulta daqui em vez do glGetUniformLocation,
+//que procura o nome no driver a cada chamada.
+
+struct UniformInfo {
+	std::string Name;          //sem o "[0]" dos arrays
+	GLenum Type = 0;
+	GLint ArraySize = 1;
+	GLint Location = -1;       //-1 nos membros de bloco
+	GLint BlockIndex = -1;
+	GLint Offset = -1;         //bytes desde o começo do bloco
+};
+
+struct UniformBlockInfo {
+	std::string Name;
+	GLuint Index = GL_INVALID_INDEX;
+	GLint DataSize = 0;
+};
+
+//membro de um bloco como a struct do C++ o espera
+struct UniformBlockMember {
+	const char* Name;
+	size_t Offset;
+};
+
+class ProgramReflection {
+public:
+	void Reflect(GLuint Program);
+	void Clear();
+
+	//nullptr quando o uniform não está ativo: não existe, ficou fora da variante ou o driver o descartou
+	const UniformInfo* FindUniform(const std::string& Name) const;
+	const UniformBlockInfo* FindBlock(const std::string& Name) const;
+
+	//-1 para uniforms inativos e membros de bloco, como o glGetUniformLocation
+	GLint GetLocation(const std::string& Name) const;
+
+	//confere o tamanho e os offsets do bloco com a struct do C++ e mostra cada diferença.
+	//true quando confere ou quando o programa não usa o bloco.
+	bool CheckBlock(const std::string& BlockName, size_t Size, const std::vector<UniformBlockMember>& Members, const std::string& ProgramName) const;
+
+	const std::vector<UniformInfo>& GetUniforms() const { return Uniforms; }
+	const std::vector<UniformBlockInfo>& GetBlocks() const { return Blocks; }
+
+private:
+	std::vector<UniformInfo> Uniforms;
+	std::vector<UniformBlockInfo> Blocks;
+	std::unordered_map<std::string, size_t> UniformIndices;
+};
@@ -0,0 +1,470 @@
+#include "SphereMesh.h"
+
+#include<array>
+#include<cassert>
+#include<cstring>
+#include<unordered_map>
+
+#include<glm/ext.hpp>
+
+#include "FastMath.h"
+#include "Hash.h"
+#include "ThreadPool.h"
+
+//linhas por bloco de trabalho do pool, grande o suficiente para amortizar o agendamento
+static size_t RowGrain(uint32_t Resolution) {
+	const size_t TargetVerticesPerChunk = 16 * 1024;
+	return glm::max<size_t>(8, TargetVerticesPerChunk / glm::max<uint32_t>(Resolution, 1));
+}
+
+SphereMeshSize GetSphereMeshSize(uint32_t Resolution) {
+	SphereMeshSize Size;
+	if (Resolution >= 2) {
+		Size.NumVertices = static_cast<size_t>(Resolution) * Resolution;
+		Size.NumTriangles = static_cast<size_t>(Resolution - 1) * (Resolution - 1) * 2;
+	}
+	return Size;
+}
+
+void BuildSphereColumns(uint32_t Resolution, SphereColumns& OutColumns) {
+	assert(Resolution >= 2);
+
+	constexpr float TwoPi = glm::two_pi<float>();
+	const float InvResolution = 1.0f / static_cast<float>(Resolution - 1);
+
+	std::vector<float> Phi(Resolution);
+	for (uint32_t VIndex = 0; VIndex < Resolution; ++VIndex) {
+		Phi[VIndex] = glm::mix(0.0f, TwoPi, VIndex * InvResolution);
+	}
+	OutColumns.SinPhi.resize(Resolution);
+	OutColumns.CosPhi.resize(Resolution);
+	FastMath::SinCos(Phi.data(), OutColumns.SinPhi.data(), OutColumns.CosPhi.data(), Resolution);
+}
+
+void WriteSphereVertices(uint32_t Resolution, const SphereColumns& Columns, uint32_t RowBegin, uint32_t RowEnd, Vertex* OutVertices) {
+	assert(Resolution >= 2);
+	assert(RowBegin <= RowEnd && RowEnd <= Resolution);
+	assert(Columns.SinPhi.size() == Resolution && Columns.CosPhi.size() == Resolution);
+
+	constexpr float Pi = glm::pi<float>();
+	const float InvResolution = 1.0f / static_cast<float>(Resolution - 1);
+	const float* SinPhi = Columns.SinPhi.data();
+	const float* CosPhi = Columns.CosPhi.data();
+
+	const glm::vec3 White{ 1.0f, 1.0f, 1.0f };
+
+	for (uint32_t Row = 0; Row < RowEnd - RowBegin; ++Row) {
+		const float U = (RowBegin + Row) * InvResolution;
+		Vertex* RowVertices = OutVertices + static_cast<size_t>(Row) * Resolution;
+
+		//Theta uma vez por linha, em vez de duas vezes sin(Theta) por vértice
+		float SinTheta = 0.0f, CosTheta = 0.0f;
+		FastMath::SinCos(glm::mix(0.0f, Pi, U), SinTheta, CosTheta);
+
+		for (uint32_t VIndex = 0; VIndex < Resolution; ++VIndex) {
+			const glm::vec3 VertexPosition{
+				SinTheta * CosPhi[VIndex],
+				SinTheta * SinPhi[VIndex],
+				CosTheta
+			};
+
+			Vertex& Out = RowVertices[VIndex];
+			Out.Position = VertexPosition;
+			Out.Normal = VertexPosition; //já tem comprimento 1 numa esfera unitária
+			Out.Color = White;
+			Out.UV = glm::vec2{ 1.0f - U, VIndex * InvResolution };
+		}
+	}
+}
+
+void WriteSphereTriangles(uint32_t Resolution, uint32_t ColumnBegin, uint32_t ColumnEnd, glm::ivec3* OutTriangles) {
+	assert(Resolution >= 2);
+	assert(ColumnBegin <= ColumnEnd && ColumnEnd <= Resolution - 1);
+
+	glm::ivec3* Out = OutTriangles;
+	for (uint32_t U = ColumnBegin; U < ColumnEnd; ++U) {
+		for (uint32_t V = 0; V < Resolution - 1; ++V) {
+			const uint32_t P0 = U + V * Resolution;
+			const uint32_t P1 = (U + 1) + V * Resolution;
+			const uint32_t P2 = (U + 1) + (V + 1) * Resolution;
+			const uint32_t P3 = U + (V + 1) * Resolution;
+
+			//anti-horário visto de fora da esfera, como os outros modos
+			*Out++ = glm::ivec3{ P0, P3, P1 };
+			*Out++ = glm::ivec3{ P3, P2, P1 };
+		}
+	}
+}
+
+void WriteSphereMesh(uint32_t Resolution, Vertex* OutVertices, size_t MaxVertices, glm::ivec3* OutTriangles, size_t MaxTriangles) {
+	const SphereMeshSize Size = GetSphereMeshSize(Resolution);
+	assert(Size.NumVertices <= MaxVertices);
+	assert(Size.NumTriangles <= MaxTriangles);
+
+	if (Size.NumVertices == 0 || Size.NumVertices > MaxVertices || Size.NumTriangles > MaxTriangles) {
+		return;
+	}
+
+	const size_t Grain = RowGrain(Resolution);
+
+	SphereColumns Columns;
+	BuildSphereColumns(Resolution, Columns);
+	ParallelFor(0, Resolution, Grain, [&](size_t Begin, size_t End) {
+		WriteSphereVertices(Resolution, Columns, static_cast<uint32_t>(Begin), static_cast<uint32_t>(End), OutVertices + Begin * Resolution);
+	});
+
+	const size_t TrianglesPerColumn = static_cast<size_t>(Resolution - 1) * 2;
+	ParallelFor(0, Resolution - 1, Grain, [&](size_t Begin, size_t End) {
+		WriteSphereTriangles(Resolution, static_cast<uint32_t>(Begin), static_cast<uint32_t>(End), OutTriangles + Begin * TrianglesPerColumn);
+	});
+}
+
+void GenerateSphereMesh(uint32_t Resolution, std::vector<Vertex>& Vertices, std::vector<glm::ivec3>& Indices) {
+	const SphereMeshSize Size = GetSphereMeshSize(Resolution);
+
+	Vertices.resize(Size.NumVertices);
+	Indices.resize(Size.NumTriangles);
+
+	WriteSphereMesh(Resolution, Vertices.data(), Vertices.size(), Indices.data(), Indices.size());
+}
+
+const char* ToString(SphereTessellation Tessellation) {
+	switch (Tessellation) {
+	case SphereTessellation::UV: return "uv";
+	case SphereTessellation::Icosphere: return "ico";
+	case SphereTessellation::CubeSphere: return "cube";
+	}
+	return "?";
+}
+
+bool ParseSphereTessellation(const std::string& Name, SphereTessellation& OutTessellation) {
+	for (SphereTessellation Tessellation : { SphereTessellation::UV, SphereTessellation::Icosphere, SphereTessellation::CubeSphere }) {
+		if (Name == ToString(Tessellation)) {
+			OutTessellation = Tessellation;
+			return true;
+		}
+	}
+	return false;
+}
+
+uint32_t GetDefaultSphereDetail(SphereTessellation Tessellation) {
+	switch (Tessellation) {
+	case SphereTessellation::UV: return 50;
+	case SphereTessellation::Icosphere: return 4;
+	case SphereTessellation::CubeSphere: return 21;
+	}
+	return 0;
+}
+
+glm::vec2 EquirectangularUV(const glm::vec3& Position) {
+	constexpr float Pi = glm::pi<float>();
+	constexpr float TwoPi = glm::two_pi<float>();
+
+	const float Theta = glm::acos(glm::clamp(Position.z, -1.0f, 1.0f));
+	float Phi = glm::atan(Position.y, Position.x);
+	if (Phi < 0.0f) {
+		Phi += TwoPi;
+	}
+
+	return glm::vec2{ 1.0f - Theta / Pi, Phi / TwoPi };
+}
+
+const CubeFace& GetCubeFace(uint32_t FaceIndex) {
+	static const std::array<CubeFace, 6> Faces = { {
+		{ glm::vec3{  1.0f,  0.0f,  0.0f }, glm::vec3{ 0.0f, 1.0f, 0.0f }, glm::vec3{ 0.0f, 0.0f, 1.0f } },
+		{ glm::vec3{ -1.0f,  0.0f,  0.0f }, glm::vec3{ 0.0f, 0.0f, 1.0f }, glm::vec3{ 0.0f, 1.0f, 0.0f } },
+		{ glm::vec3{  0.0f,  1.0f,  0.0f }, glm::vec3{ 0.0f, 0.0f, 1.0f }, glm::vec3{ 1.0f, 0.0f, 0.0f } },
+		{ glm::vec3{  0.0f, -1.0f,  0.0f }, glm::vec3{ 1.0f, 0.0f, 0.0f }, glm::vec3{ 0.0f, 0.0f, 1.0f } },
+		{ glm::vec3{  0.0f,  0.0f,  1.0f }, glm::vec3{ 1.0f, 0.0f, 0.0f }, glm::vec3{ 0.0f, 1.0f, 0.0f } },
+		{ glm::vec3{  0.0f,  0.0f, -1.0f }, glm::vec3{ 0.0f, 1.0f, 0.0f }, glm::vec3{ 1.0f, 0.0f, 0.0f } }
+	} };
+
+	assert(FaceIndex < Faces.size());
+	return Faces[FaceIndex];
+}
+
+glm::vec3 CubeToSphere(uint32_t FaceIndex, const glm::vec2& FaceUV) {
+	const CubeFace& Face = GetCubeFace(FaceIndex);
+	const glm::vec2 Signed = FaceUV * 2.0f - 1.0f;
+	return glm::normalize(Face.Normal + Face.AxisU * Signed.x + Face.AxisV * Signed.y);
+}
+
+//transforma uma malha indexada só com posições em vértices com UV equiretangular.
+//triângulos que cruzam a costura (longitude 0) recebem cópias dos vértices com a longitude somada de 1,
+//e vértices nos polos, onde a longitude não existe, recebem uma cópia por triângulo com a longitude média dos outros dois.
+static void BuildSphereVertices(const std::vector<glm::vec3>& Positions, const std::vector<glm::ivec3>& Triangles, std::vector<Vertex>& Vertices, std::vector<glm::ivec3>& Indices) {
+	constexpr float PoleEpsilon = 1.0e-6f;
+	const glm::vec3 White{ 1.0f, 1.0f, 1.0f };
+
+	Vertices.clear();
+	Indices.clear();
+	Vertices.reserve(Positions.size() + Positions.size() / 8);
+	Indices.reserve(Triangles.size());
+
+	//chave: índice da posição e variação (0 = normal, 1 = longitude + 1)
+	std::unordered_map<uint64_t, int> VertexMap;
+	VertexMap.reserve(Vertices.capacity());
+
+	auto EmitVertex = [&](int PositionIndex, const glm::vec2& UV, uint64_t Variant, bool bUnique) {
+		const uint64_t Key = (static_cast<uint64_t>(PositionIndex) << 2) | Variant;
+		if (!bUnique) {
+			auto Found = VertexMap.find(Key);
+			if (Found != VertexMap.end()) {
+				return Found->second;
+			}
+		}
+
+		const int NewIndex = static_cast<int>(Vertices.size());
+		const glm::vec3& Position = Positions[PositionIndex];
+		Vertices.push_back(Vertex{ Position, Position, White, UV });
+		if (!bUnique) {
+			VertexMap.emplace(Key, NewIndex);
+		}
+		return NewIndex;
+	};
+
+	for (const glm::ivec3& Triangle : Triangles) {
+		std::array<glm::vec2, 3> UVs;
+		std::array<bool, 3> bPole;
+		for (int Corner = 0; Corner < 3; ++Corner) {
+			const glm::vec3& Position = Positions[Triangle[Corner]];
+			UVs[Corner] = EquirectangularUV(Position);
+			bPole[Corner] = glm::abs(Position.z) > 1.0f - PoleEpsilon;
+		}
+
+		//costura: se a longitude varia mais que meia volta, as menores passam para o outro lado
+		float MinLongitude = 1.0f, MaxLongitude = 0.0f;
+		for (int Corner = 0; Corner < 3; ++Corner) {
+			if (!bPole[Corner]) {
+				MinLongitude = glm::min(MinLongitude, UVs[Corner].y);
+				MaxLongitude = glm::max(MaxLongitude, UVs[Corner].y);
+			}
+		}
+
+		std::array<bool, 3> bWrapped = { false, false, false };
+		if (MaxLongitude - MinLongitude > 0.5f) {
+			for (int Corner = 0; Corner < 3; ++Corner) {
+				if (!bPole[Corner] && UVs[Corner].y < 0.5f) {
+					UVs[Corner].y += 1.0f;
+					bWrapped[Corner] = true;
+				}
+			}
+		}
+
+		glm::ivec3 OutTriangle;
+		for (int Corner = 0; Corner < 3; ++Corner) {
+			if (bPole[Corner]) {
+				float Longitude = 0.0f;
+				int Count = 0;
+				for (int Other = 0; Other < 3; ++Other) {
+					if (!bPole[Other]) {
+						Longitude += UVs[Other].y;
+						++Count;
+					}
+				}
+				UVs[Corner].y = Count > 0 ? Longitude / Count : 0.0f;
+				OutTriangle[Corner] = EmitVertex(Triangle[Corner], UVs[Corner], 0, true);
+			}
+			else {
+				OutTriangle[Corner] = EmitVertex(Triangle[Corner], UVs[Corner], bWrapped[Corner] ? 1 : 0, false);
+			}
+		}
+
+		Indices.push_back(OutTriangle);
+	}
+}
+
+uint64_t GetSphereMeshKey(SphereTessellation Tessellation, uint32_t Detail) {
+	uint64_t Key = HashValue(SphereGeneratorVersion);
+	Key = HashValue(static_cast<uint32_t>(Tessellation), Key);
+	Key = HashValue(Detail, Key);
+	return Key;
+}
+
+void GenerateIcosphereMesh(uint32_t Subdivisions, std::vector<Vertex>& Vertices, std::vector<glm::ivec3>& Indices) {
+	//icosaedro com dois vértices nos polos (z = +-1) para que a costura dos polos caia em vértices.
+	//os outros 10 formam dois anéis em z = +-1/sqrt(5), defasados de 36 graus
+	constexpr float Pi = glm::pi<float>();
+	const float RingZ = 1.0f / glm::sqrt(5.0f);
+	const float RingRadius = 2.0f / glm::sqrt(5.0f);
+
+	std::vector<glm::vec3> Positions;
+	Positions.reserve(10 * (static_cast<size_t>(1) << (2 * glm::min(Subdivisions, 12u))) + 2);
+	Positions.push_back(glm::vec3{ 0.0f, 0.0f, 1.0f });
+	for (int Index = 0; Index < 5; ++Index) {
+		const float Phi = Index * 2.0f * Pi / 5.0f;
+		Positions.push_back(glm::vec3{ RingRadius * glm::cos(Phi), RingRadius * glm::sin(Phi), RingZ });
+	}
+	for (int Index = 0; Index < 5; ++Index) {
+		const float Phi = (Index + 0.5f) * 2.0f * Pi / 5.0f;
+		Positions.push_back(glm::vec3{ RingRadius * glm::cos(Phi), RingRadius * glm::sin(Phi), -RingZ });
+	}
+	Positions.push_back(glm::vec3{ 0.0f, 0.0f, -1.0f });
+
+	std::vector<glm::ivec3> Triangles;
+	for (int Index = 0; Index < 5; ++Index) {
+		const int Upper = 1 + Index;
+		const int NextUpper = 1 + (Index + 1) % 5;
+		const int Lower = 6 + Index;
+		const int NextLower = 6 + (Index + 1) % 5;
+
+		Triangles.push_back(glm::ivec3{ 0, Upper, NextUpper });
+		Triangles.push_back(glm::ivec3{ Upper, Lower, NextUpper });
+		Triangles.push_back(glm::ivec3{ NextUpper, Lower, NextLower });
+		Triangles.push_back(glm::ivec3{ 11, NextLower, Lower });
+	}
+
+	//cada subdivisão divide o triângulo em 4, com os pontos médios das arestas projetados na esfera
+	for (uint32_t Level = 0; Level < Subdivisions; ++Level) {
+		std::unordered_map<uint64_t, int> Midpoints;
+		Midpoints.reserve(Triangles.size() * 3 / 2);
+
+		auto Midpoint = [&](int A, int B) {
+			const uint64_t Key = (static_cast<uint64_t>(glm::min(A, B)) << 32) | static_cast<uint32_t>(glm::max(A, B));
+			auto Found = Midpoints.find(Key);
+			if (Found != Midpoints.end()) {
+				return Found->second;
+			}
+
+			const int NewIndex = static_cast<int>(Positions.size());
+			Positions.push_back(glm::normalize(Positions[A] + Positions[B]));
+			Midpoints.emplace(Key, NewIndex);
+			return NewIndex;
+		};
+
+		std::vector<glm::ivec3> Subdivided;
+		Subdivided.reserve(Triangles.size() * 4);
+		for (const glm::ivec3& Triangle : Triangles) {
+			const int AB = Midpoint(Triangle.x, Triangle.y);
+			const int BC = Midpoint(Triangle.y, Triangle.z);
+			const int CA = Midpoint(Triangle.z, Triangle.x);
+
+			Subdivided.push_back(glm::ivec3{ Triangle.x, AB, CA });
+			Subdivided.push_back(glm::ivec3{ AB, Triangle.y, BC });
+			Subdivided.push_back(glm::ivec3{ CA, BC, Triangle.z });
+			Subdivided.push_back(glm::ivec3{ AB, BC, CA });
+		}
+		Triangles.swap(Subdivided);
+	}
+
+	BuildSphereVertices(Positions, Triangles, Vertices, Indices);
+}
+
+void GenerateCubeSphereMesh(uint32_t Resolution, std::vector<Vertex>& Vertices, std::vector<glm::ivec3>& Indices) {
+	//resolução ímpar coloca um vértice no centro das faces +Z/-Z, que são os polos
+	Resolution = glm::max(Resolution, 3u) | 1u;
+	const float InvResolution = 1.0f / static_cast<float>(Resolution - 1);
+
+	std::vector<glm::vec3> Positions;
+	std::vector<glm::ivec3> Triangles;
+	Positions.reserve(static_cast<size_t>(Resolution) * Resolution * 6);
+	Triangles.reserve(static_cast<size_t>(Resolution - 1) * (Resolution - 1) * 12);
+
+	//vértices das arestas do cubo aparecem em duas ou três faces: solda pela posição exata
+	std::unordered_map<uint64_t, int> Welded;
+	auto PositionKey = [](const glm::vec3& Position) {
+		uint32_t Bits[3];
+		std::memcpy(Bits, &Position, sizeof(Bits));
+		return (static_cast<uint64_t>(Bits[0]) * 0x9E3779B97F4A7C15ull) ^ (static_cast<uint64_t>(Bits[1]) * 0xC2B2AE3D27D4EB4Full) ^ Bits[2];
+	};
+
+	std::vector<int> FaceIndices(static_cast<size_t>(Resolution) * Resolution);
+
+	for (uint32_t FaceIndex = 0; FaceIndex < 6; ++FaceIndex) {
+		for (uint32_t Row = 0; Row < Resolution; ++Row) {
+			for (uint32_t Column = 0; Column < Resolution; ++Column) {
+				const glm::vec3 Position = CubeToSphere(FaceIndex, glm::vec2{ Column * InvResolution, Row * InvResolution });
+				const bool bBorder = Row == 0 || Column == 0 || Row == Resolution - 1 || Column == Resolution - 1;
+
+				int Index = static_cast<int>(Positions.size());
+				if (bBorder) {
+					auto Inserted = Welded.emplace(PositionKey(Position), Index);
+					if (!Inserted.second && Positions[Inserted.first->second] == Position) {
+						Index = Inserted.first->second;
+					}
+				}
+
+				if (Index == static_cast<int>(Positions.size())) {
+					Positions.push_back(Position);
+				}
+				FaceIndices[Row * Resolution + Column] = Index;
+			}
+		}
+
+		for (uint32_t Row = 0; Row < Resolution - 1; ++Row) {
+			for (uint32_t Column = 0; Column < Resolution - 1; ++Column) {
+				const int P00 = FaceIndices[Row * Resolution + Column];
+				const int P10 = FaceIndices[Row * Resolution + Column + 1];
+				const int P01 = FaceIndices[(Row + 1) * Resolution + Column];
+				const int P11 = FaceIndices[(Row + 1) * Resolution + Column + 1];
+
+				//diagonal alternada por quadrante deixa a face simétrica em relação ao centro
+				const bool bFlip = (Row < Resolution / 2) != (Column < Resolution / 2);
+				if (bFlip) {
+					Triangles.push_back(glm::ivec3{ P00, P10, P11 });
+					Triangles.push_back(glm::ivec3{ P00, P11, P01 });
+				}
+				else {
+					Triangles.push_back(glm::ivec3{ P00, P10, P01 });
+					Triangles.push_back(glm::ivec3{ P01, P10, P11 });
+				}
+			}
+		}
+	}
+
+	BuildSphereVertices(Positions, Triangles, Vertices, Indices);
+}
+
+void GenerateSphereMesh(SphereTessellation Tessellation, uint32_t Detail, std::vector<Vertex>& Vertices, std::vector<glm::ivec3>& Indices) {
+	switch (Tessellation) {
+	case SphereTessellation::UV:
+		GenerateSphereMesh(Detail, Vertices, Indices);
+		break;
+	case SphereTessellation::Icosphere:
+		GenerateIcosphereMesh(Detail, Vertices, Indices);
+		break;
+	case SphereTessellation::CubeSphere:
+		GenerateCubeSphereMesh(Detail, Vertices, Indices);
+		break;
+	}
+}
+
+SphereMeshStats ComputeSphereMeshStats(const std::vector<Vertex>& Vertices, const std::vector<glm::ivec3>& Indices) {
+	SphereMeshStats Stats;
+	Stats.NumVertices = Vertices.size();
+	Stats.NumTriangles = Indices.size();
+
+	std::vector<float> Areas;
+	Areas.reserve(Indices.size());
+
+	for (const glm::ivec3& Triangle : Indices) {
+		const glm::vec3& A = Vertices[Triangle.x].Position;
+		const glm::vec3& B = Vertices[Triangle.y].Position;
+		const glm::vec3& C = Vertices[Triangle.z].Position;
+
+		Areas.push_back(0.5f * glm::length(glm::cross(B - A, C - A)));
+
+		for (const auto& Edge : { std::make_pair(A, B), std::make_pair(B, C), std::make_pair(C, A) }) {
+			Stats.MaxEdgeError = glm::max(Stats.MaxEdgeError, 1.0f - glm::length((Edge.first + Edge.second) * 0.5f));
+			Stats.MaxEdgeLength = glm::max(Stats.MaxEdgeLength, glm::length(Edge.second - Edge.first));
+		}
+
+		Stats.MaxCentroidError = glm::max(Stats.MaxCentroidError, 1.0f - glm::length((A + B + C) / 3.0f));
+	}
+
+	//triângulos degenerados (polos da esfera UV) não contam para a uniformidade
+	float MaxArea = 0.0f;
+	for (float Area : Areas) {
+		MaxArea = glm::max(MaxArea, Area);
+	}
+
+	float MinArea = MaxArea;
+	for (float Area : Areas) {
+		if (Area > MaxArea * 1.0e-4f) {
+			MinArea = glm::min(MinArea, Area);
+		}
+	}
+
+	Stats.AreaRatio = MaxArea > 0.0f ? MaxArea / MinArea : 0.0f;
+	return Stats;
+}
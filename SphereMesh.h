@@ -0,0 +1,94 @@
+#pragma once
+
+#include<cstddef>
+#include<cstdint>
+#include<string>
+#include<vector>
+
+#include<glm/glm.hpp>
+
+struct Vertex {
+	glm::vec3 Position;
+	glm::vec3 Normal;
+	glm::vec3 Color;
+	glm::vec2 UV; //cordenada de textura do vértice
+};
+
+//quantidade de vértices e triângulos de uma esfera UV com Resolution x Resolution vértices
+struct SphereMeshSize {
+	size_t NumVertices = 0;
+	size_t NumTriangles = 0;
+};
+
+SphereMeshSize GetSphereMeshSize(uint32_t Resolution);
+
+//seno e cosseno de Phi de cada coluna: só dependem da resolução, então são calculados uma vez por malha
+//e divididos entre as threads que escrevem as linhas
+struct SphereColumns {
+	std::vector<float> SinPhi;
+	std::vector<float> CosPhi;
+};
+
+void BuildSphereColumns(uint32_t Resolution, SphereColumns& OutColumns);
+
+//escreve as linhas [RowBegin, RowEnd) de vértices da esfera em OutVertices, que deve ter espaço para
+//(RowEnd - RowBegin) * Resolution vértices. Cada linha é uma latitude (Theta). Não aloca memória.
+void WriteSphereVertices(uint32_t Resolution, const SphereColumns& Columns, uint32_t RowBegin, uint32_t RowEnd, Vertex* OutVertices);
+
+//escreve os triângulos das colunas [ColumnBegin, ColumnEnd) da grade, 2 * (Resolution - 1) por coluna
+void WriteSphereTriangles(uint32_t Resolution, uint32_t ColumnBegin, uint32_t ColumnEnd, glm::ivec3* OutTriangles);
+
+//gera a malha inteira em memória fornecida pelo chamador (por exemplo um buffer mapeado da GPU),
+//dividindo as linhas entre as threads do pool. Os buffers devem ter o tamanho de GetSphereMeshSize.
+void WriteSphereMesh(uint32_t Resolution, Vertex* OutVertices, size_t MaxVertices, glm::ivec3* OutTriangles, size_t MaxTriangles);
+
+void GenerateSphereMesh(uint32_t Resolution, std::vector<Vertex>& Vertices, std::vector<glm::ivec3>& Indices);
+
+//formas de discretizar a esfera
+enum class SphereTessellation {
+	UV,         //grade de latitude x longitude, Detail = vértices por lado
+	Icosphere,  //icosaedro subdividido, Detail = número de subdivisões
+	CubeSphere  //cubo com as faces projetadas na esfera, Detail = vértices por aresta da face
+};
+
+const char* ToString(SphereTessellation Tessellation);
+bool ParseSphereTessellation(const std::string& Name, SphereTessellation& OutTessellation);
+
+//detalhe padrão de cada modo, próximo da esfera UV de resolução 50
+uint32_t GetDefaultSphereDetail(SphereTessellation Tessellation);
+
+//coordenada de textura equiretangular de um ponto da esfera unitária, na mesma convenção do GenerateSphereMesh
+glm::vec2 EquirectangularUV(const glm::vec3& Position);
+
+//as 6 faces do cubo, cada uma com Normal = cross(AxisU, AxisV) para manter o sentido anti-horário visto de fora
+struct CubeFace {
+	glm::vec3 Normal;
+	glm::vec3 AxisU;
+	glm::vec3 AxisV;
+};
+
+const CubeFace& GetCubeFace(uint32_t FaceIndex);
+
+//ponto da face (UV em [0, 1]) projetado na esfera unitária
+glm::vec3 CubeToSphere(uint32_t FaceIndex, const glm::vec2& FaceUV);
+
+//chave dos parâmetros do gerador para o cache em disco. SphereGeneratorVersion muda sempre que
+//a saída de algum gerador mudar, invalidando os arquivos antigos.
+constexpr uint32_t SphereGeneratorVersion = 1;
+uint64_t GetSphereMeshKey(SphereTessellation Tessellation, uint32_t Detail);
+
+void GenerateIcosphereMesh(uint32_t Subdivisions, std::vector<Vertex>& Vertices, std::vector<glm::ivec3>& Indices);
+void GenerateCubeSphereMesh(uint32_t Resolution, std::vector<Vertex>& Vertices, std::vector<glm::ivec3>& Indices);
+void GenerateSphereMesh(SphereTessellation Tessellation, uint32_t Detail, std::vector<Vertex>& Vertices, std::vector<glm::ivec3>& Indices);
+
+//estatísticas de qualidade de uma malha de esfera unitária
+struct SphereMeshStats {
+	size_t NumVertices = 0;
+	size_t NumTriangles = 0;
+	float MaxEdgeError = 0.0f;     //maior distância entre o meio de uma aresta e a superfície da esfera
+	float MaxCentroidError = 0.0f; //maior distância entre o centro de um triângulo e a superfície
+	float MaxEdgeLength = 0.0f;
+	float AreaRatio = 0.0f;        //maior área / menor área (1 = densidade uniforme)
+};
+
+SphereMeshStats ComputeSphereMeshStats(const std::vector<Vertex>& Vertices, const std::vector<glm::ivec3>& Indices);
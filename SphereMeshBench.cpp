@@ -0,0 +1,296 @@
+#include<iostream>
+#include<iomanip>
+#include<chrono>
+#include<vector>
+
+#include<glm/glm.hpp>
+#include<glm/ext.hpp>
+
+#include "MeshOptimize.h"
+#include "SphereMesh.h"
+#include "ThreadPool.h"
+
+//malhas maiores que isso são geradas em faixas de linhas num buffer reaproveitado
+constexpr size_t MaxMeshBytes = 512ull * 1024 * 1024;
+
+//tempo mínimo medido por resolução, repete a geração até atingir
+constexpr double MinSeconds = 0.25;
+
+using Clock = std::chrono::steady_clock;
+
+//versão original do GenerateSphereMesh (push_back sem reserve, sin(Theta) duas vezes por vértice)
+void GenerateSphereMeshReference(uint32_t Resolution, std::vector<Vertex>& Vertices, std::vector<glm::ivec3>& Indices) {
+	Vertices.clear();
+	Indices.clear();
+
+	constexpr float Pi = glm::pi<float>();
+	constexpr float TwoPi = glm::two_pi<float>();
+	float InvResolution = 1.0f / static_cast<float>(Resolution - 1);
+
+	for (uint32_t UIndex = 0; UIndex < Resolution; ++UIndex) {
+		const float U = UIndex * InvResolution;
+		const float Theta = glm::mix(0.0f, Pi, U);
+
+		for (uint32_t VIndex = 0; VIndex < Resolution; ++VIndex) {
+			const float V = VIndex * InvResolution;
+			const float Phi = glm::mix(0.0f, TwoPi, V);
+
+			glm::vec3 VertexPosition = {
+				glm::sin(Theta) * glm::cos(Phi),
+				glm::sin(Theta) * glm::sin(Phi),
+				glm::cos(Theta)
+			};
+
+			Vertices.push_back(Vertex{ VertexPosition, glm::normalize(VertexPosition), glm::vec3{ 1.0f, 1.0f, 1.0f }, glm::vec2{ 1.0f - U, V } });
+		}
+	}
+
+	for (uint32_t U = 0; U < Resolution - 1; ++U) {
+		for (uint32_t V = 0; V < Resolution - 1; ++V) {
+			uint32_t P0 = U + V * Resolution;
+			uint32_t P1 = (U + 1) + V * Resolution;
+			uint32_t P2 = (U + 1) + (V + 1) * Resolution;
+			uint32_t P3 = U + (V + 1) * Resolution;
+
+			Indices.push_back(glm::ivec3{ P0, P1, P3 });
+			Indices.push_back(glm::ivec3{ P3, P1, P2 });
+		}
+	}
+}
+
+template<typename Func>
+double MeasureSeconds(Func&& Body) {
+	int Iterations = 0;
+	const Clock::time_point Start = Clock::now();
+	double Elapsed = 0.0;
+	do {
+		Body();
+		++Iterations;
+		Elapsed = std::chrono::duration<double>(Clock::now() - Start).count();
+	} while (Elapsed < MinSeconds);
+
+	return Elapsed / Iterations;
+}
+
+//gera a esfera inteira em faixas de linhas/colunas que cabem em MaxMeshBytes
+void GenerateInSlabs(uint32_t Resolution, std::vector<Vertex>& VertexSlab, std::vector<glm::ivec3>& TriangleSlab) {
+	const size_t RowsPerSlab = VertexSlab.size() / Resolution;
+	SphereColumns Columns;
+	BuildSphereColumns(Resolution, Columns);
+	for (uint32_t Row = 0; Row < Resolution; Row += static_cast<uint32_t>(RowsPerSlab)) {
+		const uint32_t SlabEnd = static_cast<uint32_t>(glm::min<size_t>(Row + RowsPerSlab, Resolution));
+		ParallelFor(Row, SlabEnd, 8, [&](size_t Begin, size_t End) {
+			WriteSphereVertices(Resolution, Columns, static_cast<uint32_t>(Begin), static_cast<uint32_t>(End), VertexSlab.data() + (Begin - Row) * Resolution);
+		});
+	}
+
+	const size_t TrianglesPerColumn = static_cast<size_t>(Resolution - 1) * 2;
+	const size_t ColumnsPerSlab = TriangleSlab.size() / TrianglesPerColumn;
+	for (uint32_t Column = 0; Column < Resolution - 1; Column += static_cast<uint32_t>(ColumnsPerSlab)) {
+		const uint32_t SlabEnd = static_cast<uint32_t>(glm::min<size_t>(Column + ColumnsPerSlab, Resolution - 1));
+		ParallelFor(Column, SlabEnd, 8, [&](size_t Begin, size_t End) {
+			WriteSphereTriangles(Resolution, static_cast<uint32_t>(Begin), static_cast<uint32_t>(End), TriangleSlab.data() + (Begin - Column) * TrianglesPerColumn);
+		});
+	}
+}
+
+//triângulos x erro geométrico de cada modo de discretização
+void PrintTessellationStats() {
+	struct ModeDetails {
+		SphereTessellation Tessellation;
+		std::vector<uint32_t> Details;
+	};
+
+	const ModeDetails Modes[] = {
+		{ SphereTessellation::UV, { 10, 20, 50, 100, 200, 400 } },
+		{ SphereTessellation::Icosphere, { 1, 2, 3, 4, 5, 6 } },
+		{ SphereTessellation::CubeSphere, { 5, 11, 21, 41, 81, 161 } }
+	};
+
+	std::cout << std::setw(6) << "Modo"
+		<< std::setw(9) << "Detalhe"
+		<< std::setw(12) << "Vertices"
+		<< std::setw(12) << "Triangulos"
+		<< std::setw(14) << "Erro aresta"
+		<< std::setw(14) << "Erro centro"
+		<< std::setw(12) << "Max aresta"
+		<< std::setw(14) << "Area max/min" << std::endl;
+
+	for (const ModeDetails& Mode : Modes) {
+		for (uint32_t Detail : Mode.Details) {
+			std::vector<Vertex> Vertices;
+			std::vector<glm::ivec3> Triangles;
+			GenerateSphereMesh(Mode.Tessellation, Detail, Vertices, Triangles);
+			const SphereMeshStats Stats = ComputeSphereMeshStats(Vertices, Triangles);
+
+			std::cout << std::setw(6) << ToString(Mode.Tessellation)
+				<< std::setw(9) << Detail
+				<< std::setw(12) << Stats.NumVertices
+				<< std::setw(12) << Stats.NumTriangles
+				<< std::scientific << std::setprecision(3)
+				<< std::setw(14) << Stats.MaxEdgeError
+				<< std::setw(14) << Stats.MaxCentroidError
+				<< std::fixed << std::setprecision(4)
+				<< std::setw(12) << Stats.MaxEdgeLength
+				<< std::setprecision(2)
+				<< std::setw(14) << Stats.AreaRatio << std::endl;
+		}
+	}
+
+	std::cout << std::endl;
+}
+
+//ACMR/ATVR da ordem do gerador contra a reordenada pelo Tipsify, num FIFO de DefaultVertexCacheSize vértices
+void PrintVertexCacheStats() {
+	struct ModeDetail {
+		SphereTessellation Tessellation;
+		uint32_t Detail;
+	};
+
+	const ModeDetail Meshes[] = {
+		{ SphereTessellation::UV, 50 }, { SphereTessellation::UV, 400 }, { SphereTessellation::UV, 1600 },
+		{ SphereTessellation::Icosphere, 4 }, { SphereTessellation::Icosphere, 7 },
+		{ SphereTessellation::CubeSphere, 21 }, { SphereTessellation::CubeSphere, 161 }
+	};
+
+	std::cout << std::setw(6) << "Modo"
+		<< std::setw(9) << "Detalhe"
+		<< std::setw(12) << "Triangulos"
+		<< std::setw(12) << "ACMR antes"
+		<< std::setw(12) << "ACMR depois"
+		<< std::setw(12) << "ATVR antes"
+		<< std::setw(12) << "ATVR depois"
+		<< std::setw(12) << "ms" << std::endl;
+
+	for (const ModeDetail& Mesh : Meshes) {
+		std::vector<Vertex> Vertices;
+		std::vector<glm::ivec3> Triangles;
+		GenerateSphereMesh(Mesh.Tessellation, Mesh.Detail, Vertices, Triangles);
+
+		uint32_t* Indices = reinterpret_cast<uint32_t*>(Triangles.data());
+		const size_t NumIndices = Triangles.size() * 3;
+
+		const VertexCacheStats Before = AnalyzeVertexCache(Indices, NumIndices, Vertices.size());
+		const Clock::time_point Start = Clock::now();
+		OptimizeVertexCache(Indices, NumIndices, Vertices.size());
+		OptimizeVertexFetch(Vertices.data(), Vertices.size(), sizeof(Vertex), Indices, NumIndices);
+		const double Milliseconds = std::chrono::duration<double, std::milli>(Clock::now() - Start).count();
+		const VertexCacheStats After = AnalyzeVertexCache(Indices, NumIndices, Vertices.size());
+
+		std::cout << std::setw(6) << ToString(Mesh.Tessellation)
+			<< std::setw(9) << Mesh.Detail
+			<< std::setw(12) << Triangles.size()
+			<< std::fixed << std::setprecision(3)
+			<< std::setw(12) << Before.ACMR
+			<< std::setw(12) << After.ACMR
+			<< std::setw(12) << Before.ATVR
+			<< std::setw(12) << After.ATVR
+			<< std::setprecision(1)
+			<< std::setw(12) << Milliseconds << std::endl;
+	}
+
+	std::cout << std::endl;
+}
+
+//memória e execuções do vertex shader por frame: esfera UV num VBO (ordem otimizada) contra a procedural,
+//que não guarda nada mas roda o shader duas vezes por vértice (faixas sem reaproveitamento entre latitudes)
+void PrintProceduralComparison() {
+	const uint32_t Resolutions[] = { 50, 256, 1024 };
+
+	std::cout << std::setw(8) << "Res"
+		<< std::setw(14) << "VBO (KiB)"
+		<< std::setw(14) << "EBO (KiB)"
+		<< std::setw(16) << "VS VBO/frame"
+		<< std::setw(16) << "VS proc/frame" << std::endl;
+
+	for (uint32_t Resolution : Resolutions) {
+		std::vector<Vertex> Vertices;
+		std::vector<glm::ivec3> Triangles;
+		GenerateSphereMesh(Resolution, Vertices, Triangles);
+
+		uint32_t* Indices = reinterpret_cast<uint32_t*>(Triangles.data());
+		const size_t NumIndices = Triangles.size() * 3;
+		OptimizeVertexCache(Indices, NumIndices, Vertices.size());
+		const VertexCacheStats Stats = AnalyzeVertexCache(Indices, NumIndices, Vertices.size());
+
+		const size_t ProceduralInvocations = 2ull * Resolution * (Resolution - 1);
+
+		std::cout << std::setw(8) << Resolution
+			<< std::setw(14) << Vertices.size() * sizeof(Vertex) / 1024
+			<< std::setw(14) << NumIndices * sizeof(uint32_t) / 1024
+			<< std::setw(16) << static_cast<size_t>(Stats.ACMR * Triangles.size())
+			<< std::setw(16) << ProceduralInvocations << std::endl;
+	}
+
+	std::cout << std::endl;
+}
+
+int main() {
+	PrintTessellationStats();
+	PrintVertexCacheStats();
+	PrintProceduralComparison();
+
+	const uint32_t Resolutions[] = { 50, 128, 256, 512, 1024, 2048, 4096, 8192, 16384 };
+
+	std::cout << "Threads: " << GetThreadPool().GetNumThreads() << std::endl;
+	std::cout << std::setw(8) << "Res"
+		<< std::setw(14) << "Vertices"
+		<< std::setw(14) << "Ref (ms)"
+		<< std::setw(16) << "Ref (Mvert/s)"
+		<< std::setw(14) << "Novo (ms)"
+		<< std::setw(16) << "Novo (Mvert/s)"
+		<< std::setw(10) << "Ganho" << std::endl;
+
+	for (uint32_t Resolution : Resolutions) {
+		const SphereMeshSize Size = GetSphereMeshSize(Resolution);
+		const size_t MeshBytes = Size.NumVertices * sizeof(Vertex) + Size.NumTriangles * sizeof(glm::ivec3);
+		const bool bFitsInMemory = MeshBytes <= MaxMeshBytes;
+
+		//a referência só roda onde cabe na memória, ela aloca a malha inteira
+		double ReferenceSeconds = 0.0;
+		if (bFitsInMemory) {
+			std::vector<Vertex> Vertices;
+			std::vector<glm::ivec3> Triangles;
+			ReferenceSeconds = MeasureSeconds([&] { GenerateSphereMeshReference(Resolution, Vertices, Triangles); });
+		}
+
+		double NewSeconds = 0.0;
+		if (bFitsInMemory) {
+			//buffers do chamador alocados uma vez, como um buffer mapeado da GPU
+			std::vector<Vertex> Vertices(Size.NumVertices);
+			std::vector<glm::ivec3> Triangles(Size.NumTriangles);
+			NewSeconds = MeasureSeconds([&] { WriteSphereMesh(Resolution, Vertices.data(), Vertices.size(), Triangles.data(), Triangles.size()); });
+		}
+		else {
+			const size_t SlabRows = glm::max<size_t>(1, (MaxMeshBytes / 2) / (sizeof(Vertex) * Resolution));
+			const size_t SlabColumns = glm::max<size_t>(1, (MaxMeshBytes / 2) / (sizeof(glm::ivec3) * (Resolution - 1) * 2));
+			std::vector<Vertex> VertexSlab(SlabRows * Resolution);
+			std::vector<glm::ivec3> TriangleSlab(SlabColumns * (Resolution - 1) * 2);
+			NewSeconds = MeasureSeconds([&] { GenerateInSlabs(Resolution, VertexSlab, TriangleSlab); });
+		}
+
+		const double MegaVertices = Size.NumVertices / 1.0e6;
+
+		std::cout << std::fixed << std::setprecision(2)
+			<< std::setw(8) << Resolution
+			<< std::setw(14) << Size.NumVertices;
+
+		if (bFitsInMemory) {
+			std::cout << std::setw(14) << ReferenceSeconds * 1000.0
+				<< std::setw(16) << MegaVertices / ReferenceSeconds;
+		}
+		else {
+			std::cout << std::setw(14) << "-" << std::setw(16) << "-";
+		}
+
+		std::cout << std::setw(14) << NewSeconds * 1000.0
+			<< std::setw(16) << MegaVertices / NewSeconds;
+
+		if (bFitsInMemory) {
+			std::cout << std::setw(9) << ReferenceSeconds / NewSeconds << "x";
+		}
+		std::cout << std::endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,281 @@
+#include "TextureCache.h"
+
+#include<algorithm>
+#include<cassert>
+#include<cstring>
+#include<filesystem>
+#include<iostream>
+#include<memory>
+#include<new>
+#include<system_error>
+#include<vector>
+
+#include "Hash.h"
+#include "stb_image.h"
+
+//estruturas do formato DDS, gravadas como estão (little endian)
+struct DDSPixelFormat {
+	uint32_t Size;
+	uint32_t Flags;
+	uint32_t FourCC;
+	uint32_t RGBBitCount;
+	uint32_t RBitMask;
+	uint32_t GBitMask;
+	uint32_t BBitMask;
+	uint32_t ABitMask;
+};
+
+struct DDSFileHeader {
+	uint32_t Magic;              //"DDS "
+	uint32_t Size;               //124, o cabeçalho sem o Magic
+	uint32_t Flags;
+	uint32_t Height;
+	uint32_t Width;
+	uint32_t PitchOrLinearSize;
+	uint32_t Depth;
+	uint32_t MipMapCount;
+	uint32_t Reserved1[11];      //[0] "BMTX", [1] versão, [2..3] chave
+	DDSPixelFormat PixelFormat;
+	uint32_t Caps;
+	uint32_t Caps2;
+	uint32_t Caps3;
+	uint32_t Caps4;
+	uint32_t Reserved2;
+	//DDS_HEADER_DXT10
+	uint32_t DXGIFormat;
+	uint32_t ResourceDimension;
+	uint32_t MiscFlag;
+	uint32_t ArraySize;
+	uint32_t MiscFlags2;
+};
+static_assert(sizeof(DDSFileHeader) == 148, "cabecalho DDS com padding");
+
+constexpr uint32_t MakeFourCC(char A, char B, char C, char D) {
+	return static_cast<uint32_t>(A) | (static_cast<uint32_t>(B) << 8) | (static_cast<uint32_t>(C) << 16) | (static_cast<uint32_t>(D) << 24);
+}
+
+constexpr uint32_t DDSMagic = MakeFourCC('D', 'D', 'S', ' ');
+constexpr uint32_t DDSTag = MakeFourCC('B', 'M', 'T', 'X');
+
+constexpr uint32_t DDSD_CAPS = 0x1, DDSD_HEIGHT = 0x2, DDSD_WIDTH = 0x4, DDSD_PIXELFORMAT = 0x1000, DDSD_MIPMAPCOUNT = 0x20000, DDSD_LINEARSIZE = 0x80000;
+constexpr uint32_t DDPF_FOURCC = 0x4;
+constexpr uint32_t DDSCAPS_COMPLEX = 0x8, DDSCAPS_TEXTURE = 0x1000, DDSCAPS_MIPMAP = 0x400000;
+constexpr uint32_t DDSDimensionTexture2D = 3;
+constexpr uint32_t DDSAlphaModeOpaque = 3;
+
+static uint32_t GetDXGIFormat(TextureFormat Format) {
+	switch (Format) {
+	case TextureFormat::BC1: return 71;  //DXGI_FORMAT_BC1_UNORM
+	case TextureFormat::BC4: return 80;  //DXGI_FORMAT_BC4_UNORM
+	case TextureFormat::BC7: return 98;  //DXGI_FORMAT_BC7_UNORM
+	default: return 0;
+	}
+}
+
+//preenche dimensões e offsets dos levels a partir do formato e do tamanho do level 0
+static void ComputeLevels(TextureFileView& View) {
+	size_t Offset = 0;
+	for (uint32_t Level = 0; Level < View.NumLevels; ++Level) {
+		const uint32_t LevelWidth = std::max(1u, View.Width >> Level);
+		const uint32_t LevelHeight = std::max(1u, View.Height >> Level);
+		View.LevelOffsets[Level] = Offset;
+		View.LevelBytes[Level] = GetTextureLevelSize(View.Format, LevelWidth, LevelHeight);
+		Offset += View.LevelBytes[Level];
+	}
+	View.DataBytes = Offset;
+}
+
+//percorre o level 0 e os mipmaps gerados a partir dele, um level é reduzido do anterior
+template<typename FuncType>
+static void ForEachMipLevel(const uint8_t* Pixels, uint32_t Width, uint32_t Height, uint32_t Channels, const MipmapSettings& Mips, uint32_t NumLevels, FuncType Func) {
+	std::vector<uint8_t> Current, Next;
+	const uint8_t* LevelPixels = Pixels;
+	for (uint32_t Level = 0; Level < NumLevels; ++Level) {
+		const uint32_t LevelWidth = std::max(1u, Width >> Level);
+		const uint32_t LevelHeight = std::max(1u, Height >> Level);
+		Func(Level, LevelPixels, LevelWidth, LevelHeight);
+
+		if (Level + 1 < NumLevels) {
+			Next.resize(static_cast<size_t>(std::max(1u, LevelWidth / 2)) * std::max(1u, LevelHeight / 2) * Channels);
+			DownsampleMipLevel(LevelPixels, LevelWidth, LevelHeight, Channels, Mips, Next.data());
+			Current.swap(Next);
+			LevelPixels = Current.data();
+		}
+	}
+}
+
+uint64_t GetTextureCacheKey(const std::string& SourcePath, TextureFormat Format, const MipmapSettings& Mips) {
+	std::error_code Error;
+	const uint64_t FileSize = std::filesystem::file_size(SourcePath, Error);
+	const int64_t WriteTime = static_cast<int64_t>(std::filesystem::last_write_time(SourcePath, Error).time_since_epoch().count());
+
+	uint64_t Key = HashString(SourcePath);
+	Key = HashValue(FileSize, Key);
+	Key = HashValue(WriteTime, Key);
+	Key = HashValue(Format, Key);
+	Key = HashValue(Mips.Filter, Key);
+	Key = HashValue(Mips.bSRGB, Key);
+	Key = HashValue(Mips.AddressX, Key);
+	return HashValue(TextureFileVersion, Key);
+}
+
+std::string GetTextureCachePath(const std::string& SourcePath, uint64_t Key) {
+	return "cache/" + std::filesystem::path(SourcePath).stem().string() + "_" + HashToString(Key) + ".dds";
+}
+
+bool OpenTextureFile(const std::string& Path, uint64_t Key, MappedFile& File, TextureFileView& OutView) {
+	if (!File.OpenRead(Path)) {
+		return false;
+	}
+
+	if (File.GetSize() < sizeof(DDSFileHeader)) {
+		File.Close();
+		return false;
+	}
+
+	DDSFileHeader Header;
+	std::memcpy(&Header, File.GetData(), sizeof(Header));
+
+	uint64_t FileKey;
+	std::memcpy(&FileKey, &Header.Reserved1[2], sizeof(FileKey));
+
+	TextureFileView View;
+	const TextureFormat Formats[] = { TextureFormat::BC1, TextureFormat::BC4, TextureFormat::BC7 };
+	bool bKnownFormat = false;
+	for (TextureFormat Format : Formats) {
+		if (Header.DXGIFormat == GetDXGIFormat(Format)) {
+			View.Format = Format;
+			bKnownFormat = true;
+		}
+	}
+
+	View.Width = Header.Width;
+	View.Height = Header.Height;
+	View.NumLevels = Header.MipMapCount;
+
+	const bool bValidHeader = Header.Magic == DDSMagic
+		&& Header.Reserved1[0] == DDSTag
+		&& Header.Reserved1[1] == TextureFileVersion
+		&& FileKey == Key
+		&& Header.PixelFormat.FourCC == MakeFourCC('D', 'X', '1', '0')
+		&& bKnownFormat
+		&& View.Width > 0 && View.Height > 0
+		&& View.NumLevels > 0 && View.NumLevels <= MaxTextureLevels;
+
+	if (bValidHeader) {
+		ComputeLevels(View);
+	}
+
+	if (!bValidHeader || sizeof(DDSFileHeader) + View.DataBytes > File.GetSize()) {
+		File.Close();
+		return false;
+	}
+
+	View.Data = File.GetData() + sizeof(DDSFileHeader);
+	OutView = View;
+	return true;
+}
+
+bool BuildTextureFile(const std::string& Path, uint64_t Key, TextureFormat Format, const uint8_t* Pixels, uint32_t Width, uint32_t Height, uint32_t Channels, const MipmapSettings& Mips) {
+	assert(IsCompressed(Format));
+
+	const TextureFileView View = GetTextureLayout(Format, Width, Height);
+
+	std::error_code Error;
+	std::filesystem::create_directories(std::filesystem::path(Path).parent_path(), Error);
+
+	MappedFile File;
+	if (!File.CreateWrite(Path + ".tmp", sizeof(DDSFileHeader) + View.DataBytes)) {
+		return false;
+	}
+
+	uint8_t* Data = File.GetMutableData();
+	DDSFileHeader* Header = new (Data) DDSFileHeader{};
+	Header->Magic = DDSMagic;
+	Header->Size = 124;
+	Header->Flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | DDSD_LINEARSIZE;
+	Header->Height = Height;
+	Header->Width = Width;
+	Header->PitchOrLinearSize = static_cast<uint32_t>(View.LevelBytes[0]);
+	Header->MipMapCount = View.NumLevels;
+	Header->Reserved1[0] = DDSTag;
+	Header->Reserved1[1] = TextureFileVersion;
+	std::memcpy(&Header->Reserved1[2], &Key, sizeof(Key));
+	Header->PixelFormat.Size = sizeof(DDSPixelFormat);
+	Header->PixelFormat.Flags = DDPF_FOURCC;
+	Header->PixelFormat.FourCC = MakeFourCC('D', 'X', '1', '0');
+	Header->Caps = DDSCAPS_COMPLEX | DDSCAPS_TEXTURE | DDSCAPS_MIPMAP;
+	Header->DXGIFormat = GetDXGIFormat(Format);
+	Header->ResourceDimension = DDSDimensionTexture2D;
+	Header->ArraySize = 1;
+	Header->MiscFlags2 = DDSAlphaModeOpaque;
+
+	ForEachMipLevel(Pixels, Width, Height, Channels, Mips, View.NumLevels, [&](uint32_t Level, const uint8_t* LevelPixels, uint32_t LevelWidth, uint32_t LevelHeight) {
+		CompressImage(Format, LevelPixels, LevelWidth, LevelHeight, Channels, Data + sizeof(DDSFileHeader) + View.LevelOffsets[Level]);
+	});
+
+	File.Close();
+	std::filesystem::rename(Path + ".tmp", Path, Error);
+	return !Error;
+}
+
+bool LoadCachedTexture(const std::string& SourcePath, TextureFormat Format, const MipmapSettings& Mips, MappedFile& File, TextureFileView& OutView, std::string& OutFailureReason) {
+	const uint64_t Key = GetTextureCacheKey(SourcePath, Format, Mips);
+	const std::string CachePath = GetTextureCachePath(SourcePath, Key);
+	if (OpenTextureFile(CachePath, Key, File, OutView)) {
+		return true;
+	}
+
+	const int Channels = static_cast<int>(GetChannelCount(Format));
+	int Width = 0, Height = 0, NumberOfComponents = 0;
+	std::unique_ptr<unsigned char, void (*)(void*)> Pixels(stbi_load(SourcePath.c_str(), &Width, &Height, &NumberOfComponents, Channels), stbi_image_free);
+	if (!Pixels) {
+		OutFailureReason = stbi_failure_reason();
+		return false;
+	}
+
+	std::cout << "Comprimindo " << SourcePath << " " << Width << "x" << Height << " em " << ToString(Format) << " (mipmaps " << ToString(Mips.Filter) << ")" << std::endl;
+	if (!BuildTextureFile(CachePath, Key, Format, Pixels.get(), static_cast<uint32_t>(Width), static_cast<uint32_t>(Height), static_cast<uint32_t>(Channels), Mips)
+		|| !OpenTextureFile(CachePath, Key, File, OutView)) {
+		OutFailureReason = "nao foi possivel gravar " + CachePath;
+		return false;
+	}
+	return true;
+}
+
+TextureFileView GetTextureLayout(TextureFormat Format, uint32_t Width, uint32_t Height) {
+	TextureFileView View;
+	View.Format = Format;
+	View.Width = Width;
+	View.Height = Height;
+	View.NumLevels = std::min(GetNumMipLevels(Width, Height), MaxTextureLevels);
+	ComputeLevels(View);
+	return View;
+}
+
+void BuildTextureLevels(const uint8_t* Pixels, uint32_t Width, uint32_t Height, TextureFormat Format, const MipmapSettings& Mips, std::vector<uint8_t>& OutData, TextureFileView& OutView) {
+	assert(!IsCompressed(Format));
+	OutView = GetTextureLayout(Format, Width, Height);
+
+	OutData.resize(OutView.DataBytes);
+	ForEachMipLevel(Pixels, Width, Height, GetChannelCount(Format), Mips, OutView.NumLevels, [&](uint32_t Level, const uint8_t* LevelPixels, uint32_t, uint32_t) {
+		std::memcpy(OutData.data() + OutView.LevelOffsets[Level], LevelPixels, OutView.LevelBytes[Level]);
+	});
+	OutView.Data = OutData.data();
+}
+
+uint32_t GetFirstLevelUpTo(const TextureFileView& View, uint32_t MaxSize) {
+	uint32_t Level = 0;
+	while (Level + 1 < View.NumLevels && std::max(View.Width >> Level, View.Height >> Level) > MaxSize) {
+		++Level;
+	}
+	return Level;
+}
+
+size_t GetTextureBytes(const TextureFileView& View, uint32_t FirstLevel) {
+	size_t Bytes = 0;
+	for (uint32_t Level = FirstLevel; Level < View.NumLevels; ++Level) {
+		Bytes += View.LevelBytes[Level];
+	}
+	return Bytes;
+}
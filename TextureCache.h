@@ -0,0 +1,55 @@
+#pragma once
+
+#include<cstddef>
+#include<cstdint>
+#include<string>
+#include<vector>
+
+#include "MappedFile.h"
+#include "Mipmap.h"
+#include "TextureCompression.h"
+
+//cache de texturas comprimidas em arquivos DDS (cabeçalho DX10) com todos os mip levels prontos (gerados na CPU),
+//mapeados e enviados direto para o glCompressedTexImage2D. As linhas ficam na ordem do OpenGL
+//(de baixo para cima, como o stbi_load com flip), então visualizadores de DDS mostram a imagem invertida.
+//mudar o encoder ou o layout exige incrementar TextureFileVersion.
+constexpr uint32_t TextureFileVersion = 2;
+constexpr uint32_t MaxTextureLevels = 16;
+
+//ponteiros para dentro de um arquivo de textura mapeado, ou dos levels RGB8/R8 gerados em memória
+struct TextureFileView {
+	TextureFormat Format = TextureFormat::BC1;
+	uint32_t Width = 0;
+	uint32_t Height = 0;
+	uint32_t NumLevels = 0;
+	const uint8_t* Data = nullptr;  //início do level 0, os outros vêm em seguida
+	size_t DataBytes = 0;
+	size_t LevelOffsets[MaxTextureLevels] = {};  //relativos a Data
+	size_t LevelBytes[MaxTextureLevels] = {};
+};
+
+//chave do cache: caminho, tamanho e data de modificação da imagem original, formato, filtro dos mipmaps e versão
+uint64_t GetTextureCacheKey(const std::string& SourcePath, TextureFormat Format, const MipmapSettings& Mips);
+
+std::string GetTextureCachePath(const std::string& SourcePath, uint64_t Key);
+
+//mapeia um arquivo de textura e valida chave, formato e tamanhos
+bool OpenTextureFile(const std::string& Path, uint64_t Key, MappedFile& File, TextureFileView& OutView);
+
+//comprime a imagem e todos os mip levels e grava o arquivo (via Path + ".tmp", como o cache de malhas)
+bool BuildTextureFile(const std::string& Path, uint64_t Key, TextureFormat Format, const uint8_t* Pixels, uint32_t Width, uint32_t Height, uint32_t Channels, const MipmapSettings& Mips);
+
+//abre do cache ou decodifica a imagem original e cria o arquivo. Pode rodar fora da thread do OpenGL.
+bool LoadCachedTexture(const std::string& SourcePath, TextureFormat Format, const MipmapSettings& Mips, MappedFile& File, TextureFileView& OutView, std::string& OutFailureReason);
+
+//levels de uma textura com todos os mipmaps (até MaxTextureLevels), sem dados
+TextureFileView GetTextureLayout(TextureFormat Format, uint32_t Width, uint32_t Height);
+
+//RGB8 ou R8 sem cache: gera os mipmaps de uma imagem de 3 ou 1 canal em OutData, com o mesmo layout de levels do arquivo
+void BuildTextureLevels(const uint8_t* Pixels, uint32_t Width, uint32_t Height, TextureFormat Format, const MipmapSettings& Mips, std::vector<uint8_t>& OutData, TextureFileView& OutView);
+
+//primeiro level com os dois lados até MaxSize, usado para prévias
+uint32_t GetFirstLevelUpTo(const TextureFileView& View, uint32_t MaxSize);
+
+//bytes ocupados na GPU pelos levels a partir de FirstLevel
+size_t GetTextureBytes(const TextureFileView& View, uint32_t FirstLevel);
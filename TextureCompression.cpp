@@ -0,0 +1,443 @@
+#include "TextureCompression.h"
+
+#include<algorithm>
+#include<cassert>
+#include<cstring>
+
+#include<GL/glew.h>
+#include<glm/glm.hpp>
+
+#include "ThreadPool.h"
+
+//linhas de blocos por ParallelFor: chamadas curtas para não segurar o pool enquanto outra thread precisa dele
+constexpr uint32_t BlockRowsPerBatch = 16;
+
+const char* ToString(TextureFormat Format) {
+	switch (Format) {
+	case TextureFormat::BC1: return "bc1";
+	case TextureFormat::BC4: return "bc4";
+	case TextureFormat::BC7: return "bc7";
+	case TextureFormat::R8: return "r8";
+	default: return "rgb";
+	}
+}
+
+bool ParseTextureFormat(const char* Text, TextureFormat& OutFormat) {
+	const TextureFormat Formats[] = { TextureFormat::RGB8, TextureFormat::BC1, TextureFormat::BC4, TextureFormat::BC7, TextureFormat::R8 };
+	for (TextureFormat Format : Formats) {
+		if (std::strcmp(Text, ToString(Format)) == 0) {
+			OutFormat = Format;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool IsCompressed(TextureFormat Format) {
+	return Format != TextureFormat::RGB8 && Format != TextureFormat::R8;
+}
+
+uint32_t GetChannelCount(TextureFormat Format) {
+	return Format == TextureFormat::BC4 || Format == TextureFormat::R8 ? 1 : 3;
+}
+
+uint32_t GetBlockBytes(TextureFormat Format) {
+	return Format == TextureFormat::BC7 ? 16 : 8;
+}
+
+size_t GetTextureLevelSize(TextureFormat Format, uint32_t Width, uint32_t Height) {
+	if (!IsCompressed(Format)) {
+		return static_cast<size_t>(Width) * Height * GetChannelCount(Format);
+	}
+	return static_cast<size_t>((Width + 3) / 4) * ((Height + 3) / 4) * GetBlockBytes(Format);
+}
+
+uint32_t GetGLInternalFormat(TextureFormat Format) {
+	switch (Format) {
+	case TextureFormat::BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+	case TextureFormat::BC4: return GL_COMPRESSED_RED_RGTC1;
+	case TextureFormat::BC7: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+	case TextureFormat::R8: return GL_R8;
+	default: return GL_RGB8;
+	}
+}
+
+//eixo principal das cores do bloco (iteração de potência na covariância), usado para escolher os extremos
+static glm::vec3 GetPrincipalAxis(const glm::vec3 Colors[16], const glm::vec3& Mean) {
+	float Covariance[6] = { 0, 0, 0, 0, 0, 0 };
+	for (int Index = 0; Index < 16; ++Index) {
+		const glm::vec3 D = Colors[Index] - Mean;
+		Covariance[0] += D.x * D.x;
+		Covariance[1] += D.x * D.y;
+		Covariance[2] += D.x * D.z;
+		Covariance[3] += D.y * D.y;
+		Covariance[4] += D.y * D.z;
+		Covariance[5] += D.z * D.z;
+	}
+
+	glm::vec3 Axis{ 1.0f, 1.0f, 1.0f };
+	for (int Iteration = 0; Iteration < 8; ++Iteration) {
+		const glm::vec3 Next{
+			Covariance[0] * Axis.x + Covariance[1] * Axis.y + Covariance[2] * Axis.z,
+			Covariance[1] * Axis.x + Covariance[3] * Axis.y + Covariance[4] * Axis.z,
+			Covariance[2] * Axis.x + Covariance[4] * Axis.y + Covariance[5] * Axis.z
+		};
+		const float Length = glm::max(glm::max(glm::abs(Next.x), glm::abs(Next.y)), glm::abs(Next.z));
+		if (Length < 1e-6f) {
+			break;
+		}
+		Axis = Next / Length;
+	}
+	return Axis;
+}
+
+//extremos do bloco projetados no eixo principal
+static void GetEndpoints(const glm::vec3 Colors[16], glm::vec3& OutMin, glm::vec3& OutMax) {
+	glm::vec3 Mean{ 0.0f };
+	for (int Index = 0; Index < 16; ++Index) {
+		Mean += Colors[Index];
+	}
+	Mean /= 16.0f;
+
+	const glm::vec3 Axis = GetPrincipalAxis(Colors, Mean);
+	float MinProjection = glm::dot(Colors[0] - Mean, Axis);
+	float MaxProjection = MinProjection;
+	OutMin = OutMax = Colors[0];
+	for (int Index = 1; Index < 16; ++Index) {
+		const float Projection = glm::dot(Colors[Index] - Mean, Axis);
+		if (Projection < MinProjection) {
+			MinProjection = Projection;
+			OutMin = Colors[Index];
+		}
+		if (Projection > MaxProjection) {
+			MaxProjection = Projection;
+			OutMax = Colors[Index];
+		}
+	}
+}
+
+//mínimos quadrados: melhores extremos para os pesos escolhidos (Weights em [0, 1] a partir de E0)
+static bool RefineEndpoints(const glm::vec3 Colors[16], const float Weights[16], glm::vec3& InOutE0, glm::vec3& InOutE1) {
+	float A = 0.0f, B = 0.0f, C = 0.0f;
+	glm::vec3 X{ 0.0f }, Y{ 0.0f };
+	for (int Index = 0; Index < 16; ++Index) {
+		const float W1 = Weights[Index];
+		const float W0 = 1.0f - W1;
+		A += W0 * W0;
+		B += W0 * W1;
+		C += W1 * W1;
+		X += W0 * Colors[Index];
+		Y += W1 * Colors[Index];
+	}
+
+	const float Determinant = A * C - B * B;
+	if (glm::abs(Determinant) < 1e-6f) {
+		return false;
+	}
+
+	InOutE0 = glm::clamp((X * C - Y * B) / Determinant, glm::vec3{ 0.0f }, glm::vec3{ 255.0f });
+	InOutE1 = glm::clamp((Y * A - X * B) / Determinant, glm::vec3{ 0.0f }, glm::vec3{ 255.0f });
+	return true;
+}
+
+static uint16_t ToRGB565(const glm::vec3& Color) {
+	const uint32_t R = static_cast<uint32_t>(glm::round(Color.x * 31.0f / 255.0f));
+	const uint32_t G = static_cast<uint32_t>(glm::round(Color.y * 63.0f / 255.0f));
+	const uint32_t B = static_cast<uint32_t>(glm::round(Color.z * 31.0f / 255.0f));
+	return static_cast<uint16_t>((R << 11) | (G << 5) | B);
+}
+
+static glm::vec3 FromRGB565(uint16_t Color) {
+	const uint32_t R = (Color >> 11) & 31;
+	const uint32_t G = (Color >> 5) & 63;
+	const uint32_t B = Color & 31;
+	return glm::vec3{ (R << 3) | (R >> 2), (G << 2) | (G >> 4), (B << 3) | (B >> 2) };
+}
+
+//escolhe o índice de cada pixel para os extremos quantizados e devolve o erro quadrático
+static float EncodeBC1Indices(const glm::vec3 Colors[16], uint16_t Color0, uint16_t Color1, uint32_t& OutIndices, float OutWeights[16]) {
+	const glm::vec3 C0 = FromRGB565(Color0);
+	const glm::vec3 C1 = FromRGB565(Color1);
+	const glm::vec3 Palette[4] = { C0, C1, (C0 * 2.0f + C1) / 3.0f, (C0 + C1 * 2.0f) / 3.0f };
+	const float PaletteWeights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+
+	float Error = 0.0f;
+	OutIndices = 0;
+	for (int Index = 0; Index < 16; ++Index) {
+		int Best = 0;
+		float BestDistance = 1e30f;
+		for (int Entry = 0; Entry < 4; ++Entry) {
+			const glm::vec3 D = Colors[Index] - Palette[Entry];
+			const float Distance = glm::dot(D, D);
+			if (Distance < BestDistance) {
+				BestDistance = Distance;
+				Best = Entry;
+			}
+		}
+		OutIndices |= static_cast<uint32_t>(Best) << (Index * 2);
+		OutWeights[Index] = PaletteWeights[Best];
+		Error += BestDistance;
+	}
+	return Error;
+}
+
+void CompressBlockBC1(const uint8_t Pixels[16 * 4], uint8_t OutBlock[8]) {
+	glm::vec3 Colors[16];
+	for (int Index = 0; Index < 16; ++Index) {
+		Colors[Index] = glm::vec3{ Pixels[Index * 4 + 0], Pixels[Index * 4 + 1], Pixels[Index * 4 + 2] };
+	}
+
+	glm::vec3 Min, Max;
+	GetEndpoints(Colors, Min, Max);
+
+	uint16_t Color0 = ToRGB565(Max);
+	uint16_t Color1 = ToRGB565(Min);
+	uint32_t Indices = 0;
+	float Weights[16];
+	float Error = EncodeBC1Indices(Colors, Color0, Color1, Indices, Weights);
+
+	//uma passada de mínimos quadrados, mantida só se diminuir o erro
+	glm::vec3 E0 = FromRGB565(Color0), E1 = FromRGB565(Color1);
+	if (RefineEndpoints(Colors, Weights, E0, E1)) {
+		const uint16_t Refined0 = ToRGB565(E0);
+		const uint16_t Refined1 = ToRGB565(E1);
+		uint32_t RefinedIndices = 0;
+		float RefinedWeights[16];
+		const float RefinedError = EncodeBC1Indices(Colors, Refined0, Refined1, RefinedIndices, RefinedWeights);
+		if (RefinedError < Error) {
+			Color0 = Refined0;
+			Color1 = Refined1;
+			Indices = RefinedIndices;
+		}
+	}
+
+	//o modo de 4 cores exige Color0 > Color1: troca os extremos e os índices 0<->1 e 2<->3
+	if (Color0 < Color1) {
+		std::swap(Color0, Color1);
+		Indices ^= 0x55555555u;
+	}
+	else if (Color0 == Color1) {
+		Indices = 0;
+	}
+
+	OutBlock[0] = static_cast<uint8_t>(Color0 & 0xFF);
+	OutBlock[1] = static_cast<uint8_t>(Color0 >> 8);
+	OutBlock[2] = static_cast<uint8_t>(Color1 & 0xFF);
+	OutBlock[3] = static_cast<uint8_t>(Color1 >> 8);
+	std::memcpy(OutBlock + 4, &Indices, 4);
+}
+
+void CompressBlockBC4(const uint8_t Values[16], uint8_t OutBlock[8]) {
+	uint8_t Min = Values[0], Max = Values[0];
+	for (int Index = 1; Index < 16; ++Index) {
+		Min = std::min(Min, Values[Index]);
+		Max = std::max(Max, Values[Index]);
+	}
+
+	//modo de 8 valores (Red0 > Red1): 0 = Max, 1 = Min, 2..7 interpolam de Max para Min
+	uint64_t Bits = static_cast<uint64_t>(Max) | (static_cast<uint64_t>(Min) << 8);
+	if (Max > Min) {
+		const float Scale = 7.0f / static_cast<float>(Max - Min);
+		for (int Index = 0; Index < 16; ++Index) {
+			const int Step = static_cast<int>(glm::round((Max - Values[Index]) * Scale));
+			const uint64_t Code = Step == 0 ? 0 : (Step == 7 ? 1 : static_cast<uint64_t>(Step + 1));
+			Bits |= Code << (16 + Index * 3);
+		}
+	}
+
+	std::memcpy(OutBlock, &Bits, 8);
+}
+
+//BC7 modo 6: um subconjunto, extremos RGBA de 7 bits + p-bit, índices de 4 bits
+static const int BC7Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+struct BC7Mode6 {
+	glm::ivec4 Endpoints[2];  //7 bits por canal
+	int PBits[2];
+	uint8_t Indices[16];
+	float Error;
+};
+
+static glm::ivec4 ExpandBC7(const glm::ivec4& Endpoint, int PBit) {
+	return Endpoint * 2 + glm::ivec4{ PBit };
+}
+
+static void EncodeBC7Indices(const glm::vec4 Colors[16], BC7Mode6& Mode) {
+	const glm::ivec4 E0 = ExpandBC7(Mode.Endpoints[0], Mode.PBits[0]);
+	const glm::ivec4 E1 = ExpandBC7(Mode.Endpoints[1], Mode.PBits[1]);
+
+	glm::vec4 Palette[16];
+	for (int Entry = 0; Entry < 16; ++Entry) {
+		const glm::ivec4 Value = (E0 * (64 - BC7Weights4[Entry]) + E1 * BC7Weights4[Entry] + glm::ivec4{ 32 }) / 64;
+		Palette[Entry] = glm::vec4{ Value };
+	}
+
+	Mode.Error = 0.0f;
+	for (int Index = 0; Index < 16; ++Index) {
+		int Best = 0;
+		float BestDistance = 1e30f;
+		for (int Entry = 0; Entry < 16; ++Entry) {
+			const glm::vec4 D = Colors[Index] - Palette[Entry];
+			const float Distance = glm::dot(D, D);
+			if (Distance < BestDistance) {
+				BestDistance = Distance;
+				Best = Entry;
+			}
+		}
+		Mode.Indices[Index] = static_cast<uint8_t>(Best);
+		Mode.Error += BestDistance;
+	}
+}
+
+//quantiza os extremos para 7 bits + p-bit testando as quatro combinações de p-bits
+static BC7Mode6 QuantizeBC7(const glm::vec4 Colors[16], const glm::vec4& E0, const glm::vec4& E1) {
+	BC7Mode6 Best;
+	Best.Error = 1e30f;
+
+	for (int PBits = 0; PBits < 4; ++PBits) {
+		BC7Mode6 Mode;
+		Mode.PBits[0] = PBits & 1;
+		Mode.PBits[1] = PBits >> 1;
+		const glm::vec4 Ends[2] = { E0, E1 };
+		for (int End = 0; End < 2; ++End) {
+			const glm::vec4 Quantized = glm::round((Ends[End] - glm::vec4{ static_cast<float>(Mode.PBits[End]) }) * 0.5f);
+			Mode.Endpoints[End] = glm::clamp(glm::ivec4{ Quantized }, glm::ivec4{ 0 }, glm::ivec4{ 127 });
+		}
+
+		EncodeBC7Indices(Colors, Mode);
+		if (Mode.Error < Best.Error) {
+			Best = Mode;
+		}
+	}
+	return Best;
+}
+
+void CompressBlockBC7(const uint8_t Pixels[16 * 4], uint8_t OutBlock[16]) {
+	glm::vec3 Colors[16];
+	glm::vec4 ColorsAlpha[16];
+	for (int Index = 0; Index < 16; ++Index) {
+		Colors[Index] = glm::vec3{ Pixels[Index * 4 + 0], Pixels[Index * 4 + 1], Pixels[Index * 4 + 2] };
+		ColorsAlpha[Index] = glm::vec4{ Colors[Index], Pixels[Index * 4 + 3] };
+	}
+
+	glm::vec3 Min, Max;
+	GetEndpoints(Colors, Min, Max);
+
+	float MinAlpha = 255.0f, MaxAlpha = 0.0f;
+	for (int Index = 0; Index < 16; ++Index) {
+		MinAlpha = glm::min(MinAlpha, ColorsAlpha[Index].w);
+		MaxAlpha = glm::max(MaxAlpha, ColorsAlpha[Index].w);
+	}
+
+	BC7Mode6 Mode = QuantizeBC7(ColorsAlpha, glm::vec4{ Min, MinAlpha }, glm::vec4{ Max, MaxAlpha });
+
+	//uma passada de mínimos quadrados nas cores, mantida só se diminuir o erro
+	float Weights[16];
+	for (int Index = 0; Index < 16; ++Index) {
+		Weights[Index] = BC7Weights4[Mode.Indices[Index]] / 64.0f;
+	}
+	glm::vec3 E0 = Min, E1 = Max;
+	if (RefineEndpoints(Colors, Weights, E0, E1)) {
+		const BC7Mode6 Refined = QuantizeBC7(ColorsAlpha, glm::vec4{ E0, MinAlpha }, glm::vec4{ E1, MaxAlpha });
+		if (Refined.Error < Mode.Error) {
+			Mode = Refined;
+		}
+	}
+
+	//o índice do pixel 0 é gravado com 3 bits, então o bit mais alto precisa ser 0
+	if (Mode.Indices[0] >= 8) {
+		std::swap(Mode.Endpoints[0], Mode.Endpoints[1]);
+		std::swap(Mode.PBits[0], Mode.PBits[1]);
+		for (uint8_t& Index : Mode.Indices) {
+			Index = static_cast<uint8_t>(15 - Index);
+		}
+	}
+
+	//escreve os 128 bits do menos para o mais significativo
+	uint64_t Words[2] = { 0, 0 };
+	int Position = 0;
+	auto WriteBits = [&Words, &Position](uint64_t Value, int Count) {
+		for (int Bit = 0; Bit < Count; ++Bit, ++Position) {
+			Words[Position / 64] |= ((Value >> Bit) & 1ull) << (Position % 64);
+		}
+	};
+
+	WriteBits(1ull << 6, 7);
+	for (int Channel = 0; Channel < 4; ++Channel) {
+		WriteBits(static_cast<uint64_t>(Mode.Endpoints[0][Channel]), 7);
+		WriteBits(static_cast<uint64_t>(Mode.Endpoints[1][Channel]), 7);
+	}
+	WriteBits(static_cast<uint64_t>(Mode.PBits[0]), 1);
+	WriteBits(static_cast<uint64_t>(Mode.PBits[1]), 1);
+	WriteBits(Mode.Indices[0], 3);
+	for (int Index = 1; Index < 16; ++Index) {
+		WriteBits(Mode.Indices[Index], 4);
+	}
+	assert(Position == 128);
+
+	std::memcpy(OutBlock, Words, 16);
+}
+
+void CompressImage(TextureFormat Format, const uint8_t* Pixels, uint32_t Width, uint32_t Height, uint32_t Channels, uint8_t* OutBlocks) {
+	assert(IsCompressed(Format));
+	assert(Channels == 1 || Channels == 3);
+
+	const uint32_t BlocksX = (Width + 3) / 4;
+	const uint32_t BlocksY = (Height + 3) / 4;
+	const uint32_t BlockBytes = GetBlockBytes(Format);
+
+	auto CompressRows = [=](size_t RowBegin, size_t RowEnd) {
+		uint8_t Rgba[16 * 4];
+		uint8_t Values[16];
+
+		for (size_t BlockY = RowBegin; BlockY < RowEnd; ++BlockY) {
+			for (uint32_t BlockX = 0; BlockX < BlocksX; ++BlockX) {
+				for (uint32_t Y = 0; Y < 4; ++Y) {
+					const uint32_t SourceY = std::min(static_cast<uint32_t>(BlockY) * 4 + Y, Height - 1);
+					for (uint32_t X = 0; X < 4; ++X) {
+						const uint32_t SourceX = std::min(BlockX * 4 + X, Width - 1);
+						const uint8_t* Source = Pixels + (static_cast<size_t>(SourceY) * Width + SourceX) * Channels;
+						const uint32_t Pixel = Y * 4 + X;
+						if (Channels == 1) {
+							Values[Pixel] = Source[0];
+						}
+						else {
+							Rgba[Pixel * 4 + 0] = Source[0];
+							Rgba[Pixel * 4 + 1] = Source[1];
+							Rgba[Pixel * 4 + 2] = Source[2];
+							Rgba[Pixel * 4 + 3] = 255;
+						}
+					}
+				}
+
+				uint8_t* Out = OutBlocks + (BlockY * BlocksX + BlockX) * BlockBytes;
+				if (Format == TextureFormat::BC4) {
+					if (Channels == 3) {
+						for (int Pixel = 0; Pixel < 16; ++Pixel) {
+							Values[Pixel] = Rgba[Pixel * 4];
+						}
+					}
+					CompressBlockBC4(Values, Out);
+				}
+				else {
+					if (Channels == 1) {
+						for (int Pixel = 0; Pixel < 16; ++Pixel) {
+							Rgba[Pixel * 4 + 0] = Rgba[Pixel * 4 + 1] = Rgba[Pixel * 4 + 2] = Values[Pixel];
+							Rgba[Pixel * 4 + 3] = 255;
+						}
+					}
+					if (Format == TextureFormat::BC1) {
+						CompressBlockBC1(Rgba, Out);
+					}
+					else {
+						CompressBlockBC7(Rgba, Out);
+					}
+				}
+			}
+		}
+	};
+
+	for (uint32_t Batch = 0; Batch < BlocksY; Batch += BlockRowsPerBatch) {
+		ParallelFor(Batch, std::min(Batch + BlockRowsPerBatch, BlocksY), 1, CompressRows);
+	}
+}
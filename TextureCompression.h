@@ -0,0 +1,35 @@
+#pragma once
+
+#include<cstddef>
+#include<cstdint>
+
+//formatos de textura que o cache sabe gerar. Os BCn guardam blocos de 4x4 pixels.
+enum class TextureFormat {
+	RGB8,  //sem compressão, decodificada a cada execução
+	BC1,   //cor RGB, 8 bytes por bloco (0.5 byte por pixel)
+	BC4,   //um canal (máscara de nuvens), 8 bytes por bloco
+	BC7,   //cor RGB de alta qualidade (modo 6), 16 bytes por bloco
+	R8     //um canal sem compressão, a máscara quando a cor é RGB8
+};
+
+const char* ToString(TextureFormat Format);
+bool ParseTextureFormat(const char* Text, TextureFormat& OutFormat);
+
+bool IsCompressed(TextureFormat Format);
+uint32_t GetChannelCount(TextureFormat Format);
+uint32_t GetBlockBytes(TextureFormat Format);
+size_t GetTextureLevelSize(TextureFormat Format, uint32_t Width, uint32_t Height);
+
+//internal format do glCompressedTexImage2D (ou do glTexImage2D para RGB8 e R8)
+uint32_t GetGLInternalFormat(TextureFormat Format);
+
+//compressão de um bloco 4x4. Pixels em RGBA, linha por linha.
+void CompressBlockBC1(const uint8_t Pixels[16 * 4], uint8_t OutBlock[8]);
+void CompressBlockBC7(const uint8_t Pixels[16 * 4], uint8_t OutBlock[16]);
+
+//um canal por pixel
+void CompressBlockBC4(const uint8_t Values[16], uint8_t OutBlock[8]);
+
+//comprime uma imagem RGB (Channels = 3) ou de um canal (Channels = 1) inteira, dividindo as linhas de blocos
+//entre as threads do pool. Bordas que não fecham um bloco repetem o último pixel.
+void CompressImage(TextureFormat Format, const uint8_t* Pixels, uint32_t Width, uint32_t Height, uint32_t Channels, uint8_t* OutBlocks);
@@ -0,0 +1,507 @@
+#include "TextureLayers.h"
+
+#include<algorithm>
+#include<cassert>
+#include<cmath>
+#include<cstring>
+#include<iostream>
+#include<limits>
+#include<tuple>
+
+#include "GLState.h"
+#include "Profiler.h"
+
+//mínimo garantido pelo OpenGL 3.3 (GL_MAX_ARRAY_TEXTURE_LAYERS)
+constexpr uint32_t MaxLayersPerArray = 256;
+
+//frames desde a última troca de levels de um array antes de ele poder crescer de novo
+constexpr uint64_t RegrowFrames = 120;
+
+TextureFormat GetLayerFormat(uint32_t Channels, TextureFormat ColorFormat) {
+	assert(Channels == 1 || Channels == 3);
+	if (Channels == 3) {
+		return ColorFormat;
+	}
+	return IsCompressed(ColorFormat) ? TextureFormat::BC4 : TextureFormat::R8;
+}
+
+TextureLayerHandle TextureLayers::AddLayer(const std::string& Name, uint32_t Width, uint32_t Height, TextureFormat Format, const glm::vec3& PlaceholderColor) {
+	assert(Width > 0 && Height > 0);
+
+	//só arrays ainda não alocados aceitam camadas novas
+	size_t ArrayIndex = Arrays.size();
+	for (size_t Index = 0; Index < Arrays.size(); ++Index) {
+		const LayerArray& Array = Arrays[Index];
+		if (Array.Texture == 0 && Array.NumLayers < MaxLayersPerArray
+			&& Array.Layout.Format == Format && Array.Layout.Width == Width && Array.Layout.Height == Height) {
+			ArrayIndex = Index;
+			break;
+		}
+	}
+
+	if (ArrayIndex == Arrays.size()) {
+		const uint32_t Channels = GetChannelCount(Format);
+		const size_t SameChannels = std::count_if(Arrays.begin(), Arrays.end(), [Channels](const LayerArray& Array) { return GetChannelCount(Array.Layout.Format) == Channels; });
+
+		LayerArray Array;
+		Array.Layout = GetTextureLayout(Format, Width, Height);
+		Array.PreviewLevel = GetFirstLevelUpTo(Array.Layout, TextureLayerPreviewSize);
+		Array.SamplerName = Channels == 1 ? "MaskLayers" : "ColorLayers";
+		if (SameChannels > 0) {
+			Array.SamplerName += std::to_string(SameChannels);
+		}
+		Arrays.push_back(Array);
+	}
+
+	Layer NewLayer;
+	NewLayer.Name = Name;
+	NewLayer.Array = ArrayIndex;
+	NewLayer.Index = Arrays[ArrayIndex].NumLayers++;
+	NewLayer.PlaceholderColor = glm::clamp(PlaceholderColor, glm::vec3{ 0.0f }, glm::vec3{ 1.0f });
+	Layers.push_back(NewLayer);
+
+	return Layers.size() - 1;
+}
+
+const TextureFileView& TextureLayers::GetLayout(TextureLayerHandle Handle) const {
+	assert(Handle < Layers.size());
+	return Arrays[Layers[Handle].Array].Layout;
+}
+
+uint32_t TextureLayers::GetPreviewLevel(TextureLayerHandle Handle) const {
+	assert(Handle < Layers.size());
+	return Arrays[Layers[Handle].Array].PreviewLevel;
+}
+
+uint32_t TextureLayers::GetResidentLevel(TextureLayerHandle Handle) const {
+	assert(Handle < Layers.size());
+	return Arrays[Layers[Handle].Array].ResidentLevel;
+}
+
+size_t TextureLayers::GetArrayBytes(const LayerArray& Array, uint32_t FirstLevel) const {
+	size_t Bytes = 0;
+	for (uint32_t Level = FirstLevel; Level < Array.Layout.NumLevels; ++Level) {
+		Bytes += Array.Layout.LevelBytes[Level] * Array.NumLayers;
+	}
+	return Bytes;
+}
+
+void TextureLayers::SetBudget(size_t BudgetBytes, size_t ReservedBytes) {
+	Stats.BudgetBytes = BudgetBytes;
+	Stats.ReservedBytes = ReservedBytes;
+}
+
+void TextureLayers::FitBudget() {
+	for (LayerArray& Array : Arrays) {
+		Array.WantedLevel = 0;
+	}
+	Stats.bOverBudget = false;
+	if (Stats.BudgetBytes == 0) {
+		return;
+	}
+
+	const size_t Available = Stats.BudgetBytes > Stats.ReservedBytes ? Stats.BudgetBytes - Stats.ReservedBytes : 0;
+	size_t Total = 0;
+	for (const LayerArray& Array : Arrays) {
+		Total += GetArrayBytes(Array, 0);
+	}
+
+	while (Total > Available) {
+		//sai primeiro um level que a tela não mostra, depois o do array usado há mais tempo, depois o maior
+		LayerArray* Victim = nullptr;
+		auto GetPriority = [](const LayerArray& Array) {
+			const size_t Saved = Array.Layout.LevelBytes[Array.WantedLevel] * Array.NumLayers;
+			return std::make_tuple(Array.WantedLevel < Array.CoverageLevel ? 0 : 1, Array.LastUsedFrame, std::numeric_limits<size_t>::max() - Saved);
+		};
+		for (LayerArray& Array : Arrays) {
+			if (Array.WantedLevel < Array.PreviewLevel && (!Victim || GetPriority(Array) < GetPriority(*Victim))) {
+				Victim = &Array;
+			}
+		}
+
+		if (!Victim) {
+			Stats.bOverBudget = true;
+			return;
+		}
+		Total -= Victim->Layout.LevelBytes[Victim->WantedLevel] * Victim->NumLayers;
+		++Victim->WantedLevel;
+	}
+}
+
+void TextureLayers::AllocateStorage(LayerArray& Array, uint32_t BaseLevel) {
+	const TextureFileView& Layout = Array.Layout;
+	const GLenum InternalFormat = GetGLInternalFormat(Layout.Format);
+	const GLenum PixelFormat = GetChannelCount(Layout.Format) == 1 ? GL_RED : GL_RGB;
+	const GLsizei NumLevels = static_cast<GLsizei>(Layout.NumLevels - Array.ResidentLevel);
+
+	glGenTextures(1, &Array.Texture);
+	GetGLState().BindTexture(GL_TEXTURE_2D_ARRAY, Array.Texture);
+	if (GLEW_ARB_texture_storage) {
+		glTexStorage3D(GL_TEXTURE_2D_ARRAY, NumLevels, InternalFormat, static_cast<GLsizei>(std::max(1u, Layout.Width >> Array.ResidentLevel)),
+			static_cast<GLsizei>(std::max(1u, Layout.Height >> Array.ResidentLevel)), static_cast<GLsizei>(Array.NumLayers));
+	}
+	else {
+		for (uint32_t Level = Array.ResidentLevel; Level < Layout.NumLevels; ++Level) {
+			const GLint StorageLevel = static_cast<GLint>(Level - Array.ResidentLevel);
+			const GLsizei LevelWidth = static_cast<GLsizei>(std::max(1u, Layout.Width >> Level));
+			const GLsizei LevelHeight = static_cast<GLsizei>(std::max(1u, Layout.Height >> Level));
+			if (IsCompressed(Layout.Format)) {
+				glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, StorageLevel, InternalFormat, LevelWidth, LevelHeight, static_cast<GLsizei>(Array.NumLayers), 0,
+					static_cast<GLsizei>(Layout.LevelBytes[Level] * Array.NumLayers), nullptr);
+			}
+			else {
+				glTexImage3D(GL_TEXTURE_2D_ARRAY, StorageLevel, InternalFormat, LevelWidth, LevelHeight, static_cast<GLsizei>(Array.NumLayers), 0,
+					PixelFormat, GL_UNSIGNED_BYTE, nullptr);
+			}
+		}
+	}
+
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, static_cast<GLint>(BaseLevel - Array.ResidentLevel));
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, NumLevels - 1);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+	//as máscaras só têm o canal vermelho e são lidas como cinza em .rgb
+	if (PixelFormat == GL_RED) {
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_SWIZZLE_G, GL_RED);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_SWIZZLE_B, GL_RED);
+	}
+}
+
+void TextureLayers::Reallocate(size_t ArrayIndex, uint32_t NewResidentLevel) {
+	LayerArray& Array = Arrays[ArrayIndex];
+	const TextureFileView& Layout = Array.Layout;
+	const uint32_t OldResidentLevel = Array.ResidentLevel;
+	const GLuint OldTexture = Array.Texture;
+	const bool bGrow = NewResidentLevel < OldResidentLevel;
+	const GLenum PixelFormat = GetChannelCount(Layout.Format) == 1 ? GL_RED : GL_RGB;
+
+	//ao crescer os levels novos ficam fora do BASE_LEVEL até as camadas serem recarregadas
+	Array.ResidentLevel = NewResidentLevel;
+	AllocateStorage(Array, bGrow ? OldResidentLevel : NewResidentLevel);
+
+	//os levels que ficam vão do array antigo para o novo por um PBO, sem passar pela CPU
+	const uint32_t FirstKept = std::max(OldResidentLevel, NewResidentLevel);
+	GLuint Buffer;
+	glGenBuffers(1, &Buffer);
+	GetGLState().BindBuffer(GL_PIXEL_PACK_BUFFER, Buffer);
+	glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(GetArrayBytes(Array, FirstKept)), nullptr, GL_STREAM_COPY);
+
+	GetGLState().BindTexture(GL_TEXTURE_2D_ARRAY, OldTexture);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	size_t Offset = 0;
+	for (uint32_t Level = FirstKept; Level < Layout.NumLevels; ++Level) {
+		void* LevelOffset = reinterpret_cast<void*>(static_cast<uintptr_t>(Offset));
+		if (IsCompressed(Layout.Format)) {
+			glGetCompressedTexImage(GL_TEXTURE_2D_ARRAY, static_cast<GLint>(Level - OldResidentLevel), LevelOffset);
+		}
+		else {
+			glGetTexImage(GL_TEXTURE_2D_ARRAY, static_cast<GLint>(Level - OldResidentLevel), PixelFormat, GL_UNSIGNED_BYTE, LevelOffset);
+		}
+		Offset += Layout.LevelBytes[Level] * Array.NumLayers;
+	}
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	GetGLState().BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	GetGLState().BindBuffer(GL_PIXEL_UNPACK_BUFFER, Buffer);
+	GetGLState().BindTexture(GL_TEXTURE_2D_ARRAY, Array.Texture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	Offset = 0;
+	for (uint32_t Level = FirstKept; Level < Layout.NumLevels; ++Level) {
+		const GLint StorageLevel = static_cast<GLint>(Level - NewResidentLevel);
+		const GLsizei LevelWidth = static_cast<GLsizei>(std::max(1u, Layout.Width >> Level));
+		const GLsizei LevelHeight = static_cast<GLsizei>(std::max(1u, Layout.Height >> Level));
+		const GLsizei LevelBytes = static_cast<GLsizei>(Layout.LevelBytes[Level] * Array.NumLayers);
+		const void* LevelOffset = reinterpret_cast<const void*>(static_cast<uintptr_t>(Offset));
+		if (IsCompressed(Layout.Format)) {
+			glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, StorageLevel, 0, 0, 0, LevelWidth, LevelHeight, static_cast<GLsizei>(Array.NumLayers),
+				GetGLInternalFormat(Layout.Format), LevelBytes, LevelOffset);
+		}
+		else {
+			glTexSubImage3D(GL_TEXTURE_2D_ARRAY, StorageLevel, 0, 0, 0, LevelWidth, LevelHeight, static_cast<GLsizei>(Array.NumLayers),
+				PixelFormat, GL_UNSIGNED_BYTE, LevelOffset);
+		}
+		Offset += static_cast<size_t>(LevelBytes);
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	GetGLState().BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	GetGLState().DeleteBuffers(1, &Buffer);
+	GetGLState().DeleteTextures(1, &OldTexture);
+
+	if (bGrow) {
+		//camadas que falharam não têm o que recarregar, recebem a cor de espera nos levels novos
+		Array.NumDone = 0;
+		for (Layer& Target : Layers) {
+			if (Target.Array != ArrayIndex) {
+				continue;
+			}
+			if (Target.bFailed) {
+				FillPlaceholder(Target, NewResidentLevel, OldResidentLevel);
+				++Array.NumDone;
+			}
+			else {
+				Target.bDone = false;
+				Target.bReload = true;
+			}
+		}
+		if (Array.NumDone == Array.NumLayers) {
+			GetGLState().BindTexture(GL_TEXTURE_2D_ARRAY, Array.Texture);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, 0);
+		}
+		Stats.RestoredLevels += OldResidentLevel - NewResidentLevel;
+	}
+	else {
+		Stats.DroppedLevels += NewResidentLevel - OldResidentLevel;
+	}
+	Array.LastChangeFrame = Frame;
+
+	std::cout << "Array de texturas " << Array.SamplerName << (bGrow ? " cresceu" : " reduzido") << " para o level " << NewResidentLevel
+		<< ", " << GetArrayBytes(Array, NewResidentLevel) / 1024 << " KiB" << std::endl;
+}
+
+void TextureLayers::AllocatePending() {
+	const bool bPending = std::any_of(Arrays.begin(), Arrays.end(), [](const LayerArray& Array) { return Array.Texture == 0; });
+	if (!bPending) {
+		return;
+	}
+
+	//os arrays novos já nascem dentro do orçamento
+	FitBudget();
+
+	//glTexImage3D sem dados não pode ler de um PBO que esteja ligado
+	GLint PixelBuffer = 0;
+	glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &PixelBuffer);
+	GetGLState().BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	for (size_t ArrayIndex = 0; ArrayIndex < Arrays.size(); ++ArrayIndex) {
+		LayerArray& Array = Arrays[ArrayIndex];
+		if (Array.Texture != 0) {
+			continue;
+		}
+
+		//até todas as camadas chegarem só os levels da prévia são usados, e todos têm a cor de espera
+		Array.ResidentLevel = Array.WantedLevel;
+		AllocateStorage(Array, Array.PreviewLevel);
+		for (const Layer& Target : Layers) {
+			if (Target.Array == ArrayIndex) {
+				FillPlaceholder(Target, Array.PreviewLevel, Array.Layout.NumLevels);
+			}
+		}
+
+		const TextureFileView& Layout = Array.Layout;
+		std::cout << "Array de texturas " << Array.SamplerName << ": " << Array.NumLayers << " camada(s) " << Layout.Width << "x" << Layout.Height << " "
+			<< ToString(Layout.Format) << ", " << GetArrayBytes(Array, Array.ResidentLevel) / 1024 << " KiB com mipmaps";
+		if (Array.ResidentLevel > 0) {
+			std::cout << " a partir do level " << Array.ResidentLevel << " pelo orcamento";
+		}
+		std::cout << std::endl;
+	}
+
+	GetGLState().BindBuffer(GL_PIXEL_UNPACK_BUFFER, static_cast<GLuint>(PixelBuffer));
+	UpdateStats();
+}
+
+void TextureLayers::FillPlaceholder(const Layer& Target, uint32_t FirstLevel, uint32_t EndLevel) {
+	const LayerArray& Array = Arrays[Target.Array];
+	const TextureFileView& Layout = Array.Layout;
+	const uint32_t Channels = GetChannelCount(Layout.Format);
+
+	const glm::vec3 Color = Target.PlaceholderColor * 255.0f + 0.5f;
+	const uint8_t Pixel[3] = { static_cast<uint8_t>(Color.x), static_cast<uint8_t>(Color.y), static_cast<uint8_t>(Color.z) };
+
+	//a cor sólida comprime para o mesmo bloco em todo o level, basta repetir um
+	size_t UnitBytes = Channels;
+	uint8_t Unit[16];
+	if (IsCompressed(Layout.Format)) {
+		uint8_t Pixels[16 * 3];
+		for (uint32_t Index = 0; Index < 16; ++Index) {
+			std::memcpy(Pixels + Index * Channels, Pixel, Channels);
+		}
+		CompressImage(Layout.Format, Pixels, 4, 4, Channels, Unit);
+		UnitBytes = GetBlockBytes(Layout.Format);
+	}
+	else {
+		std::memcpy(Unit, Pixel, Channels);
+	}
+
+	std::vector<uint8_t> Data;
+	GetGLState().BindTexture(GL_TEXTURE_2D_ARRAY, Array.Texture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	for (uint32_t Level = std::max(FirstLevel, Array.ResidentLevel); Level < EndLevel; ++Level) {
+		const GLint StorageLevel = static_cast<GLint>(Level - Array.ResidentLevel);
+		const GLsizei LevelWidth = static_cast<GLsizei>(std::max(1u, Layout.Width >> Level));
+		const GLsizei LevelHeight = static_cast<GLsizei>(std::max(1u, Layout.Height >> Level));
+
+		Data.resize(Layout.LevelBytes[Level]);
+		for (size_t Offset = 0; Offset < Data.size(); Offset += UnitBytes) {
+			std::memcpy(Data.data() + Offset, Unit, UnitBytes);
+		}
+
+		if (IsCompressed(Layout.Format)) {
+			glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, StorageLevel, 0, 0, static_cast<GLint>(Target.Index), LevelWidth, LevelHeight, 1,
+				GetGLInternalFormat(Layout.Format), static_cast<GLsizei>(Data.size()), Data.data());
+		}
+		else {
+			glTexSubImage3D(GL_TEXTURE_2D_ARRAY, StorageLevel, 0, 0, static_cast<GLint>(Target.Index), LevelWidth, LevelHeight, 1,
+				Channels == 1 ? GL_RED : GL_RGB, GL_UNSIGNED_BYTE, Data.data());
+		}
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+void TextureLayers::Upload(TextureLayerHandle Handle, const TextureFileView& View, uint32_t FirstLevel, const uint8_t* Data) {
+	assert(Handle < Layers.size());
+	AllocatePending();
+
+	const Layer& Target = Layers[Handle];
+	const LayerArray& Array = Arrays[Target.Array];
+	const TextureFileView& Layout = Array.Layout;
+	assert(View.Format == Layout.Format && View.Width == Layout.Width && View.Height == Layout.Height && View.NumLevels == Layout.NumLevels);
+	assert(FirstLevel < Layout.NumLevels);
+
+	GetGLState().BindTexture(GL_TEXTURE_2D_ARRAY, Array.Texture);
+
+	//linhas RGB de largura qualquer não são múltiplas de 4 bytes
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	for (uint32_t Level = std::max(FirstLevel, Array.ResidentLevel); Level < Layout.NumLevels; ++Level) {
+		const GLint StorageLevel = static_cast<GLint>(Level - Array.ResidentLevel);
+		const GLsizei LevelWidth = static_cast<GLsizei>(std::max(1u, Layout.Width >> Level));
+		const GLsizei LevelHeight = static_cast<GLsizei>(std::max(1u, Layout.Height >> Level));
+
+		//com um PBO ligado o ponteiro é um offset dentro do buffer
+		const void* LevelData = Data ? static_cast<const void*>(Data + View.LevelOffsets[Level])
+			: reinterpret_cast<const void*>(static_cast<uintptr_t>(View.LevelOffsets[Level]));
+		if (IsCompressed(Layout.Format)) {
+			glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, StorageLevel, 0, 0, static_cast<GLint>(Target.Index), LevelWidth, LevelHeight, 1,
+				GetGLInternalFormat(Layout.Format), static_cast<GLsizei>(View.LevelBytes[Level]), LevelData);
+		}
+		else {
+			glTexSubImage3D(GL_TEXTURE_2D_ARRAY, StorageLevel, 0, 0, static_cast<GLint>(Target.Index), LevelWidth, LevelHeight, 1,
+				GetChannelCount(Layout.Format) == 1 ? GL_RED : GL_RGB, GL_UNSIGNED_BYTE, LevelData);
+		}
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+void TextureLayers::SetLayerDone(TextureLayerHandle Handle, bool bFailed) {
+	assert(Handle < Layers.size());
+	AllocatePending();
+
+	Layer& Target = Layers[Handle];
+	if (Target.bDone) {
+		return;
+	}
+	LayerArray& Array = Arrays[Target.Array];
+
+	//os levels finos da camada nunca foram escritos
+	if (bFailed) {
+		FillPlaceholder(Target, Array.ResidentLevel, Array.PreviewLevel);
+		Target.bFailed = true;
+	}
+
+	Target.bDone = true;
+	if (++Array.NumDone == Array.NumLayers) {
+		GetGLState().BindTexture(GL_TEXTURE_2D_ARRAY, Array.Texture);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, 0);
+	}
+}
+
+bool TextureLayers::ConsumeReloadRequest(TextureLayerHandle Handle) {
+	assert(Handle < Layers.size());
+	const bool bReload = Layers[Handle].bReload;
+	Layers[Handle].bReload = false;
+	return bReload;
+}
+
+void TextureLayers::Update(float PixelFootprint) {
+	PROFILE_SCOPE("TextureLayers::Update");
+	++Frame;
+
+	//o level mais fino que a tela usa é o que tem até um texel por pixel no ponto mais próximo
+	for (LayerArray& Array : Arrays) {
+		const float TexelsPerPixel = static_cast<float>(Array.Layout.Width) * PixelFootprint;
+		Array.CoverageLevel = TexelsPerPixel > 1.0f ? std::min(static_cast<uint32_t>(std::log2(TexelsPerPixel)), Array.PreviewLevel) : 0;
+	}
+	FitBudget();
+
+	//só arrays com todas as camadas prontas mudam. Reduzir é imediato para respeitar o teto; crescer espera
+	//um tempo desde a última troca, para um zoom indo e voltando não recarregar as camadas a cada frame.
+	for (size_t ArrayIndex = 0; ArrayIndex < Arrays.size(); ++ArrayIndex) {
+		const LayerArray& Array = Arrays[ArrayIndex];
+		if (Array.Texture == 0 || Array.NumDone < Array.NumLayers || Array.WantedLevel == Array.ResidentLevel) {
+			continue;
+		}
+		if (Array.WantedLevel < Array.ResidentLevel && Frame - Array.LastChangeFrame < RegrowFrames) {
+			continue;
+		}
+		Reallocate(ArrayIndex, Array.WantedLevel);
+		break;
+	}
+
+	UpdateStats();
+}
+
+GLint TextureLayers::Bind(GLuint Program, GLint FirstUnit) {
+	AllocatePending();
+
+	GLint Unit = FirstUnit;
+	for (LayerArray& Array : Arrays) {
+		GetGLState().BindTexture(Unit, GL_TEXTURE_2D_ARRAY, Array.Texture);
+		const GLint SamplerLocation = GetGLState().GetUniformLocation(Program, Array.SamplerName.c_str());
+		GetGLState().SetUniform(SamplerLocation, Unit);
+
+		//sem o sampler (removido pelo compilador) o programa não lê o array, que não conta como usado
+		if (SamplerLocation >= 0) {
+			Array.LastUsedFrame = Frame;
+		}
+		++Unit;
+	}
+
+	//os índices das camadas não mudam: depois do primeiro frame o cache descarta todos
+	for (const Layer& Target : Layers) {
+		GetGLState().SetUniform(GetGLState().GetUniformLocation(Program, Target.Name.c_str()), static_cast<GLint>(Target.Index));
+	}
+	return Unit;
+}
+
+size_t TextureLayers::GetLevelBytes(size_t ArrayIndex, uint32_t Level) const {
+	assert(ArrayIndex < Arrays.size());
+	const LayerArray& Array = Arrays[ArrayIndex];
+	if (Array.Texture == 0 || Level < Array.ResidentLevel || Level >= Array.Layout.NumLevels) {
+		return 0;
+	}
+	return Array.Layout.LevelBytes[Level] * Array.NumLayers;
+}
+
+size_t TextureLayers::GetGPUBytes() const {
+	size_t Bytes = 0;
+	for (const LayerArray& Array : Arrays) {
+		if (Array.Texture != 0) {
+			Bytes += GetArrayBytes(Array, Array.ResidentLevel);
+		}
+	}
+	return Bytes;
+}
+
+void TextureLayers::UpdateStats() {
+	Stats.ResidentBytes = GetGPUBytes();
+	Stats.FullBytes = 0;
+	for (const LayerArray& Array : Arrays) {
+		Stats.FullBytes += GetArrayBytes(Array, 0);
+	}
+}
+
+void TextureLayers::Shutdown() {
+	for (LayerArray& Array : Arrays) {
+		if (Array.Texture) {
+			GetGLState().DeleteTextures(1, &Array.Texture);
+			Array.Texture = 0;
+		}
+	}
+	Arrays.clear();
+	Layers.clear();
+	UpdateStats();
+}
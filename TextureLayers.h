@@ -0,0 +1,135 @@
+#pragma once
+
+#include<cstddef>
+#include<cstdint>
+#include<string>
+#include<vector>
+
+#include<GL/glew.h>
+#include<glm/glm.hpp>
+
+#include "TextureCache.h"
+#include "TextureCompression.h"
+
+//camadas de textura do planeta (cor, nuvens, luzes noturnas, máscaras...) empacotadas em GL_TEXTURE_2D_ARRAY:
+//camadas com o mesmo tamanho e formato dividem um array, então o frame liga um array por formato, não uma textura
+//por camada. O formato de cada camada sai do número de canais: cor em RGB8/BC1/BC7, máscaras em R8/BC4.
+//o shader lê com texture(ColorLayers, vec3(UV, EarthLayer)); os nomes dos samplers e dos índices vêm daqui.
+//
+//os arrays são alocados no primeiro upload ou Bind, com todas as camadas pedidas até ali. Uma camada adicionada
+//depois disso vai para um array novo. Até chegarem os dados, cada camada mostra a sua cor de espera.
+//
+//a memória tem um teto: com um orçamento, os mip levels mais finos são descartados até os arrays caberem,
+//primeiro os que estão mais finos que a tela precisa, depois os usados há mais tempo. Quando volta a caber
+//o array cresce de novo e as camadas são recarregadas pelo AsyncTextureLoader. Os levels da prévia nunca saem.
+//a storage é imutável (glTexStorage3D) quando o driver tem ARB_texture_storage, então trocar os levels
+//residentes é criar um array novo e copiar os levels que ficam, na GPU.
+
+//maior lado dos levels que ficam visíveis enquanto alguma camada do array ainda não chegou inteira
+constexpr uint32_t TextureLayerPreviewSize = 256;
+
+using TextureLayerHandle = size_t;
+
+struct TextureMemoryStats {
+	size_t BudgetBytes = 0;       //0 é sem limite
+	size_t ReservedBytes = 0;     //de texturas fora dos arrays (textura virtual), descontados do orçamento
+	size_t ResidentBytes = 0;     //levels residentes de todos os arrays
+	size_t FullBytes = 0;         //o que os arrays ocupariam com todos os levels
+	size_t DroppedLevels = 0;     //levels descartados para caber no orçamento, desde o início
+	size_t RestoredLevels = 0;    //levels que voltaram quando o orçamento permitiu
+	bool bOverBudget = false;     //nem só as prévias cabem
+};
+
+//formato de uma camada com Channels canais: o de cor escolhido para a execução, ou o de um canal equivalente
+TextureFormat GetLayerFormat(uint32_t Channels, TextureFormat ColorFormat);
+
+class TextureLayers {
+public:
+	TextureLayers() = default;
+
+	TextureLayers(const TextureLayers&) = delete;
+	TextureLayers& operator=(const TextureLayers&) = delete;
+
+	//reserva uma camada. Name é o uniform int com o índice da camada no shader.
+	TextureLayerHandle AddLayer(const std::string& Name, uint32_t Width, uint32_t Height, TextureFormat Format, const glm::vec3& PlaceholderColor);
+
+	const TextureFileView& GetLayout(TextureLayerHandle Handle) const;
+
+	//primeiro level enviado como prévia, o BASE_LEVEL do array até todas as camadas ficarem prontas
+	uint32_t GetPreviewLevel(TextureLayerHandle Handle) const;
+
+	//level mais fino na GPU, maior que 0 quando o orçamento descartou levels
+	uint32_t GetResidentLevel(TextureLayerHandle Handle) const;
+
+	//envia os levels a partir de FirstLevel para a camada; os mais finos que o residente são ignorados.
+	//View precisa ter o formato e o tamanho da camada.
+	//com Data nulo os levels são lidos do GL_PIXEL_UNPACK_BUFFER ligado, com o layout de View a partir do offset 0.
+	void Upload(TextureLayerHandle Handle, const TextureFileView& View, uint32_t FirstLevel, const uint8_t* Data);
+
+	//a camada recebeu todos os levels; com bFailed eles são preenchidos com a cor de espera.
+	//quando todas as camadas do array terminam ele passa a usar o level 0.
+	void SetLayerDone(TextureLayerHandle Handle, bool bFailed = false);
+
+	//true uma vez quando o array da camada cresceu e ela precisa ser enviada de novo, com Upload e SetLayerDone
+	bool ConsumeReloadRequest(TextureLayerHandle Handle);
+
+	//orçamento de todos os arrays mais ReservedBytes; 0 é sem limite. Vale a partir do próximo Update.
+	void SetBudget(size_t BudgetBytes, size_t ReservedBytes = 0);
+
+	//uma vez por frame, antes do Bind. PixelFootprint é a fração da largura da textura coberta por um pixel
+	//no ponto da superfície mais próximo da câmera, 0 se não for conhecida; os levels mais finos que isso não
+	//aparecem na tela e são os primeiros a sair. Troca os levels de no máximo um array por frame.
+	void Update(float PixelFootprint);
+
+	//liga um array por unidade a partir de FirstUnit e preenche os samplers e os índices das camadas.
+	//devolve a próxima unidade livre.
+	GLint Bind(GLuint Program, GLint FirstUnit);
+
+	size_t GetNumArrays() const { return Arrays.size(); }
+
+	//bytes de um level de todas as camadas de um array, 0 quando o level não está na GPU
+	size_t GetLevelBytes(size_t ArrayIndex, uint32_t Level) const;
+	size_t GetGPUBytes() const;
+	const TextureMemoryStats& GetStats() const { return Stats; }
+
+	//libera os arrays, com o contexto ainda ativo
+	void Shutdown();
+
+private:
+	struct LayerArray {
+		TextureFileView Layout;   //tamanho, formato e levels de cada camada, sem dados
+		std::string SamplerName;
+		GLuint Texture = 0;
+		uint32_t NumLayers = 0;
+		uint32_t NumDone = 0;
+		uint32_t PreviewLevel = 0;
+		uint32_t ResidentLevel = 0;   //level 0 da storage na GPU
+		uint32_t WantedLevel = 0;     //escolhido pelo orçamento
+		uint32_t CoverageLevel = 0;   //mais fino que aparece na tela
+		uint64_t LastUsedFrame = 0;   //último Bind de um programa que amostra o array
+		uint64_t LastChangeFrame = 0;
+	};
+
+	struct Layer {
+		std::string Name;
+		size_t Array = 0;
+		uint32_t Index = 0;   //camada dentro do array
+		glm::vec3 PlaceholderColor{ 0.0f };
+		bool bDone = false;
+		bool bFailed = false;   //mostra a cor de espera em todos os levels
+		bool bReload = false;
+	};
+
+	size_t GetArrayBytes(const LayerArray& Array, uint32_t FirstLevel) const;
+	void FitBudget();
+	void AllocateStorage(LayerArray& Array, uint32_t BaseLevel);
+	void Reallocate(size_t ArrayIndex, uint32_t NewResidentLevel);
+	void AllocatePending();
+	void FillPlaceholder(const Layer& Target, uint32_t FirstLevel, uint32_t EndLevel);
+	void UpdateStats();
+
+	std::vector<LayerArray> Arrays;
+	std::vector<Layer> Layers;
+	TextureMemoryStats Stats;
+	uint64_t Frame = 0;
+};
@@ -0,0 +1,314 @@
+#include "TextureLoader.h"
+
+#include<algorithm>
+#include<cassert>
+#include<chrono>
+#include<cstring>
+#include<iostream>
+#include<thread>
+
+#include "GLState.h"
+#include "Profiler.h"
+#include "stb_image.h"
+
+static double GetSeconds() {
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+AsyncTextureLoader::AsyncTextureLoader(TextureLayers& NewLayers, unsigned NumThreads)
+	: Layers(NewLayers) {
+	//a flag do stb_image é global, então é definida antes de existir qualquer thread decodificando
+	stbi_set_flip_vertically_on_load(true);
+
+	NumThreads = std::max(1u, NumThreads);
+	for (unsigned Index = 0; Index < NumThreads; ++Index) {
+		Workers.emplace_back(&AsyncTextureLoader::WorkerLoop, this);
+	}
+}
+
+AsyncTextureLoader::~AsyncTextureLoader() {
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		bStop = true;
+	}
+	WakeCondition.notify_all();
+	for (std::thread& Worker : Workers) {
+		Worker.join();
+	}
+	Workers.clear();
+}
+
+TextureHandle AsyncTextureLoader::Request(const std::string& Path, const std::string& LayerName, uint32_t Channels, const glm::vec3& PlaceholderColor, TextureFormat ColorFormat, const MipmapSettings& Mips) {
+	std::unique_ptr<StreamedTexture> Texture = std::make_unique<StreamedTexture>();
+	Texture->Path = Path;
+	Texture->Format = GetLayerFormat(Channels, ColorFormat);
+	Texture->Mips = Mips;
+	Texture->RequestSeconds = GetSeconds();
+
+	//o tamanho da camada vem do cabeçalho; sem ele a camada fica com um pixel da cor de espera
+	int Width = 0, Height = 0, NumberOfComponents = 0;
+	const bool bValidImage = stbi_info(Path.c_str(), &Width, &Height, &NumberOfComponents) != 0;
+	Texture->Width = bValidImage ? Width : 1;
+	Texture->Height = bValidImage ? Height : 1;
+	Texture->Layer = Layers.AddLayer(LayerName, static_cast<uint32_t>(Texture->Width), static_cast<uint32_t>(Texture->Height), Texture->Format, PlaceholderColor);
+	if (!bValidImage) {
+		Texture->FailureReason = stbi_failure_reason();
+		Texture->State = LoadState::Failed;
+	}
+
+	const TextureHandle Handle = Textures.size();
+	Textures.push_back(std::move(Texture));
+	if (bValidImage) {
+		Enqueue(Textures.back().get(), false);
+	}
+
+	return Handle;
+}
+
+void AsyncTextureLoader::Enqueue(StreamedTexture* Texture, bool bCopy) {
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		Tasks.push_back(Task{ Texture, bCopy });
+	}
+	WakeCondition.notify_one();
+}
+
+void AsyncTextureLoader::WorkerLoop() {
+	PROFILE_THREAD("Texturas");
+	for (;;) {
+		Task Current;
+		{
+			std::unique_lock<std::mutex> Lock(Mutex);
+			WakeCondition.wait(Lock, [this] { return bStop || !Tasks.empty(); });
+			if (bStop) {
+				return;
+			}
+			Current = Tasks.front();
+			Tasks.pop_front();
+		}
+
+		StreamedTexture& Texture = *Current.Texture;
+		if (!Current.bCopy) {
+			Decode(Texture);
+			continue;
+		}
+
+		//o PBO já está mapeado pela thread do OpenGL, aqui só é memória comum
+		std::memcpy(Texture.MappedPixels, Texture.Levels.Data, Texture.Levels.DataBytes);
+		Texture.Levels.Data = nullptr;
+		Texture.CacheFile.Close();
+		Texture.LevelPixels.clear();
+		Texture.LevelPixels.shrink_to_fit();
+
+		std::lock_guard<std::mutex> Lock(Mutex);
+		Texture.State = LoadState::Copied;
+	}
+}
+
+void AsyncTextureLoader::Decode(StreamedTexture& Texture) {
+	PROFILE_SCOPE("AsyncTextureLoader::Decode");
+	const double Start = GetSeconds();
+
+	bool bLoaded = false;
+	if (IsCompressed(Texture.Format)) {
+		//num start quente isto só mapeia o arquivo, sem decodificar nada
+		bLoaded = LoadCachedTexture(Texture.Path, Texture.Format, Texture.Mips, Texture.CacheFile, Texture.Levels, Texture.FailureReason);
+	}
+	else {
+		int Width = 0, Height = 0, NumberOfComponents = 0;
+		unsigned char* Pixels = stbi_load(Texture.Path.c_str(), &Width, &Height, &NumberOfComponents, static_cast<int>(GetChannelCount(Texture.Format)));
+		if (Pixels) {
+			BuildTextureLevels(Pixels, static_cast<uint32_t>(Width), static_cast<uint32_t>(Height), Texture.Format, Texture.Mips, Texture.LevelPixels, Texture.Levels);
+			stbi_image_free(Pixels);
+			bLoaded = true;
+		}
+		else {
+			Texture.FailureReason = stbi_failure_reason();
+		}
+	}
+
+	//a camada foi reservada com o tamanho do cabeçalho
+	if (bLoaded && (static_cast<int>(Texture.Levels.Width) != Texture.Width || static_cast<int>(Texture.Levels.Height) != Texture.Height)) {
+		Texture.FailureReason = "a imagem mudou de tamanho durante o carregamento";
+		bLoaded = false;
+	}
+
+	std::lock_guard<std::mutex> Lock(Mutex);
+	Texture.DecodeMilliseconds = (GetSeconds() - Start) * 1000.0;
+	Texture.State = bLoaded ? LoadState::Decoded : LoadState::Failed;
+}
+
+void AsyncTextureLoader::Update() {
+	PROFILE_SCOPE("AsyncTextureLoader::Update");
+	for (const std::unique_ptr<StreamedTexture>& Pointer : Textures) {
+		StreamedTexture& Texture = *Pointer;
+
+		LoadState State;
+		{
+			std::lock_guard<std::mutex> Lock(Mutex);
+			State = Texture.State;
+		}
+
+		if (State == LoadState::Decoded) {
+			//a prévia é pequena e vai direto, a imagem inteira vai pelo PBO que a thread de trabalho preenche
+			Layers.Upload(Texture.Layer, Texture.Levels, Layers.GetPreviewLevel(Texture.Layer), Texture.Levels.Data);
+
+			const GLsizeiptr Size = static_cast<GLsizeiptr>(Texture.Levels.DataBytes);
+			glGenBuffers(1, &Texture.PixelBuffer);
+			GetGLState().BindBuffer(GL_PIXEL_UNPACK_BUFFER, Texture.PixelBuffer);
+			glBufferData(GL_PIXEL_UNPACK_BUFFER, Size, nullptr, GL_STREAM_DRAW);
+			Texture.MappedPixels = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, Size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+			GetGLState().BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+			//sem o PBO mapeado a cópia não tem destino: a camada fica com a cor de espera, como num arquivo que não abre
+			if (!Texture.MappedPixels) {
+				GetGLState().DeleteBuffers(1, &Texture.PixelBuffer);
+				Texture.PixelBuffer = 0;
+				Texture.Levels.Data = nullptr;
+				Texture.CacheFile.Close();
+				Texture.LevelPixels.clear();
+				Texture.LevelPixels.shrink_to_fit();
+
+				std::lock_guard<std::mutex> Lock(Mutex);
+				Texture.FailureReason = "o PBO de " + std::to_string(Size / 1024) + " KiB nao pode ser mapeado";
+				Texture.State = LoadState::Failed;
+				continue;
+			}
+
+			{
+				std::lock_guard<std::mutex> Lock(Mutex);
+				Texture.State = LoadState::Copying;
+			}
+			Enqueue(&Texture, true);
+		}
+		else if (State == LoadState::Copied) {
+			GetGLState().BindBuffer(GL_PIXEL_UNPACK_BUFFER, Texture.PixelBuffer);
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+			Texture.MappedPixels = nullptr;
+
+			//com um PBO ligado o ponteiro do glTexSubImage3D é um offset, a cópia para a camada fica com o driver
+			Layers.Upload(Texture.Layer, Texture.Levels, 0, nullptr);
+			Texture.GPUBytes = GetTextureBytes(Texture.Levels, 0);
+			GetGLState().BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+			Texture.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+			std::lock_guard<std::mutex> Lock(Mutex);
+			Texture.State = LoadState::Uploading;
+		}
+		else if (State == LoadState::Uploading) {
+			//timeout zero: só consulta, nunca bloqueia o frame
+			const GLenum Result = glClientWaitSync(Texture.Fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+			if (Result != GL_ALREADY_SIGNALED && Result != GL_CONDITION_SATISFIED) {
+				continue;
+			}
+
+			glDeleteSync(Texture.Fence);
+			Texture.Fence = nullptr;
+			GetGLState().DeleteBuffers(1, &Texture.PixelBuffer);
+			Texture.PixelBuffer = 0;
+
+			Layers.SetLayerDone(Texture.Layer);
+
+			std::cout << "Textura " << Texture.Path << " " << Texture.Width << "x" << Texture.Height << " " << ToString(Texture.Format)
+				<< " pronta em " << (GetSeconds() - Texture.RequestSeconds) * 1000.0 << " ms (decodificacao "
+				<< Texture.DecodeMilliseconds << " ms, " << Texture.GPUBytes / 1024 << " KiB com mipmaps)" << std::endl;
+
+			std::lock_guard<std::mutex> Lock(Mutex);
+			Texture.State = LoadState::Ready;
+		}
+		else if (State == LoadState::Ready && Layers.ConsumeReloadRequest(Texture.Layer)) {
+			//o orçamento voltou a ter espaço e o array cresceu: a imagem passa de novo pelo mesmo caminho
+			Texture.RequestSeconds = GetSeconds();
+			{
+				std::lock_guard<std::mutex> Lock(Mutex);
+				Texture.State = LoadState::Decoding;
+			}
+			Enqueue(&Texture, false);
+		}
+		else if (State == LoadState::Failed && !Texture.bFailureReported) {
+			//a camada continua com a cor de espera
+			std::cerr << "Nao foi possivel carregar a textura " << Texture.Path << ": " << Texture.FailureReason << std::endl;
+			Layers.SetLayerDone(Texture.Layer, true);
+			Texture.bFailureReported = true;
+		}
+	}
+}
+
+void AsyncTextureLoader::Flush() {
+	//o Update do estado Failed ainda precisa rodar para a camada receber a cor de espera
+	for (;;) {
+		Update();
+
+		bool bPending = false;
+		for (const std::unique_ptr<StreamedTexture>& Texture : Textures) {
+			std::lock_guard<std::mutex> Lock(Mutex);
+			if (Texture->State != LoadState::Ready && !(Texture->State == LoadState::Failed && Texture->bFailureReported)) {
+				bPending = true;
+			}
+		}
+		if (!bPending) {
+			return;
+		}
+		std::this_thread::yield();
+	}
+}
+
+TextureLayerHandle AsyncTextureLoader::GetLayer(TextureHandle Handle) const {
+	assert(Handle < Textures.size());
+	return Textures[Handle]->Layer;
+}
+
+bool AsyncTextureLoader::IsReady(TextureHandle Handle) const {
+	assert(Handle < Textures.size());
+	std::lock_guard<std::mutex> Lock(Mutex);
+	return Textures[Handle]->State == LoadState::Ready;
+}
+
+bool AsyncTextureLoader::IsIdle() const {
+	std::lock_guard<std::mutex> Lock(Mutex);
+	for (const std::unique_ptr<StreamedTexture>& Texture : Textures) {
+		if (Texture->State != LoadState::Ready && Texture->State != LoadState::Failed) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void AsyncTextureLoader::ReleaseTexture(StreamedTexture& Texture) {
+	if (Texture.MappedPixels) {
+		GetGLState().BindBuffer(GL_PIXEL_UNPACK_BUFFER, Texture.PixelBuffer);
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+		GetGLState().BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		Texture.MappedPixels = nullptr;
+	}
+	if (Texture.Fence) {
+		glDeleteSync(Texture.Fence);
+		Texture.Fence = nullptr;
+	}
+	if (Texture.PixelBuffer) {
+		GetGLState().DeleteBuffers(1, &Texture.PixelBuffer);
+		Texture.PixelBuffer = 0;
+	}
+	Texture.CacheFile.Close();
+	Texture.LevelPixels.clear();
+}
+
+void AsyncTextureLoader::Shutdown() {
+	//nenhuma thread pode estar escrevendo num PBO quando ele for desmapeado
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		bStop = true;
+		Tasks.clear();
+	}
+	WakeCondition.notify_all();
+	for (std::thread& Worker : Workers) {
+		Worker.join();
+	}
+	Workers.clear();
+
+	for (const std::unique_ptr<StreamedTexture>& Texture : Textures) {
+		ReleaseTexture(*Texture);
+	}
+	Textures.clear();
+}
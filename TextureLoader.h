@@ -0,0 +1,113 @@
+#pragma once
+
+#include<condition_variable>
+#include<cstddef>
+#include<cstdint>
+#include<deque>
+#include<memory>
+#include<mutex>
+#include<string>
+#include<thread>
+#include<vector>
+
+#include<GL/glew.h>
+#include<glm/glm.hpp>
+
+#include "MappedFile.h"
+#include "Mipmap.h"
+#include "TextureCache.h"
+#include "TextureCompression.h"
+#include "TextureLayers.h"
+
+//carregamento de texturas sem travar o primeiro frame: cada imagem vira uma camada de um TextureLayers,
+//que começa com uma cor sólida, recebe uma prévia de baixa resolução assim que a imagem é decodificada numa
+//thread de trabalho e por fim a resolução completa por um pixel buffer object, liberada quando o fence da GPU sinaliza.
+//os mipmaps são gerados na thread de trabalho (ou lidos do DDS do cache nos formatos comprimidos)
+//e a prévia são os levels pequenos deles.
+
+using TextureHandle = size_t;
+
+class AsyncTextureLoader {
+public:
+	explicit AsyncTextureLoader(TextureLayers& NewLayers, unsigned NumThreads = 2);
+	~AsyncTextureLoader();
+
+	AsyncTextureLoader(const AsyncTextureLoader&) = delete;
+	AsyncTextureLoader& operator=(const AsyncTextureLoader&) = delete;
+
+	//lê só o cabeçalho da imagem para reservar a camada LayerName com Channels canais (3 para cor, 1 para máscaras)
+	//e agenda a decodificação. O formato da camada sai de GetLayerFormat com ColorFormat.
+	TextureHandle Request(const std::string& Path, const std::string& LayerName, uint32_t Channels, const glm::vec3& PlaceholderColor,
+		TextureFormat ColorFormat = TextureFormat::RGB8, const MipmapSettings& Mips = MipmapSettings{});
+
+	//avança os carregamentos, chamado uma vez por frame na thread do OpenGL. Nunca espera pela GPU.
+	void Update();
+
+	//chama o Update até todos os pedidos terminarem, para carregar tudo antes do primeiro frame
+	void Flush();
+
+	TextureLayerHandle GetLayer(TextureHandle Handle) const;
+
+	bool IsReady(TextureHandle Handle) const;
+	bool IsIdle() const;
+
+	//espera as threads e libera buffers e fences pendentes, com o contexto ainda ativo
+	void Shutdown();
+
+private:
+	enum class LoadState {
+		Decoding,    //na fila, na stbi_load e nos mipmaps ou abrindo o cache
+		Decoded,     //levels prontos, falta o PBO
+		Copying,     //thread de trabalho copiando para o PBO mapeado
+		Copied,      //falta desmapear e começar o upload
+		Uploading,   //glTexSubImage3D a partir do PBO, esperando o fence
+		Ready,
+		Failed
+	};
+
+	struct StreamedTexture {
+		std::string Path;
+		TextureFormat Format = TextureFormat::RGB8;
+		MipmapSettings Mips;
+		LoadState State = LoadState::Decoding;
+		TextureLayerHandle Layer = 0;
+		GLuint PixelBuffer = 0;
+		GLsync Fence = nullptr;
+
+		int Width = 0;
+		int Height = 0;
+		void* MappedPixels = nullptr;
+
+		//todos os levels, no arquivo do cache mapeado (comprimidos) ou em LevelPixels (RGB8),
+		//mantidos até a cópia para o PBO
+		MappedFile CacheFile;
+		std::vector<uint8_t> LevelPixels;
+		TextureFileView Levels;
+		size_t GPUBytes = 0;
+
+		double RequestSeconds = 0.0;
+		double DecodeMilliseconds = 0.0;
+
+		std::string FailureReason;
+		bool bFailureReported = false;
+	};
+
+	struct Task {
+		StreamedTexture* Texture;
+		bool bCopy;  //false decodifica, true copia os levels para o PBO mapeado
+	};
+
+	void WorkerLoop();
+	void Decode(StreamedTexture& Texture);
+	void Enqueue(StreamedTexture* Texture, bool bCopy);
+	void ReleaseTexture(StreamedTexture& Texture);
+
+	TextureLayers& Layers;
+	std::vector<std::unique_ptr<StreamedTexture>> Textures;
+
+	std::vector<std::thread> Workers;
+	mutable std::mutex Mutex;  //protege State de todas as texturas e a fila
+	std::condition_variable WakeCondition;
+	std::deque<Task> Tasks;
+	bool bStop = false;
+};
@@ -0,0 +1,116 @@
+#include "ThreadPool.h"
+
+#include<algorithm>
+
+#include "Profiler.h"
+
+//verdadeiro nas threads do pool e na thread que está dentro de um ParallelFor
+static thread_local bool bInsideParallelFor = false;
+
+ThreadPool::ThreadPool(unsigned NumThreads) {
+	//a thread que chama ParallelFor conta como uma das threads
+	const unsigned NumWorkers = NumThreads > 1 ? NumThreads - 1 : 0;
+	Workers.reserve(NumWorkers);
+	for (unsigned Index = 0; Index < NumWorkers; ++Index) {
+		Workers.emplace_back([this] { WorkerLoop(); });
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		bStop = true;
+	}
+	WakeCondition.notify_all();
+
+	for (std::thread& Worker : Workers) {
+		Worker.join();
+	}
+}
+
+void ThreadPool::RunChunks(Job& CurrentJob) {
+	PROFILE_SCOPE("ThreadPool::RunChunks");
+	for (;;) {
+		const size_t ChunkBegin = CurrentJob.Next.fetch_add(CurrentJob.Grain);
+		if (ChunkBegin >= CurrentJob.End) {
+			break;
+		}
+
+		const size_t ChunkEnd = std::min(ChunkBegin + CurrentJob.Grain, CurrentJob.End);
+		(*CurrentJob.Func)(ChunkBegin, ChunkEnd);
+		CurrentJob.Done.fetch_add(ChunkEnd - ChunkBegin);
+	}
+}
+
+void ThreadPool::WorkerLoop() {
+	PROFILE_THREAD("ThreadPool");
+	bInsideParallelFor = true;
+	size_t LastGeneration = 0;
+
+	for (;;) {
+		Job* WorkerJob = nullptr;
+		{
+			std::unique_lock<std::mutex> Lock(Mutex);
+			WakeCondition.wait(Lock, [&] { return bStop || (CurrentJob && JobGeneration != LastGeneration); });
+			if (bStop) {
+				return;
+			}
+
+			LastGeneration = JobGeneration;
+			WorkerJob = CurrentJob;
+			++ActiveWorkers;
+		}
+
+		RunChunks(*WorkerJob);
+
+		{
+			std::lock_guard<std::mutex> Lock(Mutex);
+			--ActiveWorkers;
+		}
+		DoneCondition.notify_all();
+	}
+}
+
+void ThreadPool::ParallelFor(size_t Begin, size_t End, size_t Grain, const std::function<void(size_t, size_t)>& Func) {
+	if (Begin >= End) {
+		return;
+	}
+
+	Grain = std::max<size_t>(Grain, 1);
+
+	//trabalho pequeno, sem workers ou chamada aninhada: executa direto na thread atual
+	if (Workers.empty() || End - Begin <= Grain || bInsideParallelFor) {
+		Func(Begin, End);
+		return;
+	}
+
+	std::lock_guard<std::mutex> SubmitLock(SubmitMutex);
+
+	Job NewJob;
+	NewJob.Func = &Func;
+	NewJob.Begin = Begin;
+	NewJob.End = End;
+	NewJob.Grain = Grain;
+	NewJob.Next = Begin;
+
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		CurrentJob = &NewJob;
+		++JobGeneration;
+	}
+	WakeCondition.notify_all();
+
+	bInsideParallelFor = true;
+	RunChunks(NewJob);
+	bInsideParallelFor = false;
+
+	//espera todos os blocos terminarem e nenhum worker ainda segurar o job
+	std::unique_lock<std::mutex> Lock(Mutex);
+	DoneCondition.wait(Lock, [&] { return NewJob.Done.load() == End - Begin && ActiveWorkers == 0; });
+	CurrentJob = nullptr;
+}
+
+ThreadPool& GetThreadPool() {
+	static ThreadPool Pool;
+	return Pool;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include<atomic>
+#include<condition_variable>
+#include<cstddef>
+#include<functional>
+#include<mutex>
+#include<thread>
+#include<vector>
+
+//pool de threads persistente usado para dividir trabalho de CPU (geração de malhas, texturas etc.)
+class ThreadPool {
+public:
+	explicit ThreadPool(unsigned NumThreads = std::thread::hardware_concurrency());
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	//executa Func(Begin, End) em blocos de no máximo Grain elementos, a thread chamadora também trabalha
+	void ParallelFor(size_t Begin, size_t End, size_t Grain, const std::function<void(size_t, size_t)>& Func);
+
+	unsigned GetNumThreads() const { return static_cast<unsigned>(Workers.size()) + 1; }
+
+private:
+	struct Job {
+		const std::function<void(size_t, size_t)>* Func = nullptr;
+		size_t Begin = 0;
+		size_t End = 0;
+		size_t Grain = 1;
+		std::atomic<size_t> Next{ 0 };
+		std::atomic<size_t> Done{ 0 };
+	};
+
+	void WorkerLoop();
+	static void RunChunks(Job& CurrentJob);
+
+	std::vector<std::thread> Workers;
+	std::mutex Mutex;
+	std::condition_variable WakeCondition;
+	std::condition_variable DoneCondition;
+	Job* CurrentJob = nullptr;
+	size_t JobGeneration = 0;
+	size_t ActiveWorkers = 0;
+	bool bStop = false;
+
+	//só um ParallelFor por vez ocupa o pool
+	std::mutex SubmitMutex;
+};
+
+//pool global compartilhado pelo programa
+ThreadPool& GetThreadPool();
+
+inline void ParallelFor(size_t Begin, size_t End, size_t Grain, const std::function<void(size_t, size_t)>& Func) {
+	GetThreadPool().ParallelFor(Begin, End, Grain, Func);
+}
@@ -0,0 +1,405 @@
+#include<iostream>
+#include<algorithm>
+#include<cctype>
+#include<chrono>
+#include<cstdio>
+#include<cstring>
+#include<filesystem>
+#include<fstream>
+#include<memory>
+#include<string>
+#include<system_error>
+#include<vector>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include "Hash.h"
+#include "Mipmap.h"
+#include "TextureCompression.h"
+#include "ThreadPool.h"
+#include "VirtualTextureArchive.h"
+
+//gera o arquivo de páginas da textura virtual (.bmvt) a partir de uma imagem equiretangular de qualquer tamanho.
+//PPM binário (P6) e RGB cru (com --size) são lidos em faixas direto do disco, sem carregar a imagem inteira;
+//os outros formatos passam pelo stb_image e precisam caber na memória.
+//as linhas entram de baixo para cima em todos os caminhos, como o BlueMarble carrega as texturas: o arquivo gerado
+//aqui é igual ao que o FindOrBuildVirtualTexture gera para a mesma imagem, e o --check confere isso.
+//
+//uso: TilePyramidBuilder entrada saida.bmvt [--format=rgb|bc1|bc7] [--mip-filter=box|kaiser|lanczos] [--linear]
+//                         [--size=LARGURAxALTURA] [--page=128] [--border=4]
+//     TilePyramidBuilder --check [--format=rgb|bc1|bc7] [--mip-filter=box|kaiser|lanczos] [--linear]
+
+struct BuilderOptions {
+	std::string InputPath;
+	std::string OutputPath;
+	TextureFormat Format = TextureFormat::BC1;
+	MipmapSettings Mips;
+	uint32_t RawWidth = 0;   //--size, só para RGB cru
+	uint32_t RawHeight = 0;
+	uint32_t ContentSize = DefaultVirtualPageContent;
+	uint32_t Border = DefaultVirtualPageBorder;
+	bool bCheck = false;   //--check, sem entrada nem saída
+};
+
+//imagem de origem: dimensões e leitor de linhas. Os arquivos ficam abertos enquanto o leitor existir.
+struct SourceImage {
+	uint32_t Width = 0;
+	uint32_t Height = 0;
+	ImageRowReader ReadRows;
+	std::shared_ptr<std::ifstream> File;
+	std::shared_ptr<unsigned char> Pixels;
+	bool bStreamed = false;
+};
+
+static void PrintUsage() {
+	std::cout << "uso: TilePyramidBuilder entrada saida.bmvt [--format=rgb|bc1|bc7] [--mip-filter=box|kaiser|lanczos] [--linear]" << std::endl
+		<< "                          [--size=LARGURAxALTURA] [--page=128] [--border=4]" << std::endl
+		<< "entrada: .ppm (P6) ou .raw/.rgb (RGB de 8 bits, precisa de --size) sao lidos em faixas;" << std::endl
+		<< "         jpg/png/etc. sao carregados inteiros pelo stb_image" << std::endl
+		<< "--check gera uma imagem pequena pelos caminhos em faixas, do stb_image e do BlueMarble e compara os arquivos" << std::endl;
+}
+
+static bool ParseOptions(int argc, char* argv[], BuilderOptions& Options) {
+	std::vector<std::string> Positional;
+	for (int Index = 1; Index < argc; ++Index) {
+		const std::string Argument = argv[Index];
+		const size_t Equal = Argument.find('=');
+		const std::string Name = Argument.substr(0, Equal);
+		const std::string Value = Equal != std::string::npos ? Argument.substr(Equal + 1) : std::string{};
+
+		if (Name.rfind("--", 0) != 0) {
+			Positional.push_back(Argument);
+		}
+		else if (Name == "--format") {
+			if (!ParseTextureFormat(Value.c_str(), Options.Format) || Options.Format == TextureFormat::BC4 || Options.Format == TextureFormat::R8) {
+				std::cerr << "Formato desconhecido: " << Value << " (use rgb, bc1 ou bc7)" << std::endl;
+				return false;
+			}
+		}
+		else if (Name == "--mip-filter") {
+			if (!ParseMipFilter(Value.c_str(), Options.Mips.Filter)) {
+				std::cerr << "Filtro de mipmap desconhecido: " << Value << " (use box, kaiser ou lanczos)" << std::endl;
+				return false;
+			}
+		}
+		else if (Name == "--linear") {
+			Options.Mips.bSRGB = false;
+		}
+		else if (Name == "--check") {
+			Options.bCheck = true;
+		}
+		else if (Name == "--size") {
+			int Width = 0;
+			int Height = 0;
+			if (std::sscanf(Value.c_str(), "%dx%d", &Width, &Height) != 2 || Width <= 0 || Height <= 0) {
+				std::cerr << "Tamanho invalido: " << Value << " (use LARGURAxALTURA)" << std::endl;
+				return false;
+			}
+			Options.RawWidth = static_cast<uint32_t>(Width);
+			Options.RawHeight = static_cast<uint32_t>(Height);
+		}
+		else if (Name == "--page") {
+			int ContentSize = 0;
+			if (std::sscanf(Value.c_str(), "%d", &ContentSize) != 1 || ContentSize <= 0) {
+				std::cerr << "Pagina invalida: " << Value << " (use o lado do conteudo em texels, por exemplo 128)" << std::endl;
+				return false;
+			}
+			Options.ContentSize = static_cast<uint32_t>(ContentSize);
+		}
+		else if (Name == "--border") {
+			int Border = 0;
+			if (std::sscanf(Value.c_str(), "%d", &Border) != 1 || Border < 0) {
+				std::cerr << "Borda invalida: " << Value << " (use texels, por exemplo 4)" << std::endl;
+				return false;
+			}
+			Options.Border = static_cast<uint32_t>(Border);
+		}
+		else {
+			std::cerr << "Opcao desconhecida: " << Argument << std::endl;
+			return false;
+		}
+	}
+
+	if (Options.bCheck) {
+		if (!Positional.empty()) {
+			return false;
+		}
+	}
+	else if (Positional.size() != 2) {
+		return false;
+	}
+	else {
+		Options.InputPath = Positional[0];
+		Options.OutputPath = Positional[1];
+	}
+
+	//os blocos BC são de 4x4: a página com borda precisa ser múltipla de 4, e o conteúdo par para a redução 2:1.
+	//a borda repete só o vizinho imediato, então não pode chegar ao tamanho do conteúdo
+	if (Options.Border >= Options.ContentSize) {
+		std::cerr << "Borda de " << Options.Border << " invalida: precisa ser menor que a pagina de " << Options.ContentSize << std::endl;
+		return false;
+	}
+	if (Options.ContentSize < 4 || Options.ContentSize % 2 != 0 || (Options.ContentSize + 2 * Options.Border) % 4 != 0) {
+		std::cerr << "Pagina de " << Options.ContentSize << " com borda " << Options.Border << " invalida: o conteudo precisa ser par e a pagina com borda multipla de 4" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+//cabeçalho do PPM binário: P6, largura, altura e valor máximo separados por espaços, com comentários iniciados por #
+static bool ReadPPMHeader(std::ifstream& File, uint32_t& OutWidth, uint32_t& OutHeight) {
+	auto ReadToken = [&File]() {
+		std::string Token;
+		int Char = File.get();
+		while (Char != EOF && (std::isspace(Char) || Char == '#')) {
+			if (Char == '#') {
+				while (Char != EOF && Char != '\n') {
+					Char = File.get();
+				}
+			}
+			Char = File.get();
+		}
+		while (Char != EOF && !std::isspace(Char)) {
+			Token.push_back(static_cast<char>(Char));
+			Char = File.get();
+		}
+		return Token;
+	};
+
+	if (ReadToken() != "P6") {
+		return false;
+	}
+	const std::string Width = ReadToken();
+	const std::string Height = ReadToken();
+	const std::string MaxValue = ReadToken();
+	int ParsedWidth = 0;
+	int ParsedHeight = 0;
+	if (std::sscanf(Width.c_str(), "%d", &ParsedWidth) != 1 || std::sscanf(Height.c_str(), "%d", &ParsedHeight) != 1
+		|| ParsedWidth <= 0 || ParsedHeight <= 0 || MaxValue != "255") {
+		return false;
+	}
+
+	//o último token consome exatamente um espaço, os pixels começam logo depois
+	OutWidth = static_cast<uint32_t>(ParsedWidth);
+	OutHeight = static_cast<uint32_t>(ParsedHeight);
+	return File.good();
+}
+
+static bool OpenSource(const BuilderOptions& Options, SourceImage& Source) {
+	std::string Extension = std::filesystem::path(Options.InputPath).extension().string();
+	std::transform(Extension.begin(), Extension.end(), Extension.begin(), [](unsigned char Char) { return static_cast<char>(std::tolower(Char)); });
+
+	if (Extension == ".ppm" || Extension == ".raw" || Extension == ".rgb") {
+		Source.File = std::make_shared<std::ifstream>(Options.InputPath, std::ios::binary);
+		if (!*Source.File) {
+			std::cerr << "Erro ao abrir " << Options.InputPath << std::endl;
+			return false;
+		}
+
+		std::streamoff DataOffset = 0;
+		if (Extension == ".ppm") {
+			if (!ReadPPMHeader(*Source.File, Source.Width, Source.Height)) {
+				std::cerr << "PPM invalido (so P6 com valor maximo 255): " << Options.InputPath << std::endl;
+				return false;
+			}
+			DataOffset = Source.File->tellg();
+		}
+		else {
+			Source.Width = Options.RawWidth;
+			Source.Height = Options.RawHeight;
+			if (Source.Width == 0 || Source.Height == 0) {
+				std::cerr << "RGB cru precisa de --size=LARGURAxALTURA" << std::endl;
+				return false;
+			}
+		}
+
+		std::error_code Error;
+		const uint64_t Expected = static_cast<uint64_t>(DataOffset) + static_cast<uint64_t>(Source.Width) * Source.Height * 3;
+		if (std::filesystem::file_size(Options.InputPath, Error) < Expected) {
+			std::cerr << "Arquivo menor que " << Source.Width << "x" << Source.Height << " pixels RGB: " << Options.InputPath << std::endl;
+			return false;
+		}
+
+		//a linha FirstRow é a Height - 1 - FirstRow do arquivo: a faixa é lida de uma vez e invertida na memória.
+		//as faixas andam do fim do arquivo para o início e só a borda volta ao outro extremo
+		const size_t Stride = static_cast<size_t>(Source.Width) * 3;
+		const uint32_t Height = Source.Height;
+		std::shared_ptr<std::ifstream> File = Source.File;
+		Source.ReadRows = [File, DataOffset, Stride, Height](uint32_t FirstRow, uint32_t NumRows, uint8_t* OutRows) {
+			const uint32_t FileRow = Height - FirstRow - NumRows;
+			File->seekg(DataOffset + static_cast<std::streamoff>(FileRow) * static_cast<std::streamoff>(Stride));
+			File->read(reinterpret_cast<char*>(OutRows), static_cast<std::streamsize>(NumRows) * Stride);
+			for (uint32_t Row = 0; Row < NumRows / 2; ++Row) {
+				std::swap_ranges(OutRows + Row * Stride, OutRows + (Row + 1) * Stride, OutRows + (NumRows - 1 - Row) * Stride);
+			}
+			return File->good();
+		};
+		Source.bStreamed = true;
+		return true;
+	}
+
+	//de baixo para cima, como o AsyncTextureLoader
+	stbi_set_flip_vertically_on_load(true);
+	int Width = 0, Height = 0, NumberOfComponents = 0;
+	Source.Pixels.reset(stbi_load(Options.InputPath.c_str(), &Width, &Height, &NumberOfComponents, 3), stbi_image_free);
+	if (!Source.Pixels) {
+		std::cerr << "Erro ao carregar " << Options.InputPath << ": " << stbi_failure_reason() << std::endl;
+		return false;
+	}
+
+	Source.Width = static_cast<uint32_t>(Width);
+	Source.Height = static_cast<uint32_t>(Height);
+	const size_t Stride = static_cast<size_t>(Width) * 3;
+	std::shared_ptr<unsigned char> Pixels = Source.Pixels;
+	Source.ReadRows = [Pixels, Stride](uint32_t FirstRow, uint32_t NumRows, uint8_t* OutRows) {
+		std::memcpy(OutRows, Pixels.get() + FirstRow * Stride, NumRows * Stride);
+		return true;
+	};
+	return true;
+}
+
+static bool WritePPM(const std::string& Path, const std::vector<uint8_t>& Pixels, uint32_t Width, uint32_t Height) {
+	std::ofstream File(Path, std::ios::binary | std::ios::trunc);
+	File << "P6\n" << Width << " " << Height << "\n255\n";
+	File.write(reinterpret_cast<const char*>(Pixels.data()), static_cast<std::streamsize>(Pixels.size()));
+	return File.good();
+}
+
+//conta as páginas diferentes do arquivo em Path em relação ao de ReferencePath; falso se algum não abrir ou os
+//layouts não forem iguais. A ordem das páginas no arquivo depende das threads, então a comparação é página a página
+static bool CompareArchives(const std::string& Path, const std::string& ReferencePath, size_t& OutDifferent) {
+	VirtualTextureArchive Archive, Reference;
+	if (!Archive.Open(Path) || !Reference.Open(ReferencePath)) {
+		return false;
+	}
+
+	const VirtualTextureLayout& Layout = Archive.GetLayout();
+	const VirtualTextureLayout& ReferenceLayout = Reference.GetLayout();
+	if (Layout.Width != ReferenceLayout.Width || Layout.Height != ReferenceLayout.Height || Layout.PagesX != ReferenceLayout.PagesX
+		|| Layout.PagesY != ReferenceLayout.PagesY || Layout.ContentSize != ReferenceLayout.ContentSize || Layout.Border != ReferenceLayout.Border
+		|| Layout.NumLevels != ReferenceLayout.NumLevels || Layout.Format != ReferenceLayout.Format) {
+		return false;
+	}
+
+	OutDifferent = 0;
+	for (uint32_t Level = 0; Level < Layout.NumLevels; ++Level) {
+		for (uint32_t Y = 0; Y < Layout.GetPagesY(Level); ++Y) {
+			for (uint32_t X = 0; X < Layout.GetPagesX(Level); ++X) {
+				size_t Bytes = 0, ReferenceBytes = 0;
+				const uint8_t* Page = Archive.GetPage(Level, X, Y, Bytes);
+				const uint8_t* ReferencePage = Reference.GetPage(Level, X, Y, ReferenceBytes);
+				if ((Page == nullptr) != (ReferencePage == nullptr) || Bytes != ReferenceBytes || (Page && std::memcmp(Page, ReferencePage, Bytes) != 0)) {
+					++OutDifferent;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+//gera uma imagem pequena pelos dois caminhos do TilePyramidBuilder (PPM em faixas e stb_image) e pelo do BlueMarble
+//(a imagem na memória de baixo para cima, como o stbi_load com a inversão) e confere que as páginas são as mesmas
+static bool RunCheck(const BuilderOptions& Options) {
+	//fora das potências de 2 e sem simetria vertical: uma imagem invertida muda quase todas as páginas
+	constexpr uint32_t Width = 300;
+	constexpr uint32_t Height = 170;
+	const size_t Stride = static_cast<size_t>(Width) * 3;
+	std::vector<uint8_t> Pixels(Stride * Height);
+	for (uint32_t Y = 0; Y < Height; ++Y) {
+		for (uint32_t X = 0; X < Width; ++X) {
+			uint8_t* Pixel = Pixels.data() + Y * Stride + X * 3;
+			Pixel[0] = static_cast<uint8_t>(X * 255 / (Width - 1));
+			Pixel[1] = static_cast<uint8_t>(Y * 255 / (Height - 1));
+			Pixel[2] = static_cast<uint8_t>((X * 7 + Y * Y * 3) & 0xFF);
+		}
+	}
+
+	std::error_code Error;
+	const std::string Base = (std::filesystem::temp_directory_path(Error) / "TilePyramidBuilderCheck").string();
+	const std::string StreamedInput = Base + ".ppm";
+	const std::string DecodedInput = Base + ".pnm";   //o mesmo PPM, a extensão manda para o stb_image
+	const std::string Outputs[] = { Base + "_faixas.bmvt", Base + "_stb.bmvt", Base + "_bluemarble.bmvt" };
+
+	bool bOk = WritePPM(StreamedInput, Pixels, Width, Height) && WritePPM(DecodedInput, Pixels, Width, Height);
+	const VirtualTextureLayout Layout = MakeVirtualTextureLayout(Width, Height, Options.Format);
+	const std::string Inputs[] = { StreamedInput, DecodedInput };
+	for (size_t Index = 0; Index < 2 && bOk; ++Index) {
+		BuilderOptions InputOptions = Options;
+		InputOptions.InputPath = Inputs[Index];
+		SourceImage Source;
+		bOk = OpenSource(InputOptions, Source) && BuildVirtualTexture(Outputs[Index], 0, Layout, Source.ReadRows, Options.Mips);
+	}
+
+	if (bOk) {
+		std::vector<uint8_t> Flipped(Pixels.size());
+		for (uint32_t Y = 0; Y < Height; ++Y) {
+			std::memcpy(Flipped.data() + (Height - 1 - Y) * Stride, Pixels.data() + Y * Stride, Stride);
+		}
+		bOk = BuildVirtualTexture(Outputs[2], 0, Flipped.data(), Width, Height, Options.Format, Options.Mips);
+	}
+
+	size_t StreamedDifferent = 0, DecodedDifferent = 0;
+	bOk = bOk && CompareArchives(Outputs[0], Outputs[2], StreamedDifferent) && CompareArchives(Outputs[1], Outputs[2], DecodedDifferent);
+
+	for (const std::string& Path : { StreamedInput, DecodedInput, Outputs[0], Outputs[1], Outputs[2] }) {
+		std::filesystem::remove(Path, Error);
+	}
+
+	if (!bOk) {
+		std::cerr << "Verificacao: erro ao gerar ou abrir os arquivos em " << Base << "*" << std::endl;
+		return false;
+	}
+	std::cout << "Verificacao " << ToString(Options.Format) << ": " << GetVirtualPageCount(Layout) << " paginas, " << StreamedDifferent
+		<< " diferentes em faixas e " << DecodedDifferent << " pelo stb_image em relacao ao BlueMarble" << std::endl;
+	return StreamedDifferent == 0 && DecodedDifferent == 0;
+}
+
+int main(int argc, char* argv[]) {
+	BuilderOptions Options;
+	if (!ParseOptions(argc, argv, Options)) {
+		PrintUsage();
+		return 1;
+	}
+
+	if (Options.bCheck) {
+		return RunCheck(Options) ? 0 : 1;
+	}
+
+	SourceImage Source;
+	if (!OpenSource(Options, Source)) {
+		return 1;
+	}
+
+	const VirtualTextureLayout Layout = MakeVirtualTextureLayout(Source.Width, Source.Height, Options.Format, Options.ContentSize, Options.Border);
+
+	//a chave identifica a origem e as opções; o BlueMarble aceita qualquer chave nos arquivos passados pela linha de comando
+	std::error_code Error;
+	uint64_t Key = HashString(std::filesystem::absolute(Options.InputPath, Error).string());
+	Key = HashValue(std::filesystem::file_size(Options.InputPath, Error), Key);
+	Key = HashValue(Layout.Format, Key);
+	Key = HashValue(Layout.ContentSize, Key);
+	Key = HashValue(Layout.Border, Key);
+	Key = HashValue(Options.Mips.Filter, Key);
+	Key = HashValue(Options.Mips.bSRGB, Key);
+	Key = HashValue(Options.Mips.AddressX, Key);
+	Key = HashValue(VirtualTextureVersion, Key);
+
+	std::cout << "Entrada: " << Options.InputPath << ", " << Source.Width << "x" << Source.Height
+		<< (Source.bStreamed ? " (lida em faixas)" : " (carregada inteira)") << std::endl;
+	std::cout << "Saida: " << Options.OutputPath << ", " << ToString(Layout.Format) << ", paginas de " << Layout.ContentSize << " + borda " << Layout.Border
+		<< ", filtro " << ToString(Options.Mips.Filter) << (Options.Mips.bSRGB ? " sRGB" : " linear") << ", "
+		<< GetThreadPool().GetNumThreads() << " threads" << std::endl;
+
+	VirtualTextureBuildStats Stats;
+	if (!BuildVirtualTexture(Options.OutputPath, Key, Layout, Source.ReadRows, Options.Mips, &Stats)) {
+		std::cerr << "Erro ao gerar " << Options.OutputPath << std::endl;
+		return 1;
+	}
+
+	const double SourceMegapixels = static_cast<double>(Source.Width) * Source.Height / 1.0e6;
+	std::cout << "Pronto: " << Stats.Pages << " paginas, " << Stats.ArchiveBytes / (1024 * 1024) << " MiB, "
+		<< SourceMegapixels / Stats.Seconds << " megapixels/s, " << Stats.BytesRead / (1024 * 1024) << " MiB lidos, pico de "
+		<< Stats.PeakMemoryBytes / (1024 * 1024) << " MiB em faixas" << std::endl;
+	return 0;
+}
@@ -0,0 +1,37 @@
+#include "VertexLayout.h"
+
+#include<cstddef>
+
+#include "SphereMesh.h"
+#include "VertexPacking.h"
+
+VertexLayout GetStandardVertexLayout() {
+	VertexLayout Layout;
+	Layout.Stride = sizeof(Vertex);
+	Layout.NumAttributes = 4;
+	Layout.Attributes[0] = { 0, 3, GL_FLOAT, GL_FALSE, static_cast<uint32_t>(offsetof(Vertex, Position)) };
+	Layout.Attributes[1] = { 1, 3, GL_FLOAT, GL_TRUE, static_cast<uint32_t>(offsetof(Vertex, Normal)) };
+	Layout.Attributes[2] = { 2, 3, GL_FLOAT, GL_TRUE, static_cast<uint32_t>(offsetof(Vertex, Color)) };
+	Layout.Attributes[3] = { 3, 2, GL_FLOAT, GL_TRUE, static_cast<uint32_t>(offsetof(Vertex, UV)) };
+	return Layout;
+}
+
+VertexLayout GetPackedVertexLayout() {
+	//a normal vai na location 1 como vec2, só o shader compactado sabe decodificar
+	VertexLayout Layout;
+	Layout.Stride = sizeof(PackedVertex);
+	Layout.NumAttributes = 3;
+	Layout.Attributes[0] = { 0, 3, GL_SHORT, GL_TRUE, static_cast<uint32_t>(offsetof(PackedVertex, Position)) };
+	Layout.Attributes[1] = { 1, 2, GL_SHORT, GL_TRUE, static_cast<uint32_t>(offsetof(PackedVertex, Normal)) };
+	Layout.Attributes[2] = { 3, 2, GL_HALF_FLOAT, GL_FALSE, static_cast<uint32_t>(offsetof(PackedVertex, UV)) };
+	return Layout;
+}
+
+void ApplyVertexLayout(const VertexLayout& Layout) {
+	for (uint32_t Index = 0; Index < Layout.NumAttributes && Index < MaxVertexAttributes; ++Index) {
+		const VertexAttribute& Attribute = Layout.Attributes[Index];
+		glEnableVertexAttribArray(Attribute.Location);
+		glVertexAttribPointer(Attribute.Location, Attribute.Components, Attribute.Type, Attribute.bNormalized ? GL_TRUE : GL_FALSE,
+			Layout.Stride, reinterpret_cast<void*>(static_cast<uintptr_t>(Attribute.Offset)));
+	}
+}
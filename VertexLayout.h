@@ -0,0 +1,32 @@
+#pragma once
+
+#include<cstdint>
+
+#include<GL/glew.h>
+
+constexpr uint32_t MaxVertexAttributes = 8;
+
+//descrição de um atributo no formato do glVertexAttribPointer
+struct VertexAttribute {
+	uint32_t Location;
+	uint32_t Components;
+	uint32_t Type;        //GL_FLOAT, GL_SHORT, GL_HALF_FLOAT...
+	uint32_t bNormalized;
+	uint32_t Offset;
+};
+
+//layout de um vertex buffer, salvo junto com a malha no cache em disco
+struct VertexLayout {
+	uint32_t Stride = 0;
+	uint32_t NumAttributes = 0;
+	VertexAttribute Attributes[MaxVertexAttributes] = {};
+};
+
+//layout do struct Vertex: posição, normal, cor e UV em float
+VertexLayout GetStandardVertexLayout();
+
+//layout do PackedVertex: posição snorm16, normal no octaedro em snorm16 e UV half float, sem cor
+VertexLayout GetPackedVertexLayout();
+
+//habilita e aponta os atributos do layout no VAO e no GL_ARRAY_BUFFER ativos
+void ApplyVertexLayout(const VertexLayout& Layout);
@@ -0,0 +1,81 @@
+#include "VertexPacking.h"
+
+#include<cassert>
+#include<cstring>
+
+#include<GL/glew.h>
+#include<glm/gtc/packing.hpp>
+
+#include "ThreadPool.h"
+
+static int16_t ToSnorm16(float Value) {
+	return static_cast<int16_t>(glm::round(glm::clamp(Value, -1.0f, 1.0f) * 32767.0f));
+}
+
+static float SignNotZero(float Value) {
+	return Value >= 0.0f ? 1.0f : -1.0f;
+}
+
+glm::vec2 EncodeOctahedral(const glm::vec3& Normal) {
+	//projeta no octaedro |x| + |y| + |z| = 1 e dobra o hemisfério de baixo sobre os cantos
+	const float L1 = glm::abs(Normal.x) + glm::abs(Normal.y) + glm::abs(Normal.z);
+	glm::vec2 Encoded{ Normal.x / L1, Normal.y / L1 };
+	if (Normal.z < 0.0f) {
+		Encoded = glm::vec2{ (1.0f - glm::abs(Encoded.y)) * SignNotZero(Encoded.x), (1.0f - glm::abs(Encoded.x)) * SignNotZero(Encoded.y) };
+	}
+	return Encoded;
+}
+
+glm::vec3 DecodeOctahedral(const glm::vec2& Encoded) {
+	//mesma conta do DecodeNormal em triangle_packed_vert.glsl
+	glm::vec3 Normal{ Encoded.x, Encoded.y, 1.0f - glm::abs(Encoded.x) - glm::abs(Encoded.y) };
+	const float Fold = glm::max(-Normal.z, 0.0f);
+	Normal.x += Normal.x >= 0.0f ? -Fold : Fold;
+	Normal.y += Normal.y >= 0.0f ? -Fold : Fold;
+	return glm::normalize(Normal);
+}
+
+void PackVertices(const Vertex* Vertices, size_t NumVertices, PackedVertex* OutVertices) {
+	ParallelFor(0, NumVertices, 16 * 1024, [Vertices, OutVertices](size_t Begin, size_t End) {
+		for (size_t Index = Begin; Index < End; ++Index) {
+			const Vertex& In = Vertices[Index];
+			assert(glm::abs(In.Position.x) <= 1.001f && glm::abs(In.Position.y) <= 1.001f && glm::abs(In.Position.z) <= 1.001f);
+
+			PackedVertex Out;
+			Out.Position[0] = ToSnorm16(In.Position.x);
+			Out.Position[1] = ToSnorm16(In.Position.y);
+			Out.Position[2] = ToSnorm16(In.Position.z);
+			Out.Padding = 0;
+
+			const glm::vec2 Normal = EncodeOctahedral(In.Normal);
+			Out.Normal[0] = ToSnorm16(Normal.x);
+			Out.Normal[1] = ToSnorm16(Normal.y);
+
+			Out.UV[0] = glm::packHalf1x16(In.UV.x);
+			Out.UV[1] = glm::packHalf1x16(In.UV.y);
+
+			OutVertices[Index] = Out;
+		}
+	});
+}
+
+uint32_t SelectIndexType(size_t NumVertices) {
+	return NumVertices <= 0x10000 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+size_t GetIndexSize(uint32_t IndexType) {
+	return IndexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t);
+}
+
+void PackIndices(const uint32_t* Indices, size_t NumIndices, uint32_t IndexType, void* OutIndices) {
+	if (IndexType != GL_UNSIGNED_SHORT) {
+		std::memcpy(OutIndices, Indices, NumIndices * sizeof(uint32_t));
+		return;
+	}
+
+	uint16_t* Out = static_cast<uint16_t*>(OutIndices);
+	for (size_t Index = 0; Index < NumIndices; ++Index) {
+		assert(Indices[Index] <= 0xFFFF);
+		Out[Index] = static_cast<uint16_t>(Indices[Index]);
+	}
+}
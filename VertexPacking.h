@@ -0,0 +1,33 @@
+#pragma once
+
+#include<cstddef>
+#include<cstdint>
+
+#include<glm/glm.hpp>
+
+#include "SphereMesh.h"
+
+//vértice compactado em 16 bytes (o Vertex tem 44):
+//posição em snorm16 (a malha precisa caber no cubo [-1, 1], como a esfera unitária),
+//normal em octaedro snorm16 e UV em half float. A cor constante é descartada, o shader usa branco.
+struct PackedVertex {
+	int16_t Position[3];
+	int16_t Padding;     //mantém a normal alinhada em 4 bytes
+	int16_t Normal[2];   //normal codificada no octaedro
+	uint16_t UV[2];      //half float
+};
+
+static_assert(sizeof(PackedVertex) == 16, "PackedVertex deve ter 16 bytes");
+
+//normal unitária para as coordenadas no octaedro em [-1, 1]^2
+glm::vec2 EncodeOctahedral(const glm::vec3& Normal);
+glm::vec3 DecodeOctahedral(const glm::vec2& Encoded);
+
+void PackVertices(const Vertex* Vertices, size_t NumVertices, PackedVertex* OutVertices);
+
+//GL_UNSIGNED_SHORT quando todos os índices cabem em 16 bits, senão GL_UNSIGNED_INT
+uint32_t SelectIndexType(size_t NumVertices);
+size_t GetIndexSize(uint32_t IndexType);
+
+//copia os índices convertendo para o tipo escolhido
+void PackIndices(const uint32_t* Indices, size_t NumIndices, uint32_t IndexType, void* OutIndices);
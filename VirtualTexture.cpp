@@ -0,0 +1,672 @@
+#include "VirtualTexture.h"
+
+#include<algorithm>
+#include<cassert>
+#include<cmath>
+#include<cstring>
+#include<filesystem>
+#include<iostream>
+#include<limits>
+#include<memory>
+
+#include "Hash.h"
+#include "GLState.h"
+#include "Profiler.h"
+#include "TextureCache.h"
+#include "stb_image.h"
+
+static constexpr uint64_t EmptySlot = std::numeric_limits<uint64_t>::max();
+
+VirtualTexture::~VirtualTexture() {
+	StopReader();
+}
+
+bool VirtualTexture::Open(const std::string& Path, const VirtualTextureSettings& NewSettings) {
+	assert(!IsOpen());
+	assert(NewSettings.PhysicalPagesPerSide > 0 && NewSettings.PhysicalPagesPerSide <= 256);
+
+	if (!Archive.Open(Path)) {
+		std::cout << "Erro ao abrir a textura virtual " << Path << std::endl;
+		return false;
+	}
+
+	Settings = NewSettings;
+	Frame = 0;
+	ResetStats();
+
+	const VirtualTextureLayout& Layout = Archive.GetLayout();
+	const uint32_t CoarsestLevel = Layout.NumLevels - 1;
+	const uint32_t NumSlots = Settings.PhysicalPagesPerSide * Settings.PhysicalPagesPerSide;
+	const uint32_t NumPinned = Layout.GetPagesX(CoarsestLevel) * Layout.GetPagesY(CoarsestLevel);
+	if (NumPinned >= NumSlots) {
+		std::cout << "Cache fisico pequeno demais para a textura virtual " << Path << std::endl;
+		Archive.Close();
+		return false;
+	}
+
+	//tabela de páginas: um texel por página e um mip level por nível, lida com texelFetch
+	PageTableLevels.resize(Layout.NumLevels);
+	DirtyRects.assign(Layout.NumLevels, DirtyRect{ 0, 0, 0, 0 });
+	glGenTextures(1, &PageTable);
+	GetGLState().BindTexture(GL_TEXTURE_2D, PageTable);
+	if (GLEW_ARB_texture_storage) {
+		glTexStorage2D(GL_TEXTURE_2D, Layout.NumLevels, GL_RGBA8, Layout.GetPagesX(0), Layout.GetPagesY(0));
+	}
+	for (uint32_t Level = 0; Level < Layout.NumLevels; ++Level) {
+		PageTableLevels[Level].assign(static_cast<size_t>(Layout.GetPagesX(Level)) * Layout.GetPagesY(Level), PageTableEntry{ 0, 0, 0, 0 });
+		if (!GLEW_ARB_texture_storage) {
+			glTexImage2D(GL_TEXTURE_2D, Level, GL_RGBA8, Layout.GetPagesX(Level), Layout.GetPagesY(Level), 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+		}
+	}
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, Layout.NumLevels - 1);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	//cache físico: sem mipmaps, a borda de cada página cobre o filtro bilinear
+	PhysicalSize = Settings.PhysicalPagesPerSide * Layout.GetPageSize();
+	glGenTextures(1, &Physical);
+	GetGLState().BindTexture(GL_TEXTURE_2D, Physical);
+	if (GLEW_ARB_texture_storage) {
+		glTexStorage2D(GL_TEXTURE_2D, 1, GetGLInternalFormat(Layout.Format), PhysicalSize, PhysicalSize);
+	}
+	else if (IsCompressed(Layout.Format)) {
+		glCompressedTexImage2D(GL_TEXTURE_2D, 0, GetGLInternalFormat(Layout.Format), PhysicalSize, PhysicalSize, 0,
+			static_cast<GLsizei>(GetTextureLevelSize(Layout.Format, PhysicalSize, PhysicalSize)), nullptr);
+	}
+	else {
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, PhysicalSize, PhysicalSize, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+	}
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	SlotPages.assign(NumSlots, EmptySlot);
+	SlotLastUsed.assign(NumSlots, 0);
+	SlotPinned.assign(NumSlots, false);
+
+	//o nível mais grosso fica sempre residente: toda página tem um ancestral para mostrar enquanto carrega
+	for (uint32_t Y = 0; Y < Layout.GetPagesY(CoarsestLevel); ++Y) {
+		for (uint32_t X = 0; X < Layout.GetPagesX(CoarsestLevel); ++X) {
+			size_t Bytes = 0;
+			const uint8_t* Data = Layout.HasPage(CoarsestLevel, X, Y) ? Archive.GetPage(CoarsestLevel, X, Y, Bytes) : nullptr;
+			if (Data && UploadPage(MakePageKey(CoarsestLevel, X, Y), Data, Bytes)) {
+				SlotPinned[ResidentSlots[MakePageKey(CoarsestLevel, X, Y)]] = true;
+			}
+		}
+	}
+	FlushPageTable();
+
+	glGenBuffers(1, &Readbacks[0].Buffer);
+	glGenBuffers(1, &Readbacks[1].Buffer);
+
+	bStopReader = false;
+	Reader = std::thread(&VirtualTexture::ReaderLoop, this);
+
+	const size_t PageTableBytes = GetGPUBytes() - GetTextureLevelSize(Layout.Format, PhysicalSize, PhysicalSize);
+	std::cout << "Textura virtual: " << Layout.Width << "x" << Layout.Height << " " << ToString(Layout.Format) << ", " << Layout.NumLevels << " niveis, "
+		<< "cache fisico de " << Settings.PhysicalPagesPerSide << "x" << Settings.PhysicalPagesPerSide << " paginas ("
+		<< GetTextureLevelSize(Layout.Format, PhysicalSize, PhysicalSize) / 1024 << " KiB), tabela de " << PageTableBytes / 1024 << " KiB, "
+		<< Settings.RAMBudgetBytes / (1024 * 1024) << " MiB de RAM" << std::endl;
+	return true;
+}
+
+void VirtualTexture::StopReader() {
+	if (!Reader.joinable()) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> Lock(ReaderMutex);
+		bStopReader = true;
+	}
+	ReaderCondition.notify_all();
+	Reader.join();
+}
+
+void VirtualTexture::Shutdown() {
+	StopReader();
+	ReadQueue.clear();
+	CompletedReads.clear();
+	PendingReads.clear();
+
+	for (FeedbackReadback& Readback : Readbacks) {
+		if (Readback.Fence) {
+			glDeleteSync(Readback.Fence);
+		}
+		GetGLState().DeleteBuffers(1, &Readback.Buffer);
+		Readback = FeedbackReadback{};
+	}
+	glDeleteFramebuffers(1, &FeedbackFramebuffer);
+	GetGLState().DeleteTextures(1, &FeedbackColor);
+	glDeleteRenderbuffers(1, &FeedbackDepth);
+	GetGLState().DeleteTextures(1, &PageTable);
+	GetGLState().DeleteTextures(1, &Physical);
+	FeedbackFramebuffer = FeedbackColor = FeedbackDepth = PageTable = Physical = 0;
+	FeedbackWidth = FeedbackHeight = 0;
+
+	PageTableLevels.clear();
+	DirtyRects.clear();
+	SlotPages.clear();
+	SlotLastUsed.clear();
+	SlotPinned.clear();
+	ResidentSlots.clear();
+	RAMPages.clear();
+	RAMIndex.clear();
+	RAMBytes = 0;
+	FeedbackPages.clear();
+	Archive.Close();
+}
+
+void VirtualTexture::ReaderLoop() {
+	PROFILE_THREAD("Leitor da textura virtual");
+	for (;;) {
+		uint64_t Key = 0;
+		{
+			std::unique_lock<std::mutex> Lock(ReaderMutex);
+			ReaderCondition.wait(Lock, [this]() { return bStopReader || !ReadQueue.empty(); });
+			if (bStopReader) {
+				return;
+			}
+			Key = ReadQueue.front();
+			ReadQueue.pop_front();
+		}
+
+		//a cópia tira a página do arquivo mapeado: é aqui que o disco é lido
+		PROFILE_SCOPE("VirtualTexture::ReadPage");
+		RAMPage Page;
+		Page.Key = Key;
+		size_t Bytes = 0;
+		const uint8_t* Data = Archive.GetPage(GetKeyLevel(Key), GetKeyX(Key), GetKeyY(Key), Bytes);
+		if (Data) {
+			Page.Data.assign(Data, Data + Bytes);
+		}
+
+		std::lock_guard<std::mutex> Lock(ReaderMutex);
+		CompletedReads.push_back(std::move(Page));
+	}
+}
+
+void VirtualTexture::CollectReads() {
+	std::vector<RAMPage> Completed;
+	{
+		std::lock_guard<std::mutex> Lock(ReaderMutex);
+		Completed.swap(CompletedReads);
+	}
+
+	for (RAMPage& Page : Completed) {
+		PendingReads.erase(Page.Key);
+		if (Page.Data.empty() || RAMIndex.count(Page.Key) > 0) {
+			continue;
+		}
+
+		++Stats.DiskReads;
+		RAMBytes += Page.Data.size();
+		RAMPages.push_front(std::move(Page));
+		RAMIndex[RAMPages.front().Key] = RAMPages.begin();
+	}
+
+	while (RAMBytes > Settings.RAMBudgetBytes && RAMPages.size() > 1) {
+		RAMBytes -= RAMPages.back().Data.size();
+		RAMIndex.erase(RAMPages.back().Key);
+		RAMPages.pop_back();
+		++Stats.RAMEvictions;
+	}
+}
+
+const VirtualTexture::RAMPage* VirtualTexture::FindRAMPage(uint64_t Key) {
+	const auto Found = RAMIndex.find(Key);
+	if (Found == RAMIndex.end()) {
+		return nullptr;
+	}
+
+	//usada agora, vai para a frente do LRU
+	RAMPages.splice(RAMPages.begin(), RAMPages, Found->second);
+	return &RAMPages.front();
+}
+
+bool VirtualTexture::ReadFeedback() {
+	//o feedback mais antigo primeiro; se a GPU ainda não terminou, tenta no próximo frame
+	FeedbackReadback* Oldest = nullptr;
+	for (FeedbackReadback& Readback : Readbacks) {
+		if (Readback.Fence && (!Oldest || Readback.Frame < Oldest->Frame)) {
+			Oldest = &Readback;
+		}
+	}
+	if (!Oldest) {
+		return false;
+	}
+
+	const GLenum Status = glClientWaitSync(Oldest->Fence, 0, 0);
+	if (Status != GL_ALREADY_SIGNALED && Status != GL_CONDITION_SATISFIED) {
+		return false;
+	}
+	glDeleteSync(Oldest->Fence);
+	Oldest->Fence = nullptr;
+
+	const VirtualTextureLayout& Layout = Archive.GetLayout();
+	const size_t NumPixels = static_cast<size_t>(Oldest->Width) * Oldest->Height;
+
+	FeedbackPages.clear();
+	GetGLState().BindBuffer(GL_PIXEL_PACK_BUFFER, Oldest->Buffer);
+	const uint16_t* Pixels = static_cast<const uint16_t*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, NumPixels * 4 * sizeof(uint16_t), GL_MAP_READ_BIT));
+	if (Pixels) {
+		uint64_t PreviousKey = EmptySlot;
+		for (size_t Index = 0; Index < NumPixels; ++Index) {
+			const uint16_t* Pixel = Pixels + Index * 4;
+			if (Pixel[3] == 0 || Pixel[2] >= Layout.NumLevels || !Layout.HasPage(Pixel[2], Pixel[0], Pixel[1])) {
+				continue;
+			}
+
+			//pixels vizinhos quase sempre caem na mesma página
+			const uint64_t Key = MakePageKey(Pixel[2], Pixel[0], Pixel[1]);
+			if (Key != PreviousKey) {
+				FeedbackPages.push_back(Key);
+				PreviousKey = Key;
+			}
+		}
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	}
+	GetGLState().BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	std::sort(FeedbackPages.begin(), FeedbackPages.end());
+	FeedbackPages.erase(std::unique(FeedbackPages.begin(), FeedbackPages.end()), FeedbackPages.end());
+	return true;
+}
+
+void VirtualTexture::AddPrefetch(const glm::vec3& CameraPosition, const glm::vec3& CameraVelocity, uint32_t FinestLevel, std::vector<uint64_t>& OutPages) {
+	if (glm::dot(CameraVelocity, CameraVelocity) < 1.0e-12f) {
+		return;
+	}
+
+	//ponto da superfície embaixo da posição prevista, com a mesma coordenada de textura do shader
+	const glm::vec3 Predicted = CameraPosition + CameraVelocity * Settings.PrefetchSeconds;
+	if (glm::dot(Predicted, Predicted) < 1.0e-12f) {
+		return;
+	}
+	const glm::vec3 N = glm::normalize(Predicted);
+	const float Pi = 3.14159265358979f;
+	const float Latitude = 1.0f - std::acos(glm::clamp(N.z, -1.0f, 1.0f)) / Pi;
+	const float Longitude = std::atan2(N.y, N.x) / (2.0f * Pi);
+	const float U = Latitude;
+	const float V = Longitude - std::floor(Longitude);
+
+	const VirtualTextureLayout& Layout = Archive.GetLayout();
+	const uint32_t LevelWidth = Layout.GetLevelWidth(FinestLevel);
+	const uint32_t LevelHeight = Layout.GetLevelHeight(FinestLevel);
+	const int64_t PagesX = (LevelWidth + Layout.ContentSize - 1) / Layout.ContentSize;
+	const int64_t PagesY = (LevelHeight + Layout.ContentSize - 1) / Layout.ContentSize;
+	const int64_t CenterX = std::min(static_cast<int64_t>(U * LevelWidth) / Layout.ContentSize, PagesX - 1);
+	const int64_t CenterY = std::min(static_cast<int64_t>(V * LevelHeight) / Layout.ContentSize, PagesY - 1);
+
+	//a página da posição prevista e as 8 vizinhas, repetindo nas bordas como o GL_REPEAT
+	for (int64_t OffsetY = -1; OffsetY <= 1; ++OffsetY) {
+		for (int64_t OffsetX = -1; OffsetX <= 1; ++OffsetX) {
+			const uint32_t X = static_cast<uint32_t>(((CenterX + OffsetX) % PagesX + PagesX) % PagesX);
+			const uint32_t Y = static_cast<uint32_t>(((CenterY + OffsetY) % PagesY + PagesY) % PagesY);
+			OutPages.push_back(MakePageKey(FinestLevel, X, Y));
+			++Stats.PrefetchedPages;
+		}
+	}
+}
+
+int VirtualTexture::FindFreeSlot() {
+	int Best = -1;
+	for (size_t Slot = 0; Slot < SlotPages.size(); ++Slot) {
+		if (SlotPages[Slot] == EmptySlot) {
+			return static_cast<int>(Slot);
+		}
+
+		//as páginas usadas neste frame ficam, mesmo que isso atrase os uploads
+		if (!SlotPinned[Slot] && SlotLastUsed[Slot] < Frame && (Best < 0 || SlotLastUsed[Slot] < SlotLastUsed[Best])) {
+			Best = static_cast<int>(Slot);
+		}
+	}
+	return Best;
+}
+
+bool VirtualTexture::UploadPage(uint64_t Key, const uint8_t* Data, size_t Bytes) {
+	const VirtualTextureLayout& Layout = Archive.GetLayout();
+	if (Bytes != Layout.GetPageBytes()) {
+		return false;
+	}
+
+	const int Slot = FindFreeSlot();
+	if (Slot < 0) {
+		return false;
+	}
+
+	//a página que sai passa a herdar o ancestral, e as filhas que herdavam dela também
+	if (SlotPages[Slot] != EmptySlot) {
+		const uint64_t Evicted = SlotPages[Slot];
+		const uint32_t Level = GetKeyLevel(Evicted);
+		ResidentSlots.erase(Evicted);
+		PageTableLevels[Level][static_cast<size_t>(GetKeyY(Evicted)) * Layout.GetPagesX(Level) + GetKeyX(Evicted)].bOwn = 0;
+		UpdatePageTable(Level, GetKeyX(Evicted), GetKeyY(Evicted));
+		++Stats.GPUEvictions;
+	}
+
+	const uint32_t SlotX = static_cast<uint32_t>(Slot) % Settings.PhysicalPagesPerSide;
+	const uint32_t SlotY = static_cast<uint32_t>(Slot) / Settings.PhysicalPagesPerSide;
+	const GLsizei PageSize = static_cast<GLsizei>(Layout.GetPageSize());
+
+	//o armazenamento do cache foi alocado no Open, aqui só a região do slot
+	GetGLState().BindTexture(GL_TEXTURE_2D, Physical);
+	if (IsCompressed(Layout.Format)) {
+		glCompressedTexSubImage2D(GL_TEXTURE_2D, 0, SlotX * PageSize, SlotY * PageSize, PageSize, PageSize,
+			GetGLInternalFormat(Layout.Format), static_cast<GLsizei>(Bytes), Data);
+	}
+	else {
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, SlotX * PageSize, SlotY * PageSize, PageSize, PageSize, GL_RGB, GL_UNSIGNED_BYTE, Data);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	}
+
+	SlotPages[Slot] = Key;
+	SlotLastUsed[Slot] = Frame;
+	ResidentSlots[Key] = Slot;
+
+	const uint32_t Level = GetKeyLevel(Key);
+	PageTableLevels[Level][static_cast<size_t>(GetKeyY(Key)) * Layout.GetPagesX(Level) + GetKeyX(Key)] =
+		PageTableEntry{ static_cast<uint8_t>(SlotX), static_cast<uint8_t>(SlotY), static_cast<uint8_t>(Level), 255 };
+	UpdatePageTable(Level, GetKeyX(Key), GetKeyY(Key));
+
+	++Stats.Uploads;
+	Stats.UploadBytes += Bytes;
+	return true;
+}
+
+void VirtualTexture::UpdatePageTable(uint32_t Level, uint32_t X, uint32_t Y) {
+	const VirtualTextureLayout& Layout = Archive.GetLayout();
+
+	//de cima para baixo na subárvore da página: quem não tem a própria página copia o pai, já atualizado
+	for (uint32_t Current = Level + 1; Current-- > 0;) {
+		const uint32_t Shift = Level - Current;
+		const uint32_t PagesX = Layout.GetPagesX(Current);
+		const uint32_t MinX = X << Shift;
+		const uint32_t MinY = Y << Shift;
+		const uint32_t MaxX = std::min((X + 1) << Shift, PagesX);
+		const uint32_t MaxY = std::min((Y + 1) << Shift, Layout.GetPagesY(Current));
+
+		std::vector<PageTableEntry>& Entries = PageTableLevels[Current];
+		if (Current + 1 < Layout.NumLevels) {
+			const std::vector<PageTableEntry>& Parents = PageTableLevels[Current + 1];
+			const uint32_t ParentPagesX = Layout.GetPagesX(Current + 1);
+			for (uint32_t PageY = MinY; PageY < MaxY; ++PageY) {
+				for (uint32_t PageX = MinX; PageX < MaxX; ++PageX) {
+					PageTableEntry& Entry = Entries[static_cast<size_t>(PageY) * PagesX + PageX];
+					if (!Entry.bOwn) {
+						Entry = Parents[static_cast<size_t>(PageY / 2) * ParentPagesX + PageX / 2];
+						Entry.bOwn = 0;
+					}
+				}
+			}
+		}
+
+		DirtyRect& Dirty = DirtyRects[Current];
+		if (Dirty.MaxX <= Dirty.MinX) {
+			Dirty = DirtyRect{ MinX, MinY, MaxX, MaxY };
+		}
+		else {
+			Dirty = DirtyRect{ std::min(Dirty.MinX, MinX), std::min(Dirty.MinY, MinY), std::max(Dirty.MaxX, MaxX), std::max(Dirty.MaxY, MaxY) };
+		}
+	}
+}
+
+void VirtualTexture::FlushPageTable() {
+	const VirtualTextureLayout& Layout = Archive.GetLayout();
+
+	GetGLState().BindTexture(GL_TEXTURE_2D, PageTable);
+	for (uint32_t Level = 0; Level < Layout.NumLevels; ++Level) {
+		DirtyRect& Dirty = DirtyRects[Level];
+		if (Dirty.MaxX <= Dirty.MinX) {
+			continue;
+		}
+
+		//só o retângulo alterado, lido direto do espelho com o comprimento de linha do nível
+		const uint32_t PagesX = Layout.GetPagesX(Level);
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, PagesX);
+		glTexSubImage2D(GL_TEXTURE_2D, Level, Dirty.MinX, Dirty.MinY, Dirty.MaxX - Dirty.MinX, Dirty.MaxY - Dirty.MinY, GL_RGBA, GL_UNSIGNED_BYTE,
+			&PageTableLevels[Level][static_cast<size_t>(Dirty.MinY) * PagesX + Dirty.MinX]);
+		Dirty = DirtyRect{ 0, 0, 0, 0 };
+	}
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+}
+
+void VirtualTexture::Update(const glm::vec3& CameraPosition, const glm::vec3& CameraVelocity) {
+	PROFILE_SCOPE("VirtualTexture::Update");
+	assert(IsOpen());
+	++Frame;
+	++Stats.Frames;
+
+	CollectReads();
+
+	const VirtualTextureLayout& Layout = Archive.GetLayout();
+	const uint32_t CoarsestLevel = Layout.NumLevels - 1;
+
+	//taxa de acerto: páginas distintas do feedback novo que já estavam no cache físico
+	if (ReadFeedback()) {
+		Stats.RequestedPages += FeedbackPages.size();
+		for (const uint64_t Key : FeedbackPages) {
+			Stats.ResidentHits += ResidentSlots.count(Key);
+		}
+	}
+
+	//as páginas do feedback, os seus ancestrais e as da posição prevista da câmera
+	uint32_t FinestLevel = CoarsestLevel;
+	std::vector<uint64_t> Wanted;
+	Wanted.reserve(FeedbackPages.size() * 2);
+	for (const uint64_t Key : FeedbackPages) {
+		FinestLevel = std::min(FinestLevel, GetKeyLevel(Key));
+	}
+	AddPrefetch(CameraPosition, CameraVelocity, FinestLevel, Wanted);
+	Wanted.insert(Wanted.end(), FeedbackPages.begin(), FeedbackPages.end());
+
+	const size_t NumLeaves = Wanted.size();
+	for (size_t Index = 0; Index < NumLeaves; ++Index) {
+		uint32_t Level = GetKeyLevel(Wanted[Index]);
+		uint32_t X = GetKeyX(Wanted[Index]);
+		uint32_t Y = GetKeyY(Wanted[Index]);
+		while (++Level < CoarsestLevel) {
+			X /= 2;
+			Y /= 2;
+			Wanted.push_back(MakePageKey(Level, X, Y));
+		}
+	}
+
+	//a chave começa pelo nível: em ordem decrescente os níveis grossos vêm primeiro
+	std::sort(Wanted.begin(), Wanted.end(), std::greater<uint64_t>());
+	Wanted.erase(std::unique(Wanted.begin(), Wanted.end()), Wanted.end());
+
+	std::vector<uint64_t> Missing;
+	for (const uint64_t Key : Wanted) {
+		const auto Resident = ResidentSlots.find(Key);
+		if (Resident != ResidentSlots.end()) {
+			SlotLastUsed[Resident->second] = Frame;
+		}
+		else {
+			Missing.push_back(Key);
+		}
+	}
+
+	//o que está na RAM sobe agora, até o limite do frame; o resto vai para a thread de leitura
+	uint32_t Uploads = 0;
+	for (const uint64_t Key : Missing) {
+		if (const RAMPage* Page = FindRAMPage(Key)) {
+			if (Uploads < Settings.MaxUploadsPerFrame && UploadPage(Key, Page->Data.data(), Page->Data.size())) {
+				++Uploads;
+				++Stats.RAMHits;
+			}
+		}
+	}
+	FlushPageTable();
+
+	//a fila é refeita a cada frame com as prioridades atuais; quem já está sendo lido continua
+	{
+		std::lock_guard<std::mutex> Lock(ReaderMutex);
+		for (const uint64_t Key : ReadQueue) {
+			PendingReads.erase(Key);
+		}
+		ReadQueue.clear();
+
+		for (const uint64_t Key : Missing) {
+			if (PendingReads.size() >= Settings.MaxPendingReads) {
+				break;
+			}
+			if (RAMIndex.count(Key) == 0 && PendingReads.insert(Key).second) {
+				ReadQueue.push_back(Key);
+			}
+		}
+	}
+	ReaderCondition.notify_one();
+
+	Stats.ResidentPages = ResidentSlots.size();
+	Stats.RAMBytes = RAMBytes;
+}
+
+void VirtualTexture::Bind(GLuint Program, GLint PageTableUnit, GLint PhysicalUnit, bool bFeedback) const {
+	const VirtualTextureLayout& Layout = Archive.GetLayout();
+
+	GLStateCache& State = GetGLState();
+	State.BindTexture(PageTableUnit, GL_TEXTURE_2D, PageTable);
+	State.BindTexture(PhysicalUnit, GL_TEXTURE_2D, Physical);
+
+	State.SetUniform(State.GetUniformLocation(Program, "VirtualPageTable"), PageTableUnit);
+	State.SetUniform(State.GetUniformLocation(Program, "VirtualPhysical"), PhysicalUnit);
+	State.SetUniform(State.GetUniformLocation(Program, "VirtualImageSize"), static_cast<float>(Layout.Width), static_cast<float>(Layout.Height));
+	State.SetUniform(State.GetUniformLocation(Program, "VirtualContentSize"), static_cast<float>(Layout.ContentSize));
+	State.SetUniform(State.GetUniformLocation(Program, "VirtualBorder"), static_cast<float>(Layout.Border));
+	State.SetUniform(State.GetUniformLocation(Program, "VirtualPhysicalSize"), static_cast<float>(PhysicalSize));
+	State.SetUniform(State.GetUniformLocation(Program, "VirtualMaxLevel"), static_cast<float>(Layout.NumLevels - 1));
+
+	//cada pixel do feedback cobre Divisor x Divisor pixels da tela, o nível pedido tem que ser o da tela
+	const float LevelBias = bFeedback ? -std::log2(static_cast<float>(Settings.FeedbackDivisor)) : 0.0f;
+	State.SetUniform(State.GetUniformLocation(Program, "VirtualLevelBias"), LevelBias);
+}
+
+void VirtualTexture::ResizeFeedback(int Width, int Height) {
+	glDeleteFramebuffers(1, &FeedbackFramebuffer);
+	GetGLState().DeleteTextures(1, &FeedbackColor);
+	glDeleteRenderbuffers(1, &FeedbackDepth);
+
+	FeedbackWidth = Width;
+	FeedbackHeight = Height;
+
+	glGenTextures(1, &FeedbackColor);
+	GetGLState().BindTexture(GL_TEXTURE_2D, FeedbackColor);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16UI, Width, Height, 0, GL_RGBA_INTEGER, GL_UNSIGNED_SHORT, nullptr);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	glGenRenderbuffers(1, &FeedbackDepth);
+	glBindRenderbuffer(GL_RENDERBUFFER, FeedbackDepth);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, Width, Height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &FeedbackFramebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, FeedbackFramebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, FeedbackColor, 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, FeedbackDepth);
+	assert(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void VirtualTexture::BeginFeedback(int ViewportWidth, int ViewportHeight) {
+	const int Divisor = static_cast<int>(Settings.FeedbackDivisor);
+	const int Width = std::max(1, (ViewportWidth + Divisor - 1) / Divisor);
+	const int Height = std::max(1, (ViewportHeight + Divisor - 1) / Divisor);
+
+	//o frame pode estar num framebuffer próprio (modo headless), não no da janela
+	GLint Previous = 0;
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &Previous);
+	PreviousFramebuffer = static_cast<GLuint>(Previous);
+
+	if (Width != FeedbackWidth || Height != FeedbackHeight) {
+		ResizeFeedback(Width, Height);
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, FeedbackFramebuffer);
+	GetGLState().SetViewport(0, 0, FeedbackWidth, FeedbackHeight);
+
+	//alfa 0 marca os pixels sem planeta
+	const GLuint Zero[4] = { 0, 0, 0, 0 };
+	glClearBufferuiv(GL_COLOR, 0, Zero);
+	glClear(GL_DEPTH_BUFFER_BIT);
+}
+
+void VirtualTexture::EndFeedback(int ViewportWidth, int ViewportHeight) {
+	//a leitura vai para um PBO e só é mapeada quando o fence sinalizar, sem esperar a GPU.
+	//um feedback ainda não lido neste PBO é descartado
+	FeedbackReadback& Readback = Readbacks[NextReadback];
+	NextReadback = (NextReadback + 1) % 2;
+	if (Readback.Fence) {
+		glDeleteSync(Readback.Fence);
+	}
+
+	GetGLState().BindBuffer(GL_PIXEL_PACK_BUFFER, Readback.Buffer);
+	if (Readback.Width != FeedbackWidth || Readback.Height != FeedbackHeight) {
+		Readback.Width = FeedbackWidth;
+		Readback.Height = FeedbackHeight;
+		glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<size_t>(FeedbackWidth) * FeedbackHeight * 4 * sizeof(uint16_t), nullptr, GL_STREAM_READ);
+	}
+	glReadBuffer(GL_COLOR_ATTACHMENT0);
+	glReadPixels(0, 0, FeedbackWidth, FeedbackHeight, GL_RGBA_INTEGER, GL_UNSIGNED_SHORT, nullptr);
+	GetGLState().BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	Readback.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	Readback.Frame = Frame;
+
+	glBindFramebuffer(GL_FRAMEBUFFER, PreviousFramebuffer);
+	GetGLState().SetViewport(0, 0, ViewportWidth, ViewportHeight);
+}
+
+size_t VirtualTexture::GetGPUBytes() const {
+	if (!IsOpen()) {
+		return 0;
+	}
+	size_t Bytes = GetTextureLevelSize(GetLayout().Format, PhysicalSize, PhysicalSize);
+	for (const std::vector<PageTableEntry>& Entries : PageTableLevels) {
+		Bytes += Entries.size() * sizeof(PageTableEntry);
+	}
+	return Bytes;
+}
+
+void VirtualTexture::ResetStats() {
+	const size_t ResidentPages = Stats.ResidentPages;
+	const size_t CurrentRAMBytes = Stats.RAMBytes;
+	Stats = VirtualTextureStats{};
+	Stats.ResidentPages = ResidentPages;
+	Stats.RAMBytes = CurrentRAMBytes;
+}
+
+uint64_t GetVirtualTextureCacheKey(const std::string& SourcePath, TextureFormat Format, const MipmapSettings& Mips) {
+	return HashValue(VirtualTextureVersion, GetTextureCacheKey(SourcePath, Format, Mips));
+}
+
+std::string GetVirtualTextureCachePath(const std::string& SourcePath, uint64_t Key) {
+	return "cache/" + std::filesystem::path(SourcePath).stem().string() + "_" + HashToString(Key) + ".bmvt";
+}
+
+std::string FindOrBuildVirtualTexture(const std::string& SourcePath, TextureFormat Format, const MipmapSettings& Mips) {
+	const uint64_t Key = GetVirtualTextureCacheKey(SourcePath, Format, Mips);
+	const std::string Path = GetVirtualTextureCachePath(SourcePath, Key);
+
+	VirtualTextureArchive Existing;
+	if (Existing.Open(Path, Key)) {
+		return Path;
+	}
+
+	int Width = 0, Height = 0, NumberOfComponents = 0;
+	std::unique_ptr<unsigned char, void (*)(void*)> Pixels(stbi_load(SourcePath.c_str(), &Width, &Height, &NumberOfComponents, 3), stbi_image_free);
+	if (!Pixels) {
+		std::cout << "Erro ao carregar " << SourcePath << ": " << stbi_failure_reason() << std::endl;
+		return std::string{};
+	}
+
+	if (!BuildVirtualTexture(Path, Key, Pixels.get(), Width, Height, Format, Mips)) {
+		std::cout << "Erro ao gravar " << Path << std::endl;
+		return std::string{};
+	}
+	return Path;
+}
\ No newline at end of file
@@ -0,0 +1,186 @@
+#pragma once
+
+#include<condition_variable>
+#include<cstddef>
+#include<cstdint>
+#include<deque>
+#include<list>
+#include<mutex>
+#include<string>
+#include<thread>
+#include<unordered_map>
+#include<unordered_set>
+#include<vector>
+
+#include<GL/glew.h>
+#include<glm/glm.hpp>
+
+#include "VirtualTextureArchive.h"
+
+//textura virtual: só as páginas que aparecem na tela ficam num cache físico de tamanho fixo na GPU.
+//uma tabela de páginas (uma textura com um texel por página e um mip level por nível) aponta cada página
+//para o seu lugar no cache físico, ou para o ancestral residente mais próximo enquanto ela não chega.
+//um passe de feedback em baixa resolução escreve quais páginas cada pixel usou; a leitura é assíncrona
+//(PBO + fence) e processada um ou dois frames depois. As páginas saem do arquivo mapeado numa thread
+//de leitura para um LRU na RAM e dali para a GPU, com um limite de uploads por frame.
+//a memória é fixa: cache físico, tabela de páginas e orçamento da RAM não dependem do tamanho da imagem.
+
+struct VirtualTextureSettings {
+	uint32_t PhysicalPagesPerSide = 16;        //páginas por lado no cache físico, até 256
+	size_t RAMBudgetBytes = 64 * 1024 * 1024;  //páginas lidas do disco mantidas na RAM
+	uint32_t MaxUploadsPerFrame = 16;
+	uint32_t MaxPendingReads = 64;             //páginas na fila da thread de leitura
+	uint32_t FeedbackDivisor = 8;              //o passe de feedback usa 1/8 da resolução da janela
+	float PrefetchSeconds = 0.5f;              //quanto à frente a posição da câmera é prevista
+};
+
+//acumuladas desde o último ResetStats
+struct VirtualTextureStats {
+	size_t Frames = 0;
+	size_t RequestedPages = 0;  //páginas distintas no feedback, somadas por frame
+	size_t ResidentHits = 0;    //das pedidas, as que já estavam no cache físico
+	size_t PrefetchedPages = 0;
+	size_t Uploads = 0;
+	size_t UploadBytes = 0;
+	size_t RAMHits = 0;         //uploads servidos pelo LRU da RAM, sem esperar o disco
+	size_t DiskReads = 0;
+	size_t GPUEvictions = 0;
+	size_t RAMEvictions = 0;
+
+	size_t ResidentPages = 0;   //no fim do último frame
+	size_t RAMBytes = 0;
+
+	float GetHitRate() const { return RequestedPages > 0 ? static_cast<float>(ResidentHits) / RequestedPages : 1.0f; }
+	size_t GetUploadBytesPerFrame() const { return Frames > 0 ? UploadBytes / Frames : 0; }
+};
+
+class VirtualTexture {
+public:
+	VirtualTexture() = default;
+	~VirtualTexture();
+
+	VirtualTexture(const VirtualTexture&) = delete;
+	VirtualTexture& operator=(const VirtualTexture&) = delete;
+
+	//abre o arquivo, cria as texturas e carrega o nível mais grosso, que nunca sai do cache.
+	//precisa do contexto OpenGL ativo.
+	bool Open(const std::string& Path, const VirtualTextureSettings& NewSettings = VirtualTextureSettings{});
+
+	//para a thread de leitura e libera os objetos OpenGL, com o contexto ainda ativo
+	void Shutdown();
+
+	bool IsOpen() const { return Archive.IsOpen(); }
+	const VirtualTextureLayout& GetLayout() const { return Archive.GetLayout(); }
+
+	//processa o feedback que já chegou, agenda leituras e envia páginas. Uma vez por frame, antes de desenhar.
+	//câmera no espaço do modelo do planeta
+	void Update(const glm::vec3& CameraPosition, const glm::vec3& CameraVelocity);
+
+	//liga a tabela de páginas e o cache físico nas unidades de textura e preenche os uniforms Virtual*.
+	//no passe de feedback o nível é corrigido pela resolução menor.
+	void Bind(GLuint Program, GLint PageTableUnit, GLint PhysicalUnit, bool bFeedback = false) const;
+
+	//desenhar a cena com o shader de feedback entre os dois; o EndFeedback volta ao framebuffer ligado antes do
+	//BeginFeedback e restaura o viewport
+	void BeginFeedback(int ViewportWidth, int ViewportHeight);
+	void EndFeedback(int ViewportWidth, int ViewportHeight);
+
+	//cache físico e tabela de páginas, fixos desde o Open
+	size_t GetGPUBytes() const;
+
+	const VirtualTextureStats& GetStats() const { return Stats; }
+	void ResetStats();
+
+private:
+	struct PageTableEntry {
+		uint8_t PhysicalX;
+		uint8_t PhysicalY;
+		uint8_t Level;
+		uint8_t bOwn;  //255 quando a própria página está residente, 0 quando herdou o ancestral
+	};
+
+	struct DirtyRect {
+		uint32_t MinX, MinY, MaxX, MaxY;  //máximo exclusivo, vazio quando MaxX <= MinX
+	};
+
+	struct RAMPage {
+		uint64_t Key;
+		std::vector<uint8_t> Data;
+	};
+
+	struct FeedbackReadback {
+		GLuint Buffer = 0;
+		GLsync Fence = nullptr;
+		int Width = 0;
+		int Height = 0;
+		uint64_t Frame = 0;
+	};
+
+	static uint64_t MakePageKey(uint32_t Level, uint32_t X, uint32_t Y) { return (uint64_t(Level) << 48) | (uint64_t(Y) << 24) | X; }
+	static uint32_t GetKeyLevel(uint64_t Key) { return static_cast<uint32_t>(Key >> 48); }
+	static uint32_t GetKeyY(uint64_t Key) { return static_cast<uint32_t>((Key >> 24) & 0xFFFFFF); }
+	static uint32_t GetKeyX(uint64_t Key) { return static_cast<uint32_t>(Key & 0xFFFFFF); }
+
+	void ReaderLoop();
+	void StopReader();
+	bool ReadFeedback();
+	void AddPrefetch(const glm::vec3& CameraPosition, const glm::vec3& CameraVelocity, uint32_t FinestLevel, std::vector<uint64_t>& OutPages);
+	void CollectReads();
+	const RAMPage* FindRAMPage(uint64_t Key);
+	bool UploadPage(uint64_t Key, const uint8_t* Data, size_t Bytes);
+	int FindFreeSlot();
+	void UpdatePageTable(uint32_t Level, uint32_t X, uint32_t Y);
+	void FlushPageTable();
+	void ResizeFeedback(int Width, int Height);
+
+	VirtualTextureArchive Archive;
+	VirtualTextureSettings Settings;
+	VirtualTextureStats Stats;
+	uint64_t Frame = 0;
+
+	GLuint PageTable = 0;
+	GLuint Physical = 0;
+	uint32_t PhysicalSize = 0;  //texels por lado
+
+	//espelho da tabela de páginas na CPU, um vetor por nível, e o retângulo alterado de cada um
+	std::vector<std::vector<PageTableEntry>> PageTableLevels;
+	std::vector<DirtyRect> DirtyRects;
+
+	//cache físico: página de cada slot, último frame em que foi usada e slot de cada página residente
+	std::vector<uint64_t> SlotPages;
+	std::vector<uint64_t> SlotLastUsed;
+	std::vector<bool> SlotPinned;
+	std::unordered_map<uint64_t, int> ResidentSlots;
+
+	//LRU da RAM, mais recente na frente
+	std::list<RAMPage> RAMPages;
+	std::unordered_map<uint64_t, std::list<RAMPage>::iterator> RAMIndex;
+	size_t RAMBytes = 0;
+
+	GLuint FeedbackFramebuffer = 0;
+	GLuint FeedbackColor = 0;
+	GLuint FeedbackDepth = 0;
+	GLuint PreviousFramebuffer = 0;       //ligado antes do BeginFeedback
+	int FeedbackWidth = 0;
+	int FeedbackHeight = 0;
+	FeedbackReadback Readbacks[2];
+	int NextReadback = 0;
+	std::vector<uint64_t> FeedbackPages;  //páginas do último feedback lido, usadas até chegar o próximo
+
+	//thread de leitura: pega chaves de ReadQueue e devolve as páginas copiadas em CompletedReads
+	std::thread Reader;
+	std::mutex ReaderMutex;
+	std::condition_variable ReaderCondition;
+	std::deque<uint64_t> ReadQueue;
+	std::vector<RAMPage> CompletedReads;
+	std::unordered_set<uint64_t> PendingReads;  //na fila ou sendo lidas, só na thread do OpenGL
+	bool bStopReader = false;
+};
+
+//chave e caminho do arquivo gerado automaticamente para uma imagem na pasta cache
+uint64_t GetVirtualTextureCacheKey(const std::string& SourcePath, TextureFormat Format, const MipmapSettings& Mips);
+std::string GetVirtualTextureCachePath(const std::string& SourcePath, uint64_t Key);
+
+//caminho do arquivo da imagem no cache, decodificando e construindo quando ainda não existe. Vazio se falhar.
+//imagens maiores que a memória passam pelo TilePyramidBuilder.
+std::string FindOrBuildVirtualTexture(const std::string& SourcePath, TextureFormat Format, const MipmapSettings& Mips);
\ No newline at end of file
@@ -0,0 +1,366 @@
+#include "VirtualTextureArchive.h"
+
+#include<cassert>
+#include<chrono>
+#include<cstring>
+#include<filesystem>
+#include<iostream>
+#include<system_error>
+#include<thread>
+
+#include "ThreadPool.h"
+
+static const char VirtualTextureMagic[4] = { 'B', 'M', 'V', 'T' };
+
+static uint32_t NextPowerOfTwo(uint32_t Value) {
+	uint32_t Result = 1;
+	while (Result < Value) {
+		Result *= 2;
+	}
+	return Result;
+}
+
+//módulo sempre positivo, para repetir as coordenadas das bordas
+static uint32_t Wrap(int64_t Value, uint32_t Size) {
+	const int64_t Result = Value % static_cast<int64_t>(Size);
+	return static_cast<uint32_t>(Result < 0 ? Result + Size : Result);
+}
+
+VirtualTextureLayout MakeVirtualTextureLayout(uint32_t Width, uint32_t Height, TextureFormat Format, uint32_t ContentSize, uint32_t Border) {
+	VirtualTextureLayout Layout;
+	Layout.Width = Width;
+	Layout.Height = Height;
+	Layout.ContentSize = ContentSize;
+	Layout.Border = Border;
+	Layout.Format = Format;
+	Layout.PagesX = NextPowerOfTwo((Width + ContentSize - 1) / ContentSize);
+	Layout.PagesY = NextPowerOfTwo((Height + ContentSize - 1) / ContentSize);
+
+	Layout.NumLevels = 1;
+	while ((Layout.PagesX >> Layout.NumLevels) > 0 && (Layout.PagesY >> Layout.NumLevels) > 0) {
+		++Layout.NumLevels;
+	}
+	return Layout;
+}
+
+size_t GetVirtualPageIndex(const VirtualTextureLayout& Layout, uint32_t Level, uint32_t X, uint32_t Y) {
+	size_t Index = 0;
+	for (uint32_t Previous = 0; Previous < Level; ++Previous) {
+		Index += static_cast<size_t>(Layout.GetPagesX(Previous)) * Layout.GetPagesY(Previous);
+	}
+	return Index + static_cast<size_t>(Y) * Layout.GetPagesX(Level) + X;
+}
+
+size_t GetVirtualPageCount(const VirtualTextureLayout& Layout) {
+	return GetVirtualPageIndex(Layout, Layout.NumLevels, 0, 0);
+}
+
+void ExtractVirtualPage(const VirtualTextureLayout& Layout, const uint8_t* Rows, int64_t FirstRow, uint32_t Level, uint32_t Channels, uint32_t PageX, uint32_t PageY, uint8_t* OutPixels) {
+	const uint32_t PageSize = Layout.GetPageSize();
+	const uint32_t LevelWidth = Layout.GetLevelWidth(Level);
+	const int64_t OriginX = static_cast<int64_t>(PageX) * Layout.ContentSize - Layout.Border;
+	const int64_t OriginY = static_cast<int64_t>(PageY) * Layout.ContentSize - Layout.Border;
+	assert(OriginY >= FirstRow);
+
+	for (uint32_t Y = 0; Y < PageSize; ++Y) {
+		const uint8_t* Row = Rows + static_cast<size_t>(OriginY + Y - FirstRow) * LevelWidth * Channels;
+		uint8_t* Out = OutPixels + static_cast<size_t>(Y) * PageSize * Channels;
+		for (uint32_t X = 0; X < PageSize; ++X) {
+			std::memcpy(Out + static_cast<size_t>(X) * Channels, Row + static_cast<size_t>(Wrap(OriginX + X, LevelWidth)) * Channels, Channels);
+		}
+	}
+}
+
+bool VirtualTextureArchive::Open(const std::string& Path, uint64_t Key) {
+	Close();
+	if (!File.OpenRead(Path)) {
+		return false;
+	}
+
+	VirtualTextureFileHeader Header;
+	if (File.GetSize() < sizeof(Header)) {
+		Close();
+		return false;
+	}
+	std::memcpy(&Header, File.GetData(), sizeof(Header));
+
+	Layout.Width = Header.Width;
+	Layout.Height = Header.Height;
+	Layout.PagesX = Header.PagesX;
+	Layout.PagesY = Header.PagesY;
+	Layout.ContentSize = Header.ContentSize;
+	Layout.Border = Header.Border;
+	Layout.NumLevels = Header.NumLevels;
+	Layout.Format = static_cast<TextureFormat>(Header.Format);
+
+	const bool bValid = std::memcmp(Header.Magic, VirtualTextureMagic, sizeof(VirtualTextureMagic)) == 0
+		&& Header.Version == VirtualTextureVersion
+		&& (Key == 0 || Header.Key == Key)
+		&& Header.Format <= static_cast<uint32_t>(TextureFormat::BC7) && Layout.Format != TextureFormat::BC4
+		&& Layout.ContentSize > 0 && Layout.NumLevels > 0 && Layout.NumLevels <= 16
+		&& Header.NumPages == GetVirtualPageCount(Layout)
+		&& Header.IndexOffset + Header.NumPages * sizeof(VirtualPageEntry) <= File.GetSize();
+
+	if (!bValid) {
+		Close();
+		return false;
+	}
+
+	Index = reinterpret_cast<const VirtualPageEntry*>(File.GetData() + Header.IndexOffset);
+	return true;
+}
+
+void VirtualTextureArchive::Close() {
+	File.Close();
+	Index = nullptr;
+	Layout = VirtualTextureLayout{};
+}
+
+const uint8_t* VirtualTextureArchive::GetPage(uint32_t Level, uint32_t X, uint32_t Y, size_t& OutBytes) const {
+	assert(Index && Level < Layout.NumLevels);
+	const VirtualPageEntry& Entry = Index[GetVirtualPageIndex(Layout, Level, X, Y)];
+	if (Entry.Offset == 0 || Entry.Offset + Entry.Bytes > File.GetSize()) {
+		OutBytes = 0;
+		return nullptr;
+	}
+
+	OutBytes = static_cast<size_t>(Entry.Bytes);
+	return File.GetData() + Entry.Offset;
+}
+
+bool VirtualTextureWriter::Create(const std::string& NewPath, const VirtualTextureLayout& NewLayout, uint64_t NewKey) {
+	Path = NewPath;
+	Layout = NewLayout;
+	Key = NewKey;
+	Index.assign(GetVirtualPageCount(Layout), VirtualPageEntry{ 0, 0 });
+	PagesWritten = 0;
+	bFailed = false;
+
+	std::error_code Error;
+	std::filesystem::create_directories(std::filesystem::path(Path).parent_path(), Error);
+
+	//o cabeçalho é reescrito no Finish, as páginas vêm logo depois dele
+	Stream.open(Path + ".tmp", std::ios::binary | std::ios::trunc);
+	const VirtualTextureFileHeader Empty{};
+	Stream.write(reinterpret_cast<const char*>(&Empty), sizeof(Empty));
+	NextOffset = sizeof(Empty);
+	return Stream.good();
+}
+
+bool VirtualTextureWriter::WritePage(uint32_t Level, uint32_t X, uint32_t Y, const uint8_t* Data, size_t Bytes) {
+	std::lock_guard<std::mutex> Lock(Mutex);
+
+	VirtualPageEntry& Entry = Index[GetVirtualPageIndex(Layout, Level, X, Y)];
+	Entry.Offset = NextOffset;
+	Entry.Bytes = Bytes;
+	Stream.write(reinterpret_cast<const char*>(Data), static_cast<std::streamsize>(Bytes));
+	NextOffset += Bytes;
+	++PagesWritten;
+
+	bFailed = bFailed || !Stream.good();
+	return !bFailed;
+}
+
+bool VirtualTextureWriter::Finish() {
+	VirtualTextureFileHeader Header{};
+	std::memcpy(Header.Magic, VirtualTextureMagic, sizeof(VirtualTextureMagic));
+	Header.Version = VirtualTextureVersion;
+	Header.Key = Key;
+	Header.Width = Layout.Width;
+	Header.Height = Layout.Height;
+	Header.PagesX = Layout.PagesX;
+	Header.PagesY = Layout.PagesY;
+	Header.ContentSize = Layout.ContentSize;
+	Header.Border = Layout.Border;
+	Header.NumLevels = Layout.NumLevels;
+	Header.Format = static_cast<uint32_t>(Layout.Format);
+	Header.IndexOffset = NextOffset;
+	Header.NumPages = Index.size();
+
+	Stream.write(reinterpret_cast<const char*>(Index.data()), static_cast<std::streamsize>(Index.size() * sizeof(VirtualPageEntry)));
+	Stream.seekp(0);
+	Stream.write(reinterpret_cast<const char*>(&Header), sizeof(Header));
+	Stream.close();
+
+	if (bFailed || Stream.fail()) {
+		return false;
+	}
+
+	std::error_code Error;
+	std::filesystem::rename(Path + ".tmp", Path, Error);
+	return !Error;
+}
+
+//lê as linhas virtuais [Begin, End) de um nível, repetindo as de fora da imagem como o GL_REPEAT.
+//cada trecho contínuo é uma leitura só
+static bool ReadWrappedRows(const ImageRowReader& ReadRows, uint32_t Width, uint32_t Height, int64_t Begin, int64_t End, uint8_t* OutRows) {
+	const size_t Stride = static_cast<size_t>(Width) * 3;
+	for (int64_t Y = Begin; Y < End;) {
+		const uint32_t Row = Wrap(Y, Height);
+		const uint32_t Count = static_cast<uint32_t>(std::min<int64_t>(End - Y, Height - Row));
+		if (!ReadRows(Row, Count, OutRows + static_cast<size_t>(Y - Begin) * Stride)) {
+			return false;
+		}
+		Y += Count;
+	}
+	return true;
+}
+
+//faixa de uma linha de páginas: as linhas com borda das páginas e as que o filtro do próximo nível usa
+struct VirtualTextureStrip {
+	int64_t FirstRow = 0;
+	int64_t EndRow = 0;
+	uint32_t OutRowBegin = 0;  //linhas do próximo nível geradas a partir desta faixa
+	uint32_t OutRowEnd = 0;
+	uint32_t MipFirstRow = 0;
+	std::vector<uint8_t> Rows;
+};
+
+bool BuildVirtualTexture(const std::string& Path, uint64_t Key, const VirtualTextureLayout& Layout, const ImageRowReader& ReadSourceRows, const MipmapSettings& Mips, VirtualTextureBuildStats* OutStats) {
+	const auto StartTime = std::chrono::steady_clock::now();
+	const uint32_t PageSize = Layout.GetPageSize();
+	const size_t PageBytes = Layout.GetPageBytes();
+	assert(Layout.ContentSize % 2 == 0);
+
+	VirtualTextureWriter Writer;
+	if (!Writer.Create(Path, Layout, Key)) {
+		return false;
+	}
+
+	VirtualTextureBuildStats Stats;
+	bool bOk = true;
+
+	//os níveis a partir do 1 passam por um arquivo temporário, sempre com uma faixa na memória
+	std::ifstream LevelInput;
+	std::string LevelInputPath;
+	for (uint32_t Level = 0; Level < Layout.NumLevels && bOk; ++Level) {
+		const auto LevelStartTime = std::chrono::steady_clock::now();
+		const uint32_t LevelWidth = Layout.GetLevelWidth(Level);
+		const uint32_t LevelHeight = Layout.GetLevelHeight(Level);
+		const size_t Stride = static_cast<size_t>(LevelWidth) * 3;
+		const bool bLastLevel = Level + 1 == Layout.NumLevels;
+		const uint32_t OutHeight = std::max(1u, LevelHeight / 2);
+		const uint32_t StripPagesX = (LevelWidth + Layout.ContentSize - 1) / Layout.ContentSize;
+		const uint32_t NumStrips = (LevelHeight + Layout.ContentSize - 1) / Layout.ContentSize;
+
+		const ImageRowReader ReadLevelRows = Level == 0 ? ReadSourceRows : ImageRowReader([&](uint32_t FirstRow, uint32_t NumRows, uint8_t* OutRows) {
+			LevelInput.seekg(static_cast<std::streamoff>(FirstRow) * Stride);
+			LevelInput.read(reinterpret_cast<char*>(OutRows), static_cast<std::streamsize>(NumRows) * Stride);
+			return LevelInput.good();
+		});
+
+		const std::string LevelOutputPath = Path + ".level" + std::to_string(Level + 1) + ".tmp";
+		std::ofstream LevelOutput;
+		if (!bLastLevel) {
+			LevelOutput.open(LevelOutputPath, std::ios::binary | std::ios::trunc);
+		}
+
+		auto ReadStrip = [&](uint32_t StripY, VirtualTextureStrip& Strip) {
+			Strip.FirstRow = static_cast<int64_t>(StripY) * Layout.ContentSize - Layout.Border;
+			Strip.EndRow = static_cast<int64_t>(StripY + 1) * Layout.ContentSize + Layout.Border;
+			Strip.OutRowBegin = std::min(StripY * Layout.ContentSize / 2, OutHeight);
+			Strip.OutRowEnd = bLastLevel ? Strip.OutRowBegin : std::min((StripY + 1) * Layout.ContentSize / 2, OutHeight);
+			if (StripY + 1 == NumStrips && !bLastLevel) {
+				Strip.OutRowEnd = OutHeight;
+			}
+			if (Strip.OutRowBegin < Strip.OutRowEnd) {
+				uint32_t MipEndRow = 0;
+				GetMipSourceRows(Mips, LevelHeight, Strip.OutRowBegin, Strip.OutRowEnd, Strip.MipFirstRow, MipEndRow);
+				Strip.FirstRow = std::min<int64_t>(Strip.FirstRow, Strip.MipFirstRow);
+				Strip.EndRow = std::max<int64_t>(Strip.EndRow, MipEndRow);
+			}
+
+			Strip.Rows.resize(static_cast<size_t>(Strip.EndRow - Strip.FirstRow) * Stride);
+			Stats.BytesRead += Strip.Rows.size();
+			return ReadWrappedRows(ReadLevelRows, LevelWidth, LevelHeight, Strip.FirstRow, Strip.EndRow, Strip.Rows.data());
+		};
+
+		//a próxima faixa é lida enquanto esta é cortada, comprimida e reduzida
+		VirtualTextureStrip Current, Next;
+		bool bNextOk = ReadStrip(0, Current);
+		for (uint32_t StripY = 0; StripY < NumStrips && bOk; ++StripY) {
+			bOk = bNextOk;
+			std::thread Prefetch;
+			if (StripY + 1 < NumStrips) {
+				Prefetch = std::thread([&, StripY]() { bNextOk = ReadStrip(StripY + 1, Next); });
+			}
+
+			if (bOk) {
+				ParallelFor(0, StripPagesX, 1, [&](size_t PageBegin, size_t PageEnd) {
+					std::vector<uint8_t> Page(static_cast<size_t>(PageSize) * PageSize * 3);
+					std::vector<uint8_t> Compressed(PageBytes);
+					for (size_t X = PageBegin; X < PageEnd; ++X) {
+						ExtractVirtualPage(Layout, Current.Rows.data(), Current.FirstRow, Level, 3, static_cast<uint32_t>(X), StripY, Page.data());
+						if (IsCompressed(Layout.Format)) {
+							CompressImage(Layout.Format, Page.data(), PageSize, PageSize, 3, Compressed.data());
+							Writer.WritePage(Level, static_cast<uint32_t>(X), StripY, Compressed.data(), PageBytes);
+						}
+						else {
+							Writer.WritePage(Level, static_cast<uint32_t>(X), StripY, Page.data(), PageBytes);
+						}
+					}
+				});
+
+				if (Current.OutRowBegin < Current.OutRowEnd) {
+					std::vector<uint8_t> OutRows(static_cast<size_t>(Current.OutRowEnd - Current.OutRowBegin) * std::max(1u, LevelWidth / 2) * 3);
+					const uint8_t* MipRows = Current.Rows.data() + static_cast<size_t>(Current.MipFirstRow - Current.FirstRow) * Stride;
+					DownsampleMipRows(MipRows, Current.MipFirstRow, LevelWidth, LevelHeight, 3, Mips, Current.OutRowBegin, Current.OutRowEnd, OutRows.data());
+					LevelOutput.write(reinterpret_cast<const char*>(OutRows.data()), static_cast<std::streamsize>(OutRows.size()));
+					Stats.PeakMemoryBytes = std::max(Stats.PeakMemoryBytes, Current.Rows.size() * 2 + OutRows.size());
+				}
+				else {
+					Stats.PeakMemoryBytes = std::max(Stats.PeakMemoryBytes, Current.Rows.size() * 2);
+				}
+			}
+
+			if (Prefetch.joinable()) {
+				Prefetch.join();
+			}
+			std::swap(Current, Next);
+		}
+
+		LevelInput.close();
+		if (!LevelInputPath.empty()) {
+			std::error_code Error;
+			std::filesystem::remove(LevelInputPath, Error);
+		}
+		if (!bLastLevel) {
+			LevelOutput.close();
+			bOk = bOk && !LevelOutput.fail();
+			LevelInput.open(LevelOutputPath, std::ios::binary);
+			LevelInputPath = LevelOutputPath;
+		}
+
+		std::cout << "Nivel " << Level << ": " << LevelWidth << "x" << LevelHeight << ", " << StripPagesX * NumStrips << " paginas em "
+			<< std::chrono::duration<double>(std::chrono::steady_clock::now() - LevelStartTime).count() << " s" << std::endl;
+	}
+
+	if (!LevelInputPath.empty()) {
+		LevelInput.close();
+		std::error_code Error;
+		std::filesystem::remove(LevelInputPath, Error);
+	}
+
+	bOk = Writer.Finish() && bOk;
+
+	Stats.Pages = Writer.GetPagesWritten();
+	Stats.ArchiveBytes = Writer.GetBytesWritten();
+	Stats.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+	if (OutStats) {
+		*OutStats = Stats;
+	}
+
+	std::cout << "Textura virtual: " << Stats.Pages << " paginas de " << PageSize << "x" << PageSize << " " << ToString(Layout.Format)
+		<< ", " << Layout.PagesX << "x" << Layout.PagesY << " no nivel 0, " << Layout.NumLevels << " niveis, "
+		<< Stats.ArchiveBytes / (1024 * 1024) << " MiB em " << Stats.Seconds << " s" << std::endl;
+	return bOk;
+}
+
+bool BuildVirtualTexture(const std::string& Path, uint64_t Key, const uint8_t* Pixels, uint32_t Width, uint32_t Height, TextureFormat Format, const MipmapSettings& Mips) {
+	const size_t Stride = static_cast<size_t>(Width) * 3;
+	const ImageRowReader ReadRows = [&](uint32_t FirstRow, uint32_t NumRows, uint8_t* OutRows) {
+		std::memcpy(OutRows, Pixels + FirstRow * Stride, NumRows * Stride);
+		return true;
+	};
+	return BuildVirtualTexture(Path, Key, MakeVirtualTextureLayout(Width, Height, Format), ReadRows, Mips);
+}
\ No newline at end of file
@@ -0,0 +1,139 @@
+#pragma once
+
+#include<algorithm>
+#include<cstddef>
+#include<cstdint>
+#include<fstream>
+#include<functional>
+#include<mutex>
+#include<string>
+#include<vector>
+
+#include "MappedFile.h"
+#include "Mipmap.h"
+#include "TextureCompression.h"
+
+//arquivo de páginas da textura virtual: pirâmide de mip levels cortada em páginas quadradas de ContentSize texels
+//com Border texels repetidos de cada vizinho, para o filtro bilinear não sair da página no cache físico.
+//o nível 0 tem PagesX x PagesY páginas (potências de 2) e a imagem ocupa o canto de origem;
+//páginas fora da imagem não são gravadas. O endereçamento repete nas bordas, como o GL_REPEAT da textura comum.
+//mudar o layout exige incrementar VirtualTextureVersion.
+constexpr uint32_t VirtualTextureVersion = 1;
+constexpr uint32_t DefaultVirtualPageContent = 128;
+constexpr uint32_t DefaultVirtualPageBorder = 4;
+
+struct VirtualTextureLayout {
+	uint32_t Width = 0;        //imagem original
+	uint32_t Height = 0;
+	uint32_t PagesX = 0;       //páginas no nível 0
+	uint32_t PagesY = 0;
+	uint32_t ContentSize = DefaultVirtualPageContent;
+	uint32_t Border = DefaultVirtualPageBorder;
+	uint32_t NumLevels = 0;    //o mais grosso tem uma página no lado menor
+	TextureFormat Format = TextureFormat::RGB8;
+
+	uint32_t GetPageSize() const { return ContentSize + 2 * Border; }
+	uint32_t GetPagesX(uint32_t Level) const { return std::max(1u, PagesX >> Level); }
+	uint32_t GetPagesY(uint32_t Level) const { return std::max(1u, PagesY >> Level); }
+	uint32_t GetLevelWidth(uint32_t Level) const { return std::max(1u, Width >> Level); }
+	uint32_t GetLevelHeight(uint32_t Level) const { return std::max(1u, Height >> Level); }
+	size_t GetPageBytes() const { return GetTextureLevelSize(Format, GetPageSize(), GetPageSize()); }
+
+	//a página tem algum texel dentro da imagem do nível
+	bool HasPage(uint32_t Level, uint32_t X, uint32_t Y) const {
+		return X * ContentSize < GetLevelWidth(Level) && Y * ContentSize < GetLevelHeight(Level);
+	}
+};
+
+struct VirtualTextureFileHeader {
+	char Magic[4];             //"BMVT"
+	uint32_t Version;
+	uint64_t Key;              //hash da imagem de origem e das opções, 0 para arquivos feitos à mão
+	uint32_t Width;
+	uint32_t Height;
+	uint32_t PagesX;
+	uint32_t PagesY;
+	uint32_t ContentSize;
+	uint32_t Border;
+	uint32_t NumLevels;
+	uint32_t Format;           //TextureFormat
+	uint64_t IndexOffset;      //VirtualPageEntry por página, nível 0 primeiro, linha por linha
+	uint64_t NumPages;
+};
+
+struct VirtualPageEntry {
+	uint64_t Offset;           //0 quando a página não existe
+	uint64_t Bytes;
+};
+
+//páginas por lado no nível 0 para uma imagem, arredondadas para potências de 2
+VirtualTextureLayout MakeVirtualTextureLayout(uint32_t Width, uint32_t Height, TextureFormat Format, uint32_t ContentSize = DefaultVirtualPageContent, uint32_t Border = DefaultVirtualPageBorder);
+
+//posição da página no índice do arquivo
+size_t GetVirtualPageIndex(const VirtualTextureLayout& Layout, uint32_t Level, uint32_t X, uint32_t Y);
+size_t GetVirtualPageCount(const VirtualTextureLayout& Layout);
+
+//copia a página (com borda) de uma faixa de linhas do nível. Rows começa na linha FirstRow, que pode ser negativa
+//(linhas de fora da imagem já repetidas) e precisa cobrir as linhas da página; na horizontal a repetição é feita aqui.
+void ExtractVirtualPage(const VirtualTextureLayout& Layout, const uint8_t* Rows, int64_t FirstRow, uint32_t Level, uint32_t Channels, uint32_t PageX, uint32_t PageY, uint8_t* OutPixels);
+
+//arquivo de páginas mapeado, só leitura. Pode ser lido de qualquer thread depois do Open.
+class VirtualTextureArchive {
+public:
+	bool Open(const std::string& Path, uint64_t Key = 0);
+	void Close();
+
+	bool IsOpen() const { return File.IsOpen(); }
+	const VirtualTextureLayout& GetLayout() const { return Layout; }
+
+	//nullptr quando a página não existe
+	const uint8_t* GetPage(uint32_t Level, uint32_t X, uint32_t Y, size_t& OutBytes) const;
+
+private:
+	MappedFile File;
+	VirtualTextureLayout Layout;
+	const VirtualPageEntry* Index = nullptr;
+};
+
+//grava um arquivo de páginas em Path + ".tmp" e troca pelo definitivo no Finish.
+//WritePage pode ser chamado de várias threads, em qualquer ordem.
+class VirtualTextureWriter {
+public:
+	bool Create(const std::string& NewPath, const VirtualTextureLayout& NewLayout, uint64_t Key = 0);
+	bool WritePage(uint32_t Level, uint32_t X, uint32_t Y, const uint8_t* Data, size_t Bytes);
+	bool Finish();
+
+	size_t GetPagesWritten() const { return PagesWritten; }
+	uint64_t GetBytesWritten() const { return NextOffset; }
+
+private:
+	std::string Path;
+	VirtualTextureLayout Layout;
+	uint64_t Key = 0;
+	std::ofstream Stream;
+	std::vector<VirtualPageEntry> Index;
+	uint64_t NextOffset = 0;
+	size_t PagesWritten = 0;
+	bool bFailed = false;
+	std::mutex Mutex;
+};
+
+//lê NumRows linhas RGB da imagem de origem a partir de FirstRow. As linhas são pedidas quase sempre em ordem crescente;
+//só a borda das páginas volta ao outro extremo da imagem.
+using ImageRowReader = std::function<bool(uint32_t FirstRow, uint32_t NumRows, uint8_t* OutRows)>;
+
+struct VirtualTextureBuildStats {
+	size_t Pages = 0;
+	uint64_t ArchiveBytes = 0;
+	uint64_t BytesRead = 0;       //da origem e dos níveis temporários, contando a sobreposição das faixas
+	size_t PeakMemoryBytes = 0;   //faixas de linhas em uso, sem contar o índice
+	double Seconds = 0.0;
+};
+
+//constrói o arquivo fora da memória: cada nível é lido em faixas de uma linha de páginas (mais as bordas e as linhas
+//do filtro do mipmap), cortado e comprimido em paralelo, e reduzido para o próximo nível, que vai para um arquivo
+//temporário ao lado do Path. A memória depende da largura da imagem, não da altura.
+bool BuildVirtualTexture(const std::string& Path, uint64_t Key, const VirtualTextureLayout& Layout, const ImageRowReader& ReadSourceRows, const MipmapSettings& Mips, VirtualTextureBuildStats* OutStats = nullptr);
+
+//mesmo processo para uma imagem RGB que já está na memória
+bool BuildVirtualTexture(const std::string& Path, uint64_t Key, const uint8_t* Pixels, uint32_t Width, uint32_t Height, TextureFormat Format, const MipmapSettings& Mips);
\ No newline at end of file
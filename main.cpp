@@ -1,571 +1,1164 @@
-#include<iostream>
-#include<cassert>
-#include<array>
-#include<fstream>
-#include<vector>
-
-#include<GL/glew.h>
-#include<GLFW/glfw3.h>
-#include<glm/glm.hpp>
-#include<glm/ext.hpp>
-#include<glm/gtx/string_cast.hpp>
-
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
-
-int width = 800;
-int height = 600;
-
-std::string ReadFile(const char* FilePath) {
-	std::string FileContents;
-	if (std::ifstream FileStream{ FilePath, std::ios::in }) {
-		FileContents.assign((std::istreambuf_iterator<char>(FileStream)), std::istreambuf_iterator<char>());
-	}
-	return FileContents;
-}
-
-void CheckShader(GLuint ShaderID) {
-	//ShaderID tem que ser um identificador de um shader j compilado
-	GLint Result = GL_TRUE;
-	glGetShaderiv(ShaderID, GL_COMPILE_STATUS, &Result);
-
-	if (Result == GL_FALSE) {
-		//obtm o tamanho do log
-		GLint InfoLogLenght = 0;
-		glGetShaderiv(ShaderID, GL_INFO_LOG_LENGTH, &InfoLogLenght);
-
-		std::string ShaderInfoLog(InfoLogLenght, '\0');
-		glGetShaderInfoLog(ShaderID, InfoLogLenght, nullptr, &ShaderInfoLog[0]);
-
-		if (InfoLogLenght > 0) {
-			std::cout << "Erro no shader" << std::endl;
-			std::cout << ShaderInfoLog << std::endl;
-
-			assert(false);
-		}
-	}
-}
-
-GLuint LoadShaders(const char* VertexShaderFile, const char* FragmentShaderFile) {
-	//cria os identificadores
-	GLuint VertexShaderID = glCreateShader(GL_VERTEX_SHADER);
-	GLuint FragmentShaderID = glCreateShader(GL_FRAGMENT_SHADER);
-
-	std::string VertexShaderSource = ReadFile(VertexShaderFile);
-	std::string FragmentShaderSource = ReadFile(FragmentShaderFile);
-
-	assert(!VertexShaderSource.empty());
-	assert(!FragmentShaderSource.empty());
-
-	std::cout << "Compilando " << VertexShaderFile << std::endl;
-	const char* VertexShaderSourcePtr = VertexShaderSource.c_str();
-	glShaderSource(VertexShaderID, 1, &VertexShaderSourcePtr, nullptr);
-	glCompileShader(VertexShaderID);
-	CheckShader(VertexShaderID);
-
-	std::cout << "Compilando " << FragmentShaderFile << std::endl;
-	const char* FragmentShaderSourcePtr = FragmentShaderSource.c_str();
-	glShaderSource(FragmentShaderID, 1, &FragmentShaderSourcePtr, nullptr);
-	glCompileShader(FragmentShaderID);
-	CheckShader(FragmentShaderID);
-
-	std::cout << "Linkando o programa" << std::endl;
-	GLuint ProgramID = glCreateProgram();
-	glAttachShader(ProgramID, VertexShaderID);
-	glAttachShader(ProgramID, FragmentShaderID);
-	glLinkProgram(ProgramID);
-
-	//verifica a linkagem
-	GLint Result = GL_TRUE;
-	glGetProgramiv(ProgramID, GL_LINK_STATUS, &Result);
-
-	if (Result == GL_FALSE) {
-		//pega o log para saber qual  o problema
-		GLint InfoLogLenght = 0;
-		glGetProgramiv(ProgramID, GL_INFO_LOG_LENGTH, &InfoLogLenght);
-
-		if (InfoLogLenght > 0) {
-			std::string ProgramInfoLog(InfoLogLenght, '\0');
-			glGetProgramInfoLog(ProgramID, InfoLogLenght, nullptr, &ProgramInfoLog[0]);
-			std::cout << "Erro ao linkar o programa" << std::endl;
-			std::cout << ProgramInfoLog << std::endl;
-
-			assert(false);
-		}
-	}
-
-	glDetachShader(ProgramID, VertexShaderID);
-	glDetachShader(ProgramID, FragmentShaderID);
-	glDeleteShader(VertexShaderID);
-	glDeleteShader(FragmentShaderID);
-
-	return ProgramID;
-}
-
-GLuint LoadTexture(const char* TextureFile) {
-	std::cout << "Carregando Textura" << TextureFile << std::endl;
-	stbi_set_flip_vertically_on_load(true);
-
-	int TextureWidth = 0, TextureHeight = 0, NumberOfComponents = 0;
-	unsigned char* TextureData = stbi_load(TextureFile, &TextureWidth, &TextureHeight, &NumberOfComponents, 3);
-	assert(TextureData);
-
-	//gera o identificador de textura
-	GLuint TextureID;
-	glGenTextures(1, &TextureID);
-
-	//habilita a textura para ser modifcada
-	glBindTexture(GL_TEXTURE_2D, TextureID);
-
-	//copia a textura para a memria de vdeo (GPU)
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, TextureWidth, TextureHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, TextureData);
-
-	//filtros de magnificao e minificao
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-
-	// configurao do texture wrapping
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-	//gera o mipmap a partir da textura
-	glGenerateMipmap(GL_TEXTURE_2D);
-
-	//desliga a textura pois la j foi copiada para a gpu
-	glBindTexture(GL_TEXTURE_2D, 0);
-
-	stbi_image_free(TextureData);
-
-	return TextureID;
-}
-
-struct Vertex {
-	glm::vec3 Position;
-	glm::vec3 Normal;
-	glm::vec3 Color;
-	glm::vec2 UV; //cordenada de textura do vrtice
-};
-
-struct DirectionalLight {
-	glm::vec3 Direction;
-	GLfloat Intensity;
-};
-
-GLuint LoadGeometry() {
-	//quadrado em coordenadas normalizadas
-	std::array<Vertex, 6 > quad = {
-		Vertex{glm::vec3{-1.0f, -1.0f, 0.0f}, glm::vec3{0.0f, 0.0f, 1.0f}, glm::vec3{1.0f,0.0f,0.0f}, glm::vec2{0.0f, 0.0f}}, //vrtice canto inferior esquerdo
-		Vertex{glm::vec3{1.0f, -1.0f, 0.0f}, glm::vec3{0.0f,0.0f,1.0f}, glm::vec3{0.0f,1.0f,0.0f}, glm::vec2{1.0f, 0.0f}}, //vrtice canto inferior direito
-		Vertex{glm::vec3{1.0f, 1.0f, 0.0f},glm::vec3{0.0f, 0.0f, 1.0f}, glm::vec3{1.0f,0.0f,0.0f}, glm::vec2{1.0f, 1.0f}},
-		Vertex{glm::vec3{-1.0f, 1.0f, 0.0f},glm::vec3{0.0f, 0.0f, 1.0f}, glm::vec3{0.0f,0.0f,1.0f}, glm::vec2{0.0f, 1.0f}}
-	};
-
-	//Define a lista de elementos que formam os tringulos
-	std::array<glm::ivec3, 2> Indices = {
-		glm::ivec3{0, 1, 3},
-		glm::ivec3{3, 1, 2}
-	};
-
-	//copia os dados para a GPU
-	GLuint VertexBuffer;
-
-	//gera o identifcador do vertexbuffer - VBO
-	glGenBuffers(1, &VertexBuffer);
-
-	//pede para o opengl gerar o identificador do EBO
-	GLuint ElementBuffer = 0;
-	glGenBuffers(1, &ElementBuffer);
-
-	//ativa o vertex como sendo o buffer para onde os dados vo ser copiados
-	glBindBuffer(GL_ARRAY_BUFFER, VertexBuffer);
-
-	//copias os dados para a memria de vdeo
-	glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad.data(), GL_STATIC_DRAW);
-
-	//copia os dados do Element Buffer para a GPU
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ElementBuffer);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(Indices), Indices.data(), GL_STATIC_DRAW);
-
-	//Gera o vertex array object - VAO
-	GLuint VAO;
-	glGenVertexArrays(1, &VAO);
-
-	//habilita o VAO
-	glBindVertexArray(VAO);
-
-	//Atributo para cor nos vrtices
-	glEnableVertexAttribArray(0);
-	glEnableVertexAttribArray(1);
-	glEnableVertexAttribArray(2);
-	glEnableVertexAttribArray(3);
-
-	//aponta para o OpenGl quaul vai ser o buffer ativo no momento
-	glBindBuffer(GL_ARRAY_BUFFER, VertexBuffer);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ElementBuffer);
-
-	//informa onde dentro do buffer esto os vrtices
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), nullptr);
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_TRUE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, Normal)));
-	glVertexAttribPointer(2, 3, GL_FLOAT, GL_TRUE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, Color)));
-	glVertexAttribPointer(3, 2, GL_FLOAT, GL_TRUE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, UV)));
-
-	glBindVertexArray(0);
-	return VAO;
-}
-
-void GenerateSphereMesh(GLuint Resolution, std::vector<Vertex>& Vertices, std::vector<glm::ivec3>&Indices) {
-	Vertices.clear();
-	Indices.clear();
-
-	constexpr float Pi = glm::pi<float>();
-	constexpr float TwoPi = glm::two_pi<float>();
-	float InvResolution = 1.0f / static_cast<float>(Resolution - 1);
-
-	for (GLuint UIndex = 0; UIndex < Resolution; ++UIndex) {
-		const float U = UIndex * InvResolution;
-		const float Theta = glm::mix(0.0f, Pi, U);
-
-		for (GLuint VIndex = 0; VIndex < Resolution; ++VIndex) {
-			const float V = VIndex * InvResolution;
-			const float Phi = glm::mix(0.0f, TwoPi, V);
-
-			glm::vec3 VertexPosition = {
-				glm::sin(Theta) * glm::cos(Phi),
-				glm::sin(Theta)* glm::sin(Phi),
-				glm::cos(Theta)
-			};
-
-			Vertex Vertex{
-				VertexPosition,
-				glm::normalize(VertexPosition),
-				glm::vec3{1.0f, 1.0f, 1.0f},
-				glm::vec2{1.0f - U, V}
-			};
-
-			Vertices.push_back(Vertex);
-		}
-	}
-
-	for (GLuint U = 0; U < Resolution - 1; ++U) {
-		for (GLuint V = 0; V < Resolution - 1; ++V) {
-			GLuint P0 = U + V * Resolution;
-			GLuint P1 = (U + 1) + V * Resolution;
-			GLuint P2 = (U + 1) + (V + 1) * Resolution;
-			GLuint P3 = U + (V + 1) * Resolution;
-
-			Indices.push_back(glm::ivec3{ P0, P1, P3 });
-			Indices.push_back(glm::ivec3{ P3, P1, P2 });
-		}
-	}
-}
-
-GLuint LoadSphere(GLuint& NumVertices, GLuint& NumIndices) {
-	std::vector<Vertex> Vertices;
-	std::vector<glm::ivec3> Triangles;
-	GenerateSphereMesh(50, Vertices, Triangles);
-
-	NumVertices = Vertices.size();
-	NumIndices = Triangles.size() * 3;
-
-	GLuint VertexBuffer;
-	glGenBuffers(1, &VertexBuffer);
-
-	//ativa o vertex como sendo o buffer para onde os dados vo ser copiados
-	glBindBuffer(GL_ARRAY_BUFFER, VertexBuffer);
-
-	//copias os dados para a memria de vdeo
-	glBufferData(GL_ARRAY_BUFFER, Vertices.size() * sizeof(Vertex), Vertices.data(), GL_STATIC_DRAW);
-
-	GLuint ElementBuffer;
-	glGenBuffers(1, &ElementBuffer);
-
-	//ativa o vertex como sendo o buffer para onde os dados vo ser copiados
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ElementBuffer);
-
-	//copias os dados para a memria de vdeo
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, NumIndices * sizeof(GLuint), Triangles.data(), GL_STATIC_DRAW);
-
-	GLuint VAO;
-	glGenVertexArrays(1, &VAO);
-	glBindVertexArray(VAO);
-
-	//Atributo para cor nos vrtices
-	glEnableVertexAttribArray(0);
-	glEnableVertexAttribArray(1);
-	glEnableVertexAttribArray(2);
-	glEnableVertexAttribArray(3);
-
-
-	//aponta para o OpenGl quaul vai ser o buffer ativo no momento
-	glBindBuffer(GL_ARRAY_BUFFER, VertexBuffer);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ElementBuffer);
-
-	//informa onde dentro do buffer esto os vrtices
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), nullptr);
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_TRUE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, Normal)));
-	glVertexAttribPointer(2, 3, GL_FLOAT, GL_TRUE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, Color)));
-	glVertexAttribPointer(3, 2, GL_FLOAT, GL_TRUE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, UV)));
-
-	glBindVertexArray(0);
-	return VAO;
-}
-
-class FlyCamera {
-public:
-	void MoveForward(float Amount) {
-		LocationVRP += glm::normalize(Direction) * Amount * Speed;
-	}
-
-	void MoveRight(float Amount) {
-		glm::vec3 Right = glm::normalize(glm::cross(Direction, ViewUp));
-		LocationVRP += Right * Amount * Speed;
-	}
-
-	void Look(float Yaw, float Pitch) {
-		Yaw *= Sensitivity;
-		Pitch *= Sensitivity;
-
-		const glm::vec3 Right = glm::normalize(glm::cross(Direction, ViewUp));
-
-		const glm::mat4 I = glm::identity < glm::mat4>();
-		glm::mat4 YawRotation = glm::rotate(I, glm::radians(Yaw), ViewUp);
-		glm::mat4 PitchRotation = glm::rotate(I, glm::radians(Pitch), Right);
-
-		ViewUp = PitchRotation * glm::vec4{ ViewUp, 0.0f };
-		Direction = YawRotation * PitchRotation * glm::vec4{ Direction, 0.0f };
-	}
-
-	glm::mat4 GetView() const {
-		return glm::lookAt(LocationVRP, LocationVRP + Direction, ViewUp);
-	}
-
-	glm::mat4 GetViewProjection() const {
-		//glm::mat4 View = glm::lookAt(LocationVRP, LocationVRP + Direction, ViewUp);
-		glm::mat4 Projection = glm::perspective(angulo_de_visao, razao_aspecto, near, far);
-		return Projection * GetView();
-	}
-
-	//Parametros de Interatividade
-	float Speed = 5.0f;
-	float Sensitivity = 0.1f;
-
-	//Definio da Matriz de View
-	glm::vec3 LocationVRP{ 0.0f, 0.0f, 10.0f };
-	glm::vec3 Direction{0.0f, 0.0f, -1.0f};
-	glm::vec3 ViewUp{ 0.0f, 1.0f, 0.0f };
-
-	//Definio da Matriz de projeo
-	float angulo_de_visao = glm::radians(45.0f);
-	float razao_aspecto = width / height;
-	float near = 0.01f;
-	float far = 1000.0f;
-};
-
-FlyCamera Camera;
-bool bEnableMouseMovement = false;
-glm::vec2 PreviousCursor{ 0.0, 0.0 };
-
-void MouseButtonCallback(GLFWwindow* Window, int Button, int Action, int Modifiers) {
-	//std::cout << "Button: " << Button << " Action: " << Action << " Modifiers: " << Modifiers << std::endl;
-	if (Button == GLFW_MOUSE_BUTTON_LEFT) {
-		if (Action == GLFW_PRESS) {
-			glfwSetInputMode(Window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-			double X, Y;
-			glfwGetCursorPos(Window, &X, &Y);
-
-			PreviousCursor = glm::vec2{ X,Y };
-			bEnableMouseMovement = true;
-		}
-
-		else if (Action == GLFW_RELEASE) {
-			glfwSetInputMode(Window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
-
-			bEnableMouseMovement = false;
-		}
-	}
-}
- 
-void MouseMotionCallBack(GLFWwindow* Window, double X, double Y) {
-	if (bEnableMouseMovement) {
-		glm::vec2 CurrentCursor{ X, Y };
-		glm::vec2 DeltaCursor =   CurrentCursor - PreviousCursor ;
-
-		//std::cout << glm::to_string(DeltaCursor) << std::endl;
-
-		Camera.Look(-DeltaCursor.x, -DeltaCursor.y);
-		PreviousCursor = CurrentCursor;
-	}		
-}
-
-void Resize(GLFWwindow* Window, int NewWidth, int NewHeight) {
-	width = NewWidth;
-	height = NewHeight;
-
-	Camera.razao_aspecto = static_cast<float>(width) / height;
-	glViewport(0, 0, width, height);
-}
-
-int main() {
-	//inicializao
-	if (!glfwInit()) {
-		std::cerr << "Failed to initialize GLFW" << std::endl;
-		return -1;
-	}
-
-	//criar a janela
-	GLFWwindow* Window = glfwCreateWindow(width, height, "Blue Marble", nullptr, nullptr);
-	if (!Window){
-		std::cout << "Erro ao criar janela" << std::endl;
-		glfwTerminate();
-		return 1;
-	}
-
-	//Cadastra as callbacks no GLFW
-	glfwSetMouseButtonCallback(Window, MouseButtonCallback);
-	glfwSetCursorPosCallback(Window, MouseMotionCallBack);
-	glfwSetFramebufferSizeCallback(Window, Resize);
-
-	//ativa o contexto criado na janela window
-	glfwMakeContextCurrent(Window);
-
-	//habilita e desabilita o v-sync
-	glfwSwapInterval(1);
-
-	if (glewInit() != GLEW_OK) {
-		std::cerr << "Failed to initialize GLEW" << std::endl;
-		return -1;
-	}
-
-	//Obtem informaes do driver
-	std::cout << "OpenGL Version: " << glGetString(GL_VERSION) << std::endl;
-
-	Resize(Window, width, height);
-
-	// Compilar o vertex e o fragment shader
-	GLuint ProgramID = LoadShaders("shaders/triangle_vert.glsl", "shaders/triangle_frag.glsl");
-
-	GLuint TextureID = LoadTexture("textures/earth_2k.jpg");
-	GLuint CloudTextureID = LoadTexture("textures/earth_clouds_2k.jpg");
-
-	GLuint QuadVAO = LoadGeometry();
-
-	GLuint SphereNumVertices = 0;
-	GLuint SphereNumIndices = 0;
-	GLuint SphereVAO = LoadSphere(SphereNumVertices, SphereNumIndices);
-
-	std::cout << "Numero de vertices da esfera: " << SphereNumVertices << std::endl;
-	std::cout << "Numero de indices da esfera: " << SphereNumIndices << std::endl;
-
-	//Model Matrix
-	glm::mat4 I = glm::identity<glm::mat4>();
-	glm::mat4 ModelMatrix = glm::rotate(I, glm::radians(90.0f), glm::vec3{ 1,0,0 });
-
-	//definio da cor de fundo em RGBA
-	glClearColor(0.0f, 0.0f, 0.0f, 1.0);
-
-	//salva o tempo do frame anterior
-	double PreviousTime = glfwGetTime();
-
-	//habilita o backface culling
-	glEnable(GL_CULL_FACE);
-	glCullFace(GL_BACK);
-
-	//habilita o teste de porfundidade (Z-Buffer)
-	glEnable(GL_DEPTH_TEST);
-	glDepthFunc(GL_LESS);
-
-	//criao da fonte de luz direcional
-	DirectionalLight Light;
-	Light.Direction = glm::vec3{ 0.0f, 0.0f, -1.0f };
-	Light.Intensity = 1.0f;
-
-	while(!glfwWindowShouldClose(Window)){
-		
-		double CurrentTime = glfwGetTime();
-		double DeltaTime = CurrentTime - PreviousTime;
-		if (DeltaTime > 0.0) {
-			PreviousTime = CurrentTime;
-		}
-		
-		//limpa o buffer de cor e preenche com a for configurada
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-		// Ativar o programa de shader
-		glUseProgram(ProgramID);
-
-		glm::mat4 NormalMatrix = glm::inverse(glm::transpose(Camera.GetView() * ModelMatrix));
-		glm::mat4 ViewProjectionMatrix = Camera.GetViewProjection();
-		glm::mat4 ModelViewProjection = ViewProjectionMatrix * ModelMatrix; 
-
-		GLint TimeLoc = glGetUniformLocation(ProgramID, "Time");
-		glUniform1f(TimeLoc, CurrentTime);
-
-		GLint ModelViewProjectionLoc = glGetUniformLocation(ProgramID, "ModelViewProjection");
-		glUniformMatrix4fv(ModelViewProjectionLoc, 1, GL_FALSE, glm::value_ptr(ModelViewProjection));
-
-		GLint NormalMatrixLoc = glGetUniformLocation(ProgramID, "NormalMatrix");
-		glUniformMatrix4fv(NormalMatrixLoc, 1, GL_FALSE, glm::value_ptr(NormalMatrix));
-
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, TextureID);
-
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, CloudTextureID);
-
-		GLint TextureSamplerLoc = glGetUniformLocation(ProgramID, "TextureSampler");
-		glUniform1i(TextureSamplerLoc, 0);
-
-		GLint CloudTextureLoc = glGetUniformLocation(ProgramID, "CloudsTexture");
-		glUniform1i(CloudTextureLoc, 1);
-		
-		GLint LightDirectionLoc = glGetUniformLocation(ProgramID, "LightDirection");
-		glUniform3fv(LightDirectionLoc, 1, glm::value_ptr(Camera.GetView()* glm::vec4{ Light.Direction, 0.0f }));
-
-		GLint LightIntensityLoc = glGetUniformLocation(ProgramID, "LihgtIntensity");
-		glUniform1f(LightIntensityLoc, Light.Intensity);
-
-		glBindVertexArray(SphereVAO);
-
-		//desenha o objeto com os dados armazenados no vertexbuffer
-		glPointSize(10.0f);
-		glLineWidth(10.0f);
-		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-		glDrawElements(GL_TRIANGLES, SphereNumIndices, GL_UNSIGNED_INT, nullptr);
-
-		glBindVertexArray(0);
-
-		//Desabilita o programa ativo
-		glUseProgram(0);
-
-		//Processamento de todos os eventos da fila
-		glfwPollEvents();
-
-		//Envia o contedo para ser desenhado
-		glfwSwapBuffers(Window);
-
-		//Processamento dos inputs do teclado
-		if (glfwGetKey(Window, GLFW_KEY_W) == GLFW_PRESS) {
-			Camera.MoveForward(1.0f * DeltaTime);
-		}
-
-		if (glfwGetKey(Window, GLFW_KEY_S) == GLFW_PRESS) {
-			Camera.MoveForward(-1.0f * DeltaTime);
-		}
-
-		if (glfwGetKey(Window, GLFW_KEY_A) == GLFW_PRESS) {
-			Camera.MoveRight(-1.0f * DeltaTime);
-		}
-
-		if (glfwGetKey(Window, GLFW_KEY_D) == GLFW_PRESS) {
-			Camera.MoveRight(1.0f * DeltaTime);
-		}
-	}
-
-	//desaloca o buffer
-	glDeleteVertexArrays(1, &QuadVAO);
-
-	//encerra o glfw
-	glfwTerminate();
-
-	return 0;
+#include<iostream>
+#include<cassert>
+#include<algorithm>
+#include<array>
+#include<chrono>
+#include<cstdio>
+#include<cstring>
+#include<limits>
+#include<vector>
+
+#include<GL/glew.h>
+#include<GLFW/glfw3.h>
+#include<glm/glm.hpp>
+#include<glm/ext.hpp>
+#include<glm/gtx/string_cast.hpp>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include "CubeMapTexture.h"
+#include "FrameUniforms.h"
+#include "GLState.h"
+#include "Hash.h"
+#include "HeadlessContext.h"
+#include "MeshCache.h"
+#include "MeshOptimize.h"
+#include "Meshlet.h"
+#include "Mipmap.h"
+#include "PlanetTerrain.h"
+#include "Profiler.h"
+#include "RenderQueue.h"
+#include "Reprojection.h"
+#include "ShaderLibrary.h"
+#include "SphereMesh.h"
+#include "TextureCompression.h"
+#include "TextureLayers.h"
+#include "TextureLoader.h"
+#include "VertexLayout.h"
+#include "VertexPacking.h"
+#include "VirtualTexture.h"
+
+int width = 800;
+int height = 600;
+
+struct DirectionalLight {
+	glm::vec3 Direction;
+	GLfloat Intensity;
+};
+
+GLuint LoadGeometry() {
+	//quadrado em coordenadas normalizadas
+	std::array<Vertex, 6 > quad = {
+		Vertex{glm::vec3{-1.0f, -1.0f, 0.0f}, glm::vec3{0.0f, 0.0f, 1.0f}, glm::vec3{1.0f,0.0f,0.0f}, glm::vec2{0.0f, 0.0f}}, //vértice canto inferior esquerdo
+		Vertex{glm::vec3{1.0f, -1.0f, 0.0f}, glm::vec3{0.0f,0.0f,1.0f}, glm::vec3{0.0f,1.0f,0.0f}, glm::vec2{1.0f, 0.0f}}, //vértice canto inferior direito
+		Vertex{glm::vec3{1.0f, 1.0f, 0.0f},glm::vec3{0.0f, 0.0f, 1.0f}, glm::vec3{1.0f,0.0f,0.0f}, glm::vec2{1.0f, 1.0f}},
+		Vertex{glm::vec3{-1.0f, 1.0f, 0.0f},glm::vec3{0.0f, 0.0f, 1.0f}, glm::vec3{0.0f,0.0f,1.0f}, glm::vec2{0.0f, 1.0f}}
+	};
+
+	//Define a lista de elementos que formam os triângulos
+	std::array<glm::ivec3, 2> Indices = {
+		glm::ivec3{0, 1, 3},
+		glm::ivec3{3, 1, 2}
+	};
+
+	//copia os dados para a GPU
+	GLuint VertexBuffer;
+
+	//gera o identifcador do vertexbuffer - VBO
+	glGenBuffers(1, &VertexBuffer);
+
+	//pede para o opengl gerar o identificador do EBO
+	GLuint ElementBuffer = 0;
+	glGenBuffers(1, &ElementBuffer);
+
+	//ativa o vertex como sendo o buffer para onde os dados vão ser copiados
+	GetGLState().BindBuffer(GL_ARRAY_BUFFER, VertexBuffer);
+
+	//copias os dados para a memória de vídeo
+	glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad.data(), GL_STATIC_DRAW);
+
+	//copia os dados do Element Buffer para a GPU
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ElementBuffer);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(Indices), Indices.data(), GL_STATIC_DRAW);
+
+	//Gera o vertex array object - VAO
+	GLuint VAO;
+	glGenVertexArrays(1, &VAO);
+
+	//habilita o VAO
+	GetGLState().BindVertexArray(VAO);
+
+	//Atributo para cor nos vértices
+	glEnableVertexAttribArray(0);
+	glEnableVertexAttribArray(1);
+	glEnableVertexAttribArray(2);
+	glEnableVertexAttribArray(3);
+
+	//aponta para o OpenGl quaul vai ser o buffer ativo no momento
+	GetGLState().BindBuffer(GL_ARRAY_BUFFER, VertexBuffer);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ElementBuffer);
+
+	//informa onde dentro do buffer estão os vértices
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), nullptr);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_TRUE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, Normal)));
+	glVertexAttribPointer(2, 3, GL_FLOAT, GL_TRUE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, Color)));
+	glVertexAttribPointer(3, 2, GL_FLOAT, GL_TRUE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, UV)));
+
+	GetGLState().BindVertexArray(0);
+	return VAO;
+}
+
+//cria VBO, EBO e VAO a partir de blocos de vértices e índices já prontos na memória (ou num arquivo mapeado)
+GLuint CreateMeshVAO(const void* Vertices, size_t VertexBytes, const void* Indices, size_t IndexBytes, const VertexLayout& Layout) {
+	//o EBO é estado do VAO e o frame deixa o último VAO desenhado ligado: sem isto o EBO novo iria parar nele
+	GetGLState().BindVertexArray(0);
+
+	GLuint VertexBuffer;
+	glGenBuffers(1, &VertexBuffer);
+
+	//ativa o vertex como sendo o buffer para onde os dados vão ser copiados
+	GetGLState().BindBuffer(GL_ARRAY_BUFFER, VertexBuffer);
+
+	//copias os dados para a memória de vídeo
+	glBufferData(GL_ARRAY_BUFFER, VertexBytes, Vertices, GL_STATIC_DRAW);
+
+	GLuint ElementBuffer;
+	glGenBuffers(1, &ElementBuffer);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ElementBuffer);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, IndexBytes, Indices, GL_STATIC_DRAW);
+
+	GLuint VAO;
+	glGenVertexArrays(1, &VAO);
+	GetGLState().BindVertexArray(VAO);
+
+	//aponta para o OpenGl quaul vai ser o buffer ativo no momento
+	GetGLState().BindBuffer(GL_ARRAY_BUFFER, VertexBuffer);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ElementBuffer);
+
+	//informa onde dentro do buffer estão os vértices
+	ApplyVertexLayout(Layout);
+
+	GetGLState().BindVertexArray(0);
+	return VAO;
+}
+
+void ComputeBounds(const Vertex* Vertices, size_t NumVertices, float* OutMin, float* OutMax) {
+	glm::vec3 Min{ std::numeric_limits<float>::max() };
+	glm::vec3 Max{ -std::numeric_limits<float>::max() };
+	for (size_t Index = 0; Index < NumVertices; ++Index) {
+		Min = glm::min(Min, Vertices[Index].Position);
+		Max = glm::max(Max, Vertices[Index].Position);
+	}
+
+	for (int Axis = 0; Axis < 3; ++Axis) {
+		OutMin[Axis] = Min[Axis];
+		OutMax[Axis] = Max[Axis];
+	}
+}
+
+//malha enviada para a GPU e como desenhá-la
+struct MeshBuffers {
+	GLuint VAO = 0;
+	GLuint NumVertices = 0;
+	GLuint NumIndices = 0;
+	GLenum IndexType = GL_UNSIGNED_INT;
+	size_t VertexBytes = 0;
+	size_t IndexBytes = 0;
+	std::vector<Meshlet> Meshlets; //vazio quando a malha foi escrita direto na GPU
+};
+
+//escreve a malha gerada em memória já alocada (arquivo mapeado ou buffer da GPU), compactando se pedido
+void WriteMeshData(const std::vector<Vertex>& Vertices, const std::vector<glm::ivec3>& Triangles, bool bPacked, uint32_t IndexType, void* OutVertices, void* OutIndices) {
+	if (bPacked) {
+		PackVertices(Vertices.data(), Vertices.size(), static_cast<PackedVertex*>(OutVertices));
+		PackIndices(reinterpret_cast<const uint32_t*>(Triangles.data()), Triangles.size() * 3, IndexType, OutIndices);
+	}
+	else {
+		std::memcpy(OutVertices, Vertices.data(), Vertices.size() * sizeof(Vertex));
+		std::memcpy(OutIndices, Triangles.data(), Triangles.size() * sizeof(glm::ivec3));
+	}
+}
+
+//gera a malha em memória e, se pedido, reordena triângulos e vértices para o cache de vértices da GPU
+void GenerateSphereForUpload(SphereTessellation Tessellation, GLuint Detail, bool bOptimize, std::vector<Vertex>& Vertices, std::vector<glm::ivec3>& Triangles) {
+	GenerateSphereMesh(Tessellation, Detail, Vertices, Triangles);
+	if (!bOptimize) {
+		return;
+	}
+
+	uint32_t* Indices = reinterpret_cast<uint32_t*>(Triangles.data());
+	const size_t NumIndices = Triangles.size() * 3;
+
+	const VertexCacheStats Before = AnalyzeVertexCache(Indices, NumIndices, Vertices.size());
+	OptimizeVertexCache(Indices, NumIndices, Vertices.size());
+	OptimizeVertexFetch(Vertices.data(), Vertices.size(), sizeof(Vertex), Indices, NumIndices);
+	const VertexCacheStats After = AnalyzeVertexCache(Indices, NumIndices, Vertices.size());
+
+	std::cout << "Cache de vertices: ACMR " << Before.ACMR << " -> " << After.ACMR << ", ATVR " << Before.ATVR << " -> " << After.ATVR << std::endl;
+}
+
+//gera a esfera direto no arquivo de cache mapeado e grava em disco
+bool BuildSphereMeshFile(SphereTessellation Tessellation, GLuint Detail, bool bPacked, bool bOptimize, const std::string& Path, uint64_t Key) {
+	MappedFile File;
+	MeshFileView View;
+
+	//só a esfera UV sem compactação nem reordenação pode ser escrita direto no destino
+	if (Tessellation == SphereTessellation::UV && !bPacked && !bOptimize) {
+		const SphereMeshSize Size = GetSphereMeshSize(Detail);
+		if (!CreateMeshFile(Path, Key, GetStandardVertexLayout(), GL_UNSIGNED_INT, Size.NumVertices, Size.NumTriangles * 3, File, View)) {
+			return false;
+		}
+
+		WriteSphereMesh(Detail, reinterpret_cast<Vertex*>(View.Vertices), Size.NumVertices, reinterpret_cast<glm::ivec3*>(View.Indices), Size.NumTriangles);
+		ComputeBounds(reinterpret_cast<const Vertex*>(View.Vertices), Size.NumVertices, View.Header->BoundsMin, View.Header->BoundsMax);
+	}
+	else {
+		std::vector<Vertex> Vertices;
+		std::vector<glm::ivec3> Triangles;
+		GenerateSphereForUpload(Tessellation, Detail, bOptimize, Vertices, Triangles);
+
+		const VertexLayout Layout = bPacked ? GetPackedVertexLayout() : GetStandardVertexLayout();
+		const uint32_t IndexType = bPacked ? SelectIndexType(Vertices.size()) : GL_UNSIGNED_INT;
+		if (!CreateMeshFile(Path, Key, Layout, IndexType, Vertices.size(), Triangles.size() * 3, File, View)) {
+			return false;
+		}
+
+		WriteMeshData(Vertices, Triangles, bPacked, IndexType, View.Vertices, View.Indices);
+		ComputeBounds(Vertices.data(), Vertices.size(), View.Header->BoundsMin, View.Header->BoundsMax);
+	}
+
+	return CommitMeshFile(Path, File);
+}
+
+MeshBuffers LoadSphere(SphereTessellation Tessellation, GLuint Detail, bool bUseCache, bool bPacked, bool bOptimize) {
+	const auto StartTime = std::chrono::steady_clock::now();
+	auto ElapsedMilliseconds = [&StartTime] {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - StartTime).count();
+	};
+
+	MeshBuffers Mesh;
+
+	if (bUseCache) {
+		const uint32_t Format = (bPacked ? 1u : 0u) | (bOptimize ? 2u : 0u);
+		const uint64_t Key = HashValue(Format, GetSphereMeshKey(Tessellation, Detail));
+		const std::string Path = GetMeshCachePath(std::string{ "sphere_" } + ToString(Tessellation) + (bPacked ? "_packed" : ""), Key);
+
+		MappedFile File;
+		MeshFileView View;
+		const bool bCacheHit = OpenMeshFile(Path, Key, File, View);
+		if (!bCacheHit && BuildSphereMeshFile(Tessellation, Detail, bPacked, bOptimize, Path, Key)) {
+			OpenMeshFile(Path, Key, File, View);
+		}
+
+		if (File.IsOpen()) {
+			const MeshFileHeader& Header = *View.Header;
+			Mesh.NumVertices = static_cast<GLuint>(Header.NumVertices);
+			Mesh.NumIndices = static_cast<GLuint>(Header.NumIndices);
+			Mesh.IndexType = Header.IndexType;
+			Mesh.VertexBytes = Header.VertexBytes;
+			Mesh.IndexBytes = Header.IndexBytes;
+
+			//o glBufferData lê direto das páginas mapeadas do arquivo
+			Mesh.VAO = CreateMeshVAO(View.Vertices, Header.VertexBytes, View.Indices, Header.IndexBytes, Header.Layout);
+			Mesh.Meshlets = BuildMeshlets(Header.Layout, View.Vertices, Header.NumVertices, Header.IndexType, View.Indices, Header.NumIndices);
+
+			std::cout << (bCacheHit ? "Esfera carregada do cache " : "Esfera gerada e salva no cache ") << Path
+				<< " em " << ElapsedMilliseconds() << " ms" << std::endl;
+			return Mesh;
+		}
+
+		std::cerr << "Nao foi possivel usar o cache de malha " << Path << ", gerando em memoria" << std::endl;
+	}
+
+	if (Tessellation == SphereTessellation::UV && !bPacked && !bOptimize) {
+		const SphereMeshSize Size = GetSphereMeshSize(Detail);
+
+		Mesh.NumVertices = static_cast<GLuint>(Size.NumVertices);
+		Mesh.NumIndices = static_cast<GLuint>(Size.NumTriangles * 3);
+		Mesh.VertexBytes = Size.NumVertices * sizeof(Vertex);
+		Mesh.IndexBytes = Mesh.NumIndices * sizeof(GLuint);
+
+		//aloca a memória de vídeo e gera os vértices direto no buffer mapeado, sem cópia intermediária
+		Mesh.VAO = CreateMeshVAO(nullptr, Mesh.VertexBytes, nullptr, Mesh.IndexBytes, GetStandardVertexLayout());
+
+		//o VAO guarda o EBO, e o VBO ficou ativo no GL_ARRAY_BUFFER
+		GetGLState().BindVertexArray(Mesh.VAO);
+		Vertex* MappedVertices = static_cast<Vertex*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, Mesh.VertexBytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+		glm::ivec3* MappedTriangles = static_cast<glm::ivec3*>(glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0, Mesh.IndexBytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+		assert(MappedVertices && MappedTriangles);
+
+		WriteSphereMesh(Detail, MappedVertices, Size.NumVertices, MappedTriangles, Size.NumTriangles);
+
+		glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+		GetGLState().BindVertexArray(0);
+	}
+	else {
+		//icosfera e esfera cubo precisam soldar vértices, a compactação e a reordenação precisam da malha pronta,
+		//então esses casos são gerados em memória antes de escrever no buffer mapeado
+		std::vector<Vertex> Vertices;
+		std::vector<glm::ivec3> Triangles;
+		GenerateSphereForUpload(Tessellation, Detail, bOptimize, Vertices, Triangles);
+
+		const VertexLayout Layout = bPacked ? GetPackedVertexLayout() : GetStandardVertexLayout();
+		Mesh.NumVertices = static_cast<GLuint>(Vertices.size());
+		Mesh.NumIndices = static_cast<GLuint>(Triangles.size() * 3);
+		Mesh.IndexType = bPacked ? SelectIndexType(Vertices.size()) : GL_UNSIGNED_INT;
+		Mesh.VertexBytes = Vertices.size() * Layout.Stride;
+		Mesh.IndexBytes = Mesh.NumIndices * GetIndexSize(Mesh.IndexType);
+
+		Mesh.VAO = CreateMeshVAO(nullptr, Mesh.VertexBytes, nullptr, Mesh.IndexBytes, Layout);
+
+		GetGLState().BindVertexArray(Mesh.VAO);
+		void* MappedVertices = glMapBufferRange(GL_ARRAY_BUFFER, 0, Mesh.VertexBytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+		void* MappedIndices = glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0, Mesh.IndexBytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+		assert(MappedVertices && MappedIndices);
+
+		WriteMeshData(Vertices, Triangles, bPacked, Mesh.IndexType, MappedVertices, MappedIndices);
+
+		glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+		GetGLState().BindVertexArray(0);
+
+		Mesh.Meshlets = BuildMeshlets(GetStandardVertexLayout(), Vertices.data(), Vertices.size(), GL_UNSIGNED_INT, Triangles.data(), Mesh.NumIndices);
+	}
+
+	std::cout << "Esfera gerada sem cache em " << ElapsedMilliseconds() << " ms" << std::endl;
+	return Mesh;
+}
+
+class FlyCamera {
+public:
+	void MoveForward(float Amount) {
+		LocationVRP += glm::normalize(Direction) * Amount * Speed;
+	}
+
+	void MoveRight(float Amount) {
+		glm::vec3 Right = glm::normalize(glm::cross(Direction, ViewUp));
+		LocationVRP += Right * Amount * Speed;
+	}
+
+	void Look(float Yaw, float Pitch) {
+		Yaw *= Sensitivity;
+		Pitch *= Sensitivity;
+
+		const glm::vec3 Right = glm::normalize(glm::cross(Direction, ViewUp));
+
+		const glm::mat4 I = glm::identity < glm::mat4>();
+		glm::mat4 YawRotation = glm::rotate(I, glm::radians(Yaw), ViewUp);
+		glm::mat4 PitchRotation = glm::rotate(I, glm::radians(Pitch), Right);
+
+		ViewUp = PitchRotation * glm::vec4{ ViewUp, 0.0f };
+		Direction = YawRotation * PitchRotation * glm::vec4{ Direction, 0.0f };
+	}
+
+	glm::mat4 GetView() const {
+		return glm::lookAt(LocationVRP, LocationVRP + Direction, ViewUp);
+	}
+
+	glm::mat4 GetViewProjection() const {
+		//glm::mat4 View = glm::lookAt(LocationVRP, LocationVRP + Direction, ViewUp);
+		glm::mat4 Projection = glm::perspective(angulo_de_visao, razao_aspecto, near, far);
+		return Projection * GetView();
+	}
+
+	//Parametros de Interatividade
+	float Speed = 5.0f;
+	float Sensitivity = 0.1f;
+
+	//Definição da Matriz de View
+	glm::vec3 LocationVRP{ 0.0f, 0.0f, 10.0f };
+	glm::vec3 Direction{0.0f, 0.0f, -1.0f};
+	glm::vec3 ViewUp{ 0.0f, 1.0f, 0.0f };
+
+	//Definição da Matriz de projeção
+	float angulo_de_visao = glm::radians(45.0f);
+	float razao_aspecto = width / height;
+	float near = 0.01f;
+	float far = 1000.0f;
+};
+
+FlyCamera Camera;
+bool bEnableMouseMovement = false;
+glm::vec2 PreviousCursor{ 0.0, 0.0 };
+
+void MouseButtonCallback(GLFWwindow* Window, int Button, int Action, int Modifiers) {
+	//std::cout << "Button: " << Button << " Action: " << Action << " Modifiers: " << Modifiers << std::endl;
+	if (Button == GLFW_MOUSE_BUTTON_LEFT) {
+		if (Action == GLFW_PRESS) {
+			glfwSetInputMode(Window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+			double X, Y;
+			glfwGetCursorPos(Window, &X, &Y);
+
+			PreviousCursor = glm::vec2{ X,Y };
+			bEnableMouseMovement = true;
+		}
+
+		else if (Action == GLFW_RELEASE) {
+			glfwSetInputMode(Window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
+
+			bEnableMouseMovement = false;
+		}
+	}
+}
+ 
+void MouseMotionCallBack(GLFWwindow* Window, double X, double Y) {
+	if (bEnableMouseMovement) {
+		glm::vec2 CurrentCursor{ X, Y };
+		glm::vec2 DeltaCursor =   CurrentCursor - PreviousCursor ;
+
+		//std::cout << glm::to_string(DeltaCursor) << std::endl;
+
+		Camera.Look(-DeltaCursor.x, -DeltaCursor.y);
+		PreviousCursor = CurrentCursor;
+	}		
+}
+
+//maior resolução da esfera procedural pelas teclas, 2^14 segmentos por lado
+constexpr GLint MaxProceduralResolution = 16385;
+
+//opções de linha de comando, no formato --nome=valor
+struct AppOptions {
+	bool bTerrain = true; //terreno CDLOD, --sphere troca pela malha fixa
+	SphereTessellation Tessellation = SphereTessellation::UV;
+	GLuint SphereDetail = 0; //0 usa o padrão do modo
+	bool bMeshCache = true;
+	bool bPackedVertices = false; //--packed-vertices usa o PackedVertex de 16 bytes e índices de 16 bits quando cabem
+	bool bOptimizeMesh = true; //reordena a malha para o cache de vértices, --no-mesh-optimize mantém a ordem do gerador
+	bool bMeshletCulling = true; //descarta meshlets fora do frustum ou de costas na CPU, --no-meshlets desenha a malha inteira
+	bool bProcedural = false; //--procedural gera a esfera UV no vertex shader, sem vertex buffer
+	bool bVSync = true; //--no-vsync para comparar tempo de frame
+	bool bAsyncTextures = true; //--sync-textures carrega as texturas antes do primeiro frame, como antes
+	TextureFormat ColorTextureFormat = TextureFormat::BC1; //--texture-format=rgb|bc1|bc7, as nuvens usam BC4 se não for rgb e R8 se for
+	MipmapSettings Mips; //--mip-filter=box|kaiser|lanczos
+	size_t TextureBudgetMiB = 0; //--texture-budget=MiB, teto das texturas na GPU; 0 é sem limite
+	TerrainSettings Terrain;
+	bool bVirtualTexture = false; //--virtual-texture[=arquivo.bmvt], sem arquivo gera um a partir da textura 2k
+	std::string VirtualTexturePath;
+	bool bProgramCache = true; //--no-program-cache compila os shaders a cada execução
+	bool bShaderReload = true; //--no-shader-reload desliga a recompilação dos shaders gravados na pasta shaders
+	bool bCubeMap = false; //--cubemap[=bilinear|bicubic], Terra num cubemap reprojetado da textura 2k, só no modo terreno
+	ResampleFilter CubeMapFilter = ResampleFilter::Bicubic;
+	bool bClouds = true; //--no-clouds compila os shaders sem a amostra das nuvens e não carrega a textura delas
+	bool bSpecular = true; //--no-specular compila os shaders sem o termo especular
+	std::string ProfilePath; //--profile[=caminho], grava caminho.json (trace do Chrome) e caminho.csv ao fechar; precisa do BLUEMARBLE_PROFILER
+	bool bHeadless = false; //--headless[=frames], sem janela (EGL surfaceless), desenha os frames e fecha; precisa do BLUEMARBLE_HEADLESS
+	int HeadlessFrames = 100;
+	int Width = 800; //--size=LxA, tamanho da janela ou do framebuffer headless
+	int Height = 600;
+	std::string DumpPrefix; //--dump=prefixo, no modo headless grava prefixo_NNNN.ppm
+	int DumpInterval = 0; //--dump-interval=N grava um frame a cada N; 0 grava só o último
+	bool bSortDraws = true; //--no-draw-sort envia a fila de desenho na ordem pedida, para comparar as trocas de estado
+};
+
+AppOptions ParseOptions(int argc, char* argv[]) {
+	AppOptions Options;
+
+	for (int Index = 1; Index < argc; ++Index) {
+		const std::string Argument = argv[Index];
+		const size_t Equal = Argument.find('=');
+		const std::string Name = Argument.substr(0, Equal);
+		const std::string Value = Equal != std::string::npos ? Argument.substr(Equal + 1) : std::string{};
+
+		if (Name == "--sphere") {
+			Options.bTerrain = false;
+			if (!Value.empty() && !ParseSphereTessellation(Value, Options.Tessellation)) {
+				std::cerr << "Modo de esfera desconhecido: " << Value << " (use uv, ico ou cube)" << std::endl;
+			}
+		}
+		else if (Name == "--no-mesh-cache") {
+			Options.bMeshCache = false;
+		}
+		else if (Name == "--packed-vertices") {
+			Options.bPackedVertices = true;
+		}
+		else if (Name == "--no-mesh-optimize") {
+			Options.bOptimizeMesh = false;
+		}
+		else if (Name == "--no-meshlets") {
+			Options.bMeshletCulling = false;
+		}
+		else if (Name == "--procedural") {
+			Options.bTerrain = false;
+			Options.bProcedural = true;
+			Options.Tessellation = SphereTessellation::UV;
+		}
+		else if (Name == "--no-vsync") {
+			Options.bVSync = false;
+		}
+		else if (Name == "--sync-textures") {
+			Options.bAsyncTextures = false;
+		}
+		else if (Name == "--texture-format") {
+			if (!ParseTextureFormat(Value.c_str(), Options.ColorTextureFormat) || Options.ColorTextureFormat == TextureFormat::BC4 || Options.ColorTextureFormat == TextureFormat::R8) {
+				std::cerr << "Formato de textura desconhecido: " << Value << " (use rgb, bc1 ou bc7)" << std::endl;
+				Options.ColorTextureFormat = TextureFormat::BC1;
+			}
+		}
+		else if (Name == "--mip-filter") {
+			if (!ParseMipFilter(Value.c_str(), Options.Mips.Filter)) {
+				std::cerr << "Filtro de mipmap desconhecido: " << Value << " (use box, kaiser ou lanczos)" << std::endl;
+			}
+		}
+		else if (Name == "--texture-budget") {
+			size_t BudgetMiB = 0;
+			if (std::sscanf(Value.c_str(), "%zu", &BudgetMiB) == 1) {
+				Options.TextureBudgetMiB = BudgetMiB;
+			}
+			else {
+				std::cerr << "Orcamento de texturas invalido: " << Value << " (use MiB, por exemplo 512, ou 0 sem limite)" << std::endl;
+			}
+		}
+		else if (Name == "--virtual-texture") {
+			Options.bVirtualTexture = true;
+			Options.VirtualTexturePath = Value;
+		}
+		else if (Name == "--no-program-cache") {
+			Options.bProgramCache = false;
+		}
+		else if (Name == "--no-shader-reload") {
+			Options.bShaderReload = false;
+		}
+		else if (Name == "--profile") {
+			Options.ProfilePath = Value.empty() ? "profile" : Value;
+		}
+		else if (Name == "--headless") {
+			Options.bHeadless = true;
+			if (!Value.empty()) {
+				int Frames = 0;
+				if (std::sscanf(Value.c_str(), "%d", &Frames) == 1 && Frames > 0) {
+					Options.HeadlessFrames = Frames;
+				}
+				else {
+					std::cerr << "Numero de frames invalido: " << Value << " (use um inteiro positivo, por exemplo --headless=100)" << std::endl;
+				}
+			}
+		}
+		else if (Name == "--size") {
+			int NewWidth = 0;
+			int NewHeight = 0;
+			if (std::sscanf(Value.c_str(), "%dx%d", &NewWidth, &NewHeight) == 2 && NewWidth > 0 && NewHeight > 0) {
+				Options.Width = NewWidth;
+				Options.Height = NewHeight;
+			}
+			else {
+				std::cerr << "Tamanho invalido: " << Value << " (use LxA, por exemplo 1920x1080)" << std::endl;
+			}
+		}
+		else if (Name == "--dump") {
+			Options.DumpPrefix = Value.empty() ? "frame" : Value;
+		}
+		else if (Name == "--dump-interval") {
+			int Interval = 0;
+			if (std::sscanf(Value.c_str(), "%d", &Interval) == 1 && Interval >= 0) {
+				Options.DumpInterval = Interval;
+			}
+			else {
+				std::cerr << "Intervalo invalido: " << Value << " (use N >= 0; 0 grava so o ultimo frame)" << std::endl;
+			}
+		}
+		else if (Name == "--no-draw-sort") {
+			Options.bSortDraws = false;
+		}
+		else if (Name == "--no-clouds") {
+			Options.bClouds = false;
+		}
+		else if (Name == "--no-specular") {
+			Options.bSpecular = false;
+		}
+		else if (Name == "--cubemap") {
+			Options.bCubeMap = true;
+			if (!Value.empty() && !ParseResampleFilter(Value.c_str(), Options.CubeMapFilter)) {
+				std::cerr << "Filtro de reprojecao desconhecido: " << Value << " (use bilinear ou bicubic)" << std::endl;
+			}
+		}
+		else if (Name == "--terrain-budget") {
+			long long Budget = 0;
+			if (std::sscanf(Value.c_str(), "%lld", &Budget) == 1 && Budget > 0) {
+				Options.Terrain.TriangleBudget = static_cast<size_t>(Budget);
+			}
+			else {
+				std::cerr << "Orcamento de triangulos invalido: " << Value << " (use um inteiro positivo, por exemplo 524288)" << std::endl;
+			}
+		}
+		else if (Name == "--terrain-error") {
+			float PixelError = 0.0f;
+			if (std::sscanf(Value.c_str(), "%f", &PixelError) == 1 && PixelError > 0.0f) {
+				Options.Terrain.TargetPixelError = PixelError;
+			}
+			else {
+				std::cerr << "Erro do terreno invalido: " << Value << " (use pixels maiores que 0, por exemplo 8)" << std::endl;
+			}
+		}
+		else if (Name == "--detail") {
+			int Detail = 0;
+			if (std::sscanf(Value.c_str(), "%d", &Detail) == 1 && Detail > 0) {
+				Options.SphereDetail = static_cast<GLuint>(Detail);
+			}
+			else {
+				std::cerr << "Detalhe da esfera invalido: " << Value << " (use um inteiro positivo)" << std::endl;
+			}
+		}
+		else {
+			std::cerr << "Opcao desconhecida: " << Argument << std::endl;
+		}
+	}
+
+	if (Options.SphereDetail == 0) {
+		Options.SphereDetail = GetDefaultSphereDetail(Options.Tessellation);
+	}
+
+	if (!Options.DumpPrefix.empty() && !Options.bHeadless) {
+		std::cerr << "--dump so grava no modo --headless" << std::endl;
+	}
+
+	return Options;
+}
+
+void Resize(GLFWwindow* Window, int NewWidth, int NewHeight) {
+	width = NewWidth;
+	height = NewHeight;
+
+	Camera.razao_aspecto = static_cast<float>(width) / height;
+	GetGLState().SetViewport(0, 0, width, height);
+}
+
+int main(int argc, char* argv[]) {
+	const auto StartupTime = std::chrono::steady_clock::now();
+	bool bFirstFrame = true;
+
+	const AppOptions Options = ParseOptions(argc, argv);
+
+	width = Options.Width;
+	height = Options.Height;
+
+	//sem janela no modo headless: Window fica nulo e o frame vai para o framebuffer do HeadlessContext
+	GLFWwindow* Window = nullptr;
+	HeadlessContext Headless;
+
+	if (Options.bHeadless) {
+		if (!Headless.CreateContext()) {
+			return 1;
+		}
+
+		//o glewInit procura o display do GLX (ou o DC do WGL), que não existe num contexto EGL;
+		//o glewContextInit só carrega as funções do contexto atual
+		glewExperimental = GL_TRUE;
+		if (glewContextInit() != GLEW_OK) {
+			std::cerr << "Failed to initialize GLEW" << std::endl;
+			return -1;
+		}
+
+		if (!Headless.CreateFramebuffer(width, height)) {
+			return 1;
+		}
+		Headless.Bind();
+	}
+	else {
+		//inicialização
+		if (!glfwInit()) {
+			std::cerr << "Failed to initialize GLFW" << std::endl;
+			return -1;
+		}
+
+		//criar a janela
+		Window = glfwCreateWindow(width, height, "Blue Marble", nullptr, nullptr);
+		if (!Window){
+			std::cout << "Erro ao criar janela" << std::endl;
+			glfwTerminate();
+			return 1;
+		}
+
+		//Cadastra as callbacks no GLFW
+		glfwSetMouseButtonCallback(Window, MouseButtonCallback);
+		glfwSetCursorPosCallback(Window, MouseMotionCallBack);
+		glfwSetFramebufferSizeCallback(Window, Resize);
+
+		//ativa o contexto criado na janela window
+		glfwMakeContextCurrent(Window);
+
+		//habilita e desabilita o v-sync
+		glfwSwapInterval(Options.bVSync ? 1 : 0);
+
+		if (glewInit() != GLEW_OK) {
+			std::cerr << "Failed to initialize GLEW" << std::endl;
+			return -1;
+		}
+	}
+
+	//Obtem informações do driver
+	std::cout << "OpenGL Version: " << glGetString(GL_VERSION) << std::endl;
+
+	Resize(Window, width, height);
+
+	// Compilar o vertex e o fragment shader
+	//os programas são pegos pelo handle a cada frame, porque mudam quando um arquivo da pasta shaders é gravado.
+	//o formato compactado precisa do shader que decodifica a normal
+	//as variantes só compilam no primeiro uso, então registrar a do triângulo nos outros modos não custa nada.
+	//feature flags dos fragment shaders da Terra: o que foi desligado sai do shader na compilação
+	ShaderLibrary Shaders(Options.bProgramCache);
+	ShaderDefines EarthDefines;
+	if (Options.bClouds) {
+		EarthDefines.push_back("CLOUDS");
+	}
+	if (Options.bSpecular) {
+		EarthDefines.push_back("SPECULAR");
+	}
+	Shaders.SetUniformBlock(FrameUniformsBlock, FrameUniformsBinding, sizeof(FrameUniforms), GetFrameUniformsMembers());
+	const ShaderHandle TriangleShader = Shaders.Load(Options.bPackedVertices ? "shaders/triangle_packed_vert.glsl" : "shaders/triangle_vert.glsl", "shaders/triangle_frag.glsl", EarthDefines);
+
+	//as texturas chegam durante os primeiros frames: cor de oceano e céu sem nuvens até lá.
+	//Terra e nuvens são camadas de arrays de textura, ligados um por formato
+	TextureLayers PlanetLayers;
+	PlanetLayers.SetBudget(Options.TextureBudgetMiB * 1024 * 1024);
+	AsyncTextureLoader TextureLoader(PlanetLayers);
+
+	//BC7 é do OpenGL 4.2 e BC1 de uma extensão, sem suporte cai para o formato anterior
+	TextureFormat ColorFormat = Options.ColorTextureFormat;
+	if (ColorFormat == TextureFormat::BC7 && !GLEW_ARB_texture_compression_bptc) {
+		std::cout << "BC7 nao suportado, usando BC1" << std::endl;
+		ColorFormat = TextureFormat::BC1;
+	}
+	if (ColorFormat == TextureFormat::BC1 && !GLEW_EXT_texture_compression_s3tc) {
+		std::cout << "BC1 nao suportado, usando RGB" << std::endl;
+		ColorFormat = TextureFormat::RGB8;
+	}
+
+	//as nuvens são uma máscara de um canal: R8 com a cor em RGB, BC4 com a cor comprimida
+	TextureLoader.Request("textures/earth_2k.jpg", "EarthLayer", 3, glm::vec3{ 0.05f, 0.15f, 0.35f }, ColorFormat, Options.Mips);
+	if (Options.bClouds) {
+		TextureLoader.Request("textures/earth_clouds_2k.jpg", "CloudsLayer", 1, glm::vec3{ 0.0f }, ColorFormat, Options.Mips);
+	}
+	if (!Options.bAsyncTextures) {
+		TextureLoader.Flush();
+	}
+
+	GLuint QuadVAO = LoadGeometry();
+
+	MeshBuffers Sphere;
+	MeshletDrawList SphereDrawList;
+
+	ShaderHandle TerrainShader = InvalidShader;
+	PlanetTerrain Terrain;
+
+	//textura virtual ou cubemap no lugar da textura da Terra, só no modo terreno
+	VirtualTexture EarthVirtualTexture;
+	CubeMapTexture EarthCubeMap;
+	ShaderHandle FeedbackShader = InvalidShader;
+
+	//modo procedural: VAO vazio, a resolução pode mudar a cada frame sem reenviar nada
+	ShaderHandle ProceduralShader = InvalidShader;
+	GLuint ProceduralVAO = 0;
+	GLint ProceduralResolution = static_cast<GLint>(Options.SphereDetail);
+
+	if (Options.bTerrain) {
+		if (Options.bVirtualTexture) {
+			const std::string VirtualTexturePath = Options.VirtualTexturePath.empty() ? FindOrBuildVirtualTexture("textures/earth_2k.jpg", ColorFormat, Options.Mips) : Options.VirtualTexturePath;
+			if (!VirtualTexturePath.empty() && EarthVirtualTexture.Open(VirtualTexturePath)) {
+				FeedbackShader = Shaders.Load("shaders/terrain_vert.glsl", "shaders/vt_feedback_frag.glsl");
+
+				//o cache da textura virtual tem tamanho fixo e sai do mesmo orçamento
+				PlanetLayers.SetBudget(Options.TextureBudgetMiB * 1024 * 1024, EarthVirtualTexture.GetGPUBytes());
+			}
+		}
+		else if (Options.bCubeMap && EarthCubeMap.Load("textures/earth_2k.jpg", ColorFormat, Options.Mips, Options.CubeMapFilter)) {
+			PlanetLayers.SetBudget(Options.TextureBudgetMiB * 1024 * 1024, EarthCubeMap.GetGPUBytes());
+		}
+
+		const char* TerrainFragmentShader = EarthVirtualTexture.IsOpen() ? "shaders/terrain_vt_frag.glsl" : (EarthCubeMap.IsLoaded() ? "shaders/terrain_cube_frag.glsl" : "shaders/terrain_frag.glsl");
+		TerrainShader = Shaders.Load("shaders/terrain_vert.glsl", TerrainFragmentShader, EarthDefines);
+		Terrain.Initialize(Options.Terrain);
+
+		std::cout << "Terreno CDLOD: orcamento de " << Options.Terrain.TriangleBudget << " triangulos, erro alvo de " << Options.Terrain.TargetPixelError << " pixels" << std::endl;
+	}
+	else if (Options.bProcedural) {
+		ProceduralShader = Shaders.Load("shaders/sphere_procedural_vert.glsl", "shaders/triangle_frag.glsl", EarthDefines);
+		glGenVertexArrays(1, &ProceduralVAO);
+
+		std::cout << "Esfera procedural: resolucao " << ProceduralResolution << ", 0 KiB de vertices e indices (+/- muda a resolucao)" << std::endl;
+	}
+	else {
+		Sphere = LoadSphere(Options.Tessellation, Options.SphereDetail, Options.bMeshCache, Options.bPackedVertices, Options.bOptimizeMesh);
+
+		std::cout << "Esfera: " << ToString(Options.Tessellation) << " detalhe " << Options.SphereDetail << std::endl;
+		std::cout << "Numero de vertices da esfera: " << Sphere.NumVertices << std::endl;
+		std::cout << "Numero de indices da esfera: " << Sphere.NumIndices << std::endl;
+		std::cout << "Meshlets da esfera: " << Sphere.Meshlets.size() << std::endl;
+		std::cout << "Memoria da esfera: " << Sphere.VertexBytes / 1024 << " KiB de vertices, " << Sphere.IndexBytes / 1024 << " KiB de indices"
+			<< (Options.bPackedVertices ? " (compactado)" : "") << std::endl;
+	}
+
+	if (Options.bShaderReload) {
+		Shaders.WatchDirectory("shaders");
+	}
+
+	//Model Matrix
+	glm::mat4 I = glm::identity<glm::mat4>();
+	glm::mat4 ModelMatrix = glm::rotate(I, glm::radians(90.0f), glm::vec3{ 1,0,0 });
+
+	//definição da cor de fundo em RGBA
+	glClearColor(0.0f, 0.0f, 0.0f, 1.0);
+
+	if (!Options.ProfilePath.empty() && !StartProfiler(Options.ProfilePath)) {
+		std::cout << "Profiler nao compilado, --profile precisa do BLUEMARBLE_PROFILER" << std::endl;
+	}
+
+	//sem janela o relógio é o número do frame a 60 Hz: a câmera, a textura virtual e as estatísticas
+	//andam igual em todas as execuções, independente de quanto o frame demorou
+	int FrameIndex = 0;
+	const auto GetFrameTime = [&]() { return Window ? glfwGetTime() : FrameIndex / 60.0; };
+	const auto HeadlessStartTime = std::chrono::steady_clock::now();
+
+	//salva o tempo do frame anterior
+	double PreviousTime = GetFrameTime();
+	double PreviousStatsTime = PreviousTime;
+	int FramesSinceStats = 0;
+
+	bool bIncreaseWasPressed = false;
+	bool bDecreaseWasPressed = false;
+
+	//velocidade e near plane padrão da câmera, ajustados pela altitude no modo terreno
+	const float BaseCameraSpeed = Camera.Speed;
+	const float BaseNearPlane = Camera.near;
+
+	//dados do frame de todos os shaders (FrameUniforms.h), ligado uma vez no ponto do bloco
+	GLuint FrameUniformBuffer = 0;
+	glGenBuffers(1, &FrameUniformBuffer);
+	GetGLState().BindBuffer(GL_UNIFORM_BUFFER, FrameUniformBuffer);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), nullptr, GL_STREAM_DRAW);
+	GetGLState().BindBufferBase(GL_UNIFORM_BUFFER, FrameUniformsBinding, FrameUniformBuffer);
+
+	//a textura virtual prevê para onde a câmera vai pela velocidade, no espaço do modelo
+	glm::vec3 PreviousModelCameraPosition = glm::inverse(ModelMatrix) * glm::vec4{ Camera.LocationVRP, 1.0f };
+
+	//habilita o backface culling
+	GetGLState().SetEnabled(GL_CULL_FACE, true);
+	GetGLState().SetCullFace(GL_BACK);
+
+	//habilita o teste de porfundidade (Z-Buffer)
+	GetGLState().SetEnabled(GL_DEPTH_TEST, true);
+	GetGLState().SetDepthFunc(GL_LESS);
+
+	//os draws do frame passam pela fila, ordenados por passada, programa, texturas e VAO.
+	//as texturas do planeta: arrays de camadas e, no terreno, a textura virtual ou o cubemap nas unidades seguintes
+	RenderQueue DrawQueue;
+	const uint32_t PlanetTextures = DrawQueue.AddTextureSet([&](GLuint Program) {
+		const GLint NextTextureUnit = PlanetLayers.Bind(Program, 0);
+		if (Options.bTerrain && EarthVirtualTexture.IsOpen()) {
+			EarthVirtualTexture.Bind(Program, NextTextureUnit, NextTextureUnit + 1);
+		}
+		else if (Options.bTerrain && EarthCubeMap.IsLoaded()) {
+			EarthCubeMap.Bind(Program, NextTextureUnit);
+		}
+	});
+
+	//o feedback só lê a textura virtual, nas mesmas unidades do terreno
+	const uint32_t FeedbackTextures = DrawQueue.AddTextureSet([&](GLuint Program) {
+		const GLint NextTextureUnit = static_cast<GLint>(PlanetLayers.GetNumArrays());
+		EarthVirtualTexture.Bind(Program, NextTextureUnit, NextTextureUnit + 1, true);
+	});
+	DrawQueue.SetPass(RenderPass::Feedback,
+		[&] { EarthVirtualTexture.BeginFeedback(width, height); },
+		[&] { EarthVirtualTexture.EndFeedback(width, height); });
+
+	//criação da fonte de luz direcional
+	DirectionalLight Light;
+	Light.Direction = glm::vec3{ 0.0f, 0.0f, -1.0f };
+	Light.Intensity = 1.0f;
+
+	while(Window ? !glfwWindowShouldClose(Window) : FrameIndex < Options.HeadlessFrames){
+		BeginProfilerFrame();
+
+		double CurrentTime = GetFrameTime();
+		double DeltaTime = CurrentTime - PreviousTime;
+		if (DeltaTime > 0.0) {
+			PreviousTime = CurrentTime;
+		}
+		
+		//troca a cor de espera pela prévia e pela textura final quando chegam
+		if (Options.bAsyncTextures) {
+			TextureLoader.Update();
+		}
+
+		//o frame headless vai para o framebuffer do contexto, religado caso alguma carga o tenha trocado
+		if (!Window) {
+			Headless.Bind();
+		}
+
+		//limpa o buffer de cor e preenche com a for configurada
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		//shaders gravados desde o último frame entram aqui, depois de linkar sem erro
+		Shaders.Update();
+		const ShaderHandle ActiveShader = Options.bTerrain ? TerrainShader : (Options.bProcedural ? ProceduralShader : TriangleShader);
+		const GLuint ActiveProgramID = Shaders.GetProgram(ActiveShader);
+		const GLuint FeedbackProgramID = Shaders.GetProgram(FeedbackShader);
+
+		//perto da superfície a câmera anda mais devagar e o near plane se aproxima
+		if (Options.bTerrain) {
+			const float Altitude = glm::max(glm::length(Camera.LocationVRP) - 1.0f, 1.0e-6f);
+			Camera.Speed = BaseCameraSpeed * glm::min(Altitude, 1.0f);
+			Camera.near = glm::min(BaseNearPlane, Altitude * 0.5f);
+		}
+
+		glm::mat4 NormalMatrix = glm::inverse(glm::transpose(Camera.GetView() * ModelMatrix));
+		glm::mat4 ViewProjectionMatrix = Camera.GetViewProjection();
+		glm::mat4 ModelViewProjection = ViewProjectionMatrix * ModelMatrix; 
+		const glm::vec3 ModelCameraPosition = glm::inverse(ModelMatrix) * glm::vec4{ Camera.LocationVRP, 1.0f };
+
+		//uma escrita com os dados do frame de todos os programas; o glBufferData descarta o conteúdo do frame
+		//anterior, que a GPU ainda pode estar lendo, sem esperar por ela
+		FrameUniforms Frame;
+		Frame.ModelViewProjection = ModelViewProjection;
+		Frame.NormalMatrix = NormalMatrix;
+		Frame.LightDirection = Camera.GetView() * glm::vec4{ Light.Direction, 0.0f };
+		Frame.LightIntensity = Light.Intensity;
+		Frame.CameraPosition = ModelCameraPosition;
+		Frame.Time = static_cast<float>(CurrentTime);
+		GetGLState().BindBuffer(GL_UNIFORM_BUFFER, FrameUniformBuffer);
+		glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), &Frame, GL_STREAM_DRAW);
+
+		//orçamento das texturas: um pixel no ponto mais próximo da superfície (raio 1) cobre esta fração do equador
+		const float SurfaceDistance = glm::max(glm::length(Camera.LocationVRP) - 1.0f, 1.0e-6f);
+		const float PixelFootprint = SurfaceDistance * 2.0f * glm::tan(Camera.angulo_de_visao * 0.5f) / static_cast<float>(height) / glm::two_pi<float>();
+		PlanetLayers.Update(PixelFootprint);
+
+		//desenha o objeto com os dados armazenados no vertexbuffer; o estado que não muda só chega ao driver no primeiro frame
+		GetGLState().SetPointSize(10.0f);
+		GetGLState().SetLineWidth(10.0f);
+		GetGLState().SetPolygonMode(GL_FILL);
+
+		//a profundidade dos draws na fila é a distância até a superfície; com um objeto por passada ela ainda não
+		//decide nada, mas o early-Z já recebe os draws da frente para trás quando houver mais
+		if (Options.bTerrain) {
+			//a seleção dos chunks usa a câmera no espaço do modelo do planeta
+			TerrainView View;
+			View.ModelViewProjection = ModelViewProjection;
+			View.CameraPosition = ModelCameraPosition;
+			View.FieldOfView = Camera.angulo_de_visao;
+			View.ViewportHeight = static_cast<float>(height);
+			Terrain.Select(View);
+
+			if (EarthVirtualTexture.IsOpen()) {
+				const glm::vec3 CameraVelocity = DeltaTime > 0.0 ? (View.CameraPosition - PreviousModelCameraPosition) / static_cast<float>(DeltaTime) : glm::vec3{ 0.0f };
+				PreviousModelCameraPosition = View.CameraPosition;
+				EarthVirtualTexture.Update(View.CameraPosition, CameraVelocity);
+			}
+
+			//os draws só rodam no Submit, depois deste bloco: GridSegments vai por valor
+			const float GridSegments = static_cast<float>(Options.Terrain.GridResolution - 1);
+			DrawQueue.Add(RenderPass::Opaque, ActiveProgramID, PlanetTextures, Terrain.GetVertexArray(), SurfaceDistance, [&, GridSegments] {
+				PROFILE_GPU_SCOPE("Terreno");
+				GetGLState().SetUniform(Shaders.GetUniformLocation(TerrainShader, "GridSegments"), GridSegments);
+				Terrain.Draw();
+			});
+
+			//as páginas que este frame usou, em baixa resolução, lidas nos próximos frames
+			if (EarthVirtualTexture.IsOpen()) {
+				DrawQueue.Add(RenderPass::Feedback, FeedbackProgramID, FeedbackTextures, Terrain.GetVertexArray(), SurfaceDistance, [&, GridSegments] {
+					PROFILE_GPU_SCOPE("Feedback da textura virtual");
+					GetGLState().SetUniform(Shaders.GetUniformLocation(FeedbackShader, "GridSegments"), GridSegments);
+					Terrain.Draw();
+				});
+			}
+		}
+		else if (Options.bProcedural) {
+			//uma faixa de triângulos por latitude, os vértices saem do gl_VertexID e do gl_InstanceID
+			DrawQueue.Add(RenderPass::Opaque, ActiveProgramID, PlanetTextures, ProceduralVAO, SurfaceDistance, [&] {
+				PROFILE_GPU_SCOPE("Esfera procedural");
+				GetGLState().SetUniform(Shaders.GetUniformLocation(ProceduralShader, "Resolution"), ProceduralResolution);
+				glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 2 * ProceduralResolution, ProceduralResolution - 1);
+			});
+		}
+		else if (Options.bMeshletCulling && !Sphere.Meshlets.empty()) {
+			//o cone das normais usa a câmera no espaço do modelo, como o terreno
+			SphereDrawList.Cull(Sphere.Meshlets, ModelViewProjection, ModelCameraPosition, Sphere.IndexType);
+
+			DrawQueue.Add(RenderPass::Opaque, ActiveProgramID, PlanetTextures, Sphere.VAO, SurfaceDistance, [&] {
+				PROFILE_GPU_SCOPE("Esfera");
+				SphereDrawList.Draw();
+			});
+		}
+		else {
+			DrawQueue.Add(RenderPass::Opaque, ActiveProgramID, PlanetTextures, Sphere.VAO, SurfaceDistance, [&] {
+				PROFILE_GPU_SCOPE("Esfera");
+				glDrawElements(GL_TRIANGLES, Sphere.NumIndices, Sphere.IndexType, nullptr);
+			});
+		}
+
+		DrawQueue.Submit(Options.bSortDraws);
+
+		//o programa e o VAO ficam ligados para o próximo frame, que quase sempre pede os mesmos
+
+		if (Window) {
+			//Processamento de todos os eventos da fila
+			glfwPollEvents();
+
+			//Envia o conteúdo para ser desenhado
+			PROFILE_SCOPE("glfwSwapBuffers");
+			glfwSwapBuffers(Window);
+		}
+		else {
+			//sem o swap nada segura a CPU frames à frente da GPU; o glFinish põe o tempo da GPU no frame
+			{
+				PROFILE_SCOPE("glFinish");
+				glFinish();
+			}
+
+			const bool bLastFrame = FrameIndex + 1 == Options.HeadlessFrames;
+			const bool bDumpFrame = Options.DumpInterval > 0 ? FrameIndex % Options.DumpInterval == 0 : bLastFrame;
+			if (!Options.DumpPrefix.empty() && bDumpFrame) {
+				char Suffix[16];
+				std::snprintf(Suffix, sizeof(Suffix), "_%04d.ppm", FrameIndex);
+				Headless.SaveFrame(Options.DumpPrefix + Suffix);
+			}
+		}
+		EndProfilerFrame();
+
+		if (bFirstFrame) {
+			bFirstFrame = false;
+			std::cout << "Tempo ate o primeiro frame: " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - StartupTime).count() << " ms" << std::endl;
+		}
+
+		//estatísticas uma vez por segundo
+		++FramesSinceStats;
+		if (CurrentTime - PreviousStatsTime >= 1.0) {
+			const double FrameMilliseconds = 1000.0 * (CurrentTime - PreviousStatsTime) / FramesSinceStats;
+
+			if (Options.bTerrain) {
+				const TerrainStats& Stats = Terrain.GetStats();
+				std::cout << "Terreno: " << Stats.NumChunks << " chunks, "
+					<< Stats.NumTriangles << " triangulos, nivel " << Stats.DeepestLevel
+					<< ", erro " << Stats.PixelError << " px, "
+					<< Stats.FrustumCulled << " fora do frustum, "
+					<< Stats.HorizonCulled << " atras do horizonte, selecao "
+					<< Stats.SelectionMilliseconds << " ms" << std::endl;
+
+				if (EarthVirtualTexture.IsOpen()) {
+					const VirtualTextureStats& VirtualStats = EarthVirtualTexture.GetStats();
+					std::cout << "Textura virtual: acerto de " << 100.0f * VirtualStats.GetHitRate() << "%, "
+						<< VirtualStats.GetUploadBytesPerFrame() / 1024 << " KiB enviados por frame ("
+						<< VirtualStats.Uploads << " paginas, " << VirtualStats.RAMHits << " da RAM), "
+						<< VirtualStats.DiskReads << " lidas do disco, " << VirtualStats.PrefetchedPages << " antecipadas, "
+						<< VirtualStats.ResidentPages << " residentes, " << VirtualStats.GPUEvictions << " despejadas, "
+						<< VirtualStats.RAMBytes / (1024 * 1024) << " MiB na RAM" << std::endl;
+					EarthVirtualTexture.ResetStats();
+				}
+			}
+			else if (Options.bProcedural) {
+				std::cout << "Esfera procedural: resolucao " << ProceduralResolution << ", "
+					<< FrameMilliseconds << " ms por frame" << std::endl;
+			}
+			else {
+				std::cout << "Esfera: " << (Sphere.VertexBytes + Sphere.IndexBytes) / 1024 << " KiB na GPU, "
+					<< FrameMilliseconds << " ms por frame" << std::endl;
+			}
+
+			const TextureMemoryStats& TextureStats = PlanetLayers.GetStats();
+			std::cout << "Texturas: " << TextureStats.ResidentBytes / 1024 << " de " << TextureStats.FullBytes / 1024 << " KiB na GPU";
+			if (TextureStats.BudgetBytes > 0) {
+				std::cout << " (orcamento de " << TextureStats.BudgetBytes / 1024 << " KiB, " << TextureStats.ReservedBytes / 1024 << " da textura virtual ou do cubemap"
+					<< (TextureStats.bOverBudget ? ", excedido pelas previas" : "") << ")";
+			}
+			std::cout << ", " << TextureStats.DroppedLevels << " levels descartados, " << TextureStats.RestoredLevels << " restaurados" << std::endl;
+
+			if (!Options.bTerrain && !Options.bProcedural && Options.bMeshletCulling && !Sphere.Meshlets.empty()) {
+				const MeshletCullStats& Stats = SphereDrawList.GetStats();
+				std::cout << "Meshlets: " << Stats.NumMeshlets - Stats.FrustumCulled - Stats.BackfaceCulled << " de " << Stats.NumMeshlets << " desenhados em "
+					<< Stats.NumDraws << " faixas, " << Stats.FrustumCulled << " fora do frustum, "
+					<< Stats.BackfaceCulled << " de costas, " << Stats.TrianglesSkipped << " triangulos e ~"
+					<< Stats.VerticesSkipped << " vertices poupados" << std::endl;
+			}
+
+			//trocas de estado do último frame na ordem pedida e na enviada
+			const RenderQueueStats& QueueStats = DrawQueue.GetStats();
+			std::cout << "Fila de desenho: " << QueueStats.NumDraws << " draws, " << QueueStats.Requested.GetTotal() << " trocas de estado na ordem pedida e "
+				<< QueueStats.Submitted.GetTotal() << " na enviada (programa " << QueueStats.Requested.Programs << " -> " << QueueStats.Submitted.Programs
+				<< ", texturas " << QueueStats.Requested.TextureSets << " -> " << QueueStats.Submitted.TextureSets
+				<< ", VAO " << QueueStats.Requested.VertexArrays << " -> " << QueueStats.Submitted.VertexArrays << "), ordenacao de "
+				<< QueueStats.SortMicroseconds << " us" << std::endl;
+
+			//chamadas de estado por frame, as que chegaram ao driver e as que o cache descartou
+			const GLStateStats& StateStats = GetGLState().GetStats();
+			const double StatsFrames = static_cast<double>(FramesSinceStats);
+			std::cout << "Estado GL: " << StateStats.GetIssued() / StatsFrames << " chamadas e "
+				<< StateStats.GetFiltered() / StatsFrames << " filtradas por frame (";
+			for (size_t Call = 0; Call < NumGLStateCalls; ++Call) {
+				std::cout << (Call > 0 ? ", " : "") << ToString(static_cast<GLStateCall>(Call)) << " "
+					<< StateStats.Issued[Call] / StatsFrames << "/" << StateStats.Filtered[Call] / StatsFrames;
+			}
+			std::cout << ")" << std::endl;
+			GetGLState().ResetStats();
+
+			PreviousStatsTime = CurrentTime;
+			FramesSinceStats = 0;
+		}
+
+		++FrameIndex;
+		if (!Window) {
+			continue;
+		}
+
+		//+ e - dobram ou dividem a resolução da esfera procedural, só na borda de subida da tecla
+		if (Options.bProcedural) {
+			const bool bIncrease = glfwGetKey(Window, GLFW_KEY_EQUAL) == GLFW_PRESS || glfwGetKey(Window, GLFW_KEY_KP_ADD) == GLFW_PRESS;
+			const bool bDecrease = glfwGetKey(Window, GLFW_KEY_MINUS) == GLFW_PRESS || glfwGetKey(Window, GLFW_KEY_KP_SUBTRACT) == GLFW_PRESS;
+			if (bIncrease && !bIncreaseWasPressed) {
+				ProceduralResolution = glm::min((ProceduralResolution - 1) * 2 + 1, MaxProceduralResolution);
+				std::cout << "Esfera procedural: resolucao " << ProceduralResolution << std::endl;
+			}
+			if (bDecrease && !bDecreaseWasPressed) {
+				ProceduralResolution = glm::max((ProceduralResolution - 1) / 2 + 1, 3);
+				std::cout << "Esfera procedural: resolucao " << ProceduralResolution << std::endl;
+			}
+			bIncreaseWasPressed = bIncrease;
+			bDecreaseWasPressed = bDecrease;
+		}
+
+		//Processamento dos inputs do teclado
+		if (glfwGetKey(Window, GLFW_KEY_W) == GLFW_PRESS) {
+			Camera.MoveForward(1.0f * DeltaTime);
+		}
+
+		if (glfwGetKey(Window, GLFW_KEY_S) == GLFW_PRESS) {
+			Camera.MoveForward(-1.0f * DeltaTime);
+		}
+
+		if (glfwGetKey(Window, GLFW_KEY_A) == GLFW_PRESS) {
+			Camera.MoveRight(-1.0f * DeltaTime);
+		}
+
+		if (glfwGetKey(Window, GLFW_KEY_D) == GLFW_PRESS) {
+			Camera.MoveRight(1.0f * DeltaTime);
+		}
+	}
+
+	//as últimas consultas de GPU precisam do contexto
+	StopProfiler();
+
+	if (!Window) {
+		const double WallMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - HeadlessStartTime).count();
+		std::cout << "Headless: " << FrameIndex << " frames de " << width << "x" << height << ", "
+			<< WallMilliseconds / glm::max(FrameIndex, 1) << " ms por frame" << std::endl;
+	}
+
+	//desaloca o buffer
+	GetGLState().DeleteVertexArrays(1, &QuadVAO);
+	GetGLState().DeleteBuffers(1, &FrameUniformBuffer);
+	DrawQueue.Shutdown();
+	EarthVirtualTexture.Shutdown();
+	EarthCubeMap.Shutdown();
+	Terrain.Shutdown();
+	TextureLoader.Shutdown();
+	PlanetLayers.Shutdown();
+	Shaders.Shutdown();
+	Headless.Destroy();
+
+	//encerra o glfw
+	if (Window) {
+		glfwTerminate();
+	}
+
+	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,16 @@
+//nuvens da camada de máscara girando com o tempo. Sem CLOUDS a amostra e os uniforms saem do programa
+#include "frame_uniforms.glsl"
+
+#ifdef CLOUDS
+uniform sampler2DArray MaskLayers;
+uniform int CloudsLayer;
+uniform vec2 CloudsRotationSpeed = vec2(0.008, 0.008);
+
+vec3 SampleClouds(vec2 UV){
+	return texture(MaskLayers, vec3(UV + Time * CloudsRotationSpeed, CloudsLayer)).rgb;
+}
+#else
+vec3 SampleClouds(vec2 UV){
+	return vec3(0.0);
+}
+#endif
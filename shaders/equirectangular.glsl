@@ -0,0 +1,16 @@
+//coordenada de textura equiretangular, incluída pelos shaders do terreno
+const float Pi = 3.14159265358979;
+
+//mesma convenção do EquirectangularUV. A longitude é escolhida entre [0, 1) e [-0.5, 0.5),
+//a que varia menos entre pixels vizinhos, para o mipmap não quebrar na costura
+vec2 EquirectangularUV(vec3 P){
+	vec3 N = normalize(P);
+	float Latitude = 1.0 - acos(clamp(N.z, -1.0, 1.0)) / Pi;
+	float Longitude = atan(N.y, N.x) / (2.0 * Pi);
+
+	float Wrapped = fract(Longitude);
+	float Centered = fract(Longitude + 0.5) - 0.5;
+	Longitude = fwidth(Wrapped) <= fwidth(Centered) ? Wrapped : Centered;
+
+	return vec2(Latitude, Longitude);
+}
@@ -0,0 +1,9 @@
+//dados do frame, um uniform buffer para todos os programas. A ordem segue a struct FrameUniforms do C++
+layout(std140) uniform FrameUniforms {
+	mat4 ModelViewProjection;
+	mat4 NormalMatrix;
+	vec3 LightDirection;     //no espaço da câmera
+	float LightIntensity;
+	vec3 CameraPosition;     //no espaço do modelo
+	float Time;
+};
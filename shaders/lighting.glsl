@@ -0,0 +1,28 @@
+//iluminação dos shaders da Terra: difuso de Lambert e, com SPECULAR, o especular de Phong
+#include "frame_uniforms.glsl"
+
+//a cor só entra no difuso, o especular é branco
+vec3 ApplyLighting(vec3 Albedo, vec3 SurfaceNormal){
+	//normaliza para não ter problemas na interpolação linear
+	vec3 N = normalize(SurfaceNormal);
+
+	//inverte a direção de luz para calular o vetor L
+	vec3 L = -normalize(LightDirection);
+	
+	float lambertian = max(dot(N, L), 0.0);
+	vec3 FinalColor = Albedo * LightIntensity * lambertian;
+
+#ifdef SPECULAR
+	// vetor V  
+	vec3 ViewDirection = vec3(0.0, 0.0, -1.0);
+	vec3 V = -ViewDirection;
+
+	//Vetor R 
+	vec3 R = reflect(-L, N);
+
+	//Termo especular: (R . V) ^ alpha
+	FinalColor += pow(max(dot(R, V), 0.0), 50.0);
+#endif
+
+	return FinalColor;
+}
@@ -0,0 +1,37 @@
+//esfera UV gerada no vertex shader, sem vertex buffer.
+//cada instância é uma faixa (triangle strip) entre as latitudes gl_InstanceID e gl_InstanceID + 1,
+//desenhada com glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 2 * Resolution, Resolution - 1).
+//os vértices saem iguais aos do WriteSphereVertices em SphereMesh.cpp.
+
+#version 330 core
+
+uniform int Resolution;
+
+#include "frame_uniforms.glsl"
+
+out vec3 Normal;
+out vec3 Color;
+out vec2 UV;
+
+const float PI = 3.14159265358979;
+
+void main(){
+	//vértices pares ficam na latitude de cima e ímpares na de baixo, o que deixa a faixa anti-horária vista de fora
+	int Row = gl_InstanceID + (gl_VertexID & 1);
+	int Column = gl_VertexID >> 1;
+
+	float InvResolution = 1.0 / float(Resolution - 1);
+	float U = float(Row) * InvResolution;
+	float V = float(Column) * InvResolution;
+
+	float Theta = PI * U;
+	float Phi = 2.0 * PI * V;
+	vec3 Position = vec3(sin(Theta) * cos(Phi), sin(Theta) * sin(Phi), cos(Theta));
+
+	Normal = vec3(NormalMatrix * vec4(Position,0.0));
+	Color = vec3(1.0);
+	UV = vec2(1.0 - U, V);
+
+	//Aplica a matriz nos vértices do triângulo
+	gl_Position = ModelViewProjection * vec4(Position, 1.0);
+}
@@ -0,0 +1,21 @@
+#version 330 core
+
+//Terra no cubemap reprojetado da equiretangular (CubeMapTexture), nuvens ainda na camada de máscara
+uniform samplerCube EarthCube;
+in vec3 Normal;
+in vec3 Color;
+in vec3 SpherePosition;
+out vec4 OutColor;
+
+#include "equirectangular.glsl"
+#include "clouds.glsl"
+#include "lighting.glsl"
+
+void main(){
+	//a direção no espaço do modelo escolhe a face, sem costura nem polos
+	vec3 EarthColor = texture(EarthCube, SpherePosition).rgb;
+	vec3 CloudColor = SampleClouds(EquirectangularUV(SpherePosition));
+	vec3 FinalColor = ApplyLighting(EarthColor + CloudColor, Normal);
+
+	OutColor =  vec4(FinalColor, 1.0);
+}
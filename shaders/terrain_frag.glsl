@@ -0,0 +1,22 @@
+#version 330 core
+
+//camadas de cor e de máscara (um canal lido como cinza), cada uma no seu array
+uniform sampler2DArray ColorLayers;
+uniform int EarthLayer;
+in vec3 Normal;
+in vec3 Color;
+in vec3 SpherePosition;
+out vec4 OutColor;
+
+#include "equirectangular.glsl"
+#include "clouds.glsl"
+#include "lighting.glsl"
+
+void main(){
+	vec2 UV = EquirectangularUV(SpherePosition);
+	vec3 EarthColor = texture(ColorLayers, vec3(UV, EarthLayer)).rgb;
+	vec3 CloudColor = SampleClouds(UV);
+	vec3 FinalColor = ApplyLighting(EarthColor + CloudColor, Normal);
+
+	OutColor =  vec4(FinalColor, 1.0);
+}
@@ -0,0 +1,44 @@
+//processamento dos vértices do terreno (CDLOD)
+
+#version 330 core
+
+layout (location = 0) in vec2 InGridPosition; //posição na grade do chunk, em [0, 1]
+layout (location = 4) in vec4 InChunkRect;    //xy = canto na face, z = tamanho, w = índice da face
+layout (location = 5) in vec2 InMorphRange;   //distância de início e fim do geomorph
+
+#include "frame_uniforms.glsl"
+
+uniform float GridSegments;  //segmentos por lado da grade do chunk
+
+out vec3 Normal;
+out vec3 Color;
+out vec3 SpherePosition;
+
+//mesma tabela de faces do GetCubeFace
+const vec3 FaceNormal[6] = vec3[6](vec3( 1.0, 0.0, 0.0), vec3(-1.0, 0.0, 0.0), vec3(0.0,  1.0, 0.0), vec3(0.0, -1.0, 0.0), vec3(0.0, 0.0,  1.0), vec3(0.0, 0.0, -1.0));
+const vec3 FaceAxisU[6]  = vec3[6](vec3( 0.0, 1.0, 0.0), vec3( 0.0, 0.0, 1.0), vec3(0.0,  0.0, 1.0), vec3(1.0,  0.0, 0.0), vec3(1.0, 0.0,  0.0), vec3(0.0, 1.0,  0.0));
+const vec3 FaceAxisV[6]  = vec3[6](vec3( 0.0, 0.0, 1.0), vec3( 0.0, 1.0, 0.0), vec3(1.0,  0.0, 0.0), vec3(0.0,  0.0, 1.0), vec3(0.0, 1.0,  0.0), vec3(1.0, 0.0,  0.0));
+
+vec3 CubeToSphere(int Face, vec2 FaceUV){
+	vec2 Signed = FaceUV * 2.0 - 1.0;
+	return normalize(FaceNormal[Face] + FaceAxisU[Face] * Signed.x + FaceAxisV[Face] * Signed.y);
+}
+
+void main(){
+	int Face = int(InChunkRect.w + 0.5);
+	vec2 FaceUV = InChunkRect.xy + InGridPosition * InChunkRect.z;
+
+	//geomorph: perto do fim da faixa do nível, os vértices ímpares deslizam até a grade do nível mais grosso
+	float Distance = length(CubeToSphere(Face, FaceUV) - CameraPosition);
+	float Morph = clamp((Distance - InMorphRange.x) / (InMorphRange.y - InMorphRange.x), 0.0, 1.0);
+	vec2 FracPart = fract(InGridPosition * GridSegments * 0.5) * 2.0 / GridSegments;
+	FaceUV -= FracPart * InChunkRect.z * Morph;
+
+	vec3 Position = CubeToSphere(Face, FaceUV);
+
+	Normal = vec3(NormalMatrix * vec4(Position, 0.0));
+	Color = vec3(1.0);
+	SpherePosition = Position; //a coordenada de textura é calculada por fragmento para não ter costura
+
+	gl_Position = ModelViewProjection * vec4(Position, 1.0);
+}
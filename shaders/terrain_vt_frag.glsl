@@ -0,0 +1,58 @@
+#version 330 core
+
+//as nuvens continuam no array de máscaras (clouds.glsl), a cor vem da textura virtual
+
+//textura virtual: tabela de páginas (RGBA8, um mip por nível, xy = página no cache físico, z = nível)
+//e cache físico com páginas de VirtualContentSize texels mais VirtualBorder de cada lado
+uniform sampler2D VirtualPageTable;
+uniform sampler2D VirtualPhysical;
+uniform vec2 VirtualImageSize;    //texels da imagem no nível 0
+uniform float VirtualContentSize;
+uniform float VirtualBorder;
+uniform float VirtualPhysicalSize;
+uniform float VirtualMaxLevel;
+uniform float VirtualLevelBias = 0.0;
+in vec3 Normal;
+in vec3 Color;
+in vec3 SpherePosition;
+out vec4 OutColor;
+
+#include "equirectangular.glsl"
+#include "clouds.glsl"
+#include "lighting.glsl"
+
+//nível de detalhe pelas derivadas, como o mipmap faria, e texels do nível com as mesmas dimensões do arquivo
+float VirtualLevel(vec2 UV){
+	vec2 Texel = UV * VirtualImageSize;
+	vec2 DX = dFdx(Texel);
+	vec2 DY = dFdy(Texel);
+	float Level = 0.5 * log2(max(max(dot(DX, DX), dot(DY, DY)), 1.0e-8)) + VirtualLevelBias;
+	return clamp(floor(Level), 0.0, VirtualMaxLevel);
+}
+
+vec2 VirtualLevelTexel(vec2 UV, float Level){
+	return fract(UV) * max(floor(VirtualImageSize / exp2(Level)), vec2(1.0));
+}
+
+//a entrada da tabela já aponta para o ancestral residente quando a página pedida ainda não chegou
+vec3 SampleVirtual(vec2 UV){
+	float Level = VirtualLevel(UV);
+	ivec2 Page = ivec2(VirtualLevelTexel(UV, Level) / VirtualContentSize);
+	vec3 Entry = floor(texelFetch(VirtualPageTable, Page, int(Level)).xyz * 255.0 + 0.5);
+
+	//posição relativa ao ancestral da página pedida: com níveis de tamanho ímpar o texel pode cair
+	//menos de um texel fora dela, o que a borda cobre
+	vec2 Texel = VirtualLevelTexel(UV, Entry.z);
+	vec2 InPage = Texel - vec2(Page >> ivec2(int(Entry.z - Level))) * VirtualContentSize;
+	vec2 Physical = Entry.xy * (VirtualContentSize + 2.0 * VirtualBorder) + VirtualBorder + InPage;
+	return textureLod(VirtualPhysical, Physical / VirtualPhysicalSize, 0.0).rgb;
+}
+
+void main(){
+	vec2 UV = EquirectangularUV(SpherePosition);
+	vec3 EarthColor = SampleVirtual(UV);
+	vec3 CloudColor = SampleClouds(UV);
+	vec3 FinalColor = ApplyLighting(EarthColor + CloudColor, Normal);
+
+	OutColor =  vec4(FinalColor, 1.0);
+}
@@ -0,0 +1,29 @@
+//processamento dos vértices no formato compactado (PackedVertex)
+
+#version 330 core
+
+layout (location = 0) in vec3 InPosition; //snorm16, o OpenGL já entrega em [-1, 1]
+layout (location = 1) in vec2 InNormal;   //normal codificada no octaedro
+layout (location = 3) in vec2 InUV;       //half float
+
+#include "frame_uniforms.glsl"
+
+out vec3 Normal;
+out vec3 Color;
+out vec2 UV;
+
+vec3 DecodeNormal(vec2 Encoded){
+	vec3 N = vec3(Encoded, 1.0 - abs(Encoded.x) - abs(Encoded.y));
+	float Fold = max(-N.z, 0.0);
+	N.xy += vec2(N.x >= 0.0 ? -Fold : Fold, N.y >= 0.0 ? -Fold : Fold);
+	return normalize(N);
+}
+
+void main(){
+	Normal = vec3(NormalMatrix * vec4(DecodeNormal(InNormal),0.0));
+	Color = vec3(1.0); //a cor era sempre branca, não vale a pena guardar por vértice
+	UV = InUV; //openGL interpola esse valor no pipeline
+
+	//Aplica a matriz nos vértices do triângulo
+	gl_Position = ModelViewProjection * vec4(InPosition, 1.0);
+}
@@ -0,0 +1,25 @@
+#version 330 core
+
+//passe de feedback da textura virtual: cada pixel escreve a página (x, y, nível) que o terrain_vt_frag usaria.
+//alfa 1 separa os pixels do planeta do fundo limpo com zero
+uniform vec2 VirtualImageSize;
+uniform float VirtualContentSize;
+uniform float VirtualMaxLevel;
+uniform float VirtualLevelBias = 0.0;
+in vec3 SpherePosition;
+out uvec4 OutPage;
+
+//mesma coordenada de textura do terrain_frag
+#include "equirectangular.glsl"
+
+void main(){
+	vec2 UV = EquirectangularUV(SpherePosition);
+
+	vec2 Texel = UV * VirtualImageSize;
+	vec2 DX = dFdx(Texel);
+	vec2 DY = dFdy(Texel);
+	float Level = clamp(floor(0.5 * log2(max(max(dot(DX, DX), dot(DY, DY)), 1.0e-8)) + VirtualLevelBias), 0.0, VirtualMaxLevel);
+
+	vec2 LevelTexel = fract(UV) * max(floor(VirtualImageSize / exp2(Level)), vec2(1.0));
+	OutPage = uvec4(uvec2(LevelTexel / VirtualContentSize), uint(Level), 1u);
+}
\ No newline at end of file